@@ -0,0 +1,184 @@
+#ifndef INTTITAN_ATOMIC_INTEGER_H
+#define INTTITAN_ATOMIC_INTEGER_H
+#include "integer.h"
+#include <immer/refcount/refcount_policy.hpp>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// Sharing integers between threads. A copy of an integer shares its digits with the original (a reference to the same
+// block, contiguous by default or the nodes of INTTITAN_FLEX_VECTOR_STORAGE) and copies them on the first write, so
+// copies may be read and changed by different threads as long as every thread changes only its own copies, and the
+// reference counts of the memory policy are atomic: integer_sharing_is_thread_safe. That holds for the default policy
+// and the mapped_memory_policy, not for single_thread_memory_policy and arena_memory_policy. Digits up to
+// INTTITAN_INLINE_LIMBS are part of the integer itself and copied with it.
+//
+// atomic_integer publishes a value to any number of readers without locks: store() replaces it and load() takes a copy,
+// which costs a few atomic operations (and the reference to the digits) however large the value is, e.g. for a modulus
+// that is broadcast to the worker threads and changed now and then.
+namespace int_titan
+{
+    struct atomic_integer_replay;
+    constexpr bool integer_sharing_is_thread_safe = std::is_same<integer::memory_policy::refcount, immer::refcount_policy>::value;
+    // An integer that threads may read and replace concurrently, lock-free. The value lives in a node with a reference
+    // count, and the atomic word holds the address of the node with a count of the readers about to copy it in the bits
+    // the address leaves free (differential reference counting): a reader adds one to the word, which keeps the node
+    // from being freed, copies the value, and takes the one back, from the word if the node is still the current one,
+    // else from the node to which the writer that replaced it moved the readers of the word.
+    //
+    // The count in the word has 16 bits with 64-bit pointers (32 with 32-bit ones), so at most 65535 threads may be in
+    // load() at the same time. One more would carry into the address and make every reader copy from a node that is
+    // not there: undefined behavior, which debug builds catch with an assertion in acquire().
+    class atomic_integer
+    {
+    public:
+        static_assert(integer_sharing_is_thread_safe, "atomic_integer needs the atomic reference counts of a thread-safe memory policy.");
+        explicit atomic_integer(integer x = integer()) : word(pack(new node(std::move(x))))
+        {
+        }
+        atomic_integer(const atomic_integer&) = delete;
+        atomic_integer& operator=(const atomic_integer&) = delete;
+        ~atomic_integer()
+        {
+            replace(word.load(std::memory_order_acquire), 0);
+        }
+        // A copy of the current value.
+        integer load() const
+        {
+            node* const n = acquire();
+            integer x = n->value;
+            unpin(n);
+            return x;
+        }
+        operator integer() const
+        {
+            return load();
+        }
+        void store(integer x)
+        {
+            replace(word.exchange(pack(new node(std::move(x))), std::memory_order_acq_rel), 0);
+        }
+        atomic_integer& operator=(integer x)
+        {
+            store(std::move(x));
+            return *this;
+        }
+        // Store x and return the value it replaced.
+        integer exchange(integer x)
+        {
+            node* const next = new node(std::move(x));
+            const std::uint64_t previous = word.exchange(pack(next), std::memory_order_acq_rel);
+            integer old = unpack(previous)->value;
+            replace(previous, 0);
+            return old;
+        }
+        // Replace the value x by f(x) atomically and return the new value. f may be called more than once, when other
+        // threads change the value meanwhile, so it must have no side effects.
+        template<typename F>
+        integer update(F&& f)
+        {
+            while(true)
+            {
+                // The node stays pinned until the exchange, so its address cannot be that of a newer node.
+                node* const current = acquire();
+                node* next = nullptr;
+                try
+                {
+                    next = new node(f(static_cast<const integer&>(current->value)));
+                }
+                catch(...)
+                {
+                    unpin(current);
+                    throw;
+                }
+                // Copied before it is published, after which another writer may free it.
+                integer result = next->value;
+                std::uint64_t expected = word.load(std::memory_order_acquire);
+                while(unpack(expected) == current)
+                {
+                    if(word.compare_exchange_weak(expected, pack(next), std::memory_order_acq_rel, std::memory_order_acquire))
+                    {
+                        // The pin of this thread was among the readers of the word.
+                        replace(expected, -1);
+                        return result;
+                    }
+                }
+                unpin(current);
+                delete next;
+            }
+        }
+        // Is the atomic word of this platform lock-free (with no lock inside std::atomic)?
+        static constexpr bool is_lock_free()
+        {
+            return std::atomic<std::uint64_t>::is_always_lock_free;
+        }
+    private:
+        // Steps the operations one at a time, to replay interleavings of threads in the tests.
+        friend struct atomic_integer_replay;
+        struct node
+        {
+            // References beyond the one of the atomic word, which is implicit while the node is current: the readers the
+            // writer that replaced it moved from the word, less those that have unpinned since. Readers may unpin before
+            // the writer moves them, so the count can go negative meanwhile, but it only reaches 0 when the node has
+            // been replaced and every reader has let go, after which nothing touches it.
+            std::atomic<std::int64_t> references{0};
+            const integer value;
+            explicit node(integer x) : value(std::move(x))
+            {
+            }
+        };
+        // The address takes the high bits of the word and the readers the low ones: 16 bits with 64-bit pointers, whose
+        // user space addresses have 48 bits, 32 with 32-bit ones. This bounds the concurrent readers, see the class.
+        static constexpr int reader_bits = sizeof(void*) == 8 ? 16 : 32;
+        static constexpr std::uint64_t reader_mask = (std::uint64_t(1) << reader_bits) - 1;
+        mutable std::atomic<std::uint64_t> word;
+        static std::uint64_t pack(node* const n)
+        {
+            const std::uint64_t address = reinterpret_cast<std::uintptr_t>(n);
+            assert(address >> (64 - reader_bits) == 0);
+            return address << reader_bits;
+        }
+        static node* unpack(const std::uint64_t w)
+        {
+            return reinterpret_cast<node*>(static_cast<std::uintptr_t>(w >> reader_bits));
+        }
+        // Add delta to the references of n, freeing it when none are left.
+        static void release(node* const n, const std::int64_t delta)
+        {
+            if(n->references.fetch_add(delta, std::memory_order_acq_rel) + delta == 0)
+            {
+                delete n;
+            }
+        }
+        // The node of a word just replaced: its readers become references of the node (and the implicit one of the
+        // word goes), plus as many more as given.
+        static void replace(const std::uint64_t previous, const std::int64_t more)
+        {
+            release(unpack(previous), static_cast<std::int64_t>(previous & reader_mask) + more);
+        }
+        // Pin the current node as a reader of the word.
+        node* acquire() const
+        {
+            const std::uint64_t previous = word.fetch_add(1, std::memory_order_acq_rel);
+            assert((previous & reader_mask) != reader_mask);
+            return unpack(previous);
+        }
+        // Take back the pin of n: from the word while n is current, else from n itself, where the writer moved it.
+        void unpin(node* const n) const
+        {
+            std::uint64_t expected = word.load(std::memory_order_acquire);
+            while(unpack(expected) == n)
+            {
+                if(word.compare_exchange_weak(expected, expected - 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    return;
+                }
+            }
+            release(n, -1);
+        }
+    };
+}
+
+#endif //INTTITAN_ATOMIC_INTEGER_H
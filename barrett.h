@@ -0,0 +1,64 @@
+#ifndef INTTITAN_BARRETT_H
+#define INTTITAN_BARRETT_H
+#include "config.h"
+#include "kernels.h"
+#include "multiplication.h"
+#include <algorithm>
+#include <cstddef>
+
+// Barrett reduction (P. Barrett, 1986; Handbook of Applied Cryptography, algorithm 14.42) modulo an m of k limbs, with
+// its top limb non-zero. Given mu = floor(B^2k / m), the quotient of an x below B^2k is estimated from its top limbs by
+// two multiplications, and it is at most two too small, so no division is needed.
+namespace int_titan
+{
+    namespace kernels
+    {
+        // Limbs of temporary memory barrett_reduce() needs for a modulus of k limbs.
+        constexpr std::size_t barrett_scratch_size(const std::size_t k)
+        {
+            return 5 * k + 6;
+        }
+        // r = x mod m for x of xn limbs, at most 2k. mu has mun limbs (k + 1, or k + 2 when m is a power of B). Writes k
+        // limbs, r must not overlap x.
+        inline void barrett_reduce(digit* r, const digit* x, const std::size_t xn, const digit* m, const std::size_t k, const digit* mu, const std::size_t mun, digit* t)
+        {
+            if(compare(x, xn, m, k) < 0)
+            {
+                std::copy(x, x + std::min(xn, k), r);
+                std::fill(r + std::min(xn, k), r + k, digit(0));
+                return;
+            }
+            // q2 = floor(x / B^(k - 1)) * mu.
+            const digit* q1 = x + k - 1;
+            const std::size_t q1n = xn - k + 1;
+            digit* q2 = t;
+            const std::size_t q2n = q1n + mun;
+            if(q1n >= mun)
+            {
+                multiply(q2, q1, q1n, mu, mun);
+            }
+            else
+            {
+                multiply(q2, mu, mun, q1, q1n);
+            }
+            // The estimate q3 = floor(q2 / B^(k + 1)), and u = x - q3 * m modulo B^(k + 1), which is below 3m.
+            digit* u = q2 + q2n;
+            std::copy(x, x + std::min(xn, k + 1), u);
+            std::fill(u + std::min(xn, k + 1), u + k + 1, digit(0));
+            if(q2n > k + 1)
+            {
+                // Only the low k + 1 limbs of q3 * m count, so they are all that is computed.
+                digit* product = u + k + 1;
+                multiply_low(product, q2 + k + 1, q2n - k - 1, m, k, k + 1);
+                sub_n(u, u, product, k + 1);
+            }
+            while(compare(u, k + 1, m, k) >= 0)
+            {
+                subtract(u, u, k + 1, m, k);
+            }
+            std::copy(u, u + k, r);
+        }
+    }
+}
+
+#endif //INTTITAN_BARRETT_H
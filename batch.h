@@ -0,0 +1,184 @@
+#ifndef INTTITAN_BATCH_H
+#define INTTITAN_BATCH_H
+#include "integer.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+// Arithmetic over arrays of independent integers: r[i] = x[i] op y[i] for i < count. With a parallel_executor the
+// elements are split into parts of about the same cost (not count, as the sizes may differ widely) that run on its
+// threads. A modulus is prepared once for the whole batch. r may be x or y.
+namespace int_titan
+{
+    namespace batch
+    {
+        // Elements below which a batch stays on the calling thread.
+        constexpr std::size_t parallel_elements = 256;
+        // f(first, last) over [0, count), split into ranges of about equal cost(i) for the executor.
+        template<typename Cost, typename F>
+        void for_each_range(const std::size_t count, const Cost& cost, const F& f)
+        {
+            if(parallel_executor == nullptr or count < parallel_elements)
+            {
+                f(std::size_t(0), count);
+                return;
+            }
+            const std::size_t parts = std::min(4 * parallel_executor->concurrency(), count / (parallel_elements / 4));
+            // Cumulative cost, then the range boundaries at equal steps of it.
+            std::vector<double> total(count + 1, 0.0);
+            for(std::size_t i = 0; i < count; i++)
+            {
+                total[i + 1] = total[i] + cost(i);
+            }
+            std::vector<std::size_t> bounds(parts + 1, count);
+            bounds[0] = 0;
+            for(std::size_t p = 1; p < parts; p++)
+            {
+                bounds[p] = std::lower_bound(total.begin(), total.end(), total[count] * p / parts) - total.begin();
+            }
+            kernels::parallel_for(parts, [&](const std::size_t p)
+            {
+                f(bounds[p], std::max(bounds[p], bounds[p + 1]));
+            });
+        }
+        // Cost of adding x and y, or of a comparison: their digits.
+        inline double linear_cost(const integer& x, const integer& y)
+        {
+            return 1.0 + static_cast<double>(std::max(integer::bit_length(x), integer::bit_length(y)) / digit_bits);
+        }
+        // r[i] = x[i] + y[i].
+        inline void add(integer* r, const integer* x, const integer* y, const std::size_t count)
+        {
+            for_each_range(count, [&](const std::size_t i) { return linear_cost(x[i], y[i]); }, [&](const std::size_t first, const std::size_t last)
+            {
+                for(std::size_t i = first; i < last; i++)
+                {
+                    // The in-place sum: a result that is an operand keeps its digits.
+                    if(&r[i] == &y[i])
+                    {
+                        r[i] += x[i];
+                    }
+                    else
+                    {
+                        if(&r[i] != &x[i])
+                        {
+                            r[i] = x[i];
+                        }
+                        r[i] += y[i];
+                    }
+                }
+            });
+        }
+        // r[i] = x[i] - y[i].
+        inline void subtract(integer* r, const integer* x, const integer* y, const std::size_t count)
+        {
+            for_each_range(count, [&](const std::size_t i) { return linear_cost(x[i], y[i]); }, [&](const std::size_t first, const std::size_t last)
+            {
+                for(std::size_t i = first; i < last; i++)
+                {
+                    if(&r[i] == &y[i])
+                    {
+                        integer difference = x[i];
+                        difference -= y[i];
+                        r[i] = std::move(difference);
+                        continue;
+                    }
+                    if(&r[i] != &x[i])
+                    {
+                        r[i] = x[i];
+                    }
+                    r[i] -= y[i];
+                }
+            });
+        }
+        // r[i] = x[i] * y[i].
+        inline void multiply(integer* r, const integer* x, const integer* y, const std::size_t count)
+        {
+            const auto cost = [&](const std::size_t i)
+            {
+                return 1.0 + static_cast<double>(integer::bit_length(x[i]) / digit_bits) * static_cast<double>(integer::bit_length(y[i]) / digit_bits);
+            };
+            for_each_range(count, cost, [&](const std::size_t first, const std::size_t last)
+            {
+                for(std::size_t i = first; i < last; i++)
+                {
+                    r[i] = x[i] * y[i];
+                }
+            });
+        }
+        // r[i] = x[i] % m, truncated like the operator, through one Barrett reduction prepared for m.
+        inline void mod(integer* r, const integer* x, const std::size_t count, const integer& m)
+        {
+            if(integer::bit_length(m) == 0)
+            {
+                throw std::logic_error("Division by 0 impermissible.");
+            }
+            // The remainder takes the sign of x, so that of m does not matter.
+            const barrett_reducer reducer(integer::absolute_value(m));
+            for_each_range(count, [&](const std::size_t i) { return linear_cost(x[i], m); }, [&](const std::size_t first, const std::size_t last)
+            {
+                for(std::size_t i = first; i < last; i++)
+                {
+                    r[i] = reducer.reduce(x[i]);
+                }
+            });
+        }
+        // r[i] = integer::compare(x[i], y[i]): -1, 0 or 1.
+        inline void compare(int* r, const integer* x, const integer* y, const std::size_t count)
+        {
+            for_each_range(count, [&](const std::size_t i) { return linear_cost(x[i], y[i]); }, [&](const std::size_t first, const std::size_t last)
+            {
+                for(std::size_t i = first; i < last; i++)
+                {
+                    r[i] = integer::compare(x[i], y[i]);
+                }
+            });
+        }
+        // The same over vectors, of the same size.
+        inline void check_sizes(const std::vector<integer>& x, const std::vector<integer>& y)
+        {
+            if(x.size() != y.size())
+            {
+                throw std::logic_error("Batch operands differ in size.");
+            }
+        }
+        inline std::vector<integer> add(const std::vector<integer>& x, const std::vector<integer>& y)
+        {
+            check_sizes(x, y);
+            std::vector<integer> r(x.size());
+            add(r.data(), x.data(), y.data(), x.size());
+            return r;
+        }
+        inline std::vector<integer> subtract(const std::vector<integer>& x, const std::vector<integer>& y)
+        {
+            check_sizes(x, y);
+            std::vector<integer> r(x.size());
+            subtract(r.data(), x.data(), y.data(), x.size());
+            return r;
+        }
+        inline std::vector<integer> multiply(const std::vector<integer>& x, const std::vector<integer>& y)
+        {
+            check_sizes(x, y);
+            std::vector<integer> r(x.size());
+            multiply(r.data(), x.data(), y.data(), x.size());
+            return r;
+        }
+        inline std::vector<integer> mod(const std::vector<integer>& x, const integer& m)
+        {
+            std::vector<integer> r(x.size());
+            mod(r.data(), x.data(), x.size(), m);
+            return r;
+        }
+        inline std::vector<int> compare(const std::vector<integer>& x, const std::vector<integer>& y)
+        {
+            check_sizes(x, y);
+            std::vector<int> r(x.size());
+            compare(r.data(), x.data(), y.data(), x.size());
+            return r;
+        }
+    }
+}
+
+#endif //INTTITAN_BATCH_H
@@ -0,0 +1,187 @@
+// Microbenchmarks of the integer operations over operand sizes from 1 limb to 10^7 limbs, with the throughput in limbs
+// (of the larger operand) per second, built by the bench target (INTTITAN_BENCH, needs Google Benchmark). For results to
+// keep and compare, run
+//     bench --benchmark_out=results.json --benchmark_out_format=json
+// and --benchmark_filter=<regex> picks operations, e.g. 'multiply|square' to place the multiplication tiers. Decimal
+// conversion and division stop at smaller sizes, where one run already takes seconds.
+#include "integer.h"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using int_titan::digit;
+using int_titan::integer;
+
+namespace
+{
+    // A random n-limb integer with a nonzero top limb, the same one for the same n and seed on every run.
+    integer random_integer(const std::size_t n, const std::uint64_t seed)
+    {
+        std::mt19937_64 rng(seed * 1000003 + n);
+        std::vector<digit> limbs(n);
+        for(digit& d : limbs)
+        {
+            d = static_cast<digit>(rng());
+        }
+        limbs.back() |= digit(1) << (int_titan::digit_bits - 1);
+        return integer::create(int_titan::integer_view(limbs.data(), n));
+    }
+    // The operand sizes: powers of two up to 2^20 limbs, then 10^7.
+    void sizes(benchmark::internal::Benchmark* b, const std::size_t largest)
+    {
+        for(std::size_t n = 1; n <= largest and n <= (std::size_t(1) << 20); n *= 2)
+        {
+            b->Arg(static_cast<std::int64_t>(n));
+        }
+        if(largest >= 10000000)
+        {
+            b->Arg(10000000);
+        }
+    }
+    void all_sizes(benchmark::internal::Benchmark* b)
+    {
+        sizes(b, 10000000);
+    }
+    void division_sizes(benchmark::internal::Benchmark* b)
+    {
+        sizes(b, std::size_t(1) << 20);
+    }
+    void decimal_sizes(benchmark::internal::Benchmark* b)
+    {
+        sizes(b, std::size_t(1) << 18);
+    }
+    void count_limbs(benchmark::State& state, const std::size_t n)
+    {
+        state.counters["limbs/s"] = benchmark::Counter(static_cast<double>(n), benchmark::Counter::kIsIterationInvariantRate);
+    }
+
+    void add(benchmark::State& state)
+    {
+        const std::size_t n = static_cast<std::size_t>(state.range(0));
+        const integer x = random_integer(n, 1);
+        const integer y = random_integer(n, 2);
+        for(auto _ : state)
+        {
+            benchmark::DoNotOptimize(x + y);
+        }
+        count_limbs(state, n);
+    }
+    void subtract(benchmark::State& state)
+    {
+        const std::size_t n = static_cast<std::size_t>(state.range(0));
+        const integer x = random_integer(n, 1);
+        const integer y = random_integer(n, 2);
+        for(auto _ : state)
+        {
+            benchmark::DoNotOptimize(x - y);
+        }
+        count_limbs(state, n);
+    }
+    void multiply(benchmark::State& state)
+    {
+        const std::size_t n = static_cast<std::size_t>(state.range(0));
+        const integer x = random_integer(n, 1);
+        const integer y = random_integer(n, 2);
+        for(auto _ : state)
+        {
+            benchmark::DoNotOptimize(x * y);
+        }
+        count_limbs(state, n);
+    }
+    void square(benchmark::State& state)
+    {
+        const std::size_t n = static_cast<std::size_t>(state.range(0));
+        const integer x = random_integer(n, 1);
+        for(auto _ : state)
+        {
+            benchmark::DoNotOptimize(integer::square(x));
+        }
+        count_limbs(state, n);
+    }
+    // 2n limbs by n limbs.
+    void divide(benchmark::State& state)
+    {
+        const std::size_t n = static_cast<std::size_t>(state.range(0));
+        const integer x = random_integer(2 * n, 1);
+        const integer y = random_integer(n, 2);
+        for(auto _ : state)
+        {
+            benchmark::DoNotOptimize(integer::divide(x, y));
+        }
+        count_limbs(state, 2 * n);
+    }
+    // Equal but for the lowest limb, so all of them are compared.
+    void compare(benchmark::State& state)
+    {
+        const std::size_t n = static_cast<std::size_t>(state.range(0));
+        const integer x = random_integer(n, 1);
+        integer y = x;
+        y += integer::one;
+        for(auto _ : state)
+        {
+            benchmark::DoNotOptimize(integer::compare(x, y));
+        }
+        count_limbs(state, n);
+    }
+    // The halves of a 2n-limb integer joined and the high one taken off again, which share the nodes of the trees instead
+    // of copying limbs in a build with INTTITAN_FLEX_VECTOR_STORAGE: a bench of each storage compares them.
+    void concat_limbs(benchmark::State& state)
+    {
+        const std::size_t n = static_cast<std::size_t>(state.range(0));
+        const integer high = random_integer(n, 1);
+        const integer low = random_integer(n, 2);
+        for(auto _ : state)
+        {
+            benchmark::DoNotOptimize(integer::concat_limbs(high, low, n));
+        }
+        count_limbs(state, 2 * n);
+    }
+    void shift_right(benchmark::State& state)
+    {
+        const std::size_t n = static_cast<std::size_t>(state.range(0));
+        const integer x = random_integer(2 * n, 1);
+        for(auto _ : state)
+        {
+            benchmark::DoNotOptimize(integer::shift_right(x, static_cast<int>(n)));
+        }
+        count_limbs(state, 2 * n);
+    }
+    void parse(benchmark::State& state, const int base)
+    {
+        const std::size_t n = static_cast<std::size_t>(state.range(0));
+        const std::string text = integer::to_string(random_integer(n, 1), base);
+        for(auto _ : state)
+        {
+            benchmark::DoNotOptimize(integer::create(text, base));
+        }
+        count_limbs(state, n);
+    }
+    void format(benchmark::State& state, const int base)
+    {
+        const std::size_t n = static_cast<std::size_t>(state.range(0));
+        const integer x = random_integer(n, 1);
+        for(auto _ : state)
+        {
+            benchmark::DoNotOptimize(integer::to_string(x, base));
+        }
+        count_limbs(state, n);
+    }
+}
+
+BENCHMARK(add)->Apply(all_sizes);
+BENCHMARK(subtract)->Apply(all_sizes);
+BENCHMARK(multiply)->Apply(all_sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(square)->Apply(all_sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(divide)->Apply(division_sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(compare)->Apply(all_sizes);
+BENCHMARK(concat_limbs)->Apply(all_sizes);
+BENCHMARK(shift_right)->Apply(all_sizes);
+BENCHMARK_CAPTURE(parse, hex, 16)->Apply(all_sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(parse, decimal, 10)->Apply(decimal_sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(format, hex, 16)->Apply(all_sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(format, decimal, 10)->Apply(decimal_sizes)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,213 @@
+// Modular exponentiation at the sizes of public-key cryptography, 1024 to 4096 bits with an exponent of the size of
+// the modulus: the sliding window of pow_mod, its constant-time fixed window, and a fixed_base_table of a base that
+// takes many exponents. Built by the bench_pow_mod target (INTTITAN_BENCH, needs Google Benchmark); with
+// INTTITAN_BENCH_COMPARE it also runs GMP's mpz_powm and mpz_powm_sec and OpenSSL's BN_mod_exp_mont and
+// BN_mod_exp_mont_consttime on the same operands, so that
+//     bench_pow_mod --benchmark_filter=/2048
+// puts every implementation at one size side by side. Each result has ops/s and, on x86-64, cycles/op from the time
+// stamp counter, which ticks at the nominal frequency of the processor (not the current one with turbo or power saving).
+#include "integer.h"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+#if INTTITAN_BENCH_GMP
+#include <gmp.h>
+#endif
+#if INTTITAN_BENCH_OPENSSL
+#include <openssl/bn.h>
+#endif
+
+using int_titan::digit;
+using int_titan::integer;
+
+namespace
+{
+    // A random integer of exactly the given bits, the same one for the same bits and seed on every run.
+    integer random_bits(const std::size_t bits, const std::uint64_t seed)
+    {
+        std::mt19937_64 rng(seed * 1000003 + bits);
+        const std::size_t n = (bits + int_titan::digit_bits - 1) / int_titan::digit_bits;
+        std::vector<digit> limbs(n);
+        for(digit& d : limbs)
+        {
+            d = static_cast<digit>(rng());
+        }
+        const std::size_t top = bits - (n - 1) * int_titan::digit_bits;
+        if(top < int_titan::digit_bits)
+        {
+            limbs.back() &= (digit(1) << top) - 1;
+        }
+        limbs.back() |= digit(1) << (top - 1);
+        return integer::create(int_titan::integer_view(limbs.data(), n));
+    }
+    // The operands of a size: an odd modulus (as of RSA and Diffie-Hellman), a base below it and a full exponent.
+    struct operands
+    {
+        integer modulus;
+        integer base;
+        integer exponent;
+        explicit operands(const std::size_t bits)
+            : modulus(random_bits(bits, 1) | integer::one), base(random_bits(bits - 1, 2)), exponent(random_bits(bits, 3))
+        {
+        }
+    };
+    std::uint64_t cycles()
+    {
+#if defined(__x86_64__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+    // Time calls of f, with the throughput and, where there is a cycle counter, the cycles of a call.
+    template<typename F>
+    void measure(benchmark::State& state, F&& f)
+    {
+        const std::uint64_t start = cycles();
+        for(auto _ : state)
+        {
+            f();
+        }
+        const std::uint64_t elapsed = cycles() - start;
+        state.counters["ops/s"] = benchmark::Counter(1, benchmark::Counter::kIsIterationInvariantRate);
+        if(elapsed != 0)
+        {
+            state.counters["cycles/op"] = benchmark::Counter(static_cast<double>(elapsed) / static_cast<double>(state.iterations()));
+        }
+    }
+    std::size_t bits_of(const benchmark::State& state)
+    {
+        return static_cast<std::size_t>(state.range(0));
+    }
+
+    void windowed(benchmark::State& state)
+    {
+        const operands o(bits_of(state));
+        measure(state, [&] { benchmark::DoNotOptimize(integer::pow_mod(o.base, o.exponent, o.modulus)); });
+    }
+    void constant_time(benchmark::State& state)
+    {
+        const operands o(bits_of(state));
+        measure(state, [&] { benchmark::DoNotOptimize(integer::pow_mod(o.base, o.exponent, o.modulus, true)); });
+    }
+    // The table is built once, outside the timing, as for a generator that serves many exponents.
+    void fixed_base(benchmark::State& state, const int window_bits)
+    {
+        const operands o(bits_of(state));
+        const int_titan::montgomery_context context(o.modulus);
+        const int_titan::fixed_base_table table(context, o.base, bits_of(state), window_bits);
+        measure(state, [&] { benchmark::DoNotOptimize(table.pow(o.exponent)); });
+    }
+
+#if INTTITAN_BENCH_GMP
+    // An mpz_t with the value of x (non-negative), through hexadecimal.
+    struct gmp_integer
+    {
+        mpz_t value;
+        explicit gmp_integer(const integer& x)
+        {
+            mpz_init_set_str(value, integer::to_string(x).c_str(), 16);
+        }
+        gmp_integer(const gmp_integer&) = delete;
+        gmp_integer& operator=(const gmp_integer&) = delete;
+        ~gmp_integer()
+        {
+            mpz_clear(value);
+        }
+    };
+    void gmp_powm(benchmark::State& state, const bool secure)
+    {
+        const operands o(bits_of(state));
+        const gmp_integer m(o.modulus);
+        const gmp_integer b(o.base);
+        const gmp_integer e(o.exponent);
+        gmp_integer r(integer::zero);
+        measure(state, [&]
+        {
+            if(secure)
+            {
+                mpz_powm_sec(r.value, b.value, e.value, m.value);
+            }
+            else
+            {
+                mpz_powm(r.value, b.value, e.value, m.value);
+            }
+            benchmark::DoNotOptimize(r.value);
+        });
+    }
+#endif
+
+#if INTTITAN_BENCH_OPENSSL
+    // A BIGNUM with the value of x (non-negative), through hexadecimal.
+    BIGNUM* openssl_integer(const integer& x)
+    {
+        BIGNUM* value = nullptr;
+        BN_hex2bn(&value, integer::to_string(x).c_str());
+        return value;
+    }
+    // With the Montgomery context of the modulus made once, as OpenSSL keeps it with an RSA key.
+    void openssl_mod_exp(benchmark::State& state, const bool consttime)
+    {
+        const operands o(bits_of(state));
+        BIGNUM* const m = openssl_integer(o.modulus);
+        BIGNUM* const b = openssl_integer(o.base);
+        BIGNUM* const e = openssl_integer(o.exponent);
+        BIGNUM* const r = BN_new();
+        BN_CTX* const ctx = BN_CTX_new();
+        BN_MONT_CTX* const mont = BN_MONT_CTX_new();
+        BN_MONT_CTX_set(mont, m, ctx);
+        if(consttime)
+        {
+            BN_set_flags(e, BN_FLG_CONSTTIME);
+        }
+        measure(state, [&]
+        {
+            if(consttime)
+            {
+                BN_mod_exp_mont_consttime(r, b, e, m, ctx, mont);
+            }
+            else
+            {
+                BN_mod_exp_mont(r, b, e, m, ctx, mont);
+            }
+            benchmark::DoNotOptimize(r);
+        });
+        BN_MONT_CTX_free(mont);
+        BN_CTX_free(ctx);
+        for(BIGNUM* x : {m, b, e, r})
+        {
+            BN_free(x);
+        }
+    }
+#endif
+
+    void crypto_sizes(benchmark::internal::Benchmark* b)
+    {
+        for(const std::int64_t bits : {1024, 2048, 3072, 4096})
+        {
+            b->Arg(bits);
+        }
+        b->Unit(benchmark::kMicrosecond);
+    }
+}
+
+BENCHMARK(windowed)->Apply(crypto_sizes);
+BENCHMARK(constant_time)->Apply(crypto_sizes);
+BENCHMARK_CAPTURE(fixed_base, window_4, 4)->Apply(crypto_sizes);
+BENCHMARK_CAPTURE(fixed_base, window_6, 6)->Apply(crypto_sizes);
+#if INTTITAN_BENCH_GMP
+BENCHMARK_CAPTURE(gmp_powm, mpz_powm, false)->Apply(crypto_sizes);
+BENCHMARK_CAPTURE(gmp_powm, mpz_powm_sec, true)->Apply(crypto_sizes);
+#endif
+#if INTTITAN_BENCH_OPENSSL
+BENCHMARK_CAPTURE(openssl_mod_exp, BN_mod_exp_mont, false)->Apply(crypto_sizes);
+BENCHMARK_CAPTURE(openssl_mod_exp, BN_mod_exp_mont_consttime, true)->Apply(crypto_sizes);
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,502 @@
+#ifndef INTTITAN_BIGFLOAT_H
+#define INTTITAN_BIGFLOAT_H
+#include "config.h"
+#include "integer.h"
+#include "rational.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Binary floating point of any precision: an integer mantissa times 2 to a 64-bit exponent, as in MPFR. Each value has
+// a precision in bits, and each operation rounds its exact result once, to the precision and in the rounding mode asked
+// for (the operators to the larger precision of their operands, to nearest). The mantissa is kept odd, so that every
+// value has one representation. The exponents are not checked for overflow.
+namespace int_titan
+{
+    // The rounding modes of IEEE 754.
+    enum class rounding_mode
+    {
+        // To the nearest value, ties to the even mantissa.
+        nearest,
+        toward_zero,
+        // Toward +infinity and -infinity.
+        upward,
+        downward
+    };
+    class bigfloat
+    {
+    public:
+        using exponent_type = std::int64_t;
+        // Zero.
+        bigfloat() : mantissa_value(), exponent_value(0), precision_value(INTTITAN_BIGFLOAT_PRECISION)
+        {
+        }
+        // The integer x, rounded to the precision.
+        explicit bigfloat(const integer& x, const std::size_t precision = INTTITAN_BIGFLOAT_PRECISION, const rounding_mode mode = rounding_mode::nearest)
+            : bigfloat(round(x, 0, precision, mode, false))
+        {
+        }
+        // The double value, exactly if the precision is at least 53 bits. Throws std::invalid_argument for infinities and NaN.
+        explicit bigfloat(const double value, const std::size_t precision = INTTITAN_BIGFLOAT_PRECISION, const rounding_mode mode = rounding_mode::nearest)
+            : bigfloat(from_double(value, precision, mode))
+        {
+        }
+        // The rational x, rounded to the precision.
+        static bigfloat from_rational(const rational& x, const std::size_t precision = INTTITAN_BIGFLOAT_PRECISION, const rounding_mode mode = rounding_mode::nearest)
+        {
+            return quotient(rational::numerator(x), 0, rational::denominator(x), 0, precision, mode);
+        }
+        // The parts of x = mantissa * 2^exponent, the mantissa odd (or zero).
+        static const integer& mantissa(const bigfloat& x)
+        {
+            return x.mantissa_value;
+        }
+        static exponent_type exponent(const bigfloat& x)
+        {
+            return x.exponent_value;
+        }
+        // Bits of the mantissa x is rounded to.
+        static std::size_t precision(const bigfloat& x)
+        {
+            return x.precision_value;
+        }
+        // -1, 0 or 1 as x is negative, zero or positive.
+        static int sign(const bigfloat& x)
+        {
+            return integer::sign(x.mantissa_value);
+        }
+        // x rounded to another precision.
+        static bigfloat rounded(const bigfloat& x, const std::size_t precision, const rounding_mode mode = rounding_mode::nearest)
+        {
+            return round(x.mantissa_value, x.exponent_value, precision, mode, false);
+        }
+        static bigfloat negate(bigfloat x)
+        {
+            x.mantissa_value = integer::negate(std::move(x.mantissa_value));
+            return x;
+        }
+        static bigfloat absolute_value(bigfloat x)
+        {
+            x.mantissa_value = integer::absolute_value(std::move(x.mantissa_value));
+            return x;
+        }
+        static bigfloat add(const bigfloat& x, const bigfloat& y, const std::size_t precision, const rounding_mode mode = rounding_mode::nearest)
+        {
+            if(sign(x) == 0 or sign(y) == 0)
+            {
+                const bigfloat& r = sign(x) == 0 ? y : x;
+                return round(r.mantissa_value, r.exponent_value, precision, mode, false);
+            }
+            const bool x_larger = top(x) >= top(y);
+            const bigfloat& a = x_larger ? x : y;
+            const bigfloat& b = x_larger ? y : x;
+            // Below both the lowest bit of a and the rounding of the sum, b only decides the direction: any value of its
+            // sign under 2^limit rounds the same, so a single bit stands in for it, and a sum of a huge and a tiny value
+            // takes no huge shift.
+            const exponent_type limit = std::min(a.exponent_value, top(a) - static_cast<exponent_type>(precision) - 2);
+            integer b_mantissa = b.mantissa_value;
+            exponent_type b_exponent = b.exponent_value;
+            if(top(b) < limit)
+            {
+                b_mantissa = sign(b) < 0 ? -integer::one : integer::one;
+                b_exponent = limit - 1;
+            }
+            const exponent_type e = std::min(a.exponent_value, b_exponent);
+            const integer sum = (a.mantissa_value << static_cast<std::size_t>(a.exponent_value - e)) + (b_mantissa << static_cast<std::size_t>(b_exponent - e));
+            return round(sum, e, precision, mode, false);
+        }
+        static bigfloat subtract(const bigfloat& x, const bigfloat& y, const std::size_t precision, const rounding_mode mode = rounding_mode::nearest)
+        {
+            return add(x, negate(y), precision, mode);
+        }
+        // x * y. Mantissas of many more bits than the precision are cut to its top bits first, and only the high limbs of
+        // their product are computed (integer::multiply_high): that short product, and it plus the units it may be short
+        // by and both cut mantissas, bound the exact product. When the bounds round the same so does the exact product,
+        // which is only taken otherwise.
+        static bigfloat multiply(const bigfloat& x, const bigfloat& y, const std::size_t precision, const rounding_mode mode = rounding_mode::nearest)
+        {
+            const exponent_type e = x.exponent_value + y.exponent_value;
+            const std::size_t kept = precision + 2 * digit_bits;
+            const std::size_t x_bits = integer::bit_length(x.mantissa_value);
+            const std::size_t y_bits = integer::bit_length(y.mantissa_value);
+            if(x_bits > kept or y_bits > kept)
+            {
+                const std::size_t x_cut = x_bits > kept ? x_bits - kept : 0;
+                const std::size_t y_cut = y_bits > kept ? y_bits - kept : 0;
+                const integer a = integer::absolute_value(x.mantissa_value) >> x_cut;
+                const integer b = integer::absolute_value(y.mantissa_value) >> y_cut;
+                const bool negative = (sign(x) < 0) != (sign(y) < 0);
+                // a * b is in [low, low + n + 1) * B^n, and the exact product below (a + 1) * (b + 1).
+                const std::size_t n = (kept + digit_bits - 1) / digit_bits;
+                integer low = integer::multiply_high(a, b, n);
+                integer high = low + integer(n + 3);
+                if(negative)
+                {
+                    low = integer::negate(std::move(low));
+                    high = integer::negate(std::move(high));
+                }
+                const exponent_type cut = e + static_cast<exponent_type>(x_cut + y_cut + n * digit_bits);
+                bigfloat r = round(low, cut, precision, mode, false);
+                if(r == round(high, cut, precision, mode, false))
+                {
+                    return r;
+                }
+            }
+            return round(x.mantissa_value * y.mantissa_value, e, precision, mode, false);
+        }
+        // x / y, of a non-zero y: a quotient of at least precision + 2 bits, with the remainder as a sticky bit.
+        static bigfloat divide(const bigfloat& x, const bigfloat& y, const std::size_t precision, const rounding_mode mode = rounding_mode::nearest)
+        {
+            return quotient(x.mantissa_value, x.exponent_value, y.mantissa_value, y.exponent_value, precision, mode);
+        }
+        // The square root of a non-negative x: the integer square root of a mantissa of at least 2 * precision + 4 bits
+        // (and an even exponent), with the remainder as a sticky bit.
+        static bigfloat sqrt(const bigfloat& x, const std::size_t precision, const rounding_mode mode = rounding_mode::nearest)
+        {
+            if(sign(x) < 0)
+            {
+                throw std::logic_error("Square root of a negative number impermissible.");
+            }
+            if(sign(x) == 0)
+            {
+                return zero(precision);
+            }
+            const std::size_t bits = integer::bit_length(x.mantissa_value);
+            std::size_t shift = bits < 2 * precision + 4 ? 2 * precision + 4 - bits : 0;
+            if(((x.exponent_value - static_cast<exponent_type>(shift)) & 1) != 0)
+            {
+                shift++;
+            }
+            const integer m = x.mantissa_value << shift;
+            const integer root = integer::isqrt(m);
+            return round(root, (x.exponent_value - static_cast<exponent_type>(shift)) / 2, precision, mode, root * root != m);
+        }
+        // Three-way comparison: -1, 0 or 1 as x is less than, equal to or greater than y.
+        static int compare(const bigfloat& x, const bigfloat& y)
+        {
+            const int x_sign = sign(x);
+            const int y_sign = sign(y);
+            if(x_sign != y_sign or x_sign == 0)
+            {
+                return x_sign < y_sign ? -1 : x_sign > y_sign ? 1 : 0;
+            }
+            if(top(x) != top(y))
+            {
+                return (top(x) > top(y)) == (x_sign > 0) ? 1 : -1;
+            }
+            // Of the same top bit, so the shift is less than the bits of either mantissa.
+            const exponent_type e = std::min(x.exponent_value, y.exponent_value);
+            return integer::compare(x.mantissa_value << static_cast<std::size_t>(x.exponent_value - e), y.mantissa_value << static_cast<std::size_t>(y.exponent_value - e));
+        }
+        // x as a double, rounded to nearest (overflowing to infinity).
+        static double to_double(const bigfloat& x)
+        {
+            // Below the normal range a double keeps fewer bits, down to a lowest one of 2^-1074: x is rounded to those
+            // once, and then scaled exactly (rounding to 53 bits first and then again in ldexp() can be off by one).
+            constexpr exponent_type lowest_bit = std::numeric_limits<double>::min_exponent - std::numeric_limits<double>::digits;
+            std::size_t precision = std::numeric_limits<double>::digits;
+            if(sign(x) != 0 and top(x) - static_cast<exponent_type>(precision) < lowest_bit)
+            {
+                const exponent_type kept = top(x) - lowest_bit;
+                if(kept <= 0)
+                {
+                    // Under 2^-1074: rounded up to it only from above its half 2^-1075 (a tie, which goes to the even 0).
+                    const integer magnitude = integer::absolute_value(x.mantissa_value);
+                    const bool up = kept == 0 and integer::count_trailing_zeros(magnitude) + 1 < integer::bit_length(magnitude);
+                    return std::copysign(up ? std::numeric_limits<double>::denorm_min() : 0.0, static_cast<double>(sign(x)));
+                }
+                precision = static_cast<std::size_t>(kept);
+            }
+            const bigfloat r = rounded(x, precision);
+            const exponent_type e = std::clamp<exponent_type>(r.exponent_value, -(exponent_type(1) << 20), exponent_type(1) << 20);
+            return std::ldexp(integer::to_double(r.mantissa_value), static_cast<int>(e));
+        }
+        // The integer part of x, truncated toward zero.
+        static integer to_integer(const bigfloat& x)
+        {
+            if(x.exponent_value >= 0)
+            {
+                return x.mantissa_value << static_cast<std::size_t>(x.exponent_value);
+            }
+            const integer m = integer::absolute_value(x.mantissa_value) >> static_cast<std::size_t>(-x.exponent_value);
+            return sign(x) < 0 ? -m : m;
+        }
+        // The exact value of x as a rational.
+        static rational to_rational(const bigfloat& x)
+        {
+            if(x.exponent_value >= 0)
+            {
+                return rational(x.mantissa_value << static_cast<std::size_t>(x.exponent_value));
+            }
+            return rational(x.mantissa_value, integer::one << static_cast<std::size_t>(-x.exponent_value));
+        }
+        // x in decimal scientific notation, such as "-1.25e+3", of the significant digits given (0 for as many as the
+        // precision takes to be read back), rounded to nearest.
+        static std::string to_string(const bigfloat& x, std::size_t digits = 0)
+        {
+            if(sign(x) == 0)
+            {
+                return "0";
+            }
+            if(digits == 0)
+            {
+                digits = static_cast<std::size_t>(std::ceil(static_cast<double>(x.precision_value) * 0.301029995663981195)) + 1;
+            }
+            // An estimate of the decimal exponent, then the digits of x / 10^(d - digits + 1), again for a d one off.
+            const double log10 = integer::log10(x.mantissa_value) + static_cast<double>(x.exponent_value) * 0.301029995663981195;
+            exponent_type d = static_cast<exponent_type>(std::floor(log10));
+            integer n;
+            for(int attempt = 0; attempt < 3; attempt++)
+            {
+                n = scaled_decimal(x, d - static_cast<exponent_type>(digits) + 1);
+                const integer bound = integer::pow(integer(10), digits);
+                if(n >= bound)
+                {
+                    d++;
+                }
+                else if(n < integer::divide_by_digit(bound, 10).first)
+                {
+                    d--;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            const std::string text = integer::to_string(n, 10);
+            std::string s = sign(x) < 0 ? "-" : "";
+            s += text[0];
+            if(text.size() > 1)
+            {
+                s += '.';
+                s.append(text, 1, std::string::npos);
+            }
+            s += d < 0 ? "e-" : "e+";
+            s += std::to_string(d < 0 ? -d : d);
+            return s;
+        }
+
+        // Operator functions, at the larger precision of the operands and to nearest.
+        // Comparison.
+        friend bool operator==(const bigfloat& x, const bigfloat& y)
+        {
+            return x.exponent_value == y.exponent_value and x.mantissa_value == y.mantissa_value;
+        }
+        friend bool operator!=(const bigfloat& x, const bigfloat& y)
+        {
+            return !(x == y);
+        }
+        friend bool operator<(const bigfloat& x, const bigfloat& y)
+        {
+            return compare(x, y) < 0;
+        }
+        friend bool operator<=(const bigfloat& x, const bigfloat& y)
+        {
+            return compare(x, y) <= 0;
+        }
+        friend bool operator>(const bigfloat& x, const bigfloat& y)
+        {
+            return compare(x, y) > 0;
+        }
+        friend bool operator>=(const bigfloat& x, const bigfloat& y)
+        {
+            return compare(x, y) >= 0;
+        }
+        // Arithmetic.
+        friend bigfloat operator+(const bigfloat& x, const bigfloat& y)
+        {
+            return add(x, y, std::max(x.precision_value, y.precision_value));
+        }
+        friend bigfloat& operator+=(bigfloat& x, const bigfloat& y)
+        {
+            x = x + y;
+            return x;
+        }
+        friend bigfloat operator-(const bigfloat& x, const bigfloat& y)
+        {
+            return subtract(x, y, std::max(x.precision_value, y.precision_value));
+        }
+        friend bigfloat& operator-=(bigfloat& x, const bigfloat& y)
+        {
+            x = x - y;
+            return x;
+        }
+        friend bigfloat operator-(const bigfloat& x)
+        {
+            return negate(x);
+        }
+        friend bigfloat operator*(const bigfloat& x, const bigfloat& y)
+        {
+            return multiply(x, y, std::max(x.precision_value, y.precision_value));
+        }
+        friend bigfloat& operator*=(bigfloat& x, const bigfloat& y)
+        {
+            x = x * y;
+            return x;
+        }
+        friend bigfloat operator/(const bigfloat& x, const bigfloat& y)
+        {
+            return divide(x, y, std::max(x.precision_value, y.precision_value));
+        }
+        friend bigfloat& operator/=(bigfloat& x, const bigfloat& y)
+        {
+            x = x / y;
+            return x;
+        }
+        // Stream output, as to_string.
+        friend std::ostream& operator<<(std::ostream& out, const bigfloat& x)
+        {
+            return out << to_string(x);
+        }
+    private:
+        // Odd, or zero.
+        integer mantissa_value;
+        exponent_type exponent_value;
+        std::size_t precision_value;
+        static bigfloat zero(const std::size_t precision)
+        {
+            bigfloat r;
+            r.precision_value = precision;
+            return r;
+        }
+        // The exponent just above the top bit of a non-zero x.
+        static exponent_type top(const bigfloat& x)
+        {
+            return x.exponent_value + static_cast<exponent_type>(integer::bit_length(x.mantissa_value));
+        }
+        // m * 2^e, plus a positive amount under a unit of the lowest bit of m if sticky, rounded to the precision. All the
+        // operations end here, with their exact result or one of more than precision + 1 bits and the rest as sticky.
+        static bigfloat round(const integer& m, exponent_type e, const std::size_t precision, const rounding_mode mode, bool sticky)
+        {
+            if(precision == 0)
+            {
+                throw std::invalid_argument("Precision of 0 bits impermissible.");
+            }
+            const bool negative = integer::sign(m) < 0;
+            integer magnitude = integer::absolute_value(m);
+            std::size_t bits = integer::bit_length(magnitude);
+            if(bits == 0)
+            {
+                return zero(precision);
+            }
+            // Room for the rounding bit, so that sticky stays below it.
+            if(sticky and bits < precision + 2)
+            {
+                const std::size_t room = precision + 2 - bits;
+                magnitude <<= room;
+                e -= static_cast<exponent_type>(room);
+                bits = precision + 2;
+            }
+            bool half = false;
+            if(bits > precision)
+            {
+                const std::size_t shift = bits - precision;
+                half = integer::test_bit(magnitude, shift - 1);
+                sticky = sticky or integer::count_trailing_zeros(magnitude) < shift - 1;
+                magnitude >>= shift;
+                e += static_cast<exponent_type>(shift);
+            }
+            bool up;
+            switch(mode)
+            {
+            case rounding_mode::nearest:
+                up = half and (sticky or integer::test_bit(magnitude, 0));
+                break;
+            case rounding_mode::toward_zero:
+                up = false;
+                break;
+            case rounding_mode::upward:
+                up = !negative and (half or sticky);
+                break;
+            default:
+                up = negative and (half or sticky);
+                break;
+            }
+            if(up)
+            {
+                ++magnitude;
+            }
+            const std::size_t zeros = integer::count_trailing_zeros(magnitude);
+            bigfloat r;
+            r.mantissa_value = magnitude >> zeros;
+            if(negative)
+            {
+                r.mantissa_value = integer::negate(std::move(r.mantissa_value));
+            }
+            r.exponent_value = e + static_cast<exponent_type>(zeros);
+            r.precision_value = precision;
+            return r;
+        }
+        // (x_mantissa * 2^x_exponent) / (y_mantissa * 2^y_exponent), rounded.
+        static bigfloat quotient(const integer& x_mantissa, const exponent_type x_exponent, const integer& y_mantissa, const exponent_type y_exponent, const std::size_t precision, const rounding_mode mode)
+        {
+            if(integer::bit_length(y_mantissa) == 0)
+            {
+                throw std::logic_error("Division by 0 impermissible.");
+            }
+            if(integer::bit_length(x_mantissa) == 0)
+            {
+                return zero(precision);
+            }
+            // A shift that leaves a quotient of at least precision + 2 bits.
+            const exponent_type shift = static_cast<exponent_type>(precision + 2 + integer::bit_length(y_mantissa)) - static_cast<exponent_type>(integer::bit_length(x_mantissa));
+            const integer x = integer::absolute_value(x_mantissa);
+            const integer y = integer::absolute_value(y_mantissa);
+            auto [q, r] = shift >= 0 ? integer::divide(x << static_cast<std::size_t>(shift), y) : integer::divide(x, y << static_cast<std::size_t>(-shift));
+            if((integer::sign(x_mantissa) < 0) != (integer::sign(y_mantissa) < 0))
+            {
+                q = integer::negate(std::move(q));
+            }
+            return round(q, x_exponent - y_exponent - shift, precision, mode, integer::bit_length(r) != 0);
+        }
+        static bigfloat from_double(const double value, const std::size_t precision, const rounding_mode mode)
+        {
+            if(!std::isfinite(value))
+            {
+                throw std::invalid_argument("Conversion of an infinity or NaN to a bigfloat impermissible.");
+            }
+            int e;
+            const double fraction = std::frexp(value, &e);
+            // The 53 bits of the fraction as an integer.
+            const int bits = std::numeric_limits<double>::digits;
+            return round(integer::from_double(std::ldexp(fraction, bits)), e - bits, precision, mode, false);
+        }
+        // x / 10^scale, rounded to the nearest integer (ties to even).
+        static integer scaled_decimal(const bigfloat& x, const exponent_type scale)
+        {
+            integer n = integer::absolute_value(x.mantissa_value);
+            integer d = integer::one;
+            if(x.exponent_value >= 0)
+            {
+                n <<= static_cast<std::size_t>(x.exponent_value);
+            }
+            else
+            {
+                d <<= static_cast<std::size_t>(-x.exponent_value);
+            }
+            if(scale >= 0)
+            {
+                d *= integer::pow(integer(10), static_cast<std::size_t>(scale));
+            }
+            else
+            {
+                n *= integer::pow(integer(10), static_cast<std::size_t>(-scale));
+            }
+            auto [q, r] = integer::divide(n, d);
+            const int half = integer::compare(r << 1, d);
+            if(half > 0 or (half == 0 and integer::test_bit(q, 0)))
+            {
+                ++q;
+            }
+            return std::move(q);
+        }
+    };
+}
+
+#endif //INTTITAN_BIGFLOAT_H
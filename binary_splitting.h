@@ -0,0 +1,207 @@
+#ifndef INTTITAN_BINARY_SPLITTING_H
+#define INTTITAN_BINARY_SPLITTING_H
+#include "integer.h"
+#include "parallel.h"
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+// Binary splitting of hypergeometric series: sums of a(n) p(0) ... p(n) / (q(0) ... q(n)) with integer terms, as of
+// the series of pi, e and many other constants. Summing term by term divides a number of ever more digits at every
+// step; binary splitting instead forms, for a range [n1, n2) of terms,
+//     P = p(n1) ... p(n2 - 1),  Q = q(n1) ... q(n2 - 1),  T = Q * sum of a(n) p(n1) ... p(n) / (q(n1) ... q(n)),
+// from those of its halves [n1, m) and [m, n2): P = P1 P2, Q = Q1 Q2 and T = T1 Q2 + P1 T2, all products of operands of
+// about the same size, which the fast tiers (Karatsuba up to the transforms) are best at. The sum of [0, N) is T / Q,
+// one division at the end. With a parallel_executor the halves of the top levels, and the four products that join
+// them, are computed at the same time.
+namespace int_titan
+{
+    // P, Q and T of a range of terms (p unset where it is not needed, see binary_split()).
+    struct split_sums
+    {
+        integer p;
+        integer q;
+        integer t;
+    };
+    namespace splitting
+    {
+        // P, Q and T of [n1, n2) of series (P only with need_p), the halves of the top levels (as many as levels) in
+        // parallel.
+        template<typename Series>
+        split_sums split(const Series& series, const std::size_t n1, const std::size_t n2, const bool need_p, const unsigned levels)
+        {
+            if(n2 - n1 == 1)
+            {
+                split_sums r;
+                integer p = series.p(n1);
+                r.q = series.q(n1);
+                r.t = series.a(n1) * p;
+                if(need_p)
+                {
+                    r.p = std::move(p);
+                }
+                return r;
+            }
+            const std::size_t m = n1 + (n2 - n1) / 2;
+            // T = T1 Q2 + P1 T2 takes P1 whether P is needed or not, P2 only for P.
+            split_sums halves[2];
+            const unsigned below = levels == 0 ? 0 : levels - 1;
+            const auto split_half = [&](const std::size_t i)
+            {
+                halves[i] = i == 0 ? split(series, n1, m, true, below) : split(series, m, n2, need_p, below);
+            };
+            if(levels != 0)
+            {
+                kernels::parallel_for(2, split_half);
+            }
+            else
+            {
+                split_half(0);
+                split_half(1);
+            }
+            split_sums& left = halves[0];
+            split_sums& right = halves[1];
+            split_sums r;
+            if(levels != 0)
+            {
+                integer products[4];
+                kernels::parallel_for(need_p ? 4 : 3, [&](const std::size_t i)
+                {
+                    switch(i)
+                    {
+                    case 0:
+                        products[0] = left.t * right.q;
+                        break;
+                    case 1:
+                        products[1] = left.p * right.t;
+                        break;
+                    case 2:
+                        products[2] = left.q * right.q;
+                        break;
+                    default:
+                        products[3] = left.p * right.p;
+                    }
+                });
+                r.t = std::move(products[0]) + products[1];
+                r.q = std::move(products[2]);
+                r.p = std::move(products[3]);
+                return r;
+            }
+            // The sum formed in place: T1 Q2, then P1 T2 added into its limbs.
+            r.t = left.t * right.q;
+            integer::addmul(r.t, left.p, right.t);
+            r.q = std::move(left.q) * right.q;
+            if(need_p)
+            {
+                r.p = std::move(left.p) * right.p;
+            }
+            return r;
+        }
+        // Levels of a splitting whose halves go to the executor: enough for every thread to have a subtree, and one
+        // more for balance, none without an executor.
+        inline unsigned parallel_levels()
+        {
+            if(parallel_executor == nullptr)
+            {
+                return 0;
+            }
+            unsigned levels = 1;
+            for(std::size_t n = 1; n < parallel_executor->concurrency(); n *= 2)
+            {
+                levels++;
+            }
+            return levels;
+        }
+    }
+    // P, Q and T of the terms [n1, n2) (n1 < n2) of a series, an object with the member functions
+    //     p(n), q(n), a(n)
+    // that return the integer terms (q(n) non-zero), called from several threads with a parallel_executor. The sum of
+    // a(n) p(n1) ... p(n) / (q(n1) ... q(n)) over the range is t / q. p is left zero unless need_p, as the products of
+    // the p(n) of the last terms are needed for nothing else: leaving them out saves about a fifth of the work.
+    template<typename Series>
+    split_sums binary_split(const Series& series, const std::size_t n1, const std::size_t n2, const bool need_p = false)
+    {
+        if(n1 >= n2)
+        {
+            return {integer(), integer::one, integer()};
+        }
+        return splitting::split(series, n1, n2, need_p, splitting::parallel_levels());
+    }
+    namespace splitting
+    {
+        // pi = 426880 sqrt(10005) / sum of (13591409 + 545140134 n) (6n)! / ((3n)! n!^3 (-640320)^(3n)) (Chudnovsky), in
+        // the terms of binary_split(): p(n) / q(n) is the ratio of term n to term n - 1, leaving out their a(n).
+        struct chudnovsky_series
+        {
+            integer p(const std::size_t n) const
+            {
+                if(n == 0)
+                {
+                    return integer::one;
+                }
+                const integer k(n);
+                return -((6 * k - 5) * (2 * k - 1) * (6 * k - 1));
+            }
+            integer q(const std::size_t n) const
+            {
+                if(n == 0)
+                {
+                    return integer::one;
+                }
+                const integer k(n);
+                // 640320^3 / 24.
+                return k * k * k * 10939058860032000ull;
+            }
+            integer a(const std::size_t n) const
+            {
+                return integer(n) * 545140134u + 13591409u;
+            }
+        };
+        // e = sum of 1 / n!.
+        struct exponential_series
+        {
+            integer p(std::size_t) const
+            {
+                return integer::one;
+            }
+            integer q(const std::size_t n) const
+            {
+                return n == 0 ? integer::one : integer(n);
+            }
+            integer a(std::size_t) const
+            {
+                return integer::one;
+            }
+        };
+        // Decimal digits beyond those asked for, which the truncations of the last steps may change.
+        constexpr std::size_t guard_digits = 8;
+    }
+    // floor(pi * 10^digits): the digits of pi, 3 and then as many as asked for after the point. Each term of the
+    // series adds 14.18 digits. Up to the guard digits this is exact; the last digit may be one too small only when
+    // they are followed by more nines than the guard holds.
+    inline integer pi_digits(const std::size_t digits)
+    {
+        const std::size_t precision = digits + splitting::guard_digits;
+        const std::size_t terms = static_cast<std::size_t>(static_cast<double>(precision) / 14.181647462725477) + 2;
+        const split_sums s = binary_split(splitting::chudnovsky_series(), 0, terms);
+        const integer scale = integer::pow(10, precision);
+        const integer root = integer::isqrt(10005 * scale * scale);
+        const integer pi = integer::divide(root * s.q * 426880u, s.t).first;
+        return integer::divide(pi, integer::pow(10, splitting::guard_digits)).first;
+    }
+    // floor(e * 10^digits), the same way, from the terms up to the first n with n! above 10^(digits + guard digits).
+    inline integer e_digits(const std::size_t digits)
+    {
+        const double precision = static_cast<double>(digits + splitting::guard_digits);
+        std::size_t terms = 1;
+        for(double log_factorial = 0; log_factorial <= precision; terms++)
+        {
+            log_factorial += std::log10(static_cast<double>(terms));
+        }
+        const split_sums s = binary_split(splitting::exponential_series(), 0, terms + 1);
+        const integer e = integer::divide(s.t * integer::pow(10, digits + splitting::guard_digits), s.q).first;
+        return integer::divide(e, integer::pow(10, splitting::guard_digits)).first;
+    }
+}
+
+#endif //INTTITAN_BINARY_SPLITTING_H
@@ -0,0 +1,173 @@
+#ifndef INTTITAN_BYTES_H
+#define INTTITAN_BYTES_H
+#include "config.h"
+#include "kernels.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+// Is the host little-endian, so that limbs in memory are their own little-endian bytes?
+#if defined(__BYTE_ORDER__) and defined(__ORDER_LITTLE_ENDIAN__)
+#define INTTITAN_LITTLE_ENDIAN (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#elif defined(_WIN32)
+#define INTTITAN_LITTLE_ENDIAN 1
+#else
+#define INTTITAN_LITTLE_ENDIAN 0
+#endif
+
+// Binary serialization of raw limb spans: the bytes of the magnitude, or of the two's complement for signed formats, in
+// either order. On a little-endian host the little-endian bytes of the magnitude are the limbs themselves, so they are
+// copied as a block, and the big-endian ones are the same block reversed.
+namespace int_titan
+{
+    // The order of the bytes of a serialized integer.
+    enum class byte_order
+    {
+        little,
+        big
+    };
+    // How integer::to_bytes() writes an integer and integer::from_bytes() reads it: the order of the bytes, whether they
+    // are the two's complement of a signed value (else the magnitude of a non-negative one), and whether their count
+    // comes first, as length_prefix_bytes bytes of the same order.
+    struct byte_format
+    {
+        byte_order order = byte_order::big;
+        bool is_signed = false;
+        bool length_prefix = false;
+    };
+    // Bytes of the count of a length-prefixed integer.
+    constexpr std::size_t length_prefix_bytes = 8;
+    namespace kernels
+    {
+        // Byte i (from the least significant) of the n limbs x, zero above them.
+        inline unsigned char limb_byte(const digit* x, const std::size_t n, const std::size_t i)
+        {
+            const std::size_t limb = i / sizeof(digit);
+            return limb < n ? static_cast<unsigned char>(x[limb] >> (8 * (i % sizeof(digit)))) : 0;
+        }
+        // The fewest bytes that hold x (n limbs without leading zeroes, none for zero): those of the magnitude, or of
+        // the two's complement with room for the sign bit when signed. -2^(8k - 1) still fits in k bytes.
+        inline std::size_t byte_length(const digit* x, const std::size_t n, const bool negative, const bool is_signed)
+        {
+            if(n == 0)
+            {
+                return 0;
+            }
+            const std::size_t bits = n * digit_bits - leading_zeros(x[n - 1]);
+            if(!is_signed)
+            {
+                return (bits + 7) / 8;
+            }
+            const bool power_of_two = normalized_size(x, n - 1) == 0 and (x[n - 1] & (x[n - 1] - 1)) == 0;
+            return negative and power_of_two and bits % 8 == 0 ? bits / 8 : bits / 8 + 1;
+        }
+        // Write the count bytes of x (n limbs) in the order: its magnitude, or its two's complement if negative (count
+        // must leave room for it). The bytes above x are zero, or all ones when negative.
+        inline void limbs_to_bytes(std::byte* out, const digit* x, const std::size_t n, const std::size_t count, const bool negative, const byte_order order)
+        {
+            if(count == 0)
+            {
+                return;
+            }
+#if INTTITAN_LITTLE_ENDIAN
+            const std::size_t copied = std::min(count, n * sizeof(digit));
+            if(!negative and order == byte_order::big)
+            {
+                const std::byte* bytes = reinterpret_cast<const std::byte*>(x);
+                std::fill(out, out + (count - copied), std::byte(0));
+                std::reverse_copy(bytes, bytes + copied, out + (count - copied));
+                return;
+            }
+            std::memcpy(out, x, copied);
+            std::fill(out + copied, out + count, std::byte(0));
+#else
+            for(std::size_t i = 0; i < count; i++)
+            {
+                out[i] = static_cast<std::byte>(limb_byte(x, n, i));
+            }
+#endif
+            if(negative)
+            {
+                // ~(|x| - 1): the bytes up to the lowest nonzero one are those of |x| negated, the others flipped.
+                std::size_t i = 0;
+                while(i < count and out[i] == std::byte(0))
+                {
+                    i++;
+                }
+                if(i < count)
+                {
+                    out[i] = static_cast<std::byte>(0x100 - std::to_integer<unsigned>(out[i]));
+                    for(i++; i < count; i++)
+                    {
+                        out[i] = ~out[i];
+                    }
+                }
+            }
+            if(order == byte_order::big)
+            {
+                std::reverse(out, out + count);
+            }
+        }
+        // r = the magnitude of the count bytes in the order (rn limbs, enough for them), their two's complement if
+        // signed. Returns whether they are negative.
+        inline bool bytes_to_limbs(digit* r, const std::size_t rn, const std::byte* in, const std::size_t count, const byte_order order, const bool is_signed)
+        {
+            const auto byte = [&](const std::size_t i)
+            {
+                return std::to_integer<unsigned char>(order == byte_order::little ? in[i] : in[count - 1 - i]);
+            };
+            const bool negative = is_signed and count != 0 and (byte(count - 1) & 0x80) != 0;
+            std::fill(r, r + rn, negative ? ~digit(0) : digit(0));
+#if INTTITAN_LITTLE_ENDIAN
+            if(count != 0)
+            {
+                if(order == byte_order::little)
+                {
+                    std::memcpy(r, in, count);
+                }
+                else
+                {
+                    std::reverse_copy(in, in + count, reinterpret_cast<std::byte*>(r));
+                }
+            }
+#else
+            for(std::size_t i = 0; i < count; i++)
+            {
+                const digit b = byte(i);
+                const int shift = static_cast<int>(8 * (i % sizeof(digit)));
+                r[i / sizeof(digit)] = (r[i / sizeof(digit)] & ~(digit(0xFF) << shift)) | (b << shift);
+            }
+#endif
+            if(negative)
+            {
+                // |x| = ~x + 1.
+                for(std::size_t i = 0; i < rn; i++)
+                {
+                    r[i] = ~r[i];
+                }
+                const digit unit = 1;
+                add(r, r, rn, &unit, 1);
+            }
+            return negative;
+        }
+        // The length prefix of count bytes, and its value.
+        inline void write_length_prefix(std::byte* out, const std::uint64_t count, const byte_order order)
+        {
+            for(std::size_t i = 0; i < length_prefix_bytes; i++)
+            {
+                out[order == byte_order::little ? i : length_prefix_bytes - 1 - i] = static_cast<std::byte>(count >> (8 * i));
+            }
+        }
+        inline std::uint64_t read_length_prefix(const std::byte* in, const byte_order order)
+        {
+            std::uint64_t count = 0;
+            for(std::size_t i = 0; i < length_prefix_bytes; i++)
+            {
+                count |= static_cast<std::uint64_t>(std::to_integer<unsigned>(in[order == byte_order::little ? i : length_prefix_bytes - 1 - i])) << (8 * i);
+            }
+            return count;
+        }
+    }
+}
+
+#endif //INTTITAN_BYTES_H
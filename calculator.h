@@ -0,0 +1,330 @@
+#ifndef INTTITAN_CALCULATOR_H
+#define INTTITAN_CALCULATOR_H
+#include "integer.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Evaluation of integer expressions in text, for the calculator of the executable and for files of expressions. The
+// numbers are in the base of the calculator (2 to 36, without a prefix), and the operators those of C with its
+// precedence, from the loosest:
+//     |    ^    &    << >>    + -    * / %    unary - + ~    ** (power, right to left)
+// with parentheses, and / and % truncating as in C. The expression is evaluated as it is parsed (a Pratt parser over
+// the characters, with no tokens or tree in between), into integers the calculator keeps from one expression to the
+// next, so that a file of expressions of similar sizes allocates little after the first.
+namespace int_titan
+{
+    class calculator
+    {
+    public:
+        // Parentheses and operators nested deeper than this are rejected rather than overflowing the stack.
+        static constexpr std::size_t max_depth = 1000;
+        // Numbers read in base and values written in output_base (base if 0), with uppercase or lowercase letters.
+        explicit calculator(const int base = 16, const int output_base = 0, const bool uppercase = true)
+            : radix(base), output_radix(output_base == 0 ? base : output_base), uppercase(uppercase)
+        {
+            if(radix < 2 or radix > 36 or output_radix < 2 or output_radix > 36)
+            {
+                throw std::invalid_argument("Base from 2 to 36 expected.");
+            }
+        }
+        int base() const
+        {
+            return radix;
+        }
+        int output_base() const
+        {
+            return output_radix;
+        }
+        // The value of the expression, valid until the next evaluation. Throws std::invalid_argument for a malformed
+        // expression (with the position, from 0, where it went wrong) and what the operations throw, e.g.
+        // std::logic_error for a division by 0.
+        const integer& evaluate(const std::string_view expression)
+        {
+            text = expression;
+            position = 0;
+            nesting = 0;
+            parse(0, 0);
+            skip_spaces();
+            if(position != text.size())
+            {
+                fail("Operator expected");
+            }
+            return values[0];
+        }
+        // Size of the blocks evaluate_lines() reads and writes.
+        static constexpr std::size_t block_size = 1 << 20;
+        // Evaluate every line of in and write its value to out in the output base, or "error: " and the reason, so that
+        // the output has a line for every line of the input. Empty lines stay empty, and a trailing '=' is ignored. The
+        // input is read and the output written in large blocks.
+        void evaluate_lines(std::istream& in, std::ostream& out)
+        {
+            std::string input;
+            std::string output;
+            while(true)
+            {
+                const std::size_t kept = input.size();
+                input.resize(kept + block_size);
+                in.read(input.data() + kept, static_cast<std::streamsize>(block_size));
+                input.resize(kept + static_cast<std::size_t>(in.gcount()));
+                const bool last = input.size() == kept;
+                // The complete lines, or all that is left at the end; a partial line waits for the next block.
+                const std::size_t end = last ? input.size() : input.rfind('\n') + 1;
+                evaluate_text(std::string_view(input).substr(0, end), output);
+                out.write(output.data(), static_cast<std::streamsize>(output.size()));
+                output.clear();
+                input.erase(0, end);
+                if(last)
+                {
+                    break;
+                }
+            }
+        }
+        // Evaluate the lines of text as evaluate_lines() does, appending their results to output. A last line need not
+        // end with a newline.
+        void evaluate_text(const std::string_view text, std::string& output)
+        {
+            for(std::size_t start = 0; start < text.size();)
+            {
+                const std::size_t end = std::min(text.find('\n', start), text.size());
+                evaluate_line(text.substr(start, end - start), output);
+                start = end + 1;
+            }
+        }
+        // Evaluate one line as evaluate_lines() does, appending the result and a newline to output.
+        void evaluate_line(std::string_view line, std::string& output)
+        {
+            if(!line.empty() and line.back() == '\r')
+            {
+                line.remove_suffix(1);
+            }
+            const std::size_t last = line.find_last_not_of(" \t");
+            if(last != std::string_view::npos and line[last] == '=')
+            {
+                line = line.substr(0, last);
+            }
+            if(line.find_first_not_of(" \t") == std::string_view::npos)
+            {
+                output.push_back('\n');
+                return;
+            }
+            try
+            {
+                append(output, evaluate(line));
+            }
+            catch(const std::exception& e)
+            {
+                output.append("error: ").append(e.what());
+            }
+            output.push_back('\n');
+        }
+        // Append x in the output base.
+        void append(std::string& output, const integer& x) const
+        {
+            const std::size_t size = output.size();
+            output.resize(size + integer::to_chars_length(x, output_radix));
+            char* const first = output.data() + size;
+            char* const last = to_chars(first, output.data() + output.size(), x, output_radix).ptr;
+            if(uppercase and output_radix > 10)
+            {
+                std::transform(first, last, first, [](const char c) { return static_cast<char>(std::toupper(static_cast<unsigned char>(c))); });
+            }
+            output.resize(static_cast<std::size_t>(last - output.data()));
+        }
+    private:
+        // Binding powers of the operators: the right operand of a binary one is parsed at its power plus one (the power
+        // itself for **, which groups to the right), and that of a unary one at the power of unary operators.
+        static constexpr int unary_power = 7;
+        int radix;
+        int output_radix;
+        bool uppercase;
+        std::string_view text;
+        std::size_t position = 0;
+        // Calls of parse() under way, one for every open parenthesis, unary operator and binary operator whose right
+        // operand is being read: the recursion, which max_depth bounds.
+        std::size_t nesting = 0;
+        // values[d] holds the value being computed at depth d, reused from one expression to the next.
+        std::vector<integer> values;
+        [[noreturn]] void fail(const char* what) const
+        {
+            throw std::invalid_argument(std::string(what) + " at position " + std::to_string(position) + ".");
+        }
+        void skip_spaces()
+        {
+            while(position < text.size() and (text[position] == ' ' or text[position] == '\t'))
+            {
+                position++;
+            }
+        }
+        // The binary operator at the position and its binding power, 0 for none. Its length goes into length.
+        int binary_operator(char& op, std::size_t& length) const
+        {
+            if(position >= text.size())
+            {
+                return 0;
+            }
+            op = text[position];
+            const char next = position + 1 < text.size() ? text[position + 1] : '\0';
+            length = 1;
+            switch(op)
+            {
+            case '|':
+                return 1;
+            case '^':
+                return 2;
+            case '&':
+                return 3;
+            case '<':
+            case '>':
+                length = 2;
+                return next == op ? 4 : 0;
+            case '+':
+            case '-':
+                return 5;
+            case '*':
+                if(next == '*')
+                {
+                    op = 'p';
+                    length = 2;
+                    return 8;
+                }
+                return 6;
+            case '/':
+            case '%':
+                return 6;
+            default:
+                return 0;
+            }
+        }
+        // A non-negative count (a shift or an exponent) from the value at depth d. With saturate, a count past
+        // std::size_t is its largest value instead of an error: a right shift by as much gives 0, or -1 for a negative
+        // operand.
+        std::size_t count(const std::size_t d, const bool saturate = false) const
+        {
+            if(values[d] < integer::zero)
+            {
+                fail("Non-negative count expected");
+            }
+            if(saturate and values[d] > std::numeric_limits<std::size_t>::max())
+            {
+                return std::numeric_limits<std::size_t>::max();
+            }
+            return integer::to<std::size_t>(values[d]);
+        }
+        // Evaluate the expression at the position whose operators bind at least as tightly as power into values[d].
+        void parse(const std::size_t d, const int power)
+        {
+            if(++nesting > max_depth)
+            {
+                fail("Expression nested too deeply");
+            }
+            if(values.size() <= d + 1)
+            {
+                values.resize(d + 2);
+            }
+            skip_spaces();
+            if(position >= text.size())
+            {
+                fail("Operand expected");
+            }
+            const char c = text[position];
+            if(c == '(')
+            {
+                position++;
+                parse(d, 0);
+                skip_spaces();
+                if(position >= text.size() or text[position] != ')')
+                {
+                    fail("')' expected");
+                }
+                position++;
+            }
+            else if(c == '-' or c == '+' or c == '~')
+            {
+                position++;
+                parse(d, unary_power);
+                if(c == '-')
+                {
+                    values[d] = -std::move(values[d]);
+                }
+                else if(c == '~')
+                {
+                    values[d] = ~values[d];
+                }
+            }
+            else
+            {
+                const char* const first = text.data() + position;
+                const auto [end, error] = from_chars(first, text.data() + text.size(), values[d], radix);
+                if(error != std::errc())
+                {
+                    fail("Operand expected");
+                }
+                position += static_cast<std::size_t>(end - first);
+            }
+            while(true)
+            {
+                skip_spaces();
+                char op = '\0';
+                std::size_t length = 0;
+                const int binding = binary_operator(op, length);
+                if(binding == 0 or binding < power)
+                {
+                    nesting--;
+                    return;
+                }
+                position += length;
+                parse(d + 1, op == 'p' ? binding : binding + 1);
+                // Not a reference taken before the parse, which can grow values.
+                integer& left = values[d];
+                const integer& right = values[d + 1];
+                switch(op)
+                {
+                case '|':
+                    left |= right;
+                    break;
+                case '^':
+                    left ^= right;
+                    break;
+                case '&':
+                    left &= right;
+                    break;
+                case '<':
+                    left <<= count(d + 1);
+                    break;
+                case '>':
+                    left >>= count(d + 1, true);
+                    break;
+                case '+':
+                    left += right;
+                    break;
+                case '-':
+                    left -= right;
+                    break;
+                case '*':
+                    left *= right;
+                    break;
+                case '/':
+                    left /= right;
+                    break;
+                case '%':
+                    left %= right;
+                    break;
+                default:
+                    left = integer::pow(left, count(d + 1));
+                    break;
+                }
+            }
+        }
+    };
+}
+
+#endif //INTTITAN_CALCULATOR_H
@@ -0,0 +1,181 @@
+#ifndef INTTITAN_CONFIG_H
+#define INTTITAN_CONFIG_H
+#include <cstddef>
+#include <cstdint>
+
+// Build configuration of the library. Every option can be overridden by defining the macro before including any header.
+
+// Keep the digits of an integer in an immer::flex_vector (persistent tree) instead of a contiguous buffer.
+#ifndef INTTITAN_FLEX_VECTOR_STORAGE
+#define INTTITAN_FLEX_VECTOR_STORAGE 0
+#endif
+
+// Number of digits an integer keeps inline, without allocating (only with the contiguous storage).
+#ifndef INTTITAN_INLINE_LIMBS
+#define INTTITAN_INLINE_LIMBS 4
+#endif
+
+// Memory policy of the digits of an integer, one of the immer::memory_policy types of memory.h: the default one (atomic
+// reference counts), int_titan::single_thread_memory_policy (plain reference counts), int_titan::arena_memory_policy
+// (plain reference counts, memory from the arena_scope of the thread) or int_titan::mapped_memory_policy of mapped.h
+// (atomic reference counts, large limb blocks in memory-mapped temporary files).
+#ifndef INTTITAN_MEMORY_POLICY
+#define INTTITAN_MEMORY_POLICY int_titan::default_memory_policy
+#endif
+
+// Leave the instantiation of the storage of the digits (limb_buffer, or immer's flex_vector and its trees) to the
+// int_titan library, int_titan.cpp, rather than to every translation unit. The library target of CMakeLists.txt sets it
+// for the programs linked to it, which must be built with the same options as the library.
+#ifndef INTTITAN_EXTERN_TEMPLATES
+#define INTTITAN_EXTERN_TEMPLATES 0
+#endif
+
+// Smallest block in bytes the mapped_memory_policy puts into a memory-mapped file rather than on the heap.
+#ifndef INTTITAN_MAPPED_HEAP_THRESHOLD
+#define INTTITAN_MAPPED_HEAP_THRESHOLD (std::size_t(16) << 20)
+#endif
+
+// Most bytes of temporary memory each thread keeps for reuse by the kernels, see scratch_pool.
+#ifndef INTTITAN_SCRATCH_POOL_LIMIT
+#define INTTITAN_SCRATCH_POOL_LIMIT (std::size_t(32) << 20)
+#endif
+
+// Count the arithmetic operations, the sizes of their operands and the allocations of the limbs, see stats.h. Off, the
+// counting compiles to nothing.
+#ifndef INTTITAN_STATS
+#define INTTITAN_STATS 0
+#endif
+
+// Size of a digit (limb) in bits, 32 or 64. 64-bit digits need a 128-bit type for their products, which GCC and Clang
+// have on 64-bit targets (x86-64, AArch64), so they are the default there.
+#ifndef INTTITAN_DIGIT_BITS
+#if defined(__SIZEOF_INT128__)
+#define INTTITAN_DIGIT_BITS 64
+#else
+#define INTTITAN_DIGIT_BITS 32
+#endif
+#endif
+
+// Pick the kernels for the instruction set extensions of the processor at runtime (x86-64 with GCC or Clang), see cpu.h.
+// Without it they are picked for the extensions the compiler targets.
+#ifndef INTTITAN_DISPATCH
+#if defined(__x86_64__) and defined(__GNUC__)
+#define INTTITAN_DISPATCH 1
+#else
+#define INTTITAN_DISPATCH 0
+#endif
+#endif
+
+// Use the vector instructions (SSSE3, AVX2 or NEON) where there is code for them.
+#ifndef INTTITAN_SIMD
+#define INTTITAN_SIMD 1
+#endif
+
+// Default operand sizes (in digits) at which the faster algorithms take over, see int_titan::tuning. 64-bit digits have
+// their own, most of them for operands of about the same size in bits.
+#ifndef INTTITAN_KARATSUBA_THRESHOLD
+#define INTTITAN_KARATSUBA_THRESHOLD 32
+#endif
+#ifndef INTTITAN_TOOM3_THRESHOLD
+#define INTTITAN_TOOM3_THRESHOLD (INTTITAN_DIGIT_BITS == 64 ? 128 : 192)
+#endif
+#ifndef INTTITAN_TOOM4_THRESHOLD
+#define INTTITAN_TOOM4_THRESHOLD (INTTITAN_DIGIT_BITS == 64 ? 256 : 384)
+#endif
+#ifndef INTTITAN_KARATSUBA_SQUARE_THRESHOLD
+#define INTTITAN_KARATSUBA_SQUARE_THRESHOLD 48
+#endif
+#ifndef INTTITAN_TOOM3_SQUARE_THRESHOLD
+#define INTTITAN_TOOM3_SQUARE_THRESHOLD (INTTITAN_DIGIT_BITS == 64 ? 128 : 192)
+#endif
+#ifndef INTTITAN_TOOM4_SQUARE_THRESHOLD
+#define INTTITAN_TOOM4_SQUARE_THRESHOLD (INTTITAN_DIGIT_BITS == 64 ? 256 : 384)
+#endif
+#ifndef INTTITAN_NTT_THRESHOLD
+#define INTTITAN_NTT_THRESHOLD (INTTITAN_DIGIT_BITS == 64 ? 12288 : 24576)
+#endif
+#ifndef INTTITAN_PARALLEL_MULTIPLY_THRESHOLD
+#define INTTITAN_PARALLEL_MULTIPLY_THRESHOLD (INTTITAN_DIGIT_BITS == 64 ? 2048 : 4096)
+#endif
+#ifndef INTTITAN_BURNIKEL_ZIEGLER_THRESHOLD
+#define INTTITAN_BURNIKEL_ZIEGLER_THRESHOLD (INTTITAN_DIGIT_BITS == 64 ? 24 : 40)
+#endif
+#ifndef INTTITAN_NEWTON_DIVISION_THRESHOLD
+#define INTTITAN_NEWTON_DIVISION_THRESHOLD (INTTITAN_DIGIT_BITS == 64 ? 8192 : 16384)
+#endif
+#ifndef INTTITAN_HALF_GCD_THRESHOLD
+#define INTTITAN_HALF_GCD_THRESHOLD (INTTITAN_DIGIT_BITS == 64 ? 200 : 400)
+#endif
+#ifndef INTTITAN_RADIX_PARSE_THRESHOLD
+#define INTTITAN_RADIX_PARSE_THRESHOLD (INTTITAN_DIGIT_BITS == 64 ? 16 : 30)
+#endif
+#ifndef INTTITAN_RADIX_PRINT_THRESHOLD
+#define INTTITAN_RADIX_PRINT_THRESHOLD (INTTITAN_DIGIT_BITS == 64 ? 16 : 30)
+#endif
+
+// Digits of the numerator and the denominator of a rational past which the result of an operation is reduced by their
+// gcd right away, see rational.h. Below it the gcd waits for output, hashing or an explicit reduction.
+#ifndef INTTITAN_RATIONAL_REDUCE_THRESHOLD
+#define INTTITAN_RATIONAL_REDUCE_THRESHOLD 16
+#endif
+
+// Precision in bits of a bigfloat made without one, see bigfloat.h.
+#ifndef INTTITAN_BIGFLOAT_PRECISION
+#define INTTITAN_BIGFLOAT_PRECISION 128
+#endif
+
+// Tuning file (see tuning.h) read when the program starts unless $INTTITAN_TUNING names another, empty for none.
+#ifndef INTTITAN_TUNING_FILE
+#define INTTITAN_TUNING_FILE ""
+#endif
+
+namespace int_titan
+{
+    // A single base 2^digit_bits digit (limb) and the type that can hold the product of two of them.
+#if INTTITAN_DIGIT_BITS == 64
+    using digit = std::uint64_t;
+    using superdigit = unsigned __int128;
+#elif INTTITAN_DIGIT_BITS == 32
+    using digit = std::uint32_t;
+    using superdigit = std::uint64_t;
+#else
+#error "INTTITAN_DIGIT_BITS must be 32 or 64."
+#endif
+    // Number of bits in a digit.
+    constexpr int digit_bits = INTTITAN_DIGIT_BITS;
+    // Operand sizes (in digits) at which the faster algorithms take over. They start at the INTTITAN_*_THRESHOLD values, or
+    // those of the tuning file of the program (see tuning.h), and may be changed at runtime, as long as no other thread
+    // is computing meanwhile.
+    struct thresholds
+    {
+        // Smaller operand size for Karatsuba multiplication (at least 2).
+        std::size_t karatsuba_multiply = INTTITAN_KARATSUBA_THRESHOLD;
+        // Smaller operand size for Toom-3 multiplication (at least 8).
+        std::size_t toom3_multiply = INTTITAN_TOOM3_THRESHOLD;
+        // Smaller operand size for Toom-4 multiplication (at least 16).
+        std::size_t toom4_multiply = INTTITAN_TOOM4_THRESHOLD;
+        // Operand size for Karatsuba squaring (at least 2).
+        std::size_t karatsuba_square = INTTITAN_KARATSUBA_SQUARE_THRESHOLD;
+        // Operand size for Toom-3 squaring (at least 8).
+        std::size_t toom3_square = INTTITAN_TOOM3_SQUARE_THRESHOLD;
+        // Operand size for Toom-4 squaring (at least 16).
+        std::size_t toom4_square = INTTITAN_TOOM4_SQUARE_THRESHOLD;
+        // Smaller operand size for multiplication (and squaring) by number-theoretic transforms.
+        std::size_t ntt_multiply = INTTITAN_NTT_THRESHOLD;
+        // Smaller operand size for splitting a product across the parallel_executor (when there is one).
+        std::size_t parallel_multiply = INTTITAN_PARALLEL_MULTIPLY_THRESHOLD;
+        // Divisor size for the recursive division of Burnikel and Ziegler.
+        std::size_t burnikel_ziegler_divide = INTTITAN_BURNIKEL_ZIEGLER_THRESHOLD;
+        // Divisor size for division through a Newton reciprocal, when the quotient is at least four times as long.
+        std::size_t newton_divide = INTTITAN_NEWTON_DIVISION_THRESHOLD;
+        // Operand size for the half-GCD, which reduces the operands by products of matrices of half their size.
+        std::size_t half_gcd = INTTITAN_HALF_GCD_THRESHOLD;
+        // Value size for the divide-and-conquer conversion from the digits of a base that is not a power of two.
+        std::size_t radix_parse = INTTITAN_RADIX_PARSE_THRESHOLD;
+        // Value size for the divide-and-conquer conversion into the digits of a base that is not a power of two.
+        std::size_t radix_print = INTTITAN_RADIX_PRINT_THRESHOLD;
+    };
+    inline thresholds tuning;
+}
+
+#endif //INTTITAN_CONFIG_H
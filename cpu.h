@@ -0,0 +1,103 @@
+#ifndef INTTITAN_CPU_H
+#define INTTITAN_CPU_H
+#include "config.h"
+#include <algorithm>
+#include <cstdlib>
+#include <string_view>
+#if INTTITAN_DISPATCH and defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+// Features of the processor the kernels may use. With INTTITAN_DISPATCH they are detected when first needed, so a
+// single binary picks the best kernels on every machine it runs on, otherwise they are the ones the compiler targets.
+// The environment variable INTTITAN_CPU limits them to a comma-separated list of the names below (e.g. "avx2,bmi2,adx",
+// or "none" for the portable code), to compare the kernels against each other.
+namespace int_titan
+{
+    struct cpu_features
+    {
+        bool carry_flag = false; // "carry_flag": add and subtract through ADC and SBB (every x86-64).
+        bool ssse3 = false; // "ssse3"
+        bool avx2 = false; // "avx2"
+        bool bmi2 = false; // "bmi2": MULX.
+        bool adx = false; // "adx": ADCX and ADOX.
+        bool avx512ifma = false; // "avx512ifma"
+        bool neon = false; // "neon"
+    };
+    // Compile the function for the given instruction set extensions (e.g. "avx2"), whatever the compiler targets.
+#if INTTITAN_DISPATCH
+#define INTTITAN_TARGET(features) __attribute__((target(features)))
+#else
+#define INTTITAN_TARGET(features)
+#endif
+    // What the processor has (or the compiler targets, without INTTITAN_DISPATCH).
+    inline cpu_features detect_cpu_features()
+    {
+        cpu_features features;
+#if INTTITAN_DISPATCH and defined(__x86_64__)
+        __builtin_cpu_init();
+        features.carry_flag = true;
+        features.ssse3 = __builtin_cpu_supports("ssse3");
+        features.avx2 = __builtin_cpu_supports("avx2");
+        features.bmi2 = __builtin_cpu_supports("bmi2");
+        features.avx512ifma = __builtin_cpu_supports("avx512ifma");
+        unsigned int eax, ebx, ecx, edx;
+        features.adx = __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) and (ebx >> 19 & 1) != 0;
+#else
+#if defined(__x86_64__)
+        features.carry_flag = true;
+#endif
+#if defined(__SSSE3__)
+        features.ssse3 = true;
+#endif
+#if defined(__AVX2__)
+        features.avx2 = true;
+#endif
+#if defined(__BMI2__)
+        features.bmi2 = true;
+#endif
+#if defined(__ADX__)
+        features.adx = true;
+#endif
+#if defined(__AVX512IFMA__)
+        features.avx512ifma = true;
+#endif
+#endif
+#if defined(__ARM_NEON) and defined(__aarch64__)
+        features.neon = true;
+#endif
+        return features;
+    }
+    // Only the features named in the list (comma-separated), out of the available ones.
+    inline cpu_features restrict_cpu_features(const cpu_features& available, std::string_view list)
+    {
+        cpu_features features;
+        while(!list.empty())
+        {
+            const std::size_t end = std::min(list.find(','), list.size());
+            const std::string_view name = list.substr(0, end);
+            list.remove_prefix(std::min(end + 1, list.size()));
+            features.carry_flag = features.carry_flag or (name == "carry_flag" and available.carry_flag);
+            features.ssse3 = features.ssse3 or (name == "ssse3" and available.ssse3);
+            features.avx2 = features.avx2 or (name == "avx2" and available.avx2);
+            features.bmi2 = features.bmi2 or (name == "bmi2" and available.bmi2);
+            features.adx = features.adx or (name == "adx" and available.adx);
+            features.avx512ifma = features.avx512ifma or (name == "avx512ifma" and available.avx512ifma);
+            features.neon = features.neon or (name == "neon" and available.neon);
+        }
+        return features;
+    }
+    // The features the kernels use, found once.
+    inline const cpu_features& cpu()
+    {
+        static const cpu_features features = []
+        {
+            const cpu_features available = detect_cpu_features();
+            const char* list = std::getenv("INTTITAN_CPU");
+            return list != nullptr ? restrict_cpu_features(available, list) : available;
+        }();
+        return features;
+    }
+}
+
+#endif //INTTITAN_CPU_H
@@ -0,0 +1,312 @@
+#ifndef INTTITAN_DIVISION_H
+#define INTTITAN_DIVISION_H
+#include "config.h"
+#include "kernels.h"
+#include "multiplication.h"
+#include "scratch.h"
+#include <algorithm>
+
+// Division of raw limb spans: Knuth's Algorithm D (The Art of Computer Programming, vol. 2, 4.3.1) with fast paths for
+// one-digit and two-digit divisors, then the recursive division of Burnikel and Ziegler and the division by a Newton
+// reciprocal as the divisor reaches the tuning thresholds. The last two get their speed from the multiplication.
+namespace int_titan
+{
+    namespace kernels
+    {
+        // Estimate the quotient digit of (u2 u1 u0) / (v1 v0) from the top digits, where v1 has its top bit set and
+        // (u2 u1) < (v1 v0). The estimate is exact for a two-digit divisor, and at most one too large for longer ones.
+        inline digit estimate_quotient(const digit u2, const digit u1, const digit u0, const digit v1, const digit v0)
+        {
+            constexpr superdigit base = superdigit(1) << digit_bits;
+            const superdigit numerator = (static_cast<superdigit>(u2) << digit_bits) | u1;
+            superdigit q = numerator / v1;
+            superdigit r = numerator % v1;
+            while(q >= base or q * v0 > ((r << digit_bits) | u0))
+            {
+                q--;
+                r += v1;
+                if(r >= base)
+                {
+                    break;
+                }
+            }
+            return static_cast<digit>(q);
+        }
+        // q = x / y and r = x % y for a normalized two-digit divisor held in v1 and v0, one quotient digit per step of
+        // (remainder, next digit) / divisor. The dividend is shifted left by s bits on the fly. Writes xn - 1 digits into
+        // q and 2 into r.
+        inline void divide_by_two_digits(digit* q, digit* r, const digit* x, const std::size_t xn, const digit* y)
+        {
+            const int s = leading_zeros(y[1]);
+            const digit v1 = s == 0 ? y[1] : (y[1] << s) | (y[0] >> (digit_bits - s));
+            const digit v0 = y[0] << s;
+            const auto shifted = [&](const std::size_t i) -> digit
+            {
+                const digit low = s == 0 or i == 0 ? 0 : x[i - 1] >> (digit_bits - s);
+                return i == xn ? (s == 0 ? 0 : x[xn - 1] >> (digit_bits - s)) : (x[i] << s) | low;
+            };
+            digit r1 = shifted(xn);
+            digit r0 = shifted(xn - 1);
+            for(std::size_t j = xn - 1; j-- != 0;)
+            {
+                const digit u0 = shifted(j);
+                const digit d = estimate_quotient(r1, r0, u0, v1, v0);
+                // (r1 r0 u0) - d * (v1 v0), which is the new remainder and fits in two digits.
+                const superdigit p0 = static_cast<superdigit>(d) * v0;
+                const superdigit p1 = static_cast<superdigit>(d) * v1 + (p0 >> digit_bits);
+                const digit borrow = u0 < static_cast<digit>(p0) ? 1 : 0;
+                const digit low = u0 - static_cast<digit>(p0);
+                const superdigit high = ((static_cast<superdigit>(r1) << digit_bits) | r0) - p1 - borrow;
+                r1 = static_cast<digit>(high);
+                r0 = low;
+                q[j] = d;
+            }
+            // Undo the normalization of the remainder.
+            r[0] = s == 0 ? r0 : (r0 >> s) | (r1 << (digit_bits - s));
+            r[1] = r1 >> s;
+        }
+        // Algorithm D on a normalized divisor v of n >= 2 digits and the dividend u of un digits, shifted by as much and
+        // with room for one more digit on top. Writes un - n digits into q and leaves the remainder in the low n digits
+        // of u.
+        inline void divide_normalized(digit* q, digit* u, const std::size_t un, const digit* v, const std::size_t n)
+        {
+            for(std::size_t j = un - n; j-- != 0;)
+            {
+                digit d = estimate_quotient(u[j + n], u[j + n - 1], u[j + n - 2], v[n - 1], v[n - 2]);
+                // u[j .. j + n] -= d * v.
+                const digit borrow = submul_1(u + j, v, n, d);
+                const digit top = u[j + n];
+                u[j + n] = top - borrow;
+                if(top < borrow)
+                {
+                    // The estimate was one too large, add the divisor back.
+                    d--;
+                    u[j + n] += add(u + j, u + j, n, v, n);
+                }
+                q[j] = d;
+            }
+        }
+        // Burnikel-Ziegler step: q = u / v for the n + k limbs of u, where k <= n and v (n limbs) has its top bit set.
+        // Writes the low k limbs of the quotient into q and returns the limb above them (0 or 1), the remainder is left
+        // in the low n limbs of u. The top k limbs of the quotient come from dividing the top 2k limbs of u by the top k
+        // limbs of v, which is at most 2 too large once the rest of v is subtracted as well.
+        inline digit divide_recursive(digit* q, digit* u, const std::size_t k, const digit* v, const std::size_t n, scratch_space scratch)
+        {
+            if(k < std::max<std::size_t>(tuning.burnikel_ziegler_divide, 4))
+            {
+                const digit high = compare(u + k, v, n) >= 0 ? 1 : 0;
+                if(high != 0)
+                {
+                    subtract(u + k, u + k, n, v, n);
+                }
+                divide_normalized(q, u, n + k, v, n);
+                return high;
+            }
+            if(k == n)
+            {
+                // Two steps of half the size, the second one starts from a remainder below v.
+                const std::size_t low = n / 2;
+                const digit high = divide_recursive(q + low, u + low, n - low, v, n, scratch);
+                divide_recursive(q, u, low, v, n, scratch);
+                return high;
+            }
+            const std::size_t low = n - k; // Size of the part of v left out of the first division.
+            digit high = divide_recursive(q, u + low, k, v + low, k, scratch);
+            digit* t = scratch.take(n);
+            if(k >= low)
+            {
+                multiply(t, q, k, v, low, scratch);
+            }
+            else
+            {
+                multiply(t, v, low, q, k, scratch);
+            }
+            digit borrow = subtract(u, u, n, t, n);
+            if(high != 0)
+            {
+                borrow += subtract(u + k, u + k, low, v, low);
+            }
+            const digit one = 1;
+            while(borrow != 0)
+            {
+                high -= subtract(q, q, k, &one, 1);
+                borrow -= add(u, u, n, v, n);
+            }
+            return high;
+        }
+        // Burnikel-Ziegler division of the un limbs of u by v (n limbs, top bit set), where the top n limbs of u are below
+        // v. Writes un - n limbs into q and leaves the remainder in the low n limbs of u. The quotient is found n limbs at
+        // a time from the top, with the odd part first.
+        inline void divide_burnikel_ziegler(digit* q, digit* u, const std::size_t un, const digit* v, const std::size_t n)
+        {
+            const std::size_t size = 2 * n + multiply_scratch_size(n);
+            const scratch_buffer<> memory(size);
+            const scratch_space scratch{memory.get(), memory.get() + size};
+            std::size_t j = un - n;
+            if(j % n != 0)
+            {
+                divide_recursive(q + j - j % n, u + j - j % n, j % n, v, n, scratch);
+                j -= j % n;
+            }
+            while(j != 0)
+            {
+                j -= n;
+                divide_recursive(q + j, u + j, n, v, n, scratch);
+            }
+        }
+        // w = floor(B^2n / v) for v of n limbs with its top bit set, give or take a few units, by Newton's iteration.
+        // Writes n + 1 limbs. The reciprocal of the top h = n / 2 + 1 limbs of v is extended with one step
+        // x + x * (B^2n - v * x) / B^2n, which squares the relative error. The extra limb in h keeps the error from
+        // growing from one level to the next.
+        inline void reciprocal(digit* w, const digit* v, const std::size_t n)
+        {
+            if(n < std::max<std::size_t>(tuning.newton_divide, 4))
+            {
+                const scratch_buffer<> u(2 * n + 1);
+                std::fill(u.get(), u.get() + 2 * n, digit(0));
+                u[2 * n] = 1;
+                divide_burnikel_ziegler(w, u.get(), 2 * n + 1, v, n);
+                return;
+            }
+            const std::size_t h = n / 2 + 1;
+            const std::size_t l = n - h;
+            const scratch_buffer<> memory((2 * n + 1) + (2 * n + 2));
+            digit* e = memory.get();
+            digit* c = e + 2 * n + 1;
+            // x = (reciprocal of the top h limbs of v) * B^l.
+            const digit* x_top = w + l;
+            std::fill(w, w + l, digit(0));
+            reciprocal(w + l, v + l, h);
+            std::fill(e, e + l, digit(0));
+            multiply(e + l, v, n, x_top, h + 1);
+            // e = |B^2n - v * x|.
+            const bool too_large = e[2 * n] != 0;
+            if(too_large)
+            {
+                e[2 * n]--;
+            }
+            else
+            {
+                std::fill(c, c + 2 * n, digit(0));
+                subtract(e, c, 2 * n, e, 2 * n);
+            }
+            // The correction x * e / B^2n = x_top * e / B^(n + h) is found from the top of e only, which costs at most
+            // a couple of units.
+            const std::size_t en = normalized_size(e, 2 * n + 1);
+            if(en <= n)
+            {
+                return;
+            }
+            const digit* e_high = e + n;
+            const std::size_t ehn = en - n;
+            if(ehn >= h + 1)
+            {
+                multiply(c, e_high, ehn, x_top, h + 1);
+            }
+            else
+            {
+                multiply(c, x_top, h + 1, e_high, ehn);
+            }
+            const std::size_t cn = normalized_size(c, h + 1 + ehn);
+            if(cn <= h)
+            {
+                return;
+            }
+            const std::size_t correction_size = std::min(cn - h, n + 1);
+            if(too_large)
+            {
+                subtract(w, w, n + 1, c + h, correction_size);
+            }
+            else
+            {
+                add(w, w, n + 1, c + h, correction_size);
+            }
+        }
+        // Division of the un limbs of u by v (n limbs, top bit set) through the reciprocal of v, where the top n limbs of u
+        // are below v. Writes un - n limbs into q and leaves the remainder in the low n limbs of u. Every n quotient limbs
+        // cost two multiplications: the top half of the current 2n limbs times the reciprocal gives an estimate within a
+        // few units, and the product of the estimate and v gives the remainder, which is then corrected.
+        inline void divide_newton(digit* q, digit* u, const std::size_t un, const digit* v, const std::size_t n)
+        {
+            std::size_t j = un - n;
+            if(j % n != 0)
+            {
+                divide_burnikel_ziegler(q + j - j % n, u + j - j % n, n + j % n, v, n);
+                j -= j % n;
+            }
+            const scratch_buffer<> memory((n + 1) + (2 * n + 1));
+            digit* w = memory.get();
+            digit* t = w + n + 1;
+            reciprocal(w, v, n);
+            const digit one = 1;
+            while(j != 0)
+            {
+                j -= n;
+                digit* window = u + j;
+                digit* block = q + j;
+                multiply(t, w, n + 1, window + n, n);
+                // The quotient is below B^n, so an estimate beyond that is cut down right away.
+                if(t[2 * n] != 0)
+                {
+                    std::fill(t + n, t + 2 * n, ~digit(0));
+                }
+                std::copy(t + n, t + 2 * n, block);
+                // The remainder is within a few v of [0, v), so its low n + 1 limbs hold it in two's complement, and
+                // only those of block * v are computed.
+                multiply_low(t, block, n, v, n, n + 1);
+                sub_n(window, window, t, n + 1);
+                while(window[n] >> (digit_bits - 1) != 0)
+                {
+                    subtract(block, block, n, &one, 1);
+                    add(window, window, n + 1, v, n);
+                }
+                while(compare(window, n + 1, v, n) >= 0)
+                {
+                    subtract(window, window, n + 1, v, n);
+                    add(block, block, n, &one, 1);
+                }
+                std::fill(window + n + 1, window + 2 * n, digit(0));
+            }
+        }
+        // q = x / y and r = x % y, where xn >= yn and y has no leading zeroes. Writes xn - yn + 1 digits into q and yn
+        // into r, which must not overlap x or y.
+        inline void divide(digit* q, digit* r, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn)
+        {
+            assert(yn != 0 and y[yn - 1] != 0 and xn >= yn);
+            if(yn == 1)
+            {
+                r[0] = divide_by_digit(q, x, xn, y[0]);
+                return;
+            }
+            if(yn == 2)
+            {
+                divide_by_two_digits(q, r, x, xn, y);
+                return;
+            }
+            // Normalize so that the top bit of the divisor is set, as the quotient estimates need it.
+            const scratch_buffer<> memory(xn + 1 + yn);
+            digit* u = memory.get();
+            digit* v = u + xn + 1;
+            const int s = leading_zeros(y[yn - 1]);
+            shift_left_bits(v, y, yn, s);
+            u[xn] = shift_left_bits(u, x, xn, s);
+            // The reciprocal costs about as much as a few blocks of the recursive division, so it only pays off for long
+            // quotients.
+            if(yn >= std::max<std::size_t>(tuning.newton_divide, 4) and xn + 1 - yn >= 4 * yn)
+            {
+                divide_newton(q, u, xn + 1, v, yn);
+            }
+            else if(yn >= std::max<std::size_t>(tuning.burnikel_ziegler_divide, 4))
+            {
+                divide_burnikel_ziegler(q, u, xn + 1, v, yn);
+            }
+            else
+            {
+                divide_normalized(q, u, xn + 1, v, yn);
+            }
+            shift_right_bits(r, u, yn, s);
+        }
+    }
+}
+
+#endif //INTTITAN_DIVISION_H
@@ -0,0 +1,257 @@
+#ifndef INTTITAN_EXPONENTIATION_H
+#define INTTITAN_EXPONENTIATION_H
+#include "config.h"
+#include "kernels.h"
+#include "scratch.h"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Modular exponentiation of raw limb spans, for any modulus type that provides, for values of size() limbs:
+// one(): the value 1.
+// mul(r, x, y): r = x * y, where r may alias x or y.
+// sqr(r, x): r = x^2, where r may alias x.
+// The values may be kept in another form (e.g. the one of Montgomery), exponentiation only multiplies them.
+namespace int_titan
+{
+    namespace kernels
+    {
+        // Bit i of e.
+        inline digit exponent_bit(const digit* e, const std::size_t i)
+        {
+            return (e[i / digit_bits] >> (i % digit_bits)) & 1;
+        }
+        // Bits i to i + k - 1 of e, which has en limbs (zeroes above them), for k below digit_bits.
+        inline digit exponent_window(const digit* e, const std::size_t en, const std::size_t i, const int k)
+        {
+            const std::size_t limb = i / digit_bits;
+            const int shift = static_cast<int>(i % digit_bits);
+            if(limb >= en)
+            {
+                return 0;
+            }
+            digit w = e[limb] >> shift;
+            if(shift + k > digit_bits and limb + 1 < en)
+            {
+                w |= e[limb + 1] << (digit_bits - shift);
+            }
+            return w & ((digit(1) << k) - 1);
+        }
+        // Window size (in bits) for an exponent of the given number of bits, which balances the precomputed powers
+        // against the multiplications they save.
+        inline int exponent_window_bits(const std::size_t bits)
+        {
+            return bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : 1;
+        }
+        // r = x^e by the sliding window: the exponent is cut into windows of up to k bits that start and end with a one,
+        // so only the odd powers x, x^3, ..., x^(2^k - 1) are precomputed, and the zero bits between the windows cost a
+        // squaring each. e has en limbs, without leading zeroes.
+        template<typename Modulus>
+        void power_sliding_window(digit* r, const digit* x, const digit* e, const std::size_t en, const Modulus& modulus)
+        {
+            const std::size_t n = modulus.size();
+            if(en == 0)
+            {
+                std::copy(modulus.one(), modulus.one() + n, r);
+                return;
+            }
+            const std::size_t bits = en * digit_bits - leading_zeros(e[en - 1]);
+            const int k = exponent_window_bits(bits);
+            const std::size_t entries = std::size_t(1) << (k - 1);
+            // The odd powers, then the square of x that steps from one to the next.
+            const scratch_buffer<> memory((entries + 1) * n);
+            digit* powers = memory.get();
+            digit* x_squared = powers + entries * n;
+            std::copy(x, x + n, powers);
+            modulus.sqr(x_squared, x);
+            for(std::size_t j = 1; j < entries; j++)
+            {
+                modulus.mul(powers + j * n, powers + (j - 1) * n, x_squared);
+            }
+            bool started = false;
+            for(std::size_t i = bits; i != 0;)
+            {
+                if(exponent_bit(e, i - 1) == 0)
+                {
+                    modulus.sqr(r, r);
+                    i--;
+                    continue;
+                }
+                // The window is bits i - 1 down to low, ending with a one.
+                std::size_t low = i > static_cast<std::size_t>(k) ? i - k : 0;
+                while(exponent_bit(e, low) == 0)
+                {
+                    low++;
+                }
+                digit window = 0;
+                for(std::size_t j = i; j-- != low;)
+                {
+                    window = 2 * window + exponent_bit(e, j);
+                }
+                const digit* power = powers + (window >> 1) * n;
+                if(started)
+                {
+                    for(std::size_t j = low; j < i; j++)
+                    {
+                        modulus.sqr(r, r);
+                    }
+                    modulus.mul(r, r, power);
+                }
+                else
+                {
+                    // The top window starts the result, so nothing is squared before it.
+                    std::copy(power, power + n, r);
+                    started = true;
+                }
+                i = low;
+            }
+        }
+        // r = x[0]^e[0] * ... * x[count - 1]^e[count - 1] by interleaved sliding windows (Straus, Shamir's trick for two):
+        // every exponent is cut into windows as by power_sliding_window, each with the odd powers of its base, but all
+        // of them share one chain of squarings, so a product of count powers costs about as many squarings as one. e[j]
+        // has en[j] limbs, without leading zeroes.
+        template<typename Modulus>
+        void power_interleaved(digit* r, const digit* const* x, const digit* const* e, const std::size_t* en, const std::size_t count, const Modulus& modulus)
+        {
+            const std::size_t n = modulus.size();
+            std::size_t bits = 0;
+            std::size_t entries = 0;
+            for(std::size_t j = 0; j < count; j++)
+            {
+                if(en[j] != 0)
+                {
+                    const std::size_t b = en[j] * digit_bits - leading_zeros(e[j][en[j] - 1]);
+                    bits = std::max(bits, b);
+                    entries += std::size_t(1) << (exponent_window_bits(b) - 1);
+                }
+            }
+            std::copy(modulus.one(), modulus.one() + n, r);
+            if(bits == 0)
+            {
+                return;
+            }
+            // The odd powers of every base, a square to step between them, and for every base and bit the value of the
+            // window that ends there (zero for none).
+            const scratch_buffer<> memory((entries + 1) * n + count * bits);
+            digit* powers = memory.get();
+            digit* x_squared = powers + entries * n;
+            digit* windows = x_squared + n;
+            std::fill(windows, windows + count * bits, digit(0));
+            std::size_t offset = 0;
+            std::vector<const digit*> base_powers(count, nullptr);
+            for(std::size_t j = 0; j < count; j++)
+            {
+                if(en[j] == 0)
+                {
+                    continue;
+                }
+                const std::size_t b = en[j] * digit_bits - leading_zeros(e[j][en[j] - 1]);
+                const int k = exponent_window_bits(b);
+                digit* p = powers + offset * n;
+                base_powers[j] = p;
+                offset += std::size_t(1) << (k - 1);
+                std::copy(x[j], x[j] + n, p);
+                modulus.sqr(x_squared, x[j]);
+                for(std::size_t i = 1; i < std::size_t(1) << (k - 1); i++)
+                {
+                    modulus.mul(p + i * n, p + (i - 1) * n, x_squared);
+                }
+                for(std::size_t i = b; i != 0;)
+                {
+                    if(exponent_bit(e[j], i - 1) == 0)
+                    {
+                        i--;
+                        continue;
+                    }
+                    std::size_t low = i > static_cast<std::size_t>(k) ? i - k : 0;
+                    while(exponent_bit(e[j], low) == 0)
+                    {
+                        low++;
+                    }
+                    digit window = 0;
+                    for(std::size_t t = i; t-- != low;)
+                    {
+                        window = 2 * window + exponent_bit(e[j], t);
+                    }
+                    windows[j * bits + low] = window;
+                    i = low;
+                }
+            }
+            bool started = false;
+            for(std::size_t i = bits; i-- != 0;)
+            {
+                if(started)
+                {
+                    modulus.sqr(r, r);
+                }
+                for(std::size_t j = 0; j < count; j++)
+                {
+                    const digit window = windows[j * bits + i];
+                    if(window == 0)
+                    {
+                        continue;
+                    }
+                    const digit* power = base_powers[j] + (window >> 1) * n;
+                    if(started)
+                    {
+                        modulus.mul(r, r, power);
+                    }
+                    else
+                    {
+                        std::copy(power, power + n, r);
+                        started = true;
+                    }
+                }
+            }
+        }
+        // r = x^e by the fixed window, whose sequence of multiplications and memory accesses does not depend on the bits
+        // of e, only on its number of limbs en (which may include leading zeroes): every window of k bits costs k
+        // squarings and a multiplication by x^window, even a zero one, and x^window is read out of all the powers by masks.
+        // For secret exponents, as long as the multiplications of the modulus take constant time too.
+        template<typename Modulus>
+        void power_fixed_window(digit* r, const digit* x, const digit* e, const std::size_t en, const Modulus& modulus)
+        {
+            const std::size_t n = modulus.size();
+            const std::size_t bits = en * digit_bits;
+            if(bits == 0)
+            {
+                std::copy(modulus.one(), modulus.one() + n, r);
+                return;
+            }
+            // A window size that divides the digit size, so that no window straddles two limbs.
+            const int k = bits > 79 ? 4 : 2;
+            const std::size_t entries = std::size_t(1) << k;
+            const scratch_buffer<> memory((entries + 1) * n);
+            digit* powers = memory.get();
+            digit* selected = powers + entries * n;
+            std::copy(modulus.one(), modulus.one() + n, powers);
+            std::copy(x, x + n, powers + n);
+            for(std::size_t j = 2; j < entries; j++)
+            {
+                modulus.mul(powers + j * n, powers + (j - 1) * n, x);
+            }
+            std::copy(modulus.one(), modulus.one() + n, r);
+            for(std::size_t i = bits; i != 0; i -= k)
+            {
+                const digit window = (e[(i - k) / digit_bits] >> ((i - k) % digit_bits)) & (entries - 1);
+                std::fill(selected, selected + n, digit(0));
+                for(std::size_t w = 0; w < entries; w++)
+                {
+                    // All ones for the wanted power, without a branch on the window.
+                    const digit mask = static_cast<digit>(0) - ((static_cast<digit>(w ^ window) - 1) >> (digit_bits - 1) & 1);
+                    for(std::size_t j = 0; j < n; j++)
+                    {
+                        selected[j] |= powers[w * n + j] & mask;
+                    }
+                }
+                for(int j = 0; j < k; j++)
+                {
+                    modulus.sqr(r, r);
+                }
+                modulus.mul(r, r, selected);
+            }
+        }
+    }
+}
+
+#endif //INTTITAN_EXPONENTIATION_H
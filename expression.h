@@ -0,0 +1,283 @@
+#ifndef INTTITAN_EXPRESSION_H
+#define INTTITAN_EXPRESSION_H
+#include "integer.h"
+#include <type_traits>
+
+// Opt-in lazy evaluation of chained arithmetic. Wrapping an operand in lazy() makes the operators build an expression
+// instead of computing, and nothing is computed until the expression is assigned to an integer. Then the first term goes
+// into the destination and the others are fused into it (a product through integer::addmul or integer::submul, a
+// product modulo m through integer::multiply_mod), so a * b + c * d - e creates no intermediate integer:
+//
+//     r = lazy(a) * b + lazy(c) * d - e;
+//     assign(r, lazy(a) * b + lazy(c) * d - e); // Reuses the digits of r.
+//     r += lazy(c) * d;
+//
+// The operands are held by reference, so an expression must not outlive them (e.g. it should not be kept in an auto
+// variable across statements).
+namespace int_titan
+{
+    namespace expression
+    {
+        // Base of the expression types, which provide:
+        // assign(r): r = value, where r is not an operand.
+        // accumulate(r, negate): r = r + value (or r - value when negate), where r is not an operand.
+        // refers_to(r): is r an operand?
+        template<typename Derived>
+        struct node
+        {
+            const Derived& self() const
+            {
+                return static_cast<const Derived&>(*this);
+            }
+            integer value() const
+            {
+                integer r;
+                self().assign(r);
+                return r;
+            }
+            operator integer() const
+            {
+                return value();
+            }
+        };
+        template<typename T>
+        constexpr bool is_node = std::is_base_of<node<T>, T>::value;
+        // An operand.
+        struct leaf : node<leaf>
+        {
+            const integer& x;
+            explicit leaf(const integer& x) : x(x)
+            {
+            }
+            const integer& value() const
+            {
+                return x;
+            }
+            void assign(integer& r) const
+            {
+                r = x;
+            }
+            void accumulate(integer& r, const bool negate) const
+            {
+                if(negate)
+                {
+                    r -= x;
+                }
+                else
+                {
+                    r += x;
+                }
+            }
+            bool refers_to(const integer& r) const
+            {
+                return &x == &r;
+            }
+        };
+        // left * right.
+        template<typename Left, typename Right>
+        struct product : node<product<Left, Right>>
+        {
+            Left left;
+            Right right;
+            product(const Left& left, const Right& right) : left(left), right(right)
+            {
+            }
+            void assign(integer& r) const
+            {
+                r = integer::multiply(left.value(), right.value());
+            }
+            void accumulate(integer& r, const bool negate) const
+            {
+                // Operands that are expressions themselves are computed first (r is not among their operands).
+                const auto& x = left.value();
+                const auto& y = right.value();
+                if(negate)
+                {
+                    integer::submul(r, x, y);
+                }
+                else
+                {
+                    integer::addmul(r, x, y);
+                }
+            }
+            bool refers_to(const integer& r) const
+            {
+                return left.refers_to(r) or right.refers_to(r);
+            }
+        };
+        // left + right, or left - right when subtract.
+        template<typename Left, typename Right>
+        struct sum : node<sum<Left, Right>>
+        {
+            Left left;
+            Right right;
+            bool subtract;
+            sum(const Left& left, const Right& right, const bool subtract) : left(left), right(right), subtract(subtract)
+            {
+            }
+            void assign(integer& r) const
+            {
+                left.assign(r);
+                right.accumulate(r, subtract);
+            }
+            void accumulate(integer& r, const bool negate) const
+            {
+                left.accumulate(r, negate);
+                right.accumulate(r, negate != subtract);
+            }
+            bool refers_to(const integer& r) const
+            {
+                return left.refers_to(r) or right.refers_to(r);
+            }
+        };
+        // -operand.
+        template<typename Operand>
+        struct negation : node<negation<Operand>>
+        {
+            Operand operand;
+            explicit negation(const Operand& operand) : operand(operand)
+            {
+            }
+            void assign(integer& r) const
+            {
+                operand.assign(r);
+                r = -r;
+            }
+            void accumulate(integer& r, const bool negate) const
+            {
+                operand.accumulate(r, !negate);
+            }
+            bool refers_to(const integer& r) const
+            {
+                return operand.refers_to(r);
+            }
+        };
+        // operand % modulus, truncated like the operator. A product of two operands is reduced by integer::multiply_mod.
+        template<typename Operand, typename Modulus>
+        struct remainder : node<remainder<Operand, Modulus>>
+        {
+            Operand operand;
+            Modulus modulus;
+            remainder(const Operand& operand, const Modulus& modulus) : operand(operand), modulus(modulus)
+            {
+            }
+            integer compute() const
+            {
+                if constexpr(std::is_same<Operand, product<leaf, leaf>>::value)
+                {
+                    return integer::multiply_mod(operand.left.x, operand.right.x, modulus.value());
+                }
+                else
+                {
+                    return operand.value() % modulus.value();
+                }
+            }
+            void assign(integer& r) const
+            {
+                r = compute();
+            }
+            void accumulate(integer& r, const bool negate) const
+            {
+                const integer x = compute();
+                if(negate)
+                {
+                    r -= x;
+                }
+                else
+                {
+                    r += x;
+                }
+            }
+            bool refers_to(const integer& r) const
+            {
+                return operand.refers_to(r) or modulus.refers_to(r);
+            }
+        };
+        // The expression for an operand of an operator.
+        inline leaf wrap(const integer& x)
+        {
+            return leaf(x);
+        }
+        template<typename T, typename = std::enable_if_t<is_node<T>>>
+        const T& wrap(const T& x)
+        {
+            return x;
+        }
+        template<typename T>
+        using wrapped = std::decay_t<decltype(wrap(std::declval<const T&>()))>;
+        // Do the operands of a binary operator make an expression (at least one of them is already one)?
+        template<typename X, typename Y>
+        constexpr bool is_operation = (is_node<X> and (is_node<Y> or std::is_same<Y, integer>::value)) or (is_node<Y> and std::is_same<X, integer>::value);
+        template<typename X, typename Y, typename = std::enable_if_t<is_operation<X, Y>>>
+        product<wrapped<X>, wrapped<Y>> operator*(const X& x, const Y& y)
+        {
+            return {wrap(x), wrap(y)};
+        }
+        template<typename X, typename Y, typename = std::enable_if_t<is_operation<X, Y>>>
+        sum<wrapped<X>, wrapped<Y>> operator+(const X& x, const Y& y)
+        {
+            return {wrap(x), wrap(y), false};
+        }
+        template<typename X, typename Y, typename = std::enable_if_t<is_operation<X, Y>>>
+        sum<wrapped<X>, wrapped<Y>> operator-(const X& x, const Y& y)
+        {
+            return {wrap(x), wrap(y), true};
+        }
+        template<typename X, typename Y, typename = std::enable_if_t<is_operation<X, Y>>>
+        remainder<wrapped<X>, wrapped<Y>> operator%(const X& x, const Y& y)
+        {
+            return {wrap(x), wrap(y)};
+        }
+        template<typename X, typename = std::enable_if_t<is_node<X>>>
+        negation<X> operator-(const X& x)
+        {
+            return negation<X>(x);
+        }
+        // r = e, reusing the digits of r unless r is an operand of e.
+        template<typename E, typename = std::enable_if_t<is_node<E>>>
+        void assign(integer& r, const E& e)
+        {
+            if(e.refers_to(r))
+            {
+                r = e.value();
+            }
+            else
+            {
+                e.assign(r);
+            }
+        }
+        template<typename E, typename = std::enable_if_t<is_node<E>>>
+        integer& operator+=(integer& r, const E& e)
+        {
+            if(e.refers_to(r))
+            {
+                r += e.value();
+            }
+            else
+            {
+                e.accumulate(r, false);
+            }
+            return r;
+        }
+        template<typename E, typename = std::enable_if_t<is_node<E>>>
+        integer& operator-=(integer& r, const E& e)
+        {
+            if(e.refers_to(r))
+            {
+                r -= e.value();
+            }
+            else
+            {
+                e.accumulate(r, true);
+            }
+            return r;
+        }
+    }
+    // Start a lazily evaluated expression from x.
+    inline expression::leaf lazy(const integer& x)
+    {
+        return expression::leaf(x);
+    }
+}
+
+#endif //INTTITAN_EXPRESSION_H
@@ -0,0 +1,373 @@
+#ifndef INTTITAN_FIXED_INTEGER_H
+#define INTTITAN_FIXED_INTEGER_H
+#include "config.h"
+#include "integer.h"
+#include "kernels.h"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// Integers of a fixed number of bits, in an std::array of limbs and without any heap memory. The kernels below run over
+// a number of limbs known at compile time, so the compilers unroll them completely (and they work in constant
+// expressions too).
+namespace int_titan
+{
+    namespace kernels
+    {
+        // f(0), f(1), ..., f(N - 1), unrolled whatever the optimization level.
+        template<typename F, std::size_t... I>
+        constexpr void unroll(F&& f, std::index_sequence<I...>)
+        {
+            (f(I), ...);
+        }
+        template<std::size_t N, typename F>
+        constexpr void unroll(F&& f)
+        {
+            unroll(f, std::make_index_sequence<N>());
+        }
+        // r = x + y, all N limbs. Returns the carry out of the top one. r may alias x or y.
+        template<std::size_t N>
+        constexpr digit fixed_add(std::array<digit, N>& r, const std::array<digit, N>& x, const std::array<digit, N>& y)
+        {
+#if defined(__x86_64__) and defined(__GNUC__)
+            // At run time, a single chain of ADC.
+            if(!__builtin_is_constant_evaluated())
+            {
+                unsigned char flag = 0;
+                unroll<N>([&](const std::size_t i)
+                {
+                    flag = add_with_carry(flag, x[i], y[i], r[i]);
+                });
+                return flag;
+            }
+#endif
+            digit carry = 0;
+            unroll<N>([&](const std::size_t i)
+            {
+                const superdigit sum = static_cast<superdigit>(x[i]) + y[i] + carry;
+                r[i] = static_cast<digit>(sum);
+                carry = static_cast<digit>(sum >> digit_bits);
+            });
+            return carry;
+        }
+        // r = x - y, all N limbs. Returns the borrow out of the top one. r may alias x or y.
+        template<std::size_t N>
+        constexpr digit fixed_subtract(std::array<digit, N>& r, const std::array<digit, N>& x, const std::array<digit, N>& y)
+        {
+#if defined(__x86_64__) and defined(__GNUC__)
+            if(!__builtin_is_constant_evaluated())
+            {
+                unsigned char flag = 0;
+                unroll<N>([&](const std::size_t i)
+                {
+                    flag = subtract_with_borrow(flag, x[i], y[i], r[i]);
+                });
+                return flag;
+            }
+#endif
+            digit borrow = 0;
+            unroll<N>([&](const std::size_t i)
+            {
+                const superdigit difference = static_cast<superdigit>(x[i]) - y[i] - borrow;
+                r[i] = static_cast<digit>(difference);
+                borrow = static_cast<digit>(difference >> digit_bits) & 1;
+            });
+            return borrow;
+        }
+        // r = x * y modulo B^R (the low R limbs of the product, R at most N + M). r must not overlap x or y.
+        template<std::size_t R, std::size_t N, std::size_t M>
+        constexpr void fixed_multiply(std::array<digit, R>& r, const std::array<digit, N>& x, const std::array<digit, M>& y)
+        {
+            r = {};
+            unroll<(N < R ? N : R)>([&](const std::size_t i)
+            {
+                digit carry = 0;
+                unroll<M>([&](const std::size_t j)
+                {
+                    if(i + j < R)
+                    {
+                        const superdigit t = static_cast<superdigit>(x[i]) * y[j] + r[i + j] + carry;
+                        r[i + j] = static_cast<digit>(t);
+                        carry = static_cast<digit>(t >> digit_bits);
+                    }
+                });
+                if(i + M < R)
+                {
+                    r[i + M] = carry;
+                }
+            });
+        }
+        // Compare x and y, both N limbs (returns -1, 0 or 1).
+        template<std::size_t N>
+        constexpr int fixed_compare(const std::array<digit, N>& x, const std::array<digit, N>& y)
+        {
+            for(std::size_t i = N; i-- != 0;)
+            {
+                if(x[i] != y[i])
+                {
+                    return x[i] < y[i] ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+    }
+    // An unsigned integer of Bits bits (a multiple of the digit size), with the arithmetic modulo 2^Bits of the built-in
+    // unsigned types. Converts to and from integer explicitly.
+    template<std::size_t Bits>
+    class fixed_integer
+    {
+        static_assert(Bits != 0 and Bits % digit_bits == 0, "The bits of a fixed_integer must be a multiple of the digit size.");
+    public:
+        using digit = int_titan::digit;
+        // Number of limbs.
+        static constexpr std::size_t size = Bits / digit_bits;
+        using limb_array = std::array<digit, size>;
+        constexpr fixed_integer() : limbs{}
+        {
+        }
+        // From the limbs (little-endian).
+        constexpr explicit fixed_integer(const limb_array& limbs) : limbs(limbs)
+        {
+        }
+        // From a fixed_integer of another size, modulo 2^Bits.
+        template<std::size_t OtherBits, typename = std::enable_if_t<OtherBits != Bits>>
+        constexpr explicit fixed_integer(const fixed_integer<OtherBits>& x) : limbs{}
+        {
+            for(std::size_t i = 0; i < size and i < fixed_integer<OtherBits>::size; i++)
+            {
+                limbs[i] = x.get_limbs()[i];
+            }
+        }
+        // From a machine integer, modulo 2^Bits (so a negative one becomes 2^Bits minus its magnitude).
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        constexpr explicit fixed_integer(const T value) : limbs{}
+        {
+            // At least 64 bits, sign-extended, so that it fills whole digits.
+            using wide_type = std::conditional_t<(sizeof(T) > 8), T, std::conditional_t<machine_integer_traits<T>::is_signed, std::int64_t, std::uint64_t>>;
+            using bits_type = machine_unsigned_t<wide_type>;
+            constexpr std::size_t width = sizeof(wide_type) * CHAR_BIT;
+            bits_type bits = static_cast<bits_type>(static_cast<wide_type>(value));
+            for(std::size_t i = 0; i < size and i < width / digit_bits; i++)
+            {
+                limbs[i] = static_cast<digit>(bits);
+                if constexpr(width > digit_bits)
+                {
+                    bits >>= digit_bits;
+                }
+            }
+            if constexpr(machine_integer_traits<T>::is_signed)
+            {
+                for(std::size_t i = width / digit_bits; value < 0 and i < size; i++)
+                {
+                    limbs[i] = ~digit(0);
+                }
+            }
+        }
+        // From an integer, modulo 2^Bits.
+        explicit fixed_integer(const integer& x) : limbs{}
+        {
+            const auto& xv = x.digits.view();
+            const std::size_t n = std::min(xv.size(), size);
+            for(std::size_t i = 0; i < n; i++)
+            {
+                limbs[i] = xv[i];
+            }
+            if(x.is_negative)
+            {
+                *this = -*this;
+            }
+        }
+        // The value as an integer.
+        explicit operator integer() const
+        {
+            integer::digit_buffer result(limbs.data(), limbs.data() + size);
+            result.resize(kernels::normalized_size(limbs.data(), size));
+            return integer::create_from_buffer(std::move(result), false);
+        }
+        constexpr const limb_array& get_limbs() const
+        {
+            return limbs;
+        }
+        // x + y, setting carry to the carry out of the top.
+        static constexpr fixed_integer add(const fixed_integer& x, const fixed_integer& y, digit& carry)
+        {
+            fixed_integer r;
+            carry = kernels::fixed_add(r.limbs, x.limbs, y.limbs);
+            return r;
+        }
+        // x - y, setting borrow to the borrow out of the top.
+        static constexpr fixed_integer subtract(const fixed_integer& x, const fixed_integer& y, digit& borrow)
+        {
+            fixed_integer r;
+            borrow = kernels::fixed_subtract(r.limbs, x.limbs, y.limbs);
+            return r;
+        }
+        // The full product of x and y, of twice the bits.
+        static constexpr fixed_integer<2 * Bits> multiply_wide(const fixed_integer& x, const fixed_integer& y)
+        {
+            typename fixed_integer<2 * Bits>::limb_array r{};
+            kernels::fixed_multiply(r, x.limbs, y.limbs);
+            return fixed_integer<2 * Bits>(r);
+        }
+        // Three-way comparison (-1, 0 or 1).
+        static constexpr int compare(const fixed_integer& x, const fixed_integer& y)
+        {
+            return kernels::fixed_compare(x.limbs, y.limbs);
+        }
+
+        // Operator functions.
+        // Comparison.
+        friend constexpr bool operator==(const fixed_integer& x, const fixed_integer& y)
+        {
+            return compare(x, y) == 0;
+        }
+        friend constexpr bool operator!=(const fixed_integer& x, const fixed_integer& y)
+        {
+            return compare(x, y) != 0;
+        }
+        friend constexpr bool operator<(const fixed_integer& x, const fixed_integer& y)
+        {
+            return compare(x, y) < 0;
+        }
+        friend constexpr bool operator<=(const fixed_integer& x, const fixed_integer& y)
+        {
+            return compare(x, y) <= 0;
+        }
+        friend constexpr bool operator>(const fixed_integer& x, const fixed_integer& y)
+        {
+            return compare(x, y) > 0;
+        }
+        friend constexpr bool operator>=(const fixed_integer& x, const fixed_integer& y)
+        {
+            return compare(x, y) >= 0;
+        }
+        // Arithmetic (modulo 2^Bits).
+        friend constexpr fixed_integer operator+(const fixed_integer& x, const fixed_integer& y)
+        {
+            fixed_integer r;
+            kernels::fixed_add(r.limbs, x.limbs, y.limbs);
+            return r;
+        }
+        friend constexpr fixed_integer& operator+=(fixed_integer& x, const fixed_integer& y)
+        {
+            kernels::fixed_add(x.limbs, x.limbs, y.limbs);
+            return x;
+        }
+        friend constexpr fixed_integer operator-(const fixed_integer& x, const fixed_integer& y)
+        {
+            fixed_integer r;
+            kernels::fixed_subtract(r.limbs, x.limbs, y.limbs);
+            return r;
+        }
+        friend constexpr fixed_integer operator-(const fixed_integer& x)
+        {
+            return fixed_integer() - x;
+        }
+        friend constexpr fixed_integer& operator-=(fixed_integer& x, const fixed_integer& y)
+        {
+            kernels::fixed_subtract(x.limbs, x.limbs, y.limbs);
+            return x;
+        }
+        friend constexpr fixed_integer operator*(const fixed_integer& x, const fixed_integer& y)
+        {
+            fixed_integer r;
+            kernels::fixed_multiply(r.limbs, x.limbs, y.limbs);
+            return r;
+        }
+        friend constexpr fixed_integer& operator*=(fixed_integer& x, const fixed_integer& y)
+        {
+            x = x * y;
+            return x;
+        }
+    private:
+        limb_array limbs;
+    };
+    // Integer literals parsed at compile time: decimal, hexadecimal (0x), binary (0b) or octal (0), with the digit
+    // separators of C++14.
+    namespace literal
+    {
+        // Value of a digit character, or -1.
+        constexpr int digit_value(const char c)
+        {
+            return c >= '0' and c <= '9' ? c - '0' : c >= 'a' and c <= 'f' ? c - 'a' + 10 : c >= 'A' and c <= 'F' ? c - 'A' + 10 : -1;
+        }
+        template<char... Chars>
+        struct parser
+        {
+            static constexpr char characters[] = {Chars...};
+            static constexpr std::size_t count = sizeof...(Chars);
+            static constexpr int base = count < 2 or characters[0] != '0' ? 10
+                : characters[1] == 'x' or characters[1] == 'X' ? 16 : characters[1] == 'b' or characters[1] == 'B' ? 2 : 8;
+            static constexpr std::size_t first = base == 16 or base == 2 ? 2 : 0;
+            static constexpr std::size_t digits()
+            {
+                std::size_t n = 0;
+                for(std::size_t i = first; i < count; i++)
+                {
+                    n += characters[i] != '\'' ? 1 : 0;
+                }
+                return n;
+            }
+            static constexpr bool is_valid()
+            {
+                for(std::size_t i = first; i < count; i++)
+                {
+                    if(characters[i] != '\'' and (digit_value(characters[i]) < 0 or digit_value(characters[i]) >= base))
+                    {
+                        return false;
+                    }
+                }
+                return digits() != 0;
+            }
+            static_assert(is_valid(), "Not an integer literal.");
+            // Bits for the digits (log2(10) < 3.322 for decimal), so leading zeroes make room too.
+            static constexpr std::size_t bits = base == 16 ? 4 * digits() : base == 8 ? 3 * digits() : base == 2 ? digits() : digits() * 3322 / 1000 + 1;
+            static constexpr std::size_t size = (bits + digit_bits - 1) / digit_bits;
+            using type = fixed_integer<size * digit_bits>;
+            // x = x * base + d for each digit, one pass over the limbs each.
+            static constexpr type value()
+            {
+                typename type::limb_array x{};
+                for(std::size_t i = first; i < count; i++)
+                {
+                    if(characters[i] == '\'')
+                    {
+                        continue;
+                    }
+                    superdigit carry = static_cast<superdigit>(digit_value(characters[i]));
+                    for(std::size_t j = 0; j < size; j++)
+                    {
+                        const superdigit t = static_cast<superdigit>(x[j]) * base + carry;
+                        x[j] = static_cast<digit>(t);
+                        carry = t >> digit_bits;
+                    }
+                }
+                return type(x);
+            }
+        };
+    }
+    namespace literals
+    {
+        // A fixed_integer of the literal, with as many bits as its digits need: 0xFFFF_big is a fixed_integer of one digit,
+        // computed by the compiler. Convert it to the wanted size or to an integer.
+        template<char... Chars>
+        constexpr typename literal::parser<Chars...>::type operator""_big()
+        {
+            return literal::parser<Chars...>::value();
+        }
+        // An integer of the literal, whose digits the compiler computes: only copied into the integer at run time, no
+        // parsing.
+        template<char... Chars>
+        integer operator""_integer()
+        {
+            static constexpr typename literal::parser<Chars...>::type value = literal::parser<Chars...>::value();
+            return integer(value);
+        }
+    }
+}
+
+#endif //INTTITAN_FIXED_INTEGER_H
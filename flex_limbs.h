@@ -0,0 +1,110 @@
+#ifndef INTTITAN_FLEX_LIMBS_H
+#define INTTITAN_FLEX_LIMBS_H
+#include "limb_buffer.h"
+#include <immer/algorithm.hpp>
+#include <immer/flex_vector.hpp>
+#include <immer/flex_vector_transient.hpp>
+
+namespace int_titan
+{
+    // Limbs kept in a persistent immer::flex_vector. The arithmetic kernels work on contiguous memory, so they read the limbs
+    // through a flattened copy (see view()) and the results are built back into a tree in one pass. The tree nodes come
+    // from MemoryPolicy, see memory.h.
+    template<typename Digit, typename MemoryPolicy = default_memory_policy>
+    class flex_limbs
+    {
+    public:
+        using value_type = Digit;
+        using size_type = std::size_t;
+        using memory_policy = MemoryPolicy;
+        using tree_type = immer::flex_vector<Digit, MemoryPolicy>;
+        flex_limbs() = default;
+        flex_limbs(const tree_type& tree) : tree(tree)
+        {
+        }
+        flex_limbs(std::initializer_list<Digit> digits) : tree(digits)
+        {
+        }
+        template<std::size_t InlineLimbs, typename BufferPolicy>
+        flex_limbs(const limb_buffer<Digit, InlineLimbs, BufferPolicy>& buffer) : tree(buffer.begin(), buffer.end())
+        {
+        }
+        size_type size() const
+        {
+            return tree.size();
+        }
+        bool empty() const
+        {
+            return tree.empty();
+        }
+        Digit operator[](const size_type index) const
+        {
+            return tree[index];
+        }
+        // The underlying persistent vector.
+        const tree_type& persistent() const
+        {
+            return tree;
+        }
+        // Do both refer to the same tree?
+        bool shares_storage(const flex_limbs& other) const
+        {
+            return tree.identity() == other.tree.identity();
+        }
+        // Slicing and concatenation share the nodes of the trees and take O(log n) (the strength of the persistent vector,
+        // which an integer that is assembled from parts formed apart can use without copying limbs).
+        // The limbs [0, n).
+        flex_limbs take(const size_type n) const
+        {
+            return tree.take(n);
+        }
+        // The limbs [n, size()).
+        flex_limbs drop(const size_type n) const
+        {
+            return tree.drop(n);
+        }
+        // These limbs followed by those of high.
+        flex_limbs concat(const flex_limbs& high) const
+        {
+            return tree + high.tree;
+        }
+        // n zero limbs.
+        static flex_limbs zeros(const size_type n)
+        {
+            return tree_type(n, Digit(0));
+        }
+        // Number of limbs without the leading zeroes.
+        size_type normalized_size() const
+        {
+            size_type n = tree.size();
+            while(n > 0 and tree[n - 1] == 0)
+            {
+                n--;
+            }
+            return n;
+        }
+        // Contiguous copy of the limbs.
+        limb_buffer<Digit> view() const
+        {
+            limb_buffer<Digit> flat(tree.size());
+            Digit* out = flat.mutable_data();
+            immer::for_each_chunk(tree, [&out](const Digit* first, const Digit* last)
+            {
+                out = std::copy(first, last, out);
+            });
+            return flat;
+        }
+        friend bool operator==(const flex_limbs& x, const flex_limbs& y)
+        {
+            return x.tree == y.tree;
+        }
+        friend bool operator!=(const flex_limbs& x, const flex_limbs& y)
+        {
+            return x.tree != y.tree;
+        }
+    private:
+        tree_type tree;
+    };
+}
+
+#endif //INTTITAN_FLEX_LIMBS_H
@@ -0,0 +1,247 @@
+#ifndef INTTITAN_DIFFERENTIAL_H
+#define INTTITAN_DIFFERENTIAL_H
+#include "integer.h"
+#include <gmpxx.h>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Differential testing of integer against GMP, shared by the fuzz and stress targets: check() runs every operation on
+// a pair of integers and on the same values in GMP, and reports each result that differs by its name.
+namespace int_titan::differential
+{
+    // The value of x in GMP, through the bytes of its magnitude.
+    inline mpz_class reference(const integer& x)
+    {
+        const integer magnitude = integer::absolute_value(x);
+        std::vector<std::byte> bytes(integer::byte_length(magnitude));
+        integer::to_bytes(magnitude, bytes.data(), bytes.size());
+        mpz_class r;
+        mpz_import(r.get_mpz_t(), bytes.size(), 1, 1, 0, 0, bytes.data());
+        return x < integer::zero ? mpz_class(-r) : r;
+    }
+    // The integer of the n limbs x, negated if negative.
+    inline integer from_limbs(const digit* x, const std::size_t n, const bool negative)
+    {
+        return integer::create(integer_view(x, n, negative));
+    }
+    // The least thresholds the algorithms take, so that each tier runs on operands of a few limbs.
+    inline thresholds least_thresholds()
+    {
+        thresholds t = tuning;
+        for(const threshold_name& threshold : threshold_names)
+        {
+            t.*threshold.member = threshold.least;
+        }
+        return t;
+    }
+    inline int sign(const int comparison)
+    {
+        return (comparison > 0) - (comparison < 0);
+    }
+    // Runs the operations on x and y and calls fail(name) for each whose result is not GMP's. The costly ones that do
+    // not take part in the tiers (roots, primality, pow) get smaller operands.
+    template<typename Fail>
+    void check(const integer& x, const integer& y, Fail&& fail)
+    {
+        const mpz_class a = reference(x);
+        const mpz_class b = reference(y);
+        // Each result must also be in the canonical form: no leading zero digits and no negative zero.
+        const auto expect = [&](const char* name, const integer& r, const mpz_class& e)
+        {
+            const std::size_t limbs = e == 0 ? 0 : (mpz_sizeinbase(e.get_mpz_t(), 2) + digit_bits - 1) / digit_bits;
+            if(reference(r) != e or integer::sign(r) != sgn(e) or integer::limb_count(r) != limbs)
+            {
+                fail(name);
+            }
+        };
+        const auto expect_true = [&](const char* name, const bool ok)
+        {
+            if(!ok)
+            {
+                fail(name);
+            }
+        };
+        const std::size_t bits = std::max(mpz_sizeinbase(a.get_mpz_t(), 2), mpz_sizeinbase(b.get_mpz_t(), 2));
+        // Addition and subtraction, by every overload.
+        expect("add", integer::add(x, y), a + b);
+        expect("x + y", x + y, a + b);
+        expect("x&& + y", integer(x) + y, a + b);
+        expect("x + y&&", x + integer(y), a + b);
+        {
+            integer r = x;
+            r += y;
+            expect("x += y", r, a + b);
+            r = x;
+            r += r;
+            expect("x += x", r, a + a);
+            r = x;
+            ++r;
+            expect("++x", r, a + 1);
+        }
+        expect("subtract", integer::subtract(x, y), a - b);
+        expect("x - y", x - y, a - b);
+        expect("x&& - y", integer(x) - y, a - b);
+        expect("x - y&&", x - integer(y), a - b);
+        expect("-x", -x, -a);
+        {
+            integer r = x;
+            r -= y;
+            expect("x -= y", r, a - b);
+            r = x;
+            r -= r;
+            expect("x -= x", r, 0);
+            r = x;
+            --r;
+            expect("--x", r, a - 1);
+        }
+        // Multiplication.
+        expect("multiply", integer::multiply(x, y), a * b);
+        expect("x * y", x * y, a * b);
+        expect("x&& * y", integer(x) * y, a * b);
+        expect("x * x", x * x, a * a);
+        expect("x * -x", x * -x, -(a * a));
+        expect("square", integer::square(x), a * a);
+        {
+            integer r = x;
+            r *= y;
+            expect("x *= y", r, a * b);
+            r = y;
+            integer::addmul(r, x, y);
+            expect("addmul", r, b + a * b);
+            r = y;
+            integer::submul(r, x, y);
+            expect("submul", r, b - a * b);
+        }
+        // Short products: the low limbs exactly, the high ones at most n too small.
+        {
+            const bool negative = sgn(a) * sgn(b) < 0;
+            const mpz_class magnitude = abs(a) * abs(b);
+            const std::size_t n = 1 + bits / (2 * digit_bits);
+            mpz_class low;
+            mpz_tdiv_r_2exp(low.get_mpz_t(), magnitude.get_mpz_t(), n * digit_bits);
+            expect("multiply_low", integer::multiply_low(x, y, n), negative ? mpz_class(-low) : low);
+            const std::size_t m = (bits + digit_bits - 1) / digit_bits;
+            mpz_class high;
+            mpz_tdiv_q_2exp(high.get_mpz_t(), magnitude.get_mpz_t(), m * digit_bits);
+            const mpz_class error = high - abs(reference(integer::multiply_high(x, y, m)));
+            expect_true("multiply_high", error >= 0 and error <= m);
+        }
+        // Comparison.
+        const int comparison = sign(cmp(a, b));
+        expect_true("compare", integer::compare(x, y) == comparison);
+        expect_true("x == y", (x == y) == (comparison == 0));
+        expect_true("x != y", (x != y) == (comparison != 0));
+        expect_true("x < y", (x < y) == (comparison < 0));
+        expect_true("x <= y", (x <= y) == (comparison <= 0));
+        expect_true("x > y", (x > y) == (comparison > 0));
+        expect_true("x >= y", (x >= y) == (comparison >= 0));
+        expect_true("hash", comparison != 0 or integer::hash(x) == integer::hash(y));
+        // Division, truncating as GMP's tdiv.
+        if(b != 0)
+        {
+            const auto [quotient, remainder] = integer::divide(x, y);
+            expect("divide quotient", quotient, a / b);
+            expect("divide remainder", remainder, a % b);
+            expect("x / y", x / y, a / b);
+            expect("x % y", x % y, a % b);
+            expect("multiply_mod", integer::multiply_mod(x, x, y), a * a % b);
+            const mpz_class m = abs(b);
+            const mpz_class e = abs(a) % (mpz_class(1) << 32);
+            mpz_class power;
+            mpz_powm(power.get_mpz_t(), a.get_mpz_t(), e.get_mpz_t(), m.get_mpz_t());
+            expect("pow_mod", integer::pow_mod(x, integer::create(e.get_str(16), true), y), power);
+            {
+                const mpz_class f = abs(b) % (mpz_class(1) << 32);
+                mpz_class other;
+                mpz_powm(other.get_mpz_t(), a.get_mpz_t(), f.get_mpz_t(), m.get_mpz_t());
+                expect("multi_pow_mod", integer::multi_pow_mod(x, integer::create(e.get_str(16), true), x, integer::create(f.get_str(16), true), y), power * other % m);
+            }
+            mpz_class inverse;
+            if(m > 1 and mpz_invert(inverse.get_mpz_t(), a.get_mpz_t(), m.get_mpz_t()) != 0)
+            {
+                expect("mod_inverse", integer::mod_inverse(x, y), inverse);
+            }
+        }
+        else
+        {
+            bool thrown = false;
+            try
+            {
+                integer::divide(x, y);
+            }
+            catch(const std::logic_error&)
+            {
+                thrown = true;
+            }
+            expect_true("divide by zero", thrown);
+        }
+        {
+            const mpz_class low = abs(b) % (mpz_class(1) << (digit_bits - 1));
+            const digit d = static_cast<digit>(std::stoull(low.get_str(10))) | 1;
+            const mpz_class dd(std::to_string(d));
+            const auto [quotient, remainder] = integer::divide_by_digit(x, d);
+            expect("divide_by_digit quotient", quotient, a / dd);
+            expect_true("divide_by_digit remainder", mpz_class(std::to_string(remainder)) == abs(a) % dd);
+            expect_true("mod_digit", mpz_class(std::to_string(integer::mod_digit(x, d))) == abs(a) % dd);
+            expect("divide_exact_by_digit", integer::divide_exact_by_digit(x * integer::create(dd.get_str(16), true), d), a);
+        }
+        // Bits, in two's complement for negative values.
+        expect("x & y", x & y, a & b);
+        expect("x | y", x | y, a | b);
+        expect("x ^ y", x ^ y, a ^ b);
+        expect("~x", ~x, ~a);
+        {
+            const std::size_t shift = mpz_class(abs(b) % (4 * digit_bits + 3)).get_ui();
+            expect("x << k", x << shift, a << shift);
+            expect("x >> k", x >> shift, a >> shift);
+            const int limbs = static_cast<int>(shift % 5);
+            expect("shift_left", integer::shift_left(x, limbs), a << (limbs * digit_bits));
+            mpz_class truncated;
+            mpz_tdiv_q_2exp(truncated.get_mpz_t(), a.get_mpz_t(), limbs * digit_bits);
+            expect("shift_right", integer::shift_right(x, limbs), truncated);
+            for(const std::size_t i : {std::size_t(0), shift, bits / 2, bits, bits + 1})
+            {
+                expect_true("test_bit", integer::test_bit(x, i) == (mpz_tstbit(a.get_mpz_t(), i) != 0));
+            }
+        }
+        expect_true("bit_length", integer::bit_length(x) == (a == 0 ? 0 : mpz_sizeinbase(a.get_mpz_t(), 2)));
+        expect_true("popcount", integer::popcount(x) == mpz_popcount(mpz_class(abs(a)).get_mpz_t()));
+        expect_true("count_trailing_zeros", integer::count_trailing_zeros(x) == (a == 0 ? 0 : mpz_scan1(a.get_mpz_t(), 0)));
+        // Number theory.
+        expect("gcd", integer::gcd(x, y), gcd(a, b));
+        {
+            integer s;
+            integer t;
+            const integer g = integer::extended_gcd(x, y, s, t);
+            expect("extended_gcd", g, gcd(a, b));
+            expect("extended_gcd cofactors", s * x + t * y, gcd(a, b));
+        }
+        expect("isqrt", integer::isqrt(integer::absolute_value(x)), sqrt(abs(a)));
+        expect_true("is_perfect_square", integer::is_perfect_square(integer::absolute_value(x)) == (mpz_perfect_square_p(mpz_class(abs(a)).get_mpz_t()) != 0));
+        expect_true("is_perfect_square x^2", integer::is_perfect_square(x * x));
+        {
+            mpz_class root;
+            mpz_root(root.get_mpz_t(), a.get_mpz_t(), 3);
+            expect("iroot", integer::iroot(x, 3), root);
+        }
+        if(bits <= 8 * digit_bits)
+        {
+            mpz_class power;
+            mpz_pow_ui(power.get_mpz_t(), a.get_mpz_t(), 5);
+            expect("pow", integer::pow(x, 5), power);
+            const bool prime = mpz_probab_prime_p(a.get_mpz_t(), 30) != 0;
+            expect_true("is_probable_prime", integer::is_probable_prime(x) == (a >= 2 and prime));
+        }
+        // Text.
+        for(const int base : {10, 16, 7})
+        {
+            const std::string text = a.get_str(base);
+            expect_true("to_string", integer::to_string(x, base, false) == text);
+            expect("create", integer::create(text, base), a);
+        }
+    }
+}
+
+#endif //INTTITAN_DIFFERENTIAL_H
@@ -0,0 +1,81 @@
+// libFuzzer target that cross-checks the operations of integer against GMP (see differential.h) for the operands in its
+// input, and aborts on the first mismatch. The input is three bytes of header, then the bytes of the limbs of x and y:
+//     flags: bit 0 negates x, bit 1 negates y, bit 2 sets the least thresholds (every tier at a few limbs), bit 3 checks
+//            x with itself
+//     split: the first split / 255 of the limb bytes are x, the others y
+//     tiles: 1 + tiles % 8 copies of the limbs of each operand, so that short inputs reach the tiers as well
+// Built with Clang by the fuzz target (INTTITAN_FUZZ), run as
+//     fuzz [corpus directory] [-max_len=4096]
+// With other compilers the target replays inputs instead, e.g. those libFuzzer saved for its crashes:
+//     fuzz <file>...
+#include "fuzz/differential.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#ifdef INTTITAN_FUZZ_REPLAY
+#include <fstream>
+#include <iterator>
+#endif
+
+using int_titan::digit;
+using int_titan::integer;
+using int_titan::tuning;
+
+namespace
+{
+    const int_titan::thresholds built_in = tuning;
+    const int_titan::thresholds least = int_titan::differential::least_thresholds();
+    integer operand(const std::uint8_t* data, const std::size_t size, const std::size_t tiles, const bool negative)
+    {
+        const std::size_t n = (size + sizeof(digit) - 1) / sizeof(digit);
+        std::vector<digit> limbs(n * tiles);
+        std::copy(data, data + size, reinterpret_cast<std::uint8_t*>(limbs.data()));
+        for(std::size_t i = 1; i < tiles; i++)
+        {
+            std::copy_n(limbs.begin(), n, limbs.begin() + i * n);
+        }
+        return int_titan::differential::from_limbs(limbs.data(), limbs.size(), negative);
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, const std::size_t size)
+{
+    if(size < 3)
+    {
+        return 0;
+    }
+    const std::uint8_t flags = data[0];
+    const std::size_t tiles = 1 + data[2] % 8;
+    const std::size_t length = size - 3;
+    const std::size_t split = length * data[1] / 255;
+    const integer x = operand(data + 3, split, tiles, (flags & 1) != 0);
+    const integer y = (flags & 8) != 0 ? x : operand(data + 3 + split, length - split, tiles, (flags & 2) != 0);
+    tuning = (flags & 4) != 0 ? least : built_in;
+    int_titan::differential::check(x, y, [](const char* name)
+    {
+        std::cerr << "mismatch in " << name << '\n';
+        std::abort();
+    });
+    return 0;
+}
+
+#ifdef INTTITAN_FUZZ_REPLAY
+int main(int argc, char** argv)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        std::ifstream in(argv[i], std::ios::binary);
+        if(!in)
+        {
+            std::cerr << "cannot read " << argv[i] << '\n';
+            return 1;
+        }
+        const std::vector<char> bytes{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(bytes.data()), bytes.size());
+    }
+    return 0;
+}
+#endif
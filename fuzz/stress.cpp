@@ -0,0 +1,139 @@
+// Cross-checks the operations of integer against GMP (see differential.h) on operands of the sizes around each
+// threshold of int_titan::tuning and on random ones, in the four combinations of signs and with an operand as both
+// arguments. Everything runs twice, with a parallel executor: with the built-in thresholds, and with the least ones,
+// where every tier of the algorithms takes over at a few limbs. The operands are of bit patterns that stress the
+// carries: random limbs, all ones, single bits, and long runs of ones and zeroes.
+//     stress [rounds] [seed]
+// Each mismatch is printed with the seed and the round that give it back; the exit status is 1 if there is any.
+#include "fuzz/differential.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using int_titan::digit;
+using int_titan::integer;
+using int_titan::tuning;
+
+namespace
+{
+    std::uint64_t mismatches = 0;
+    integer random_integer(std::mt19937_64& rng, const std::size_t n)
+    {
+        std::vector<digit> limbs(n);
+        switch(rng() % 4)
+        {
+        case 0:
+            for(digit& d : limbs)
+            {
+                d = static_cast<digit>(rng());
+            }
+            break;
+        case 1:
+            std::fill(limbs.begin(), limbs.end(), int_titan::integer::max_digit);
+            break;
+        case 2:
+            for(std::size_t i = 0; i < 1 + n / 64 and n != 0; i++)
+            {
+                limbs[rng() % n] |= digit(1) << (rng() % int_titan::digit_bits);
+            }
+            break;
+        default:
+            // Runs of ones and zeroes, as mpz_rrandomb makes them.
+            for(std::size_t bit = 0; bit < n * int_titan::digit_bits;)
+            {
+                const std::size_t run = 1 + rng() % (2 * int_titan::digit_bits);
+                const bool ones = rng() % 2 != 0;
+                for(std::size_t i = bit; i < std::min(bit + run, n * int_titan::digit_bits); i++)
+                {
+                    limbs[i / int_titan::digit_bits] |= ones ? digit(1) << (i % int_titan::digit_bits) : 0;
+                }
+                bit += run;
+            }
+            break;
+        }
+        if(n != 0 and limbs.back() == 0)
+        {
+            limbs.back() = 1;
+        }
+        return int_titan::differential::from_limbs(limbs.data(), n, false);
+    }
+    // Check x and y of the given sizes, in every combination of signs.
+    void check(const char* pass, const std::uint64_t seed, const std::uint64_t round, const std::size_t xn, const std::size_t yn)
+    {
+        std::mt19937_64 rng(seed * 1000003 + round);
+        const integer x = random_integer(rng, xn);
+        const integer y = random_integer(rng, yn);
+        for(const integer& a : {x, -x})
+        {
+            for(const integer& b : {y, -y})
+            {
+                const auto fail = [&](const char* name)
+                {
+                    mismatches++;
+                    std::cout << "mismatch in " << name << " (" << pass << " thresholds, seed " << seed << ", round " << round << "): " << (a < integer::zero ? "-" : "") << xn << " limbs by " << (b < integer::zero ? "-" : "") << yn << " limbs";
+                    if(xn + yn <= 16)
+                    {
+                        std::cout << ", x = " << integer::to_string(a) << ", y = " << integer::to_string(b);
+                    }
+                    std::cout << '\n';
+                };
+                int_titan::differential::check(a, b, fail);
+            }
+        }
+        int_titan::differential::check(x, x, [&](const char* name)
+        {
+            mismatches++;
+            std::cout << "mismatch in " << name << " (" << pass << " thresholds, seed " << seed << ", round " << round << "): x = y of " << xn << " limbs\n";
+        });
+    }
+    // Operands of up to largest limbs, except around the thresholds.
+    void run(const char* pass, const std::uint64_t seed, const std::uint64_t rounds, const std::size_t largest)
+    {
+        std::uint64_t round = 0;
+        // Around each threshold, for operands of the same size, of half of it, and for dividends of twice it.
+        for(const int_titan::threshold_name& threshold : int_titan::threshold_names)
+        {
+            const std::size_t t = tuning.*threshold.member;
+            if(t > 4096)
+            {
+                continue;
+            }
+            for(const std::size_t n : {t - 1, t, t + 1})
+            {
+                check(pass, seed, round++, n, n);
+                check(pass, seed, round++, n, n / 2 + 1);
+                check(pass, seed, round++, 2 * n, n);
+                check(pass, seed, round++, 2 * n + 1, n);
+            }
+        }
+        // Random sizes, from a distribution uniform in their logarithm.
+        std::mt19937_64 rng(seed);
+        for(std::uint64_t i = 0; i < rounds; i++)
+        {
+            const auto size = [&rng, largest]
+            {
+                return static_cast<std::size_t>(rng() % ((largest >> (rng() % 13)) + 1));
+            };
+            check(pass, seed, round++, size(), size());
+        }
+        std::cout << pass << " thresholds: " << round << " rounds, " << mismatches << " mismatches\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::uint64_t rounds = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200;
+    const std::uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    // Two threads, so that the parallel products run too.
+    int_titan::thread_pool pool(2);
+    int_titan::parallel_executor = &pool;
+    run("built-in", seed, rounds, 4096);
+    tuning = int_titan::differential::least_thresholds();
+    run("least", seed, rounds, 512);
+    return mismatches == 0 ? 0 : 1;
+}
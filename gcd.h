@@ -0,0 +1,324 @@
+#ifndef INTTITAN_GCD_H
+#define INTTITAN_GCD_H
+#include "config.h"
+#include "division.h"
+#include "kernels.h"
+#include "multiplication.h"
+#include "scratch.h"
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+// Greatest common divisors of raw limb spans: the binary algorithm of Stein once the operands fit in two digits, and
+// Lehmer's algorithm above (The Art of Computer Programming, vol. 2, 4.5.2), which runs Euclid on the top two digits of
+// the operands and applies the quotients it is sure of to the whole operands at once, as a matrix of one-digit
+// cofactors. The half-GCD of the largest operands, which needs the integer arithmetic, is in integer.h.
+namespace int_titan
+{
+    namespace kernels
+    {
+        // The signed type of twice the digit size, for the cofactors of Lehmer's algorithm.
+#if INTTITAN_DIGIT_BITS == 64
+        using signed_superdigit = __int128;
+#else
+        using signed_superdigit = std::int64_t;
+#endif
+        // Number of trailing zero bits of a non-zero superdigit.
+        inline int trailing_zeros(const superdigit x)
+        {
+            const digit low = static_cast<digit>(x);
+            return low != 0 ? trailing_zeros(low) : digit_bits + trailing_zeros(static_cast<digit>(x >> digit_bits));
+        }
+        // gcd(x, y) by the binary algorithm: the common powers of two are set aside, and the smaller odd value is taken
+        // from the larger one until they meet, every difference stripped of its trailing zeroes at once.
+        template<typename T>
+        T binary_gcd(T x, T y)
+        {
+            if(x == 0 or y == 0)
+            {
+                return x | y;
+            }
+            const int shift = trailing_zeros(x | y);
+            x >>= trailing_zeros(x);
+            do
+            {
+                y >>= trailing_zeros(y);
+                if(x > y)
+                {
+                    std::swap(x, y);
+                }
+                y -= x;
+            }
+            while(y != 0);
+            return x << shift;
+        }
+        // The quotients of a step of Lehmer's algorithm as the matrix of their cofactors, by magnitude (each below
+        // 2^(digit_bits - 1)). After an even number of quotients the new pair is (u0 x - v0 y, v1 y - u1 x), after an
+        // odd one the negation of both.
+        struct lehmer_cofactors
+        {
+            digit u0, v0, u1, v1;
+            bool odd;
+        };
+        // Bits [shift, shift + 2 * digit_bits) of the n limbs x.
+        inline superdigit top_bits(const digit* x, const std::size_t n, const std::size_t shift)
+        {
+            const std::size_t i = shift / digit_bits;
+            const int s = static_cast<int>(shift % digit_bits);
+            const auto limb = [&](const std::size_t j) -> superdigit
+            {
+                return j < n ? x[j] : 0;
+            };
+            const superdigit low = limb(i) | (limb(i + 1) << digit_bits);
+            return s == 0 ? low : (low >> s) | (limb(i + 2) << (2 * digit_bits - s));
+        }
+        // The cofactors of the quotients of x and y (x >= y, n limbs each, x[n - 1] non-zero) that their top
+        // 2 * digit_bits - 2 bits determine, few enough for the sums of the bounds to fit in a signed superdigit. A
+        // quotient is taken only when the bounds of Algorithm L, from the top bits with the cofactors added, agree on it;
+        // the pair it leads to is then that of Euclid on the whole operands. Returns false when not even the first
+        // quotient is known, for a division step instead.
+        inline bool lehmer_matrix(lehmer_cofactors& m, const digit* x, const digit* y, const std::size_t n)
+        {
+            const std::size_t bits = n * digit_bits - leading_zeros(x[n - 1]);
+            const std::size_t shift = bits > 2 * digit_bits - 2 ? bits - (2 * digit_bits - 2) : 0;
+            using cofactor = signed_superdigit;
+            constexpr cofactor limit = cofactor(1) << (digit_bits - 1);
+            cofactor u = static_cast<cofactor>(top_bits(x, n, shift));
+            cofactor v = static_cast<cofactor>(top_bits(y, n, shift));
+            cofactor a = 1, b = 0, c = 0, d = 1;
+            bool odd = false;
+            const auto magnitude = [](const cofactor z)
+            {
+                return z < 0 ? -z : z;
+            };
+            while(v + c > 0 and v + d > 0 and u + a >= 0 and u + b >= 0)
+            {
+                const cofactor q = (u + a) / (v + c);
+                if(q != (u + b) / (v + d))
+                {
+                    break;
+                }
+                // The new cofactors a - q c and b - q d are the sums of the magnitudes, as the signs alternate.
+                if((c != 0 and q > (limit - 1 - magnitude(a)) / magnitude(c)) or q > (limit - 1 - magnitude(b)) / magnitude(d))
+                {
+                    break;
+                }
+                const cofactor t = a - q * c;
+                a = c;
+                c = t;
+                const cofactor w = b - q * d;
+                b = d;
+                d = w;
+                const cofactor r = u - q * v;
+                u = v;
+                v = r;
+                odd = !odd;
+            }
+            if(b == 0)
+            {
+                return false;
+            }
+            m = {static_cast<digit>(magnitude(a)), static_cast<digit>(magnitude(b)), static_cast<digit>(magnitude(c)), static_cast<digit>(magnitude(d)), odd};
+            return true;
+        }
+        // r = u x - v y over n limbs, which must not be negative. r must not overlap x or y.
+        inline void lehmer_combine(digit* r, const digit* x, const digit* y, const std::size_t n, const digit u, const digit v)
+        {
+            const digit carry = multiply_by_digit(r, x, n, u);
+            const digit borrow = submul_1(r, y, n, v);
+            assert(carry == borrow);
+            static_cast<void>(carry);
+            static_cast<void>(borrow);
+        }
+        // The pair of the cofactors m applied to (x, y): x' into r and y' into s, n limbs each, neither overlapping x or y.
+        inline void lehmer_apply(digit* r, digit* s, const digit* x, const digit* y, const std::size_t n, const lehmer_cofactors& m)
+        {
+            if(m.odd)
+            {
+                lehmer_combine(r, y, x, n, m.v0, m.u0);
+                lehmer_combine(s, x, y, n, m.u1, m.v1);
+            }
+            else
+            {
+                lehmer_combine(r, x, y, n, m.u0, m.v0);
+                lehmer_combine(s, y, x, n, m.v1, m.u1);
+            }
+        }
+        // The cofactors of a run of Euclid steps (x, y) -> (x', y'), by magnitude: after an even number of steps
+        // x' = m[0] x - m[1] y and y' = m[3] y - m[2] x, after an odd one the negation of both. The signs of a column
+        // alternate with every step, so composing steps only ever adds magnitudes. Each entry has room for the limbs of
+        // the x the steps start from plus two, as have the two spare buffers.
+        struct euclid_matrix
+        {
+            digit* m[4];
+            digit* spare[2];
+            // Limbs in use, the same for the four entries.
+            std::size_t n;
+            bool odd;
+            // The identity, in buffers of the given room each cut out of memory (6 * room limbs).
+            void reset(digit* memory, const std::size_t room)
+            {
+                for(int i = 0; i < 4; i++)
+                {
+                    m[i] = memory + i * room;
+                    m[i][0] = i == 0 or i == 3 ? 1 : 0;
+                }
+                spare[0] = memory + 4 * room;
+                spare[1] = memory + 5 * room;
+                n = 1;
+                odd = false;
+            }
+            // The column (m[j], m[2 + j]) becomes (m[j] u0 + m[2 + j] v0, m[j] u1 + m[2 + j] v1): a Lehmer step.
+            void apply(const lehmer_cofactors& c)
+            {
+                digit top[4];
+                for(int j = 0; j < 2; j++)
+                {
+                    top[j] = multiply_by_digit(spare[0], m[j], n, c.u0);
+                    top[j] += addmul_1(spare[0], m[2 + j], n, c.v0);
+                    top[2 + j] = multiply_by_digit(spare[1], m[j], n, c.u1);
+                    top[2 + j] += addmul_1(spare[1], m[2 + j], n, c.v1);
+                    std::swap(m[j], spare[0]);
+                    std::swap(m[2 + j], spare[1]);
+                }
+                grow(top);
+                odd = odd != c.odd;
+            }
+            // The column (m[j], m[2 + j]) becomes (m[2 + j], m[j] + q m[2 + j]): a division step by the quotient q of qn
+            // limbs.
+            void divide(const digit* q, const std::size_t qn)
+            {
+                const std::size_t rn = n + qn + 1;
+                for(int j = 0; j < 2; j++)
+                {
+                    digit* r = spare[0];
+                    if(n >= qn)
+                    {
+                        multiply(r, m[2 + j], n, q, qn);
+                    }
+                    else
+                    {
+                        multiply(r, q, qn, m[2 + j], n);
+                    }
+                    r[rn - 1] = add(r, r, rn - 1, m[j], n);
+                    spare[0] = m[j];
+                    m[j] = m[2 + j];
+                    m[2 + j] = r;
+                    std::fill(m[j] + n, m[j] + rn, digit(0));
+                }
+                n = rn;
+                while(n > 1 and (m[0][n - 1] | m[1][n - 1] | m[2][n - 1] | m[3][n - 1]) == 0)
+                {
+                    n--;
+                }
+                odd = !odd;
+            }
+        private:
+            void grow(const digit* top)
+            {
+                for(int i = 0; i < 4; i++)
+                {
+                    m[i][n] = top[i];
+                }
+                if((top[0] | top[1] | top[2] | top[3]) != 0)
+                {
+                    n++;
+                }
+            }
+        };
+        // A pair x >= y for Euclid, in buffers that swap roles with every step: the pair, the next one and a quotient,
+        // each of room for the xn limbs of x to start with.
+        struct euclid_pair
+        {
+            digit* x;
+            digit* y;
+            digit* next_x;
+            digit* next_y;
+            digit* q;
+            std::size_t xn;
+            std::size_t yn;
+            // Limbs of memory for a pair that starts with xn limbs.
+            static constexpr std::size_t memory_size(const std::size_t xn)
+            {
+                return 5 * xn;
+            }
+            euclid_pair(digit* memory, const digit* a, const std::size_t an, const digit* b, const std::size_t bn)
+                : x(memory), y(x + an), next_x(y + an), next_y(next_x + an), q(next_y + an), xn(an), yn(bn)
+            {
+                std::copy(a, a + an, x);
+                std::copy(b, b + bn, y);
+            }
+            std::size_t y_bits() const
+            {
+                return yn == 0 ? 0 : yn * digit_bits - leading_zeros(y[yn - 1]);
+            }
+        };
+        // Steps of Euclid on the pair, their cofactors into m unless it is nullptr, until y has at most the given
+        // number of bits: Lehmer steps while the operands are as long, a division step when y is shorter or no quotient
+        // is certain. The last Lehmer step may take y somewhat further.
+        inline void euclid_reduce(euclid_pair& p, const std::size_t bits, euclid_matrix* m)
+        {
+            while(p.y_bits() > bits)
+            {
+                lehmer_cofactors c;
+                if(p.xn == p.yn and lehmer_matrix(c, p.x, p.y, p.xn))
+                {
+                    lehmer_apply(p.next_x, p.next_y, p.x, p.y, p.xn, c);
+                    std::swap(p.x, p.next_x);
+                    std::swap(p.y, p.next_y);
+                    p.yn = normalized_size(p.y, p.xn);
+                    p.xn = normalized_size(p.x, p.xn);
+                    if(m != nullptr)
+                    {
+                        m->apply(c);
+                    }
+                    continue;
+                }
+                // (x, y) = (y, x mod y).
+                divide(p.q, p.next_y, p.x, p.xn, p.y, p.yn);
+                if(m != nullptr)
+                {
+                    m->divide(p.q, normalized_size(p.q, p.xn - p.yn + 1));
+                }
+                std::swap(p.x, p.y);
+                std::swap(p.y, p.next_y);
+                p.xn = p.yn;
+                p.yn = normalized_size(p.y, p.yn);
+            }
+        }
+        // g = gcd(x, y) for x of xn limbs and y of yn, without leading zeroes. Writes up to max(xn, yn, 2) limbs into g
+        // and returns their number. Euclid by Lehmer steps down to two digits, then the binary algorithm.
+        inline std::size_t gcd(digit* g, const digit* x, std::size_t xn, const digit* y, std::size_t yn)
+        {
+            if(compare(x, xn, y, yn) < 0)
+            {
+                std::swap(x, y);
+                std::swap(xn, yn);
+            }
+            const scratch_buffer<> memory(euclid_pair::memory_size(xn));
+            euclid_pair p(memory.get(), x, xn, y, yn);
+            euclid_reduce(p, 2 * digit_bits, nullptr);
+            if(p.yn == 0)
+            {
+                std::copy(p.x, p.x + p.xn, g);
+                return p.xn;
+            }
+            if(p.xn > 2)
+            {
+                divide(p.q, p.next_y, p.x, p.xn, p.y, p.yn);
+                std::swap(p.x, p.next_y);
+                p.xn = normalized_size(p.x, p.yn);
+            }
+            const auto value = [](const digit* z, const std::size_t n)
+            {
+                return n == 0 ? superdigit(0) : n == 1 ? superdigit(z[0]) : z[0] | (superdigit(z[1]) << digit_bits);
+            };
+            const superdigit d = binary_gcd(value(p.x, p.xn), value(p.y, p.yn));
+            g[0] = static_cast<digit>(d);
+            g[1] = static_cast<digit>(d >> digit_bits);
+            return normalized_size(g, 2);
+        }
+    }
+}
+
+#endif //INTTITAN_GCD_H
@@ -0,0 +1,322 @@
+#ifndef INTTITAN_HEX_H
+#define INTTITAN_HEX_H
+#include "config.h"
+#include "cpu.h"
+#include <cstddef>
+#include <cstdint>
+// The x86 vector code is compiled if it can be picked at runtime, or if the compiler targets its extension anyway.
+#if INTTITAN_SIMD and defined(__x86_64__) and (INTTITAN_DISPATCH or defined(__SSSE3__))
+#define INTTITAN_HEX_SSSE3 1
+#else
+#define INTTITAN_HEX_SSSE3 0
+#endif
+#if INTTITAN_SIMD and defined(__x86_64__) and (INTTITAN_DISPATCH or defined(__AVX2__))
+#define INTTITAN_HEX_AVX2 1
+#else
+#define INTTITAN_HEX_AVX2 0
+#endif
+#if INTTITAN_SIMD and defined(__ARM_NEON) and defined(__aarch64__)
+#define INTTITAN_HEX_NEON 1
+#else
+#define INTTITAN_HEX_NEON 0
+#endif
+#if INTTITAN_HEX_SSSE3
+#include <immintrin.h>
+#elif INTTITAN_HEX_NEON
+#include <arm_neon.h>
+#endif
+
+// Hexadecimal encoding and decoding of raw limb spans, digit_bits / 4 characters per limb with the most significant
+// first. The vector versions handle 16 bytes of limbs (SSSE3, NEON) or 32 (AVX2) per step, the scalar code does the rest.
+// Reversing the bytes of little-endian limbs puts them in big-endian order whatever the size of a limb, so the vector
+// code is the same for 32-bit and 64-bit limbs. to_hex() and from_hex() go to the versions for the processor, see cpu().
+namespace int_titan
+{
+    namespace kernels
+    {
+        // Characters per limb.
+        constexpr std::size_t hex_limb_characters = digit_bits / 4;
+        // Limbs in 16 bytes, a step of the vector code.
+        constexpr std::size_t hex_vector_limbs = 16 / sizeof(digit);
+        // Character for each value of a hex digit.
+        inline const char* hex_characters(const bool uppercase)
+        {
+            return uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+        }
+        // Value of every character as a hex digit, or -1.
+        struct hex_value_table
+        {
+            std::int8_t values[256];
+            constexpr hex_value_table() : values()
+            {
+                for(int c = 0; c < 256; c++)
+                {
+                    const int lower = c | 0x20;
+                    values[c] = static_cast<std::int8_t>(c >= '0' and c <= '9' ? c - '0' : lower >= 'a' and lower <= 'f' ? lower - 'a' + 10 : -1);
+                }
+            }
+        };
+        inline constexpr hex_value_table hex_values{};
+        // The limb of the first count (up to hex_limb_characters) hex characters at s, returns false for an invalid character.
+        inline bool hex_decode_digit(digit& d, const char* s, const std::size_t count)
+        {
+            int invalid = 0;
+            d = 0;
+            for(std::size_t i = 0; i < count; i++)
+            {
+                const int value = hex_values.values[static_cast<unsigned char>(s[i])];
+                invalid |= value;
+                d = (d << 4) | static_cast<digit>(value & 0xF);
+            }
+            return invalid >= 0;
+        }
+        // Writes the hex_limb_characters characters of d.
+        inline void hex_encode_digit(char* s, digit d, const char* characters)
+        {
+            for(std::size_t i = hex_limb_characters; i-- != 0; d >>= 4)
+            {
+                s[i] = characters[d & 0xF];
+            }
+        }
+#if INTTITAN_HEX_SSSE3
+        // Writes the 32 characters of the 16 bytes of limbs at x (the top one first).
+        INTTITAN_TARGET("ssse3") inline void hex_encode_16(char* s, const digit* x, const __m128i table)
+        {
+            const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+            const __m128i bytes = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x)), reverse);
+            const __m128i mask = _mm_set1_epi8(0xF);
+            const __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+            const __m128i low = _mm_and_si128(bytes, mask);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(s), _mm_shuffle_epi8(table, _mm_unpacklo_epi8(high, low)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(s + 16), _mm_shuffle_epi8(table, _mm_unpackhi_epi8(high, low)));
+        }
+        // Values of the 16 hex characters at s, with the bits of the invalid ones in the returned mask.
+        INTTITAN_TARGET("ssse3") inline int hex_decode_values(__m128i& values, const char* s)
+        {
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+            const __m128i decimal = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+            const __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+            const __m128i is_decimal = _mm_cmpeq_epi8(_mm_min_epu8(decimal, _mm_set1_epi8(9)), decimal);
+            const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+            values = _mm_or_si128(_mm_and_si128(is_decimal, decimal), _mm_andnot_si128(is_decimal, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+            return ~_mm_movemask_epi8(_mm_or_si128(is_decimal, is_letter)) & 0xFFFF;
+        }
+        // The 8 bytes of limbs of the 16 hex characters at s, returns false for an invalid character.
+        INTTITAN_TARGET("ssse3") inline bool hex_decode_8(digit* r, const char* s)
+        {
+            __m128i values;
+            if(hex_decode_values(values, s) != 0)
+            {
+                return false;
+            }
+            // Pairs of characters into bytes, then the bytes into little-endian order.
+            const __m128i bytes = _mm_maddubs_epi16(values, _mm_set1_epi16(0x0110));
+            const __m128i reverse = _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0, 2, 4, 6, 8, 10, 12, 14);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(r), _mm_shuffle_epi8(bytes, reverse));
+            return true;
+        }
+#endif
+#if INTTITAN_HEX_NEON
+        // Writes the 32 characters of the 16 bytes of limbs at x (the top one first).
+        inline void hex_encode_16(char* s, const digit* x, const uint8x16_t table)
+        {
+            const uint8x16_t v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(x));
+            const uint8x16_t half_reversed = vrev64q_u8(v);
+            const uint8x16_t bytes = vextq_u8(half_reversed, half_reversed, 8);
+            const uint8x16_t high = vshrq_n_u8(bytes, 4);
+            const uint8x16_t low = vandq_u8(bytes, vdupq_n_u8(0xF));
+            vst1q_u8(reinterpret_cast<std::uint8_t*>(s), vqtbl1q_u8(table, vzip1q_u8(high, low)));
+            vst1q_u8(reinterpret_cast<std::uint8_t*>(s + 16), vqtbl1q_u8(table, vzip2q_u8(high, low)));
+        }
+        // The 8 bytes of limbs of the 16 hex characters at s, returns false for an invalid character.
+        inline bool hex_decode_8(digit* r, const char* s)
+        {
+            const uint8x16_t c = vld1q_u8(reinterpret_cast<const std::uint8_t*>(s));
+            const uint8x16_t decimal = vsubq_u8(c, vdupq_n_u8('0'));
+            const uint8x16_t letter = vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+            const uint8x16_t is_decimal = vcleq_u8(decimal, vdupq_n_u8(9));
+            const uint8x16_t is_letter = vcleq_u8(letter, vdupq_n_u8(5));
+            if(vminvq_u8(vorrq_u8(is_decimal, is_letter)) == 0)
+            {
+                return false;
+            }
+            const uint8x16_t values = vbslq_u8(is_decimal, decimal, vaddq_u8(letter, vdupq_n_u8(10)));
+            // Pairs of characters into bytes (the even ones are the high halves), then the bytes into little-endian order.
+            const uint8x8_t bytes = vorr_u8(vshl_n_u8(vmovn_u16(vreinterpretq_u16_u8(values)), 4), vshrn_n_u16(vreinterpretq_u16_u8(values), 8));
+            vst1_u8(reinterpret_cast<std::uint8_t*>(r), vrev64_u8(bytes));
+            return true;
+        }
+#endif
+        // Writes the hex_limb_characters * n characters of x (n limbs), leading zeroes included, a limb at a time.
+        inline void to_hex_portable(char* s, const digit* x, std::size_t n, const bool uppercase)
+        {
+            const char* characters = hex_characters(uppercase);
+            for(; n != 0; n--, s += hex_limb_characters)
+            {
+                hex_encode_digit(s, x[n - 1], characters);
+            }
+        }
+        // r = the value of the count hex characters at s, a limb at a time. Writes count / hex_limb_characters limbs
+        // (rounded up) and returns false if there is an invalid character.
+        inline bool from_hex_portable(digit* r, const char* s, const std::size_t count)
+        {
+            std::size_t n = (count + hex_limb_characters - 1) / hex_limb_characters;
+            if(n != 0)
+            {
+                // The top limb takes the characters left over by the others.
+                const std::size_t first = count - hex_limb_characters * (n - 1);
+                if(!hex_decode_digit(r[--n], s, first))
+                {
+                    return false;
+                }
+                s += first;
+            }
+            for(; n != 0; n--, s += hex_limb_characters)
+            {
+                if(!hex_decode_digit(r[n - 1], s, hex_limb_characters))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+#if INTTITAN_HEX_SSSE3
+        // to_hex() 16 bytes of limbs at a time.
+        INTTITAN_TARGET("ssse3") inline void to_hex_ssse3(char* s, const digit* x, std::size_t n, const bool uppercase)
+        {
+            const __m128i table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex_characters(uppercase)));
+            for(; n >= hex_vector_limbs; n -= hex_vector_limbs, s += 32)
+            {
+                hex_encode_16(s, x + n - hex_vector_limbs, table);
+            }
+            to_hex_portable(s, x, n, uppercase);
+        }
+        // from_hex() 16 characters at a time.
+        INTTITAN_TARGET("ssse3") inline bool from_hex_ssse3(digit* r, const char* s, const std::size_t count)
+        {
+            std::size_t n = count / hex_limb_characters;
+            const std::size_t first = count - hex_limb_characters * n;
+            if(first != 0)
+            {
+                if(!hex_decode_digit(r[n], s, first))
+                {
+                    return false;
+                }
+                s += first;
+            }
+            for(const std::size_t step = hex_vector_limbs / 2; n >= step; n -= step, s += 16)
+            {
+                if(!hex_decode_8(r + n - step, s))
+                {
+                    return false;
+                }
+            }
+            return from_hex_portable(r, s, hex_limb_characters * n);
+        }
+#endif
+#if INTTITAN_HEX_AVX2
+        // to_hex() 32 bytes of limbs at a time.
+        INTTITAN_TARGET("avx2") inline void to_hex_avx2(char* s, const digit* x, std::size_t n, const bool uppercase)
+        {
+            const __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex_characters(uppercase))));
+            const __m256i reverse = _mm256_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+            const __m256i mask = _mm256_set1_epi8(0xF);
+            for(; n >= 2 * hex_vector_limbs; n -= 2 * hex_vector_limbs, s += 64)
+            {
+                // Swap the halves, then reverse the bytes in each.
+                const __m256i v = _mm256_permute4x64_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + n - 2 * hex_vector_limbs)), 0x4E);
+                const __m256i bytes = _mm256_shuffle_epi8(v, reverse);
+                const __m256i high = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask);
+                const __m256i low = _mm256_and_si256(bytes, mask);
+                const __m256i first = _mm256_shuffle_epi8(table, _mm256_unpacklo_epi8(high, low));
+                const __m256i second = _mm256_shuffle_epi8(table, _mm256_unpackhi_epi8(high, low));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(s), _mm256_permute2x128_si256(first, second, 0x20));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(s + 32), _mm256_permute2x128_si256(first, second, 0x31));
+            }
+            to_hex_ssse3(s, x, n, uppercase);
+        }
+#endif
+#if INTTITAN_HEX_NEON
+        // to_hex() 16 bytes of limbs at a time.
+        inline void to_hex_neon(char* s, const digit* x, std::size_t n, const bool uppercase)
+        {
+            const uint8x16_t table = vld1q_u8(reinterpret_cast<const std::uint8_t*>(hex_characters(uppercase)));
+            for(; n >= hex_vector_limbs; n -= hex_vector_limbs, s += 32)
+            {
+                hex_encode_16(s, x + n - hex_vector_limbs, table);
+            }
+            to_hex_portable(s, x, n, uppercase);
+        }
+        // from_hex() 16 characters at a time.
+        inline bool from_hex_neon(digit* r, const char* s, const std::size_t count)
+        {
+            std::size_t n = count / hex_limb_characters;
+            const std::size_t first = count - hex_limb_characters * n;
+            if(first != 0)
+            {
+                if(!hex_decode_digit(r[n], s, first))
+                {
+                    return false;
+                }
+                s += first;
+            }
+            for(const std::size_t step = hex_vector_limbs / 2; n >= step; n -= step, s += 16)
+            {
+                if(!hex_decode_8(r + n - step, s))
+                {
+                    return false;
+                }
+            }
+            return from_hex_portable(r, s, hex_limb_characters * n);
+        }
+#endif
+        // The hex codecs bound to the best versions for the processor (see cpu()) the first time they are needed.
+        struct hex_kernels
+        {
+            void (*to_hex)(char*, const digit*, std::size_t, bool);
+            bool (*from_hex)(digit*, const char*, std::size_t);
+        };
+        inline hex_kernels select_hex_kernels(const cpu_features& features)
+        {
+            hex_kernels selected{to_hex_portable, from_hex_portable};
+#if INTTITAN_HEX_SSSE3
+            if(features.ssse3)
+            {
+                selected = {to_hex_ssse3, from_hex_ssse3};
+            }
+#endif
+#if INTTITAN_HEX_AVX2
+            if(features.avx2)
+            {
+                selected.to_hex = to_hex_avx2;
+            }
+#endif
+#if INTTITAN_HEX_NEON
+            if(features.neon)
+            {
+                selected = {to_hex_neon, from_hex_neon};
+            }
+#endif
+            (void)features;
+            return selected;
+        }
+        inline const hex_kernels& hex_codecs()
+        {
+            static const hex_kernels selected = select_hex_kernels(cpu());
+            return selected;
+        }
+        // Writes the hex_limb_characters * n characters of x (n limbs), leading zeroes included.
+        inline void to_hex(char* s, const digit* x, const std::size_t n, const bool uppercase)
+        {
+            hex_codecs().to_hex(s, x, n, uppercase);
+        }
+        // r = the value of the count hex characters at s. Writes count / hex_limb_characters limbs (rounded up) and returns
+        // false if there is an invalid character.
+        inline bool from_hex(digit* r, const char* s, const std::size_t count)
+        {
+            return hex_codecs().from_hex(r, s, count);
+        }
+    }
+}
+
+#endif //INTTITAN_HEX_H
@@ -0,0 +1,195 @@
+#ifndef INTTITAN_IFMA_H
+#define INTTITAN_IFMA_H
+#include "config.h"
+#include "cpu.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+// The IFMA code is compiled if it can be picked at runtime, or if the compiler targets the extension anyway.
+#if INTTITAN_SIMD and defined(__x86_64__) and INTTITAN_DIGIT_BITS == 64 and (INTTITAN_DISPATCH or defined(__AVX512IFMA__))
+#define INTTITAN_IFMA 1
+#include <immintrin.h>
+#else
+#define INTTITAN_IFMA 0
+#endif
+
+// Montgomery multiplication in radix 2^52 with the AVX-512 IFMA instructions, which multiply eight pairs of 52-bit
+// digits at a time and add the low (VPMADD52LUQ) or the high (VPMADD52HUQ) 52 bits of the products to 64-bit
+// accumulators. The accumulators take thousands of such sums before they overflow, so the carries wait for the end of
+// the multiplication. A modulus of n limbs takes radix_52_digits(n) digits, each in a 64-bit word, and the values are
+// kept in radix 2^52 all through an exponentiation, converted from and to limbs only at its ends.
+//
+// The multiplication is the almost Montgomery one (S. Gueron, Efficient software implementations of modular
+// exponentiation, 2012): with R = 2^(52k) above 4m, the product of two values below 2m is below 2m again, so it never
+// subtracts m, and the time does not depend on the values. Only the conversion back to limbs reduces below m.
+namespace int_titan
+{
+    namespace kernels
+    {
+        constexpr int radix_52_bits = 52;
+        constexpr std::uint64_t radix_52_mask = (std::uint64_t(1) << radix_52_bits) - 1;
+        // Digits of 52 bits for the values modulo m of n limbs: R = 2^(52k) above 4m, whatever the top limb of m.
+        constexpr std::size_t radix_52_digits(const std::size_t n)
+        {
+            return (n * digit_bits + 2 + radix_52_bits - 1) / radix_52_bits;
+        }
+        // Digits the kernels read and write for k of them, a whole number of vectors of eight (zeroes above the k).
+        constexpr std::size_t radix_52_padded(const std::size_t k)
+        {
+            return (k + 7) / 8 * 8;
+        }
+        // The k digits of 52 bits of x (n limbs), zeroes above the top one.
+        inline void to_radix_52(std::uint64_t* r, const std::size_t k, const digit* x, const std::size_t n)
+        {
+            for(std::size_t j = 0; j < k; j++)
+            {
+                const std::size_t bit = j * radix_52_bits;
+                const std::size_t limb = bit / digit_bits;
+                const unsigned shift = static_cast<unsigned>(bit % digit_bits);
+                std::uint64_t value = 0;
+                if(limb < n)
+                {
+                    value = static_cast<std::uint64_t>(x[limb]) >> shift;
+                    if(shift + static_cast<unsigned>(radix_52_bits) > static_cast<unsigned>(digit_bits) and limb + 1 < n)
+                    {
+                        value |= static_cast<std::uint64_t>(x[limb + 1]) << (digit_bits - shift);
+                    }
+                }
+                r[j] = value & radix_52_mask;
+            }
+        }
+        // The n limbs of x (k digits of 52 bits), which must be below B^n.
+        inline void from_radix_52(digit* r, const std::size_t n, const std::uint64_t* x, const std::size_t k)
+        {
+            std::fill(r, r + n, digit(0));
+            for(std::size_t j = 0; j < k; j++)
+            {
+                const std::size_t bit = j * radix_52_bits;
+                const std::size_t limb = bit / digit_bits;
+                const unsigned shift = static_cast<unsigned>(bit % digit_bits);
+                if(limb < n)
+                {
+                    r[limb] |= static_cast<digit>(x[j] << shift);
+                    if(shift + static_cast<unsigned>(radix_52_bits) > static_cast<unsigned>(digit_bits) and limb + 1 < n)
+                    {
+                        r[limb + 1] |= static_cast<digit>(x[j] >> (digit_bits - shift));
+                    }
+                }
+            }
+        }
+#if INTTITAN_IFMA
+        // The low and the high 52 bits of the product of two digits, as VPMADD52LUQ and VPMADD52HUQ take them.
+        inline std::uint64_t low_52(const std::uint64_t a, const std::uint64_t b)
+        {
+            return (a * b) & radix_52_mask;
+        }
+        inline std::uint64_t high_52(const std::uint64_t a, const std::uint64_t b)
+        {
+            return static_cast<std::uint64_t>((static_cast<unsigned __int128>(a) * b) >> radix_52_bits);
+        }
+        // r = x * y / 2^(52k) mod m, below 2m for x and y below 2m, with the k digits of every value in vectors of
+        // eight (Vectors of them, zeroes above the k). m_inverse is -m^-1 mod 2^52. Every step adds x[i] * y and the
+        // multiple q * m that clears the low digit, then moves the accumulators down by a digit: the low halves of the
+        // products go in before the move and the high halves, which belong one digit up, after it.
+        // The two low digits are kept in scalars instead of the first lanes, so that q, which every step waits for, does
+        // not wait for the vectors: a step reads the third lane, which the step before it has finished long ago, and the
+        // carry out of the low digit goes into the next one there. r may alias x or y.
+        template<std::size_t Vectors>
+        INTTITAN_TARGET("avx512f,avx512ifma") void montgomery_multiply_ifma(std::uint64_t* r, const std::uint64_t* x, const std::uint64_t* y, const std::uint64_t* m, const std::size_t k, const std::uint64_t m_inverse)
+        {
+            __m512i accumulator[Vectors];
+            __m512i yv[Vectors];
+            __m512i mv[Vectors];
+            _Pragma("GCC unroll 16")
+            for(std::size_t v = 0; v < Vectors; v++)
+            {
+                accumulator[v] = _mm512_setzero_si512();
+                yv[v] = _mm512_loadu_si512(y + 8 * v);
+                mv[v] = _mm512_loadu_si512(m + 8 * v);
+            }
+            const __m512i zero = _mm512_setzero_si512();
+            const std::uint64_t y0 = y[0], y1 = y[1], y2 = y[2];
+            const std::uint64_t m0 = m[0], m1 = m[1], m2 = m[2];
+            // Digits 0 and 1 (the lanes of the vectors there are not read).
+            std::uint64_t low = 0;
+            std::uint64_t next = 0;
+            for(std::size_t i = 0; i < k; i++)
+            {
+                const std::uint64_t xi = x[i];
+                // The zero-masking forms of the lane moves, as the others leave GCC warning of undefined lanes.
+                const __m128i lanes = _mm512_maskz_extracti32x4_epi32(0xF, accumulator[0], 1);
+                const std::uint64_t third = static_cast<std::uint64_t>(_mm_cvtsi128_si64(lanes));
+                const std::uint64_t sum = low + low_52(xi, y0);
+                const std::uint64_t q = (sum * m_inverse) & radix_52_mask;
+                const std::uint64_t carry = (sum + low_52(q, m0)) >> radix_52_bits;
+                low = next + low_52(xi, y1) + low_52(q, m1) + high_52(xi, y0) + high_52(q, m0) + carry;
+                next = third + low_52(xi, y2) + low_52(q, m2) + high_52(xi, y1) + high_52(q, m1);
+                const __m512i xb = _mm512_set1_epi64(static_cast<long long>(xi));
+                const __m512i qb = _mm512_set1_epi64(static_cast<long long>(q));
+                _Pragma("GCC unroll 16")
+                for(std::size_t v = 0; v < Vectors; v++)
+                {
+                    accumulator[v] = _mm512_madd52lo_epu64(accumulator[v], xb, yv[v]);
+                    accumulator[v] = _mm512_madd52lo_epu64(accumulator[v], qb, mv[v]);
+                }
+                _Pragma("GCC unroll 16")
+                for(std::size_t v = 0; v + 1 < Vectors; v++)
+                {
+                    accumulator[v] = _mm512_maskz_alignr_epi64(0xFF, accumulator[v + 1], accumulator[v], 1);
+                }
+                accumulator[Vectors - 1] = _mm512_maskz_alignr_epi64(0x7F, zero, accumulator[Vectors - 1], 1);
+                _Pragma("GCC unroll 16")
+                for(std::size_t v = 0; v < Vectors; v++)
+                {
+                    accumulator[v] = _mm512_madd52hi_epu64(accumulator[v], xb, yv[v]);
+                    accumulator[v] = _mm512_madd52hi_epu64(accumulator[v], qb, mv[v]);
+                }
+            }
+            // The carries, through the digits of 52 bits. The result is below 2m < 2^(52k), so none leaves the top one.
+            alignas(64) std::uint64_t digits[8 * Vectors];
+            _Pragma("GCC unroll 16")
+            for(std::size_t v = 0; v < Vectors; v++)
+            {
+                _mm512_store_si512(digits + 8 * v, accumulator[v]);
+            }
+            digits[0] = low;
+            digits[1] = next;
+            std::uint64_t carry = 0;
+            for(std::size_t j = 0; j < k; j++)
+            {
+                const std::uint64_t sum = digits[j] + carry;
+                r[j] = sum & radix_52_mask;
+                carry = sum >> radix_52_bits;
+            }
+            std::fill(r + k, r + 8 * Vectors, std::uint64_t(0));
+        }
+#endif
+        // The multiplication for k digits, nullptr if there is none for their size or the processor (see cpu()).
+        using radix_52_multiply = void (*)(std::uint64_t*, const std::uint64_t*, const std::uint64_t*, const std::uint64_t*, std::size_t, std::uint64_t);
+        // Most digits montgomery_multiply_ifma() is instantiated for, 4096-bit moduli and a bit more.
+        constexpr std::size_t ifma_max_digits = 96;
+        inline radix_52_multiply select_radix_52_multiply(const cpu_features& features, const std::size_t k)
+        {
+#if INTTITAN_IFMA
+            if(features.avx512ifma)
+            {
+                static constexpr radix_52_multiply kernels[] = {
+                    montgomery_multiply_ifma<1>, montgomery_multiply_ifma<2>, montgomery_multiply_ifma<3>,
+                    montgomery_multiply_ifma<4>, montgomery_multiply_ifma<5>, montgomery_multiply_ifma<6>,
+                    montgomery_multiply_ifma<7>, montgomery_multiply_ifma<8>, montgomery_multiply_ifma<9>,
+                    montgomery_multiply_ifma<10>, montgomery_multiply_ifma<11>, montgomery_multiply_ifma<12>};
+                static_assert(sizeof(kernels) / sizeof(kernels[0]) * 8 == ifma_max_digits);
+                if(k != 0 and k <= ifma_max_digits)
+                {
+                    return kernels[(k - 1) / 8];
+                }
+            }
+#endif
+            (void)features;
+            (void)k;
+            return nullptr;
+        }
+    }
+}
+
+#endif //INTTITAN_IFMA_H
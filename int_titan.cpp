@@ -0,0 +1,15 @@
+// The int_titan library: the explicit instantiations that INTTITAN_EXTERN_TEMPLATES declares in integer.h, compiled
+// here once for all the translation units of a program.
+#include "integer.h"
+#if INTTITAN_FLEX_VECTOR_STORAGE
+// A flex_vector converts from and to the other immer vectors, which its instantiation needs whole.
+#include <immer/vector.hpp>
+#include <immer/vector_transient.hpp>
+#endif
+
+template class int_titan::limb_buffer<int_titan::digit, INTTITAN_INLINE_LIMBS, int_titan::integer::memory_policy>;
+#if INTTITAN_FLEX_VECTOR_STORAGE
+template class int_titan::flex_limbs<int_titan::digit, int_titan::integer::memory_policy>;
+template class immer::flex_vector<int_titan::digit, int_titan::integer::memory_policy>;
+template class immer::flex_vector_transient<int_titan::digit, int_titan::integer::memory_policy>;
+#endif
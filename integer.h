@@ -1,32 +1,148 @@
 #ifndef INTTITAN_INTEGER_H
 #define INTTITAN_INTEGER_H
-#include <immer/vector.hpp>
-#include <immer/vector_transient.hpp>
-#include <immer/flex_vector.hpp>
-#include <immer/flex_vector_transient.hpp>
+#include "barrett.h"
+#include "bytes.h"
+#include "config.h"
+#include "division.h"
+#include "exponentiation.h"
+#include "gcd.h"
+#include "hex.h"
+#include "ifma.h"
+#include "integer_view.h"
+#include "kernels.h"
+#include "limb_buffer.h"
+#include "mapped.h"
+#include "memory.h"
+#include "montgomery.h"
+#include "multiplication.h"
+#include "primes.h"
+#include "radix.h"
+#include "roots.h"
+#include "scratch.h"
+#include "stats.h"
+#include "tuning.h"
+#if INTTITAN_FLEX_VECTOR_STORAGE
+#include "flex_limbs.h"
+#endif
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ostream>
+#if __cplusplus >= 202002L
+#include <span>
+#if __has_include(<format>)
+#include <format>
+#endif
+#endif
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
-#include <sstream>
+#include <vector>
+// Can integer::one be built in a constant expression? Only in contiguous digits with room for one of them inline.
+#if !INTTITAN_FLEX_VECTOR_STORAGE and INTTITAN_INLINE_LIMBS > 0
+#define INTTITAN_CONSTANT_DIGITS 1
+#else
+#define INTTITAN_CONSTANT_DIGITS 0
+#endif
 
 namespace int_titan
 {
+    class montgomery_context;
+#if INTTITAN_IFMA
+    class ifma_montgomery_context;
+#endif
+    class barrett_reducer;
+    class fixed_base_table;
+    class polynomial;
+    template<std::size_t Bits>
+    class fixed_integer;
+    // The built-in integer types (not bool), which mix with integer. __int128 is one of them also where the standard
+    // traits leave it out (the strict ISO modes of GCC and Clang), so its traits are those below.
+    template<typename T>
+    struct machine_integer_traits
+    {
+        static constexpr bool is_integer = std::is_integral<T>::value and !std::is_same<T, bool>::value;
+        static constexpr bool is_signed = std::is_signed<T>::value;
+        // void for the other types.
+        using unsigned_type = typename std::conditional_t<is_integer, std::make_unsigned<T>, std::enable_if<true>>::type;
+    };
+#ifdef __SIZEOF_INT128__
+    template<>
+    struct machine_integer_traits<__int128>
+    {
+        static constexpr bool is_integer = true;
+        static constexpr bool is_signed = true;
+        using unsigned_type = unsigned __int128;
+    };
+    template<>
+    struct machine_integer_traits<unsigned __int128>
+    {
+        static constexpr bool is_integer = true;
+        static constexpr bool is_signed = false;
+        using unsigned_type = unsigned __int128;
+    };
+#endif
+    template<typename T>
+    constexpr bool is_machine_integer = machine_integer_traits<T>::is_integer;
+    template<typename T>
+    using machine_unsigned_t = typename machine_integer_traits<T>::unsigned_type;
     // This class represents the arbitrary-length integer type.
     class integer
     {
     public:
-        using digit = uint32_t;
-        using superdigit = uint64_t;
+        using digit = int_titan::digit;
+        using superdigit = int_titan::superdigit;
         static constexpr digit max_digit = std::numeric_limits<digit>::max();
-        using integer_digits = immer::flex_vector<digit>;
-        // From base 2^32 digits (native representation).
+        // Number of digits an integer holds without allocating, see INTTITAN_INLINE_LIMBS.
+        static constexpr std::size_t inline_digits = INTTITAN_INLINE_LIMBS;
+        // Heap and reference counting of the digits, see INTTITAN_MEMORY_POLICY (with its heap counted under INTTITAN_STATS).
+        using memory_policy = stats_memory_policy<INTTITAN_MEMORY_POLICY>;
+        // Storage of the digits, selected by INTTITAN_FLEX_VECTOR_STORAGE.
+#if INTTITAN_FLEX_VECTOR_STORAGE
+        using integer_digits = flex_limbs<digit, memory_policy>;
+#else
+        using integer_digits = limb_buffer<digit, inline_digits, memory_policy>;
+#endif
+        integer() = default;
+        // From a machine integer, implicitly as between the built-in types: its digits are written in place, inline for
+        // all up to INTTITAN_INLINE_LIMBS digits.
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        integer(const T value)
+        {
+            digit d[machine_digits<T>];
+            const std::size_t n = magnitude_digits(value, d, is_negative);
+            digits = integer_digits(digit_buffer(d, d + n));
+        }
+        // From base 2^digit_bits digits (native representation), without their leading zeroes.
         static integer create(const integer_digits& digits, const bool is_negative)
         {
             integer x;
+#if INTTITAN_FLEX_VECTOR_STORAGE
+            x.digits = digits.take(digits.normalized_size());
+#else
             x.digits = digits;
-            x.is_negative = is_negative;
+            x.digits.resize(kernels::normalized_size(x.digits.data(), x.digits.size()));
+#endif
+            x.is_negative = is_negative and !x.digits.empty();
             return x;
         }
         // From string representation in decimal or hexadecimal.
-        static integer create(std::string_view str, const bool is_hex = true)
+        static integer create(const std::string_view str, const bool is_hex = true)
+        {
+            return create(str, is_hex ? 16 : 10);
+        }
+        // From string representation in a base from 2 to 36 (letters for the digits above 9, in either case).
+        static integer create(std::string_view str, const int base)
         {
             bool is_negative = false;
             if(!str.empty() and (str[0] == '-' or str[0] == '+'))
@@ -34,496 +150,3707 @@ namespace int_titan
                 is_negative = str[0] == '-';
                 str = str.substr(1);
             }
-            // Currently, only hex is supported.
-            assert(is_hex);
-            return create(digits_from_string(str, is_hex), is_negative);
+            integer x = create(digits_from_string(str, base), is_negative);
+            x.is_negative = is_negative and !x.digits.empty();
+            return x;
         }
-        // Zero value.
+        // Zero value (see the definitions at the end of the header).
         static const integer zero;
         // Unit value.
         static const integer one;
         // Convert integer to string.
         static std::string to_string(const integer& x, const bool is_hex = true, const bool uppercase = true)
         {
-            // Currently, only hex is supported.
-            assert(is_hex);
-            return string_from_integer(x, is_hex, uppercase);
+            return to_string(x, is_hex ? 16 : 10, uppercase);
         }
-        // Negate the integer.
-        static integer negate(integer x)
+        // Convert integer to string in a base from 2 to 36.
+        static std::string to_string(const integer& x, const int base, const bool uppercase = true)
         {
-            x.is_negative = !x.is_negative;
-            return x;
+            return string_from_integer(x, base, uppercase);
         }
-        // Absolute value.
-        static integer absolute_value(integer x)
+        // From the text of an integer in a stream (decimal or hexadecimal), read in pieces so that no more than
+        // stream_characters of it are in memory at a time: whitespace, an optional sign, then the digits up to the first
+        // other character, which is left in the stream. Throws if there are no digits.
+        static integer parse_stream(std::istream& in, const bool is_hex = true)
         {
-            x.is_negative = false;
-            return x;
+            return parse_stream(in, is_hex ? 16 : 10);
         }
-        // Add the two integers.
-        static integer add(const integer& x, const integer& y)
+        // In a base from 2 to 36. Powers of two take linear time, other bases divide and conquer over pieces of
+        // digits as they arrive, as create() does over all of them.
+        static integer parse_stream(std::istream& in, const int base)
         {
-            // Cover the cases for negative numbers.
-            // -x + (-y) = -(x + y)
-            if(x.is_negative and y.is_negative)
-            {
-                return negate(add(negate(x), negate(y)));
-            }
-            // -x + y = y - x
-            else if(x.is_negative and !y.is_negative)
+            check_base(base);
+            return integer_from_istream(in, base, false);
+        }
+        // Write the text of an integer (decimal or hexadecimal) to a stream, in pieces of stream_characters, so
+        // that the whole of it is never in memory.
+        static void write_stream(std::ostream& out, const integer& x, const bool is_hex = true, const bool uppercase = true)
+        {
+            write_stream(out, x, is_hex ? 16 : 10, uppercase);
+        }
+        // In a base from 2 to 36. Powers of two take linear time, other bases divide and conquer down to pieces of
+        // digits, each written as soon as it is known.
+        static void write_stream(std::ostream& out, const integer& x, const int base, const bool uppercase = true)
+        {
+            check_base(base);
+            const auto& xv = x.digits.view();
+            const std::size_t n = xv.size();
+            if(n == 0)
             {
-                return subtract(y, negate(x));
+                out.put('0');
+                return;
             }
-            // x + (-y) = x - y
-            else if(!x.is_negative and y.is_negative)
+            if(x.is_negative)
             {
-                return subtract(x, negate(y));
+                out.put('-');
             }
-            auto result = integer_digits().transient();
-            int carry = 0;
-            for(int i = 0; i < std::max(x.digits.size(), y.digits.size()); i++)
+            magnitude_to_stream(out, xv.data(), n, base, uppercase);
+        }
+        // Room to_chars() needs for x in a base from 2 to 36: the exact number of characters for powers of two, at most
+        // two more for other bases.
+        static std::size_t to_chars_length(const integer& x, const int base = 10)
+        {
+            check_base(base);
+            const auto& xv = x.digits.view();
+            const std::size_t n = xv.size();
+            if(n == 0)
             {
-                digit sum = get_digit(x, i) + get_digit(y, i) + carry;
-                carry = sum < get_digit(x, i) ? 1 : 0; // Check for integer overflow.
-                result.push_back(sum);
+                return 1;
             }
-            if(carry == 1) // Add another digit if carry is on.
+            const std::size_t sign = x.is_negative ? 1 : 0;
+            const std::size_t significant = n * digit_bits - kernels::leading_zeros(xv[n - 1]);
+            const int bits = kernels::radix_bits(base);
+            if(bits != 0)
             {
-                result.push_back(1);
+                return sign + (significant + bits - 1) / bits;
             }
-            return create(result.persistent(), false);
+            return sign + static_cast<std::size_t>(static_cast<double>(significant) / std::log2(base)) + 2;
         }
-        // Subtract one integer from the other.
-        static integer subtract(const integer& x, const integer& y)
+        // Write x in the base (lowercase letters) into [first, last) as std::to_chars() does: a minus sign for negative
+        // values and no leading zeroes. Returns the end of the characters, or last and std::errc::value_too_large when
+        // they do not fit. With to_chars_length() characters of room, they are written in place with no allocation.
+        friend std::to_chars_result to_chars(char* first, char* last, const integer& x, const int base = 10)
         {
-            // Cover the case where x is less than y.
-            // x - y = -(y - x)
-            if (is_less_than(x, y))
-            {
-                return negate(subtract(y, x));
-            }
-            // Cover the cases for negative numbers.
-            // -x - (-y) = y - x
-            if (x.is_negative and y.is_negative)
+            return chars_from_integer(first, last, x, base, false);
+        }
+        // Read an integer in the base from [first, last) as std::from_chars() does: an optional minus sign, then the
+        // digits up to the first other character, which the result points to. Without digits value is not changed and
+        // std::errc::invalid_argument is returned.
+        friend std::from_chars_result from_chars(const char* first, const char* last, integer& value, const int base = 10)
+        {
+            check_base(base);
+            const bool is_negative = first != last and *first == '-';
+            const char* begin = is_negative ? first + 1 : first;
+            const char* end = begin;
+            while(end != last and kernels::radix_values.values[static_cast<unsigned char>(*end)] >= 0 and kernels::radix_values.values[static_cast<unsigned char>(*end)] < base)
             {
-                return negate(subtract(negate(y), negate(x)));
+                end++;
             }
-            // -x - y = -(x + y)
-            else if (x.is_negative and !y.is_negative)
+            if(end == begin)
             {
-                return negate(add(negate(x), y));
+                return {first, std::errc::invalid_argument};
             }
-            // x - (-y) = x + y
-            else if (!x.is_negative and y.is_negative)
+            value = create(digits_from_string(std::string_view(begin, static_cast<std::size_t>(end - begin)), base), false);
+            value.is_negative = is_negative and !value.digits.empty();
+            return {end, std::errc()};
+        }
+        // Write x in the base of the stream (std::dec, std::hex or std::oct), with std::uppercase, std::showpos and
+        // std::showbase, straight to the stream. With a width, padded as a string is.
+        friend std::ostream& operator<<(std::ostream& out, const integer& x)
+        {
+            const std::ios_base::fmtflags flags = out.flags();
+            const int base = stream_base(flags);
+            const bool uppercase = (flags & std::ios_base::uppercase) != 0;
+            const auto& xv = x.digits.view();
+            const std::size_t n = xv.size();
+            std::string prefix = x.is_negative and n != 0 ? "-" : (flags & std::ios_base::showpos) != 0 ? "+" : "";
+            if((flags & std::ios_base::showbase) != 0 and base != 10 and n != 0)
             {
-                return add(x, negate(y));
+                prefix += base == 16 ? uppercase ? "0X" : "0x" : "0";
             }
-            auto result = integer_digits().transient();
-            int borrow = 0;
-            for (int i = 0; i < std::max(x.digits.size(), y.digits.size()); i++)
+            if(out.width() != 0)
             {
-                digit diff;
-                if (get_digit(x, i) - borrow >= get_digit(y, i)) // No underflow.
+                const std::string magnitude = n != 0 ? string_from_integer(absolute_value(x), base, uppercase) : "0";
+                const std::size_t width = static_cast<std::size_t>(out.width());
+                std::string text = prefix + magnitude;
+                if((flags & std::ios_base::adjustfield) == std::ios_base::internal and text.size() < width)
                 {
-                    diff = get_digit(x, i) - borrow - get_digit(y, i);
-                    borrow = 0;
+                    // The fill goes after the sign and a 0x or 0X, as for int: the 0 of octal stays with the digits.
+                    const bool octal_zero = base == 8 and (flags & std::ios_base::showbase) != 0 and n != 0;
+                    text.insert(prefix.size() - (octal_zero ? 1 : 0), width - text.size(), out.fill());
+                    out.width(0);
                 }
-                else // Underflow. Borrow set to 1 and inverse digit applied.
-                {
-                    diff = inverse_digit(get_digit(y, i) - (get_digit(x, i) - borrow));
-                    borrow = 1;
-                }
-                result.push_back(diff);
+                return out << text;
+            }
+            out << prefix;
+            if(n == 0)
+            {
+                out.put('0');
             }
-            // Remove leading 0s.
-            while (!result.empty() and result[result.size() - 1] == 0)
+            else
             {
-                result.take(result.size() - 1);
+                magnitude_to_stream(out, xv.data(), n, base, uppercase);
             }
-            return create(result.persistent(), false);
+            return out;
         }
-        // Shift left (multiply by 10^amount, base 2^32), basically adding 'amount' zeroes.
-        static integer shift_left(integer x, const int amount)
+        // Read x in the base of the stream as parse_stream() does, setting std::ios_base::failbit instead of throwing
+        // if there is no integer. As for int, std::hex also takes a "0x" or "0X" prefix (which must be followed by
+        // digits), and with no base set (e.g. std::setbase(0)) the prefix decides it: "0x" hexadecimal, "0" octal, else
+        // decimal.
+        friend std::istream& operator>>(std::istream& in, integer& x)
         {
-            if(is_equal_to(x, zero))
+            try
             {
-                return x;
+                const std::ios_base::fmtflags field = in.flags() & std::ios_base::basefield;
+                x = integer_from_istream(in, field == std::ios_base::fmtflags() ? 0 : stream_base(in.flags()), true);
             }
-            for(int i = 0; i < amount; i++)
+            catch(const std::invalid_argument&)
             {
-                x.digits = x.digits.push_front(0);
+                in.setstate(std::ios_base::failbit);
             }
-            return x;
+            return in;
         }
-        // Shift right (divide by 10^amount, base 2^32), basically removing 'amount' digits from the right.
-        static integer shift_right(const integer& x, const int amount)
+        // From the limbs of a view, copied once.
+        static integer create(const integer_view& x)
         {
-            return create(x.digits.drop(amount), x.is_negative);
+            return create_from_buffer(digit_buffer(x.limbs(), x.limbs() + x.size()), x.is_negative());
         }
-        // Multiply two integers.
-        static integer multiply(integer x, integer y)
+        // From the limbs [first, last) of the magnitude, least significant first, from any forward iterator of digits:
+        // the digits are allocated once, at their number without leading zeroes for pointers.
+        template<typename Iterator>
+        static integer from_limbs(const Iterator first, const Iterator last, const bool is_negative = false)
         {
-            if(y.digits.size() > x.digits.size())
+            static_assert(std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value, "The limbs are read twice.");
+            digit_buffer buffer;
+            if constexpr(std::is_pointer<Iterator>::value)
             {
-                // It is somewhat more performant to have the smaller number on the right.
-                return multiply(y, x);
+                buffer = digit_buffer(first, first + kernels::normalized_size(first, static_cast<std::size_t>(last - first)));
             }
-            const bool is_negative = x.is_negative xor y.is_negative;
-            x.is_negative = y.is_negative = false;
-            integer result = zero;
-            // Multiply x with each digit of y, shifting according to the position of the digit.
-            for(int i = 0; i < y.digits.size(); i++)
+            else
             {
-                integer product_by_digit = multiply_integer_by_digit(x, y.digits[i]);
-                result = add(result, shift_left(product_by_digit, i));
+                buffer.resize(static_cast<std::size_t>(std::distance(first, last)));
+                std::copy(first, last, buffer.mutable_data());
+                buffer.resize(kernels::normalized_size(buffer.data(), buffer.size()));
             }
-            result.is_negative = is_negative;
-            return result;
+            const bool negative = is_negative and !buffer.empty();
+            return create_from_buffer(std::move(buffer), negative);
         }
-        // Divide two integers (returns <result, remainder>).
-        static std::pair<integer, integer> divide(integer x, integer y)
+        // Is x in the range of the machine integer type T?
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        static bool fits(const integer& x)
         {
-            if(is_equal_to(y, zero))
-            {
-                throw std::logic_error("Division by 0 impermissible.");
-            }
-            if(is_less_than(x, y))
-            {
-                return {zero, x};
-            }
-            const bool is_negative = x.is_negative xor y.is_negative;
-            x.is_negative = y.is_negative = false;
-            // Long division.
-            integer carry = zero;
-            integer result = zero;
-            for(int i = static_cast<int>(x.digits.size() - 1); i >= 0; i--)
-            {
-                carry.digits = carry.digits.push_front(get_digit(x, i));
-                digit new_digit = small_divide(carry, y);
-                if(!result.digits.empty() or new_digit != 0)
-                {
-                    result.digits = result.digits.push_front(new_digit);
-                }
-                carry = subtract(carry, multiply_integer_by_digit(y, new_digit));
-            }
-            result.is_negative = carry.is_negative = is_negative;
-            return {result, carry};
+            machine_unsigned_t<T> magnitude;
+            return machine_magnitude<T>(x, magnitude);
         }
-        // Is x less than y? (strict indicates strict inequality).
-        static bool is_less_than(const integer& x, const integer& y, const bool strict = true)
+        // x as the machine integer type T. Throws std::out_of_range unless it fits().
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        static T to(const integer& x)
         {
-            // If both are zero.
-            if(is_equal_to(x, zero) and is_equal_to(y, zero))
+            using magnitude_type = machine_unsigned_t<T>;
+            magnitude_type magnitude;
+            if(!machine_magnitude<T>(x, magnitude))
             {
-                return false;
+                throw std::out_of_range("Integer out of the range of the type.");
             }
-            // If unequal signs.
-            if(x.is_negative != y.is_negative)
+            return static_cast<T>(x.is_negative ? static_cast<magnitude_type>(magnitude_type(0) - magnitude) : magnitude);
+        }
+        // x rounded to the nearest floating-point value (ties to even), infinite beyond the range of the type. Only the
+        // top limbs are read, and the others for whether any of their bits is set.
+        static float to_float(const integer& x)
+        {
+            return to_floating<float>(x);
+        }
+        static double to_double(const integer& x)
+        {
+            return to_floating<double>(x);
+        }
+        static long double to_long_double(const integer& x)
+        {
+            return to_floating<long double>(x);
+        }
+        // The integer part of a finite value (truncated toward zero), throws std::invalid_argument for infinities and NaN.
+        static integer from_double(const double value)
+        {
+            return from_floating(value);
+        }
+        static integer from_long_double(const long double value)
+        {
+            return from_floating(value);
+        }
+        // log2 |x| and log10 |x| from the top limbs, to the precision of a double (-infinity for zero), e.g. to size the
+        // output of a conversion: x has floor(log10(x)) + 1 decimal digits, up to the rounding of the estimate.
+        static double log2(const integer& x)
+        {
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            if(xn == 0)
             {
-                return x.is_negative;
+                return -std::numeric_limits<double>::infinity();
             }
-            // If both negative.
-            if(x.is_negative and y.is_negative)
+            // The top two digits, as a fraction of 2^(2 * digit_bits), hold more bits than a double does.
+            const double low = xn > 1 ? static_cast<double>(xv[xn - 2]) : 0.0;
+            const double top = (static_cast<double>(xv[xn - 1]) + std::ldexp(low, -digit_bits)) * std::ldexp(1.0, -digit_bits);
+            return std::log2(top) + static_cast<double>(xn * digit_bits);
+        }
+        static double log10(const integer& x)
+        {
+            // log10(2).
+            return log2(x) * 0.301029995663981195213738894724493027;
+        }
+#if !INTTITAN_FLEX_VECTOR_STORAGE
+        // The limbs of x in place, valid while x lives unchanged.
+        static integer_view view(const integer& x)
+        {
+            return integer_view(x.digits.data(), x.digits.size(), x.is_negative);
+        }
+#endif
+        // Number of bytes to_bytes() writes for x, the prefix included.
+        static std::size_t byte_length(const integer& x, const byte_format& format = {})
+        {
+            const auto& xv = x.digits.view();
+            return byte_length(integer_view(xv.data(), xv.size(), x.is_negative), format);
+        }
+        static std::size_t byte_length(const integer_view& x, const byte_format& format = {})
+        {
+            const std::size_t count = kernels::byte_length(x.limbs(), x.size(), x.is_negative(), format.is_signed);
+            return format.length_prefix ? length_prefix_bytes + count : count;
+        }
+        // Write x into the size bytes at out: the fewest bytes that hold it in the format (none for zero), after their
+        // count if it has a prefix. Returns the number of bytes written. Throws if they do not fit, or for a negative x
+        // in an unsigned format. On a little-endian host the bytes are a copy of the limbs, reversed for big-endian.
+        static std::size_t to_bytes(const integer& x, std::byte* out, const std::size_t size, const byte_format& format = {})
+        {
+            const auto& xv = x.digits.view();
+            return to_bytes(integer_view(xv.data(), xv.size(), x.is_negative), out, size, format);
+        }
+        static std::size_t to_bytes(const integer_view& x, std::byte* out, const std::size_t size, const byte_format& format = {})
+        {
+            if(x.is_negative() and !format.is_signed)
             {
-                return !is_less_than(negate(y), negate(x));
+                throw std::logic_error("Negative value in an unsigned byte format impermissible.");
             }
-
-            // Compare digits one by one.
-            if(x.digits.size() != y.digits.size())
+            const std::size_t count = kernels::byte_length(x.limbs(), x.size(), x.is_negative(), format.is_signed);
+            const std::size_t prefix = format.length_prefix ? length_prefix_bytes : 0;
+            if(size < prefix + count)
             {
-                return x.digits.size() < y.digits.size();
+                throw std::logic_error("Byte buffer too small.");
             }
-            for(int i = static_cast<int>(x.digits.size() - 1); i >= 0; i--)
+            if(format.length_prefix)
             {
-                if(get_digit(x, i) != get_digit(y, i))
-                {
-                    return get_digit(x, i) < get_digit(y, i);
-                }
+                kernels::write_length_prefix(out, count, format.order);
             }
-            return !strict;
+            kernels::limbs_to_bytes(out + prefix, x.limbs(), x.size(), count, x.is_negative(), format.order);
+            return prefix + count;
         }
-        // Are x and y equal?
-        static bool is_equal_to(const integer& x, const integer& y)
+        // The integer in the size bytes at data, in the format. With a prefix, the bytes it counts must follow it (any
+        // bytes after them are ignored).
+        static integer from_bytes(const std::byte* data, std::size_t size, const byte_format& format = {})
         {
-            if(x.digits.empty() and y.digits.empty())
+            if(format.length_prefix)
             {
-                return true; // Both zero (if a negative zero arises, treat it the same as positive).
+                if(size < length_prefix_bytes or kernels::read_length_prefix(data, format.order) > size - length_prefix_bytes)
+                {
+                    throw std::logic_error("Byte buffer too small.");
+                }
+                size = static_cast<std::size_t>(kernels::read_length_prefix(data, format.order));
+                data += length_prefix_bytes;
             }
-            return x.is_negative == y.is_negative and x.digits == y.digits;
-        }
-
-        // Operator functions.
-        // Comparison.
-        friend bool operator==(const integer& x, const integer& y)
-        {
-            return is_equal_to(x, y);
-        }
-        friend bool operator!=(const integer& x, const integer& y)
-        {
-            return !is_equal_to(x, y);
+            const std::size_t n = (size + sizeof(digit) - 1) / sizeof(digit);
+            digit_buffer result(n);
+            digit* r = result.mutable_data();
+            const bool is_negative = kernels::bytes_to_limbs(r, n, data, size, format.order, format.is_signed);
+            result.resize(kernels::normalized_size(r, n));
+            return create_from_buffer(std::move(result), is_negative and !result.empty());
         }
-        friend bool operator<(const integer& x, const integer& y)
+#if __cplusplus >= 202002L
+        static std::size_t to_bytes(const integer& x, const std::span<std::byte> out, const byte_format& format = {})
         {
-            return is_less_than(x, y);
+            return to_bytes(x, out.data(), out.size(), format);
         }
-        friend bool operator<=(const integer& x, const integer& y)
+        static integer from_bytes(const std::span<const std::byte> data, const byte_format& format = {})
         {
-            return is_less_than(x, y);
+            return from_bytes(data.data(), data.size(), format);
         }
-        friend bool operator>(const integer& x, const integer& y)
+#endif
+        // Every integer is kept in a canonical form, without leading zero digits and without a negative zero, so that
+        // these take O(1) and the operations read the numbers of digits as they are.
+        static bool is_zero(const integer& x)
         {
-            return is_less_than(x, y);
+            return x.digits.empty();
         }
-        friend bool operator>=(const integer& x, const integer& y)
+        // -1, 0 or 1 as x is negative, zero or positive.
+        static int sign(const integer& x)
         {
-            return is_less_than(x, y);
+            return x.is_negative ? -1 : x.digits.empty() ? 0 : 1;
         }
-        // Arithmetic.
-        friend integer operator+(const integer& x, const integer& y)
+        // Number of base 2^digit_bits digits of |x|, 0 for 0.
+        static std::size_t limb_count(const integer& x)
         {
-            return add(x, y);
+            return x.digits.size();
         }
-        friend integer operator+(const integer& x)
+        // Negate the integer.
+        static integer negate(integer x)
         {
+            x.is_negative = !x.is_negative and !x.digits.empty();
             return x;
         }
-        friend integer& operator+=(integer& x, const integer& y)
+        // Absolute value.
+        static integer absolute_value(integer x)
         {
-            x = add(x, y);
+            x.is_negative = false;
             return x;
         }
-        friend integer& operator++(integer& x)
+        // Add the two integers: one step on the signs, then a single pass of the kernel over the digits (see sum_of).
+        static integer add(const integer& x, const integer& y)
         {
-            x = add(x, one);
-            return x;
+            const auto& xv = x.digits.view();
+            const auto& yv = y.digits.view();
+            return sum_of(xv.data(), xv.size(), x.is_negative, yv.data(), yv.size(), y.is_negative);
         }
-        friend integer operator++(integer& x, int)
+        // Subtract one integer from the other, as the sum with y negated.
+        static integer subtract(const integer& x, const integer& y)
         {
-            integer old = x;
-            x = add(x, one);
-            return old;
+            const auto& xv = x.digits.view();
+            const auto& yv = y.digits.view();
+            return sum_of(xv.data(), xv.size(), x.is_negative, yv.data(), yv.size(), !y.is_negative);
         }
-        friend integer operator-(const integer& x, const integer& y)
+        // Sum and difference of views, read in place.
+        static integer add(const integer_view& x, const integer_view& y)
         {
-            return subtract(x, y);
+            return sum_of(x.limbs(), x.size(), x.is_negative(), y.limbs(), y.size(), y.is_negative());
         }
-        friend integer operator-(const integer& x)
+        static integer subtract(const integer_view& x, const integer_view& y)
         {
-            return negate(x);
+            return sum_of(x.limbs(), x.size(), x.is_negative(), y.limbs(), y.size(), !y.is_negative());
         }
-        friend integer& operator-=(integer& x, const integer& y)
+        // Shift left (multiply by 10^amount, base 2^digit_bits), basically adding 'amount' zeroes.
+        static integer shift_left(integer x, const int amount)
         {
-            x = subtract(x, y);
+            if(is_zero(x) or amount <= 0)
+            {
+                return x;
+            }
+#if INTTITAN_FLEX_VECTOR_STORAGE
+            // The zeroes are joined to the tree, which keeps the nodes of x.
+            x.digits = integer_digits::zeros(static_cast<std::size_t>(amount)).concat(x.digits);
             return x;
+#else
+            const auto& xv = x.digits.view();
+            digit_buffer result(xv.size() + amount);
+            std::copy(xv.begin(), xv.end(), result.mutable_data() + amount);
+            return create_from_buffer(std::move(result), x.is_negative);
+#endif
         }
-        friend integer& operator--(integer& x)
+        // Shift right (divide by 10^amount, base 2^digit_bits), basically removing 'amount' digits from the right.
+        static integer shift_right(const integer& x, const int amount)
         {
-            x = subtract(x, one);
-            return x;
+            const auto& xv = x.digits.view();
+            if(amount >= static_cast<int>(xv.size()))
+            {
+                return create(integer_digits(), x.is_negative);
+            }
+            const std::size_t skipped = amount > 0 ? amount : 0;
+#if INTTITAN_FLEX_VECTOR_STORAGE
+            return create(x.digits.drop(skipped), x.is_negative);
+#else
+            return create_from_buffer(digit_buffer(xv.begin() + skipped, xv.end()), x.is_negative);
+#endif
         }
-        friend integer operator--(integer& x, int)
+        // high * B^k + low for 0 <= low < B^k (B = 2^digit_bits), with the sign of high: the limbs of low, padded to k,
+        // followed by those of high, e.g. for a result whose halves are formed apart. With INTTITAN_FLEX_VECTOR_STORAGE
+        // the trees are joined in O(log n), sharing their nodes with high and low; contiguous digits are copied once.
+        // Throws std::invalid_argument for a low part out of range.
+        static integer concat_limbs(const integer& high, const integer& low, const std::size_t k)
         {
-            integer old = x;
-            x = subtract(x, one);
-            return old;
+            const std::size_t ln = low.digits.size();
+            if(ln > k or (low.is_negative and ln != 0))
+            {
+                throw std::invalid_argument("Low part from 0 to B^k expected.");
+            }
+            const std::size_t hn = high.digits.size();
+            if(hn == 0)
+            {
+                return absolute_value(low);
+            }
+#if INTTITAN_FLEX_VECTOR_STORAGE
+            return create(low.digits.concat(integer_digits::zeros(k - ln)).concat(high.digits), high.is_negative);
+#else
+            digit_buffer result(k + hn);
+            digit* r = result.mutable_data();
+            std::copy(low.digits.data(), low.digits.data() + ln, r);
+            std::copy(high.digits.data(), high.digits.data() + hn, r + k);
+            return create_from_buffer(std::move(result), high.is_negative);
+#endif
         }
-        friend integer operator*(const integer& x, const integer& y)
+        // x * 2^bits, shifting by bits rather than digits.
+        static integer shift_left_bits(const integer& x, const std::size_t bits)
         {
-            return multiply(x, y);
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            if(xn == 0)
+            {
+                return zero;
+            }
+            const std::size_t skipped = bits / digit_bits;
+            digit_buffer result(xn + skipped + 1);
+            digit* r = result.mutable_data();
+            r[xn + skipped] = kernels::shift_left_bits(r + skipped, xv.data(), xn, static_cast<int>(bits % digit_bits));
+            result.resize(kernels::normalized_size(r, result.size()));
+            return create_from_buffer(std::move(result), x.is_negative);
         }
-        friend integer& operator*=(integer& x, const integer& y)
+        // floor(x / 2^bits), the arithmetic shift of two's complement: negative values round towards minus infinity.
+        static integer shift_right_bits(const integer& x, const std::size_t bits)
         {
-            x = multiply(x, y);
-            return x;
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            const std::size_t skipped = bits / digit_bits;
+            if(skipped >= xn)
+            {
+                return x.is_negative and xn != 0 ? negate(one) : zero;
+            }
+            const std::size_t rn = xn - skipped;
+            // One more digit for the carry of the rounding.
+            digit_buffer result(rn + 1);
+            digit* r = result.mutable_data();
+            const digit out = kernels::shift_right_bits(r, xv.data() + skipped, rn, static_cast<int>(bits % digit_bits));
+            if(x.is_negative and (out != 0 or kernels::normalized_size(xv.data(), skipped) != 0))
+            {
+                const digit unit = 1;
+                r[rn] = kernels::add(r, r, rn, &unit, 1);
+            }
+            result.resize(kernels::normalized_size(r, rn + 1));
+            return create_from_buffer(std::move(result), x.is_negative and !result.empty());
         }
-        friend integer operator/(const integer& x, const integer& y)
+        // Bitwise and, or, xor and not, with the semantics of two's complement: a negative value acts as if it had
+        // infinitely many ones on top (so ~x = -x - 1).
+        static integer bitwise_and(const integer& x, const integer& y)
         {
-            return divide(x, y).first;
+            return bitwise(x, y, [](const digit a, const digit b)
+            {
+                return static_cast<digit>(a & b);
+            });
         }
-        friend integer& operator/=(integer& x, const integer& y)
+        static integer bitwise_or(const integer& x, const integer& y)
         {
-            x = divide(x, y).first;
-            return x;
+            return bitwise(x, y, [](const digit a, const digit b)
+            {
+                return static_cast<digit>(a | b);
+            });
         }
-        friend integer operator%(const integer& x, const integer& y)
+        static integer bitwise_xor(const integer& x, const integer& y)
         {
-            return divide(x, y).second;
+            return bitwise(x, y, [](const digit a, const digit b)
+            {
+                return static_cast<digit>(a ^ b);
+            });
         }
-        friend integer& operator%=(integer& x, const integer& y)
+        static integer bitwise_not(integer x)
         {
-            x = divide(x, y).second;
-            return x;
+            add_in_place(x, one, false);
+            return negate(std::move(x));
         }
-    private:
-        // A vector of base-2^32 digits (little-endian).
-        integer_digits digits;
-        // Is the integer negative?
-        bool is_negative = false;
-        // Get a digit from an integer.
-        static digit get_digit(const integer& x, const int index)
+        // Bit i of x, in two's complement for negative x.
+        static bool test_bit(const integer& x, const std::size_t i)
         {
-            // Return the digit's value if present, else return 0 as a leading zero.
-            return index < x.digits.size() ? x.digits[index] : 0;
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            const bool bit = i / digit_bits < xn and (xv[i / digit_bits] >> (i % digit_bits) & 1) != 0;
+            if(!x.is_negative or xn == 0)
+            {
+                return bit;
+            }
+            // -|x| = ~(|x| - 1): the bits up to the lowest one are those of |x|, the others flipped.
+            return i <= count_trailing_zeros(x) ? bit : !bit;
         }
-        // Get an inverse digit of a digit (the one with which it adds up to 10 base 2^32).
-        static digit inverse_digit(const digit digit)
+        // Number of bits of |x| (0 for zero).
+        static std::size_t bit_length(const integer& x)
         {
-            assert(digit != 0); // 0 does not have an inverse.
-            return static_cast<superdigit>(max_digit) + 1 - digit;
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            return xn == 0 ? 0 : xn * digit_bits - kernels::leading_zeros(xv[xn - 1]);
         }
-        // Get value of a digit character (e.g. value of '0' is 0, value of 'D' is 13).
-        static int get_digit_character_value(char d)
+        // Number of one bits of |x|.
+        static std::size_t popcount(const integer& x)
         {
-            d = static_cast<char>(std::tolower(d));
-            assert((d >= '0' and d <= '9') or (d >= 'a' and d <= 'z'));
-            if(d >= '0' and d <= '9')
+            std::size_t count = 0;
+            for(const digit d : x.digits.view())
             {
-                return d - '0';
+                count += kernels::population_count(d);
             }
-            return 10 + d - 'a';
+            return count;
         }
-        // Get digit character for value.
-        static char get_digit_character(const int value, const bool uppercase = true)
+        // Number of zero bits below the lowest one of x, which are the same in two's complement (0 for zero).
+        static std::size_t count_trailing_zeros(const integer& x)
         {
-            assert(value < (1 + '9' - '0') + (1 + 'Z' - 'A'));
-            if(value < 10)
+            const auto& xv = x.digits.view();
+            for(std::size_t i = 0; i < xv.size(); i++)
             {
-                return static_cast<char>('0' + value);
+                if(xv[i] != 0)
+                {
+                    return i * digit_bits + kernels::trailing_zeros(xv[i]);
+                }
             }
-            char a = uppercase ? 'A' : 'a';
-            return static_cast<char>(a + value - 10);
+            return 0;
+        }
+        // Multiply two integers.
+        static integer multiply(const integer& x, const integer& y)
+        {
+            // The same limbs (a shared block may have been shrunk on one side, so the sizes must agree too), but not
+            // necessarily the same sign.
+            if(x.digits.size() == y.digits.size() and x.digits.shares_storage(y.digits))
+            {
+                integer r = square(x);
+                r.is_negative = (x.is_negative xor y.is_negative) and !r.digits.empty();
+                return r;
+            }
+            if(y.digits.size() > x.digits.size())
+            {
+                // It is somewhat more performant to have the smaller number on the right.
+                return multiply(y, x);
+            }
+            const auto& xv = x.digits.view();
+            const auto& yv = y.digits.view();
+            return product_of(xv.data(), xv.size(), yv.data(), yv.size(), x.is_negative xor y.is_negative);
         }
-        // Read integers from strings (decimal and hex).
-        static integer_digits digits_from_string(const std::string_view str, const bool is_hex)
+        // The product of two views, read in place: e.g. of the halves of operands split by integer_view::low() and high().
+        static integer multiply(const integer_view& x, const integer_view& y)
         {
-            // Only hex is currently supported.
-            assert(is_hex);
-            if(is_hex)
+            const bool is_negative = x.is_negative() xor y.is_negative();
+            if(y.size() > x.size())
             {
-                return digits_from_hex_string(str);
+                return product_of(y.limbs(), y.size(), x.limbs(), x.size(), is_negative);
             }
-            throw std::exception();
+            return product_of(x.limbs(), x.size(), y.limbs(), y.size(), is_negative);
+        }
+        // Square an integer, with about half the work of multiplying two different ones.
+        static integer square(const integer& x)
+        {
+            const auto& xv = x.digits.view();
+            return square_of(xv.data(), xv.size());
+        }
+        static integer square(const integer_view& x)
+        {
+            return square_of(x.limbs(), x.size());
+        }
+        // |x| * |y| mod B^n, the low n limbs of the product, with the sign of x * y. For large n the short product takes
+        // about 0.6 of the work of the full one.
+        static integer multiply_low(const integer& x, const integer& y, const std::size_t n)
+        {
+            const auto& xv = x.digits.view();
+            const auto& yv = y.digits.view();
+            const std::size_t xn = std::min(xv.size(), n);
+            const std::size_t yn = std::min(yv.size(), n);
+            statistics::count(operation::multiply, std::max(xn, yn), std::min(xn, yn));
+            digit_buffer result(n);
+            digit* r = result.mutable_data();
+            kernels::multiply_low(r, xv.data(), xn, yv.data(), yn, n);
+            result.resize(kernels::normalized_size(r, n));
+            const bool is_negative = (x.is_negative xor y.is_negative) and !result.empty();
+            return create_from_buffer(std::move(result), is_negative);
         }
-        // Convert integers to strings (decimal and hex).
-        static std::string string_from_integer(const integer& x, const bool is_hex = true, const bool uppercase = true)
+        // floor(|x| * |y| / B^n) for x and y below B^n, the high n limbs of the product, with the sign of x * y. The short
+        // product leaves out the carries of the low limbs, so the magnitude may be up to n too small, which the callers
+        // allow for (as with the quotient estimates of a division).
+        static integer multiply_high(const integer& x, const integer& y, const std::size_t n)
         {
-            // Only hex is currently supported.
-            assert(is_hex);
-            if(is_hex)
+            const auto& xv = x.digits.view();
+            const auto& yv = y.digits.view();
+            const std::size_t xn = xv.size();
+            const std::size_t yn = yv.size();
+            if(xn > n or yn > n)
+            {
+                throw std::invalid_argument("Operand of more limbs than the short product.");
+            }
+            if(xn == 0 or yn == 0)
             {
-                return hex_string_from_integer(x, uppercase);
+                return zero;
             }
-            throw std::exception();
+            statistics::count(operation::multiply, n, n);
+            // The kernel takes operands of n limbs.
+            const kernels::scratch_buffer<> operands(2 * n);
+            digit* a = operands.get();
+            digit* b = a + n;
+            std::copy(xv.data(), xv.data() + xn, a);
+            std::fill(a + xn, a + n, digit(0));
+            std::copy(yv.data(), yv.data() + yn, b);
+            std::fill(b + yn, b + n, digit(0));
+            digit_buffer result(n);
+            digit* r = result.mutable_data();
+            kernels::multiply_high(r, a, b, n);
+            result.resize(kernels::normalized_size(r, n));
+            const bool is_negative = (x.is_negative xor y.is_negative) and !result.empty();
+            return create_from_buffer(std::move(result), is_negative);
+        }
+        // r = r + x * y. The product goes into temporary limbs and straight into r, without an integer for it.
+        static void addmul(integer& r, const integer& x, const integer& y)
+        {
+            add_product(r, x, y, false);
+        }
+        // r = r - x * y, the same way as addmul().
+        static void submul(integer& r, const integer& x, const integer& y)
+        {
+            add_product(r, x, y, true);
         }
-        // Read integers from hex strings.
-        static integer_digits digits_from_hex_string(const std::string_view str)
+        // (x * y) % m, without integers for the product or the quotient. The result takes the sign of x * y, as with %.
+        static integer multiply_mod(const integer& x, const integer& y, const integer& m)
         {
-            const int bits_per_hex_digit = 4; // How many bits are contained in a hex digit.
-            const int characters_per_digit = 32 / bits_per_hex_digit; // How many hex digits in str fill up a base-2^32 digit.
-            auto result = integer_digits().transient();
-            digit current_digit = 0;
-            for(int counter = 0, i = static_cast<int>(str.size() - 1); i >= 0; i--)
+            const auto& mv = m.digits.view();
+            const std::size_t mn = mv.size();
+            if(mn == 0)
             {
-                const int current_character = get_digit_character_value(str[i]);
-                current_digit |= (current_character << (bits_per_hex_digit * counter));
-                if ((++counter %= characters_per_digit) == 0)
-                {
-                    result.push_back(current_digit);
-                    current_digit = 0;
-                }
+                throw std::logic_error("Division by 0 impermissible.");
             }
-            if(current_digit != 0)
+            digit_buffer product = multiply_magnitudes(x, y);
+            const std::size_t pn = product.size();
+            const bool is_negative = (x.is_negative xor y.is_negative) and pn != 0;
+            if(kernels::compare(product.data(), pn, mv.data(), mn) < 0)
             {
-                result.push_back(current_digit);
+                return create_from_buffer(std::move(product), is_negative);
             }
-            return result.persistent();
+            statistics::count(operation::divide, pn, mn);
+            const kernels::scratch_buffer<> quotient(pn - mn + 1);
+            digit_buffer remainder(mn);
+            digit* r = remainder.mutable_data();
+            kernels::divide(quotient.get(), r, product.data(), pn, mv.data(), mn);
+            remainder.resize(kernels::normalized_size(r, mn));
+            return create_from_buffer(std::move(remainder), is_negative and !remainder.empty());
         }
-        // Convert integers to hex strings.
-        static std::string hex_string_from_integer(const integer& x, const bool uppercase = true)
+        // base^exponent mod |modulus|, in [0, |modulus|). Odd moduli go through a Montgomery context, even ones through
+        // a Barrett reducer, and the exponent is scanned by a sliding window sized from its length. With constant_time,
+        // a fixed window and a lookup of the powers that do not depend on the bits of the exponent (only on its number
+        // of digits), for secret exponents.
+        static integer pow_mod(const integer& base, const integer& exponent, const integer& modulus, bool constant_time = false);
+        // bases[0]^exponents[0] * ... * bases[count - 1]^exponents[count - 1] mod |modulus|, in [0, |modulus|), with
+        // the powers interleaved (Straus; Shamir's trick for two): one chain of squarings for all of them, so g^a h^b
+        // costs little more than g^a. For a base that takes many exponents, see fixed_base_table.
+        static integer multi_pow_mod(const integer* bases, const integer* exponents, std::size_t count, const integer& modulus);
+        static integer multi_pow_mod(const integer& g, const integer& a, const integer& h, const integer& b, const integer& modulus)
         {
-            const int bits_per_hex_digit = 4; // How many bits are contained in a hex digit.
-            std::stringstream ss;
-            if(x.is_negative)
+            const integer bases[] = {g, h};
+            const integer exponents[] = {a, b};
+            return multi_pow_mod(bases, exponents, 2, modulus);
+        }
+        // base^exponent (1 for a zero exponent) by left-to-right binary exponentiation: squarings, and products by the
+        // base for the one bits. The size of the result is known up front, so all the work is in limbs allocated once,
+        // and the trailing zero bits of the base (all of a power of two) become a shift.
+        static integer pow(const integer& base, std::size_t exponent);
+        // The greatest common divisor of |x| and |y| (0 for two zeroes). The binary algorithm for operands of up to two
+        // digits, Lehmer's algorithm above them, and from tuning.half_gcd on a half-GCD that reduces the operands by
+        // matrices from their top halves, multiplied in by the fast products.
+        static integer gcd(const integer& x, const integer& y);
+        // gcd(x, y), with s and t such that s x + t y = gcd(x, y), |s| at most |y| / (2 gcd) and |t| at most about
+        // |x| / (2 gcd). For x or y zero, the other one's sign and 0.
+        static integer extended_gcd(const integer& x, const integer& y, integer& s, integer& t);
+        // The inverse of x modulo |m|, in [0, |m|). Throws if x and m have a common factor.
+        static integer mod_inverse(const integer& x, const integer& m);
+        // floor(sqrt(x)) for x >= 0, by Newton's iteration with precision doubling: the root of the top half of x, from
+        // those of ever shorter tops down to two digits (a floating-point estimate made exact), is carried to the root
+        // of x by one step, so each step works on only the limbs it needs. For squares the step is that of Zimmermann's
+        // square root, whose division is of a quarter of the size.
+        static integer isqrt(const integer& x);
+        // The k-th root of x (k >= 1) rounded toward zero, the same way. x may be negative for odd k.
+        static integer iroot(const integer& x, unsigned k);
+        // Is x the square of an integer? Residues modulo 256 and small odd primes reject most candidates before any root
+        // is taken.
+        static bool is_perfect_square(const integer& x);
+        // Is x probably prime? Trial division by the small primes, then the test of Baillie-PSW: a strong probable-prime
+        // test to base 2 (Miller-Rabin) and a strong Lucas test with the parameters of Selfridge, all in a Montgomery
+        // context for x. No composite is known to pass both, and none below 2^64 does. Each of the further rounds is a
+        // Miller-Rabin test to the next odd prime base, 3, 5, 7 and so on. False for x < 2.
+        static bool is_probable_prime(const integer& x, unsigned rounds = 0);
+        // The smallest probable prime above x (2 for x < 2), by the tests of is_probable_prime(). The odd candidates are
+        // sieved by the primes below 2^16 in windows: the residues of the first candidate are computed once and those of
+        // the next windows follow by additions, so only the candidates without a small factor are tested.
+        static integer next_prime(const integer& x, unsigned rounds = 0);
+        // x / d truncated toward zero, and the remainder of |x| by d (d > 0): x = q d + r, or q d - r for negative x. The
+        // divisions by d become multiplications by its reciprocal, see kernels::digit_divisor.
+        static std::pair<integer, digit> divide_by_digit(const integer& x, const digit d)
+        {
+            if(d == 0)
             {
-                ss << '-';
+                throw std::logic_error("Division by 0 impermissible.");
             }
-            const auto& digits = x.digits;
-            int current_bits = 0;
-            bool has_at_least_one_character = false; // Used to avoid leading zeroes.
-            // Reads the digits from the most significant to the least significant.
-            for(int counter = 0, i = static_cast<int>(digits.size() - 1); i >= 0; i--)
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            statistics::count(operation::small_divide, xn, 1);
+            digit_buffer quotient(xn);
+            digit* q = quotient.mutable_data();
+            const digit remainder = kernels::divide_by_digit(q, xv.data(), xn, d);
+            quotient.resize(kernels::normalized_size(q, xn));
+            const bool is_negative = x.is_negative and !quotient.empty();
+            return {create_from_buffer(std::move(quotient), is_negative), remainder};
+        }
+        // |x| mod d (d > 0), without the quotient.
+        static digit mod_digit(const integer& x, const digit d)
+        {
+            if(d == 0)
             {
-                digit current_digit = digits[i];
-                // Reads individual bits from the most significant to the least significant.
-                for(int bit = 31; bit >= 0; bit--)
-                {
-                    bool is_set = !!(current_digit & (1 << bit));
-                    current_bits |= (is_set << (bits_per_hex_digit - 1 - (counter % bits_per_hex_digit)));
-                    if((++counter %= bits_per_hex_digit) == 0)
-                    {
-                        if(has_at_least_one_character or current_bits != 0)
-                        {
-                            ss << get_digit_character(current_bits, uppercase);
-                            has_at_least_one_character = true;
-                            current_bits = 0;
-                        }
-                    }
-                }
+                throw std::logic_error("Division by 0 impermissible.");
             }
-            return ss.str();
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            statistics::count(operation::small_divide, xn, 1);
+            return kernels::modulo_digit(xv.data(), xn, d);
         }
-        // Multiplication of base 2^32 digits.
-        static superdigit multiply_digits(const digit x, const digit y)
+        // x / d for an x known to be a multiple of d (d > 0), by multiplications by the inverse of d modulo the digit
+        // base, from the bottom digit up. For any other x the result is meaningless.
+        static integer divide_exact_by_digit(const integer& x, const digit d)
         {
-            const superdigit p = static_cast<superdigit>(x) * static_cast<superdigit>(y);
-            return p;
+            if(d == 0)
+            {
+                throw std::logic_error("Division by 0 impermissible.");
+            }
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            statistics::count(operation::small_divide, xn, 1);
+            digit_buffer quotient(xn);
+            digit* q = quotient.mutable_data();
+            kernels::divide_exact_by_digit(q, xv.data(), xn, d);
+            quotient.resize(kernels::normalized_size(q, xn));
+            const bool is_negative = x.is_negative and !quotient.empty();
+            return create_from_buffer(std::move(quotient), is_negative);
         }
-        // Multiplication of an integer with a base 2^32 digit.
-        static integer multiply_integer_by_digit(const integer& x, const digit d)
+        // Divide two integers (returns <result, remainder>). Divisors of one digit go to divide_by_digit().
+        static std::pair<integer, integer> divide(const integer& x, const integer& y)
         {
-            digit carry = 0;
-            auto result = integer_digits().transient();
-            for(int i = 0; i < x.digits.size(); i++)
+            const auto& xv = x.digits.view();
+            const auto& yv = y.digits.view();
+            const std::size_t xn = xv.size();
+            const std::size_t yn = yv.size();
+            if(yn == 0)
             {
-                const superdigit product = multiply_digits(get_digit(x, i), d) + carry;
-                result.push_back((product << 32) >> 32);
-                carry = (product >> 32);
+                throw std::logic_error("Division by 0 impermissible.");
             }
-            if(carry != 0)
+            // Truncating division, as for the built-in types: the remainder takes the sign of x.
+            if(kernels::compare(xv.data(), xn, yv.data(), yn) < 0)
             {
-                result.push_back(carry);
+                return {zero, x};
             }
-            // Remove leading 0s.
-            while (!result.empty() and result[result.size() - 1] == 0)
+            if(yn == 1)
             {
-                result.take(result.size() - 1);
+                auto [quotient, remainder] = divide_by_digit(x, yv[0]);
+                quotient.is_negative = (quotient.is_negative xor y.is_negative) and !is_zero(quotient);
+                return {std::move(quotient), from_remainder(remainder, x.is_negative)};
             }
-            return create(result.persistent(), x.is_negative);
+            statistics::count(operation::divide, xn, yn);
+            digit_buffer quotient(xn - yn + 1);
+            digit_buffer remainder(yn);
+            digit* q = quotient.mutable_data();
+            digit* r = remainder.mutable_data();
+            kernels::divide(q, r, xv.data(), xn, yv.data(), yn);
+            quotient.resize(kernels::normalized_size(q, quotient.size()));
+            remainder.resize(kernels::normalized_size(r, remainder.size()));
+            const bool quotient_negative = x.is_negative xor y.is_negative;
+            const bool remainder_negative = x.is_negative and !remainder.empty();
+            return {create_from_buffer(std::move(quotient), quotient_negative), create_from_buffer(std::move(remainder), remainder_negative)};
         }
-        // Division of an integer with an integer that we know will result in a digit.
-        static digit small_divide(const integer& x, const integer& y)
+        // Three-way comparison: -1, 0 or 1 as x is less than, equal to or greater than y. Straight from the signs, the
+        // numbers of digits and a scan of the digits from the top (a negative zero is zero).
+        static int compare(const integer& x, const integer& y)
         {
-            // Common case, should be checked first.
-            if(is_less_than(x, y))
+            if(x.is_negative != y.is_negative)
             {
-                return 0;
+                return x.is_negative ? -1 : 1;
             }
-            // For each bit in the resulting digit, check in descending order whether each one of them being set overshoots the solution.
-            digit cur = 0;
-            for(int i = 31; i >= 0; i--)
+            if(x.digits.size() != y.digits.size() or x.digits.shares_storage(y.digits))
             {
-                if(!is_less_than(x, multiply_integer_by_digit(y, cur | (1 << i))))
-                {
-                    cur |= (1 << i);
-                }
+                // The signs and numbers of digits decide, or the digits are the same.
+                const int magnitude = x.digits.size() == y.digits.size() ? 0 : x.digits.size() < y.digits.size() ? -1 : 1;
+                return x.is_negative ? -magnitude : magnitude;
             }
-            return cur;
+            const auto& xv = x.digits.view();
+            const auto& yv = y.digits.view();
+            const int magnitude = kernels::compare(xv.data(), yv.data(), xv.size());
+            return x.is_negative ? -magnitude : magnitude;
         }
-    };
-}
+        static int compare(const integer_view& x, const integer_view& y)
+        {
+            // Views have no leading zeroes, so an empty one is the only zero.
+            const bool x_negative = x.is_negative() and !x.is_zero();
+            const bool y_negative = y.is_negative() and !y.is_zero();
+            if(x_negative != y_negative)
+            {
+                return x_negative ? -1 : 1;
+            }
+            const int magnitude = compare_magnitudes(x.limbs(), x.size(), y.limbs(), y.size());
+            return x_negative ? -magnitude : magnitude;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        static int compare(const integer& x, const T value)
+        {
+            const small_operand<T> y(value);
+            if(x.is_negative != y.is_negative)
+            {
+                return x.is_negative ? -1 : 1;
+            }
+            const auto& xv = x.digits.view();
+            const int magnitude = compare_magnitudes(xv.data(), xv.size(), y.digits, y.size);
+            return x.is_negative ? -magnitude : magnitude;
+        }
+        // Is x less than y? (strict indicates strict inequality).
+        static bool is_less_than(const integer& x, const integer& y, const bool strict = true)
+        {
+            const int comparison = compare(x, y);
+            return strict ? comparison < 0 : comparison <= 0;
+        }
+        // Are x and y equal?
+        static bool is_equal_to(const integer& x, const integer& y)
+        {
+            return compare(x, y) == 0;
+        }
+        // Is x equal to the machine integer?
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        static bool is_equal_to(const integer& x, const T value)
+        {
+            digit d[machine_digits<T>];
+            bool negative;
+            const std::size_t n = magnitude_digits(value, d, negative);
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            return xn == n and (n == 0 or x.is_negative == negative) and kernels::compare(xv.data(), d, n) == 0;
+        }
+        // Hash of the value, the same for equal integers (whatever their storage) and for a machine integer of the value.
+        static std::size_t hash(const integer& x)
+        {
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            return static_cast<std::size_t>(kernels::hash(xv.data(), xn, x.is_negative and xn != 0));
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        static std::size_t hash(const T value)
+        {
+            digit d[machine_digits<T>];
+            bool negative;
+            const std::size_t n = magnitude_digits(value, d, negative);
+            return static_cast<std::size_t>(kernels::hash(d, n, negative));
+        }
+
+        // Operator functions.
+        // Comparison.
+        friend bool operator==(const integer& x, const integer& y)
+        {
+            return compare(x, y) == 0;
+        }
+        friend bool operator!=(const integer& x, const integer& y)
+        {
+            return compare(x, y) != 0;
+        }
+        friend bool operator<(const integer& x, const integer& y)
+        {
+            return compare(x, y) < 0;
+        }
+        friend bool operator<=(const integer& x, const integer& y)
+        {
+            return compare(x, y) <= 0;
+        }
+        friend bool operator>(const integer& x, const integer& y)
+        {
+            return compare(x, y) > 0;
+        }
+        friend bool operator>=(const integer& x, const integer& y)
+        {
+            return compare(x, y) >= 0;
+        }
+        // With a machine integer on either side, compared without an integer for it.
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend bool operator==(const integer& x, const T y)
+        {
+            return is_equal_to(x, y);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend bool operator==(const T x, const integer& y)
+        {
+            return is_equal_to(y, x);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend bool operator!=(const integer& x, const T y)
+        {
+            return !is_equal_to(x, y);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend bool operator!=(const T x, const integer& y)
+        {
+            return !is_equal_to(y, x);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend bool operator<(const integer& x, const T y)
+        {
+            return compare(x, y) < 0;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend bool operator<(const T x, const integer& y)
+        {
+            return compare(y, x) > 0;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend bool operator<=(const integer& x, const T y)
+        {
+            return compare(x, y) <= 0;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend bool operator<=(const T x, const integer& y)
+        {
+            return compare(y, x) >= 0;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend bool operator>(const integer& x, const T y)
+        {
+            return compare(x, y) > 0;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend bool operator>(const T x, const integer& y)
+        {
+            return compare(y, x) < 0;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend bool operator>=(const integer& x, const T y)
+        {
+            return compare(x, y) >= 0;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend bool operator>=(const T x, const integer& y)
+        {
+            return compare(y, x) <= 0;
+        }
+        // Arithmetic.
+        friend integer operator+(const integer& x, const integer& y)
+        {
+            return add(x, y);
+        }
+        // A temporary operand lends its digits to the result, which is then computed in place.
+        friend integer operator+(integer&& x, const integer& y)
+        {
+            add_in_place(x, y, false);
+            return std::move(x);
+        }
+        friend integer operator+(const integer& x, integer&& y)
+        {
+            add_in_place(y, x, false);
+            return std::move(y);
+        }
+        friend integer operator+(integer&& x, integer&& y)
+        {
+            add_in_place(x, y, false);
+            return std::move(x);
+        }
+        friend integer operator+(const integer& x)
+        {
+            return x;
+        }
+        friend integer operator+(integer&& x)
+        {
+            return std::move(x);
+        }
+        friend integer& operator+=(integer& x, const integer& y)
+        {
+            add_in_place(x, y, false);
+            return x;
+        }
+        friend integer& operator++(integer& x)
+        {
+            add_in_place(x, one, false);
+            return x;
+        }
+        friend integer operator++(integer& x, int)
+        {
+            integer old = x;
+            add_in_place(x, one, false);
+            return old;
+        }
+        friend integer operator-(const integer& x, const integer& y)
+        {
+            return subtract(x, y);
+        }
+        friend integer operator-(integer&& x, const integer& y)
+        {
+            add_in_place(x, y, true);
+            return std::move(x);
+        }
+        // x - y = -(y - x), here in the digits of y.
+        friend integer operator-(const integer& x, integer&& y)
+        {
+            add_in_place(y, x, true);
+            y.is_negative = !y.is_negative and !y.digits.empty();
+            return std::move(y);
+        }
+        friend integer operator-(integer&& x, integer&& y)
+        {
+            add_in_place(x, y, true);
+            return std::move(x);
+        }
+        friend integer operator-(const integer& x)
+        {
+            return negate(x);
+        }
+        friend integer operator-(integer&& x)
+        {
+            return negate(std::move(x));
+        }
+        friend integer& operator-=(integer& x, const integer& y)
+        {
+            add_in_place(x, y, true);
+            return x;
+        }
+        friend integer& operator--(integer& x)
+        {
+            add_in_place(x, one, true);
+            return x;
+        }
+        friend integer operator--(integer& x, int)
+        {
+            integer old = x;
+            add_in_place(x, one, true);
+            return old;
+        }
+        friend integer operator*(const integer& x, const integer& y)
+        {
+            return multiply(x, y);
+        }
+        friend integer operator*(integer&& x, const integer& y)
+        {
+            multiply_in_place(x, y);
+            return std::move(x);
+        }
+        friend integer operator*(const integer& x, integer&& y)
+        {
+            multiply_in_place(y, x);
+            return std::move(y);
+        }
+        friend integer operator*(integer&& x, integer&& y)
+        {
+            multiply_in_place(x, y);
+            return std::move(x);
+        }
+        friend integer& operator*=(integer& x, const integer& y)
+        {
+            multiply_in_place(x, y);
+            return x;
+        }
+        friend integer operator/(const integer& x, const integer& y)
+        {
+            return divide(x, y).first;
+        }
+        friend integer& operator/=(integer& x, const integer& y)
+        {
+            x = divide(x, y).first;
+            return x;
+        }
+        friend integer operator%(const integer& x, const integer& y)
+        {
+            const auto& yv = y.digits.view();
+            if(yv.size() == 1)
+            {
+                // A remainder of one digit needs no quotient.
+                return from_remainder(mod_digit(x, yv[0]), x.is_negative);
+            }
+            return divide(x, y).second;
+        }
+        friend integer& operator%=(integer& x, const integer& y)
+        {
+            x = x % y;
+            return x;
+        }
+        // Arithmetic with a machine integer, whose digits (one, or two for 64 bits with 32-bit digits) go to the kernels
+        // from the stack: e.g. x * 10 + d builds no integer for 10 or d. The result is formed in a copy of x (the
+        // digits of a temporary), as the carry rarely runs far and a single digit multiplies in place.
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator+(const integer& x, const T y)
+        {
+            integer r = x;
+            r += y;
+            return r;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator+(integer&& x, const T y)
+        {
+            x += y;
+            return std::move(x);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator+(const T x, const integer& y)
+        {
+            return y + x;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator+(const T x, integer&& y)
+        {
+            y += x;
+            return std::move(y);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer& operator+=(integer& x, const T y)
+        {
+            const small_operand<T> v(y);
+            add_in_place(x, v.digits, v.size, v.is_negative);
+            return x;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator-(const integer& x, const T y)
+        {
+            integer r = x;
+            r -= y;
+            return r;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator-(integer&& x, const T y)
+        {
+            x -= y;
+            return std::move(x);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator-(const T x, const integer& y)
+        {
+            return x - integer(y);
+        }
+        // x - y = -(y - x), here in the digits of y.
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator-(const T x, integer&& y)
+        {
+            y -= x;
+            return negate(std::move(y));
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer& operator-=(integer& x, const T y)
+        {
+            const small_operand<T> v(y);
+            add_in_place(x, v.digits, v.size, !v.is_negative);
+            return x;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator*(const integer& x, const T y)
+        {
+            integer r = x;
+            r *= y;
+            return r;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator*(integer&& x, const T y)
+        {
+            x *= y;
+            return std::move(x);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator*(const T x, const integer& y)
+        {
+            return y * x;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator*(const T x, integer&& y)
+        {
+            y *= x;
+            return std::move(y);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer& operator*=(integer& x, const T y)
+        {
+            const small_operand<T> v(y);
+            multiply_in_place(x, v.digits, v.size, v.is_negative);
+            return x;
+        }
+        // Truncated as for integers; a divisor of one digit goes to divide_by_digit() and mod_digit().
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator/(const integer& x, const T y)
+        {
+            const small_operand<T> v(y);
+            if(v.size != 1)
+            {
+                return divide(x, integer(y)).first;
+            }
+            integer quotient = divide_by_digit(x, v.digits[0]).first;
+            return v.is_negative ? negate(std::move(quotient)) : quotient;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer& operator/=(integer& x, const T y)
+        {
+            x = x / y;
+            return x;
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer operator%(const integer& x, const T y)
+        {
+            const small_operand<T> v(y);
+            if(v.size != 1)
+            {
+                return divide(x, integer(y)).second;
+            }
+            return from_remainder(mod_digit(x, v.digits[0]), x.is_negative);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        friend integer& operator%=(integer& x, const T y)
+        {
+            x = x % y;
+            return x;
+        }
+        // Bitwise.
+        friend integer operator&(const integer& x, const integer& y)
+        {
+            return bitwise_and(x, y);
+        }
+        friend integer& operator&=(integer& x, const integer& y)
+        {
+            x = bitwise_and(x, y);
+            return x;
+        }
+        friend integer operator|(const integer& x, const integer& y)
+        {
+            return bitwise_or(x, y);
+        }
+        friend integer& operator|=(integer& x, const integer& y)
+        {
+            x = bitwise_or(x, y);
+            return x;
+        }
+        friend integer operator^(const integer& x, const integer& y)
+        {
+            return bitwise_xor(x, y);
+        }
+        friend integer& operator^=(integer& x, const integer& y)
+        {
+            x = bitwise_xor(x, y);
+            return x;
+        }
+        friend integer operator~(const integer& x)
+        {
+            return bitwise_not(x);
+        }
+        friend integer operator<<(const integer& x, const std::size_t bits)
+        {
+            return shift_left_bits(x, bits);
+        }
+        friend integer& operator<<=(integer& x, const std::size_t bits)
+        {
+            x = shift_left_bits(x, bits);
+            return x;
+        }
+        friend integer operator>>(const integer& x, const std::size_t bits)
+        {
+            return shift_right_bits(x, bits);
+        }
+        friend integer& operator>>=(integer& x, const std::size_t bits)
+        {
+            x = shift_right_bits(x, bits);
+            return x;
+        }
+    private:
+        // Work on the digits directly.
+        friend class montgomery_context;
+#if INTTITAN_IFMA
+        friend class ifma_montgomery_context;
+#endif
+        friend class barrett_reducer;
+        friend class fixed_base_table;
+        friend class polynomial;
+        template<std::size_t Bits>
+        friend class fixed_integer;
+        // A vector of base-2^digit_bits digits (little-endian).
+        integer_digits digits;
+        // Is the integer negative?
+        bool is_negative = false;
+#if INTTITAN_CONSTANT_DIGITS
+        // The one-digit value d > 0 in a constant expression, for the constants.
+        constexpr integer(std::in_place_t, const digit d) : digits(std::in_place, d)
+        {
+        }
+#endif
+        // Contiguous digits produced by the kernels.
+        using digit_buffer = limb_buffer<digit, inline_digits, memory_policy>;
+        // Take over a buffer of digits produced by the kernels, in the canonical form: the kernels' results are mostly
+        // trimmed already, so this reads a digit or two.
+        static integer create_from_buffer(digit_buffer&& buffer, bool is_negative)
+        {
+            buffer.resize(kernels::normalized_size(buffer.data(), buffer.size()));
+            is_negative = is_negative and !buffer.empty();
+            integer x;
+            x.digits = integer_digits(std::move(buffer));
+            x.is_negative = is_negative;
+            return x;
+        }
+        // The operations on magnitudes the integer and view overloads share: x and y are xn and yn limbs without leading
+        // zeroes, and the result takes the sign given, unless it is zero.
+        // -1, 0 or 1 as |x| is less than, equal to or greater than |y|.
+        static int compare_magnitudes(const digit* x, const std::size_t xn, const digit* y, const std::size_t yn)
+        {
+            return xn != yn ? (xn < yn ? -1 : 1) : kernels::compare(x, y, xn);
+        }
+        // |x| + |y|.
+        static integer add_magnitudes(const digit* x, const std::size_t xn, const digit* y, const std::size_t yn, const bool is_negative)
+        {
+            if(xn < yn)
+            {
+                // The kernel expects the longer operand first.
+                return add_magnitudes(y, yn, x, xn, is_negative);
+            }
+            statistics::count(operation::add, xn, yn);
+            digit_buffer result;
+            if(xn > inline_digits)
+            {
+                result.reserve(xn + 1); // Room for the carry, so it never reallocates.
+            }
+            // A sum of inline operands stays inline unless the carry spills it.
+            result.resize(xn);
+            const digit carry = kernels::add(result.mutable_data(), x, xn, y, yn);
+            if(carry != 0)
+            {
+                result.push_back(carry);
+            }
+            return create_from_buffer(std::move(result), is_negative and !result.empty());
+        }
+        // |x| - |y| for |x| >= |y|, so there is no borrow out of the top.
+        static integer subtract_magnitudes(const digit* x, const std::size_t xn, const digit* y, const std::size_t yn, const bool is_negative)
+        {
+            statistics::count(operation::subtract, xn, yn);
+            digit_buffer result(xn);
+            digit* r = result.mutable_data();
+            kernels::subtract(r, x, xn, y, yn);
+            result.resize(kernels::normalized_size(r, xn));
+            return create_from_buffer(std::move(result), is_negative and !result.empty());
+        }
+        // x + y for signed magnitudes: a sum when the signs agree, else the difference of the larger and the smaller, which
+        // one comparison of the magnitudes picks (from the numbers of limbs alone, unless they are equal).
+        static integer sum_of(const digit* x, const std::size_t xn, const bool x_negative, const digit* y, const std::size_t yn, const bool y_negative)
+        {
+            if(x_negative == y_negative)
+            {
+                return add_magnitudes(x, xn, y, yn, x_negative);
+            }
+            // The same digits (x - x) are equal without a scan.
+            const int comparison = x == y and xn == yn ? 0 : compare_magnitudes(x, xn, y, yn);
+            if(comparison == 0)
+            {
+                return integer();
+            }
+            return comparison > 0 ? subtract_magnitudes(x, xn, y, yn, x_negative) : subtract_magnitudes(y, yn, x, xn, y_negative);
+        }
+        // |x| * |y| for xn >= yn (the kernels are somewhat faster with the smaller number on the right).
+        static integer product_of(const digit* x, const std::size_t xn, const digit* y, const std::size_t yn, const bool is_negative)
+        {
+            statistics::count(operation::multiply, xn, yn);
+            // A single digit (as from a machine integer) takes one pass of the kernel, without the dispatch to a basecase.
+            if(yn == 1)
+            {
+                digit_buffer result;
+                if(xn > inline_digits)
+                {
+                    result.reserve(xn + 1);
+                }
+                // Inline digits stay inline unless the carry spills them, as in a sum.
+                result.resize(xn);
+                const digit carry = kernels::multiply_by_digit(result.mutable_data(), x, xn, y[0]);
+                if(carry != 0)
+                {
+                    result.push_back(carry);
+                }
+                return create_from_buffer(std::move(result), is_negative);
+            }
+            // Fast path: inline operands are multiplied on the stack and the product allocates at most once.
+            if(xn <= inline_digits)
+            {
+                digit product[2 * inline_digits + 1];
+                kernels::multiply_basecase(product, x, xn, y, yn);
+                const std::size_t n = kernels::normalized_size(product, xn + yn);
+                return create_from_buffer(digit_buffer(product, product + n), is_negative);
+            }
+            digit_buffer result(xn + yn);
+            digit* r = result.mutable_data();
+            kernels::multiply(r, x, xn, y, yn);
+            result.resize(kernels::normalized_size(r, result.size()));
+            return create_from_buffer(std::move(result), is_negative);
+        }
+        // |x|^2.
+        static integer square_of(const digit* x, const std::size_t xn)
+        {
+            statistics::count(operation::square, xn);
+            if(xn <= inline_digits)
+            {
+                digit product[2 * inline_digits + 1];
+                kernels::square_basecase(product, x, xn);
+                const std::size_t n = kernels::normalized_size(product, 2 * xn);
+                return create_from_buffer(digit_buffer(product, product + n), false);
+            }
+            digit_buffer result(2 * xn);
+            digit* r = result.mutable_data();
+            kernels::square(r, x, xn);
+            result.resize(kernels::normalized_size(r, result.size()));
+            return create_from_buffer(std::move(result), false);
+        }
+        // Number of digits a machine integer type needs.
+        template<typename T>
+        static constexpr std::size_t machine_digits = (sizeof(T) * CHAR_BIT + digit_bits - 1) / digit_bits;
+        // A machine integer as the digits of its magnitude, on the stack, for the kernels.
+        template<typename T>
+        struct small_operand
+        {
+            digit digits[machine_digits<T>];
+            bool is_negative = false;
+            std::size_t size;
+            explicit small_operand(const T value) : size(magnitude_digits(value, digits, is_negative))
+            {
+            }
+        };
+        // x rounded to the floating-point type F: its top digits_of_F + 1 bits, the lowest one for rounding, and a sticky
+        // bit for the others.
+        template<typename F>
+        static F to_floating(const integer& x)
+        {
+            constexpr std::size_t precision = std::numeric_limits<F>::digits;
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            const std::size_t bits = xn == 0 ? 0 : xn * digit_bits - kernels::leading_zeros(xv[xn - 1]);
+            const F sign = x.is_negative ? F(-1) : F(1);
+            if(bits == 0)
+            {
+                return F(0);
+            }
+            if(bits > static_cast<std::size_t>(std::numeric_limits<F>::max_exponent))
+            {
+                return sign * std::numeric_limits<F>::infinity();
+            }
+            const std::size_t kept = std::min(bits, precision + 1);
+            const std::size_t shift = bits - kept;
+            const std::size_t skipped = shift / digit_bits;
+            // The kept bits, then a digit for the carry of the rounding.
+            digit m[(precision + 1) / digit_bits + 3] = {};
+            const std::size_t mn = xn - skipped;
+            const bool sticky = kernels::shift_right_bits(m, xv.data() + skipped, mn, static_cast<int>(shift % digit_bits)) != 0 or kernels::normalized_size(xv.data(), skipped) != 0;
+            int exponent = static_cast<int>(shift);
+            if(kept > precision)
+            {
+                const bool round = (m[0] & 1) != 0;
+                kernels::shift_right_bits(m, m, mn, 1);
+                exponent++;
+                if(round and (sticky or (m[0] & 1) != 0))
+                {
+                    const digit unit = 1;
+                    m[mn] = kernels::add(m, m, mn, &unit, 1);
+                }
+            }
+            // At most 2^precision, so each of the partial sums is exact.
+            F r = 0;
+            for(std::size_t i = mn + 1; i-- != 0;)
+            {
+                r = std::ldexp(r, digit_bits) + static_cast<F>(m[i]);
+            }
+            return sign * std::ldexp(r, exponent);
+        }
+        // The integer part of value, a digit at a time from the top: each is the integer part of the rest, scaled, which
+        // is exact.
+        template<typename F>
+        static integer from_floating(const F value)
+        {
+            if(!std::isfinite(value))
+            {
+                throw std::invalid_argument("Conversion of an infinity or NaN to an integer impermissible.");
+            }
+            const F magnitude = std::trunc(std::fabs(value));
+            if(magnitude < F(1))
+            {
+                return zero;
+            }
+            int exponent;
+            std::frexp(magnitude, &exponent);
+            const std::size_t n = (static_cast<std::size_t>(exponent) + digit_bits - 1) / digit_bits;
+            digit_buffer result(n);
+            digit* r = result.mutable_data();
+            F rest = std::ldexp(magnitude, -static_cast<int>((n - 1) * digit_bits));
+            for(std::size_t i = n; i-- != 0;)
+            {
+                r[i] = static_cast<digit>(rest);
+                rest = std::ldexp(rest - static_cast<F>(r[i]), digit_bits);
+            }
+            return create_from_buffer(std::move(result), value < 0);
+        }
+        // |x| into magnitude, if x is in the range of T.
+        template<typename T>
+        static bool machine_magnitude(const integer& x, machine_unsigned_t<T>& magnitude)
+        {
+            using magnitude_type = machine_unsigned_t<T>;
+            constexpr std::size_t bits = sizeof(T) * CHAR_BIT;
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            if(xn > machine_digits<T>)
+            {
+                return false;
+            }
+            if constexpr(bits < digit_bits)
+            {
+                if(xn != 0 and xv[0] >> bits != 0)
+                {
+                    return false;
+                }
+            }
+            magnitude = 0;
+            for(std::size_t i = xn; i-- != 0;)
+            {
+                if constexpr(bits > digit_bits)
+                {
+                    magnitude <<= digit_bits;
+                }
+                magnitude |= static_cast<magnitude_type>(xv[i]);
+            }
+            const bool negative = x.is_negative and xn != 0;
+            if constexpr(machine_integer_traits<T>::is_signed)
+            {
+                // Up to 2^(bits - 1) - 1, and 2^(bits - 1) for negative values.
+                return magnitude <= static_cast<magnitude_type>((magnitude_type(~magnitude_type(0)) >> 1) + (negative ? 1 : 0));
+            }
+            else
+            {
+                return !negative;
+            }
+        }
+        // The digits of |value| into d (machine_digits<T> of them), returns their number without leading zeroes.
+        template<typename T>
+        static std::size_t magnitude_digits(const T value, digit* d, bool& negative)
+        {
+            using magnitude_type = machine_unsigned_t<T>;
+            magnitude_type magnitude = static_cast<magnitude_type>(value);
+            negative = false;
+            if constexpr(machine_integer_traits<T>::is_signed)
+            {
+                negative = value < 0;
+                magnitude = negative ? static_cast<magnitude_type>(magnitude_type(0) - magnitude) : magnitude;
+            }
+            std::size_t n = 0;
+            while(magnitude != 0)
+            {
+                d[n++] = static_cast<digit>(magnitude);
+                if constexpr(sizeof(T) * CHAR_BIT > digit_bits)
+                {
+                    magnitude >>= digit_bits;
+                }
+                else
+                {
+                    magnitude = 0;
+                }
+            }
+            return n;
+        }
+        // The low n digits of x in two's complement, ~(|x| - 1) for negative x. n is at least the size of x. Returns
+        // whether x is negative (and not zero).
+        static bool twos_complement(digit* r, const integer& x, const std::size_t n)
+        {
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            std::copy(xv.begin(), xv.begin() + xn, r);
+            std::fill(r + xn, r + n, digit(0));
+            if(x.is_negative and xn != 0)
+            {
+                const digit unit = 1;
+                kernels::subtract(r, r, n, &unit, 1);
+                for(std::size_t i = 0; i < n; i++)
+                {
+                    r[i] = ~r[i];
+                }
+                return true;
+            }
+            return false;
+        }
+        // op applied to each digit of x and y in two's complement. The digits above both are those of the signs (all
+        // zeroes or all ones), so their op tells the sign of the result.
+        template<typename Op>
+        static integer bitwise(const integer& x, const integer& y, Op op)
+        {
+            const std::size_t n = std::max(x.digits.size(), y.digits.size());
+            const kernels::scratch_buffer<> memory(2 * n);
+            digit* a = memory.get();
+            digit* b = a + n;
+            const bool x_negative = twos_complement(a, x, n);
+            const bool y_negative = twos_complement(b, y, n);
+            const bool is_negative = op(x_negative ? max_digit : 0, y_negative ? max_digit : 0) != 0;
+            digit_buffer result(n + 1);
+            digit* r = result.mutable_data();
+            for(std::size_t i = 0; i < n; i++)
+            {
+                r[i] = op(a[i], b[i]);
+            }
+            if(is_negative)
+            {
+                // r is the two's complement of the result, whose magnitude is ~r + 1.
+                for(std::size_t i = 0; i < n; i++)
+                {
+                    r[i] = ~r[i];
+                }
+                const digit unit = 1;
+                r[n] = kernels::add(r, r, n, &unit, 1);
+            }
+            result.resize(kernels::normalized_size(r, n + 1));
+            return create_from_buffer(std::move(result), is_negative and !result.empty());
+        }
+        // x mod m (m positive, of n digits) in n digits, non-negative.
+        static digit_buffer residue(const integer& x, const integer& m, const std::size_t n)
+        {
+            integer reduced = x % m;
+            if(reduced.is_negative)
+            {
+                reduced += m;
+            }
+            const auto& rv = reduced.digits.view();
+            digit_buffer value(n);
+            std::copy(rv.begin(), rv.begin() + std::min(rv.size(), n), value.mutable_data());
+            return value;
+        }
+        // x = x + y (or x - y when subtract_y), reusing the digits of x. Its memory only grows for a carry out of the top
+        // or a longer y, and is copied only if it is shared with another integer.
+        static void add_in_place(integer& x, const integer& y, const bool subtract_y)
+        {
+            if(&x == &y)
+            {
+                // The limbs of y must not change under the kernels.
+                const integer copy = y;
+                add_in_place(x, copy, subtract_y);
+                return;
+            }
+            const auto& yv = y.digits.view();
+            add_in_place(x, yv.data(), yv.size(), y.is_negative != subtract_y);
+        }
+        // x = x + y for the limbs y (negative if y_negative), which must not be in x.
+        static void add_in_place(integer& x, const digit* y, const std::size_t yn, const bool y_negative)
+        {
+#if INTTITAN_FLEX_VECTOR_STORAGE
+            // The persistent tree is never written in place, so the sum is formed in a contiguous copy of x.
+            const auto& xv = x.digits.view();
+            digit_buffer r(xv.begin(), xv.end());
+            add_magnitude(r, x.is_negative, y, yn, y_negative);
+            x.digits = integer_digits(r);
+#else
+            add_magnitude(x.digits, x.is_negative, y, yn, y_negative);
+#endif
+        }
+        // r = r + y with signs, where y is not in r. The sign of r is updated too.
+        static void add_magnitude(digit_buffer& r, bool& is_negative, const digit* y, const std::size_t yn, const bool y_negative)
+        {
+            const std::size_t rn = r.size();
+            statistics::count(is_negative == y_negative ? operation::add : operation::subtract, std::max(rn, yn), std::min(rn, yn));
+            if(is_negative == y_negative)
+            {
+                if(yn > rn)
+                {
+                    r.resize(yn);
+                }
+                digit* rd = r.mutable_data();
+                const digit carry = kernels::add(rd, rd, r.size(), y, yn);
+                if(carry != 0)
+                {
+                    r.push_back(carry);
+                }
+                return;
+            }
+            // Opposite signs: the smaller magnitude is taken from the larger one, which gives the sign.
+            if(kernels::compare(r.data(), rn, y, yn) >= 0)
+            {
+                digit* rd = r.mutable_data();
+                kernels::subtract(rd, rd, rn, y, yn);
+            }
+            else
+            {
+                r.resize(yn);
+                digit* rd = r.mutable_data();
+                kernels::subtract(rd, y, yn, rd, rn);
+                is_negative = y_negative;
+            }
+            r.resize(kernels::normalized_size(r.data(), r.size()));
+            is_negative = is_negative and !r.empty();
+        }
+        // |x * y|, normalized.
+        static digit_buffer multiply_magnitudes(const integer& x, const integer& y)
+        {
+            const auto& xv = x.digits.view();
+            const auto& yv = y.digits.view();
+            const auto& longer = xv.size() >= yv.size() ? xv : yv;
+            const auto& shorter = xv.size() >= yv.size() ? yv : xv;
+            if(shorter.empty())
+            {
+                return digit_buffer();
+            }
+            statistics::count(operation::multiply, longer.size(), shorter.size());
+            digit_buffer product(longer.size() + shorter.size());
+            digit* p = product.mutable_data();
+            kernels::multiply(p, longer.data(), longer.size(), shorter.data(), shorter.size());
+            product.resize(kernels::normalized_size(p, product.size()));
+            return product;
+        }
+        // r = r + x * y (or r - x * y when subtract_product). r may be x or y, since the product is formed first.
+        static void add_product(integer& r, const integer& x, const integer& y, const bool subtract_product)
+        {
+            const digit_buffer product = multiply_magnitudes(x, y);
+            add_in_place(r, product.data(), product.size(), (x.is_negative xor y.is_negative) != subtract_product);
+        }
+        // x = x * y. A single-digit y is multiplied into the digits of x in place, otherwise the product (which needs
+        // memory of its own) replaces them.
+        static void multiply_in_place(integer& x, const integer& y)
+        {
+            const auto& yv = y.digits.view();
+            if(yv.size() == 1)
+            {
+                multiply_in_place(x, yv.data(), 1, y.is_negative);
+                return;
+            }
+            x = multiply(x, y);
+        }
+        // x = x * y for the limbs y (negative if y_negative).
+        static void multiply_in_place(integer& x, const digit* y, const std::size_t yn, const bool y_negative)
+        {
+            const bool is_negative = x.is_negative xor y_negative;
+#if !INTTITAN_FLEX_VECTOR_STORAGE
+            if(yn == 1)
+            {
+                // Read before the digits of x are written, which y may be.
+                const digit d = y[0];
+                statistics::count(operation::multiply, x.digits.size(), 1);
+                digit* r = x.digits.mutable_data();
+                const digit carry = kernels::multiply_by_digit(r, r, x.digits.size(), d);
+                if(carry != 0)
+                {
+                    x.digits.push_back(carry);
+                }
+                x.is_negative = is_negative and !x.digits.empty();
+                return;
+            }
+#endif
+            const auto& xv = x.digits.view();
+            x = xv.size() >= yn ? product_of(xv.data(), xv.size(), y, yn, is_negative) : product_of(y, yn, xv.data(), xv.size(), is_negative);
+        }
+        // The matrix of the steps of a GCD, see the definition below.
+        struct gcd_matrix;
+        // Steps of Euclid on a pair a >= b >= 0, which keep it in order, with their matrix multiplied into m (from the
+        // left) when it is not nullptr. Division: (a, b) = (b, a mod b).
+        static void gcd_division_step(integer& a, integer& b, gcd_matrix* m);
+        // m = t m.
+        static void gcd_multiply(const gcd_matrix& t, gcd_matrix& m);
+        // Lehmer and division steps by the kernels until b has at most the given number of bits.
+        static void gcd_reduce(integer& a, integer& b, std::size_t bits, gcd_matrix* m);
+        // The matrix t of the steps on the top bits of the pair, applied to all of it.
+        static void gcd_apply(integer& a, integer& b, const gcd_matrix& t, gcd_matrix* m);
+        // Steps until b has at most half the bits of a, plus one.
+        static void half_gcd(integer& a, integer& b, gcd_matrix* m);
+        // An integer of a single digit.
+        static integer from_digit(const digit d)
+        {
+            return d == 0 ? zero : create_from_buffer(digit_buffer(&d, &d + 1), false);
+        }
+        // The remainder of one digit, with the sign of the dividend as for %.
+        static integer from_remainder(const digit r, const bool is_negative)
+        {
+            return r == 0 ? zero : create_from_buffer(digit_buffer(&r, &r + 1), is_negative);
+        }
+        // The value of at most two digits.
+        static superdigit to_superdigit(const integer& x)
+        {
+            const auto& xv = x.digits.view();
+            superdigit n = 0;
+            for(std::size_t i = xv.size(); i-- != 0;)
+            {
+                n = (n << digit_bits) | xv[i];
+            }
+            return n;
+        }
+        static integer from_superdigit(const superdigit n)
+        {
+            const digit d[2] = {static_cast<digit>(n), static_cast<digit>(n >> digit_bits)};
+            return create_from_buffer(digit_buffer(d, d + kernels::normalized_size(d, 2)), false);
+        }
+        // |x| mod 2^bits.
+        static integer low_bits(const integer& x, const std::size_t bits)
+        {
+            const auto& xv = x.digits.view();
+            const std::size_t n = std::min(xv.size(), (bits + digit_bits - 1) / digit_bits);
+            digit_buffer r(xv.begin(), xv.begin() + n);
+            if(n * digit_bits > bits)
+            {
+                r.mutable_data()[n - 1] &= (digit(1) << (bits % digit_bits)) - 1;
+            }
+            r.resize(kernels::normalized_size(r.data(), n));
+            return create_from_buffer(std::move(r), false);
+        }
+        // floor(x^(1/k)) for x >= 0 and k >= 3.
+        static integer root(const integer& x, unsigned k);
+        // The tests of is_probable_prime() after trial division, for an odd x above 2^32.
+        struct prime_test;
+        static bool probable_prime_tests(const integer& x, unsigned rounds);
+        // s = floor(sqrt(x)) and r = x - s^2 for x >= 0.
+        static void square_root(const integer& x, integer& s, integer& r);
+        // Get value of a digit character (e.g. value of '0' is 0, value of 'D' is 13), or -1 for other characters.
+        static int get_digit_character_value(char d)
+        {
+            d = static_cast<char>(std::tolower(static_cast<unsigned char>(d)));
+            if(d >= '0' and d <= '9')
+            {
+                return d - '0';
+            }
+            if(d >= 'a' and d <= 'z')
+            {
+                return 10 + d - 'a';
+            }
+            return -1;
+        }
+        // Get digit character for value.
+        static char get_digit_character(const int value, const bool uppercase = true)
+        {
+            assert(value < (1 + '9' - '0') + (1 + 'Z' - 'A'));
+            if(value < 10)
+            {
+                return static_cast<char>('0' + value);
+            }
+            char a = uppercase ? 'A' : 'a';
+            return static_cast<char>(a + value - 10);
+        }
+        // Throws unless the base is between 2 and 36.
+        static void check_base(const int base)
+        {
+            if(base < 2 or base > 36)
+            {
+                throw std::invalid_argument("Base must be between 2 and 36.");
+            }
+        }
+        // Read integers from strings.
+        static integer_digits digits_from_string(const std::string_view str, const int base)
+        {
+            check_base(base);
+            if(base == 16)
+            {
+                digit_buffer result((str.size() + kernels::hex_limb_characters - 1) / kernels::hex_limb_characters);
+                digit* r = result.mutable_data();
+                if(!kernels::from_hex(r, str.data(), str.size()))
+                {
+                    throw std::invalid_argument("Invalid digit for the base.");
+                }
+                result.resize(kernels::normalized_size(r, result.size()));
+                return integer_digits(std::move(result));
+            }
+            // The kernels take the values of the digits.
+            const kernels::scratch_buffer<unsigned char> values(str.size());
+            for(std::size_t i = 0; i < str.size(); i++)
+            {
+                const int value = kernels::radix_values.values[static_cast<unsigned char>(str[i])];
+                if(value < 0 or value >= base)
+                {
+                    throw std::invalid_argument("Invalid digit for the base.");
+                }
+                values.get()[i] = static_cast<unsigned char>(value);
+            }
+            digit_buffer result(kernels::radix_limbs(str.size(), base));
+            const std::size_t n = kernels::from_radix(result.mutable_data(), values.get(), str.size(), base);
+            result.resize(n);
+            return integer_digits(std::move(result));
+        }
+        // Characters write_characters() writes for n limbs.
+        static std::size_t digit_characters(const std::size_t n, const int base)
+        {
+            return base == 16 ? kernels::hex_limb_characters * n : kernels::radix_digits(n, base);
+        }
+        // Write the digit_characters(n) characters of the n limbs x (n > 0) in the base into s, leading zeroes included,
+        // and return the number of those (fewer than all).
+        static std::size_t write_characters(char* s, const digit* x, const std::size_t n, const int base, const bool uppercase)
+        {
+            const std::size_t count = digit_characters(n, base);
+            if(base == 16)
+            {
+                kernels::to_hex(s, x, n, uppercase);
+                return static_cast<std::size_t>(std::find_if(s, s + count, [](const char c) { return c != '0'; }) - s);
+            }
+            unsigned char* values = reinterpret_cast<unsigned char*>(s);
+            kernels::to_radix(values, x, n, count, base);
+            const std::size_t zeroes = static_cast<std::size_t>(std::find_if(values, values + count, [](const unsigned char v) { return v != 0; }) - values);
+            for(std::size_t i = zeroes; i < count; i++)
+            {
+                s[i] = get_digit_character(values[i], uppercase);
+            }
+            return zeroes;
+        }
+        // Convert integers to strings.
+        static std::string string_from_integer(const integer& x, const int base, const bool uppercase = true)
+        {
+            check_base(base);
+            const auto& xv = x.digits.view();
+            const std::size_t n = xv.size();
+            if(n == 0)
+            {
+                return "0";
+            }
+            // Written after the room for the sign, then the leading 0s are removed.
+            const std::size_t sign = x.is_negative ? 1 : 0;
+            std::string str(sign + digit_characters(n, base), '-');
+            str.erase(sign, write_characters(str.data() + sign, xv.data(), n, base, uppercase));
+            return str;
+        }
+        // Convert integers to characters in [first, last), see to_chars(). With the room for the leading zeroes of
+        // write_characters() they are written in place and moved down, else powers of two take exactly their digits,
+        // and other bases a string.
+        static std::to_chars_result chars_from_integer(char* first, char* last, const integer& x, const int base, const bool uppercase)
+        {
+            const std::size_t length = to_chars_length(x, base);
+            const std::size_t room = static_cast<std::size_t>(last - first);
+            const auto& xv = x.digits.view();
+            const std::size_t n = xv.size();
+            if(n == 0)
+            {
+                if(room == 0)
+                {
+                    return {last, std::errc::value_too_large};
+                }
+                *first = '0';
+                return {first + 1, std::errc()};
+            }
+            const std::size_t sign = x.is_negative ? 1 : 0;
+            if(room >= sign + digit_characters(n, base))
+            {
+                if(sign != 0)
+                {
+                    *first = '-';
+                }
+                const std::size_t zeroes = write_characters(first + sign, xv.data(), n, base, uppercase);
+                const std::size_t end = sign + digit_characters(n, base);
+                std::copy(first + sign + zeroes, first + end, first + sign);
+                return {first + end - zeroes, std::errc()};
+            }
+            if(kernels::radix_bits(base) != 0)
+            {
+                if(room < length)
+                {
+                    return {last, std::errc::value_too_large};
+                }
+                if(sign != 0)
+                {
+                    *first = '-';
+                }
+                unsigned char* values = reinterpret_cast<unsigned char*>(first + sign);
+                kernels::to_radix_power_of_two(values, xv.data(), n, length - sign, kernels::radix_bits(base));
+                for(std::size_t i = 0; i < length - sign; i++)
+                {
+                    first[sign + i] = get_digit_character(values[i], uppercase);
+                }
+                return {first + length, std::errc()};
+            }
+            const std::string str = string_from_integer(x, base, uppercase);
+            if(str.size() > room)
+            {
+                return {last, std::errc::value_too_large};
+            }
+            return {std::copy(str.begin(), str.end(), first), std::errc()};
+        }
+        // The base of the basefield of stream flags: 16 for std::hex, 8 for std::oct, else 10.
+        static int stream_base(const std::ios_base::fmtflags flags)
+        {
+            const std::ios_base::fmtflags field = flags & std::ios_base::basefield;
+            return field == std::ios_base::hex ? 16 : field == std::ios_base::oct ? 8 : 10;
+        }
+        // parse_stream() in the base, or, with prefixed, as operator>> of int reads: a "0x" or "0X" after the sign is
+        // skipped in base 16, and base 0 is that of the prefix ("0x" 16, "0" 8, else 10).
+        static integer integer_from_istream(std::istream& in, int base, const bool prefixed)
+        {
+            const std::istream::sentry sentry(in);
+            if(!sentry)
+            {
+                throw std::invalid_argument("No integer in the stream.");
+            }
+            std::streambuf& buffer = *in.rdbuf();
+            bool is_negative = false;
+            const int c = buffer.sgetc();
+            if(c == '-' or c == '+')
+            {
+                is_negative = c == '-';
+                buffer.sbumpc();
+            }
+            // A zero read as part of a prefix, which is the value if no digits follow (but not after a 0x).
+            bool zero = false;
+            if(prefixed and (base == 16 or base == 0) and buffer.sgetc() == '0')
+            {
+                zero = true;
+                const int next = buffer.snextc();
+                if(next == 'x' or next == 'X')
+                {
+                    buffer.sbumpc();
+                    base = 16;
+                    zero = false;
+                }
+                else if(base == 0)
+                {
+                    base = 8;
+                }
+            }
+            else if(base == 0)
+            {
+                base = 10;
+            }
+            const int first = buffer.sgetc();
+            const int value = first == std::char_traits<char>::eof() ? -1 : kernels::radix_values.values[first];
+            if(zero and (value < 0 or value >= base))
+            {
+                if(first == std::char_traits<char>::eof())
+                {
+                    in.setstate(std::ios_base::eofbit);
+                }
+                return integer();
+            }
+            if(value < 0 or value >= base)
+            {
+                in.setstate(first == std::char_traits<char>::eof() ? std::ios_base::failbit | std::ios_base::eofbit : std::ios_base::failbit);
+                throw std::invalid_argument("Invalid digit for the base.");
+            }
+            integer x = kernels::radix_bits(base) != 0 ? power_of_two_integer_from_stream(buffer, base) : integer_from_stream(buffer, base);
+            if(buffer.sgetc() == std::char_traits<char>::eof())
+            {
+                in.setstate(std::ios_base::eofbit);
+            }
+            x.is_negative = is_negative and !x.digits.empty();
+            return x;
+        }
+        // Characters in memory at a time while streaming, a multiple of digit_bits so that the digits of a power of
+        // two base fill whole limbs.
+        static constexpr std::size_t stream_characters = std::size_t(1) << 16;
+        // Read up to size digits of the base from buffer into s and return their number. Stops before the first other
+        // character.
+        static std::size_t read_stream_digits(std::streambuf& buffer, char* s, const std::size_t size, const int base)
+        {
+            std::size_t count = 0;
+            for(int c = buffer.sgetc(); count < size; c = buffer.snextc())
+            {
+                if(c == std::char_traits<char>::eof())
+                {
+                    break;
+                }
+                const int value = kernels::radix_values.values[c];
+                if(value < 0 or value >= base)
+                {
+                    break;
+                }
+                s[count++] = static_cast<char>(c);
+            }
+            return count;
+        }
+        // r = the value of the count digit characters at s (valid for the base), radix_limbs(count) limbs of it. The
+        // characters are overwritten.
+        static void decode_stream_digits(digit* r, char* s, const std::size_t count, const int base)
+        {
+            if(base == 16)
+            {
+                kernels::from_hex(r, s, count);
+                return;
+            }
+            for(std::size_t i = 0; i < count; i++)
+            {
+                s[i] = static_cast<char>(kernels::radix_values.values[static_cast<unsigned char>(s[i])]);
+            }
+            kernels::from_radix(r, reinterpret_cast<const unsigned char*>(s), count, base);
+        }
+        // The digits of a power of two base from a stream: the blocks of stream_characters of them fill whole limbs, so
+        // they are decoded as they come, the most significant first, and put the other way round at the end; the value
+        // of the few digits after them is shifted in below.
+        static integer power_of_two_integer_from_stream(std::streambuf& buffer, const int base)
+        {
+            const int bits = kernels::radix_bits(base);
+            const std::size_t block_limbs = stream_characters * bits / digit_bits;
+            std::string s(stream_characters, '\0');
+            digit_buffer blocks;
+            std::size_t count;
+            while((count = read_stream_digits(buffer, s.data(), stream_characters, base)) == stream_characters)
+            {
+                const std::size_t m = blocks.size();
+                blocks.resize(m + block_limbs);
+                decode_stream_digits(blocks.mutable_data() + m, s.data(), count, base);
+            }
+            digit* b = blocks.mutable_data();
+            const std::size_t m = blocks.size() / block_limbs;
+            for(std::size_t i = 0; i < m / 2; i++)
+            {
+                std::swap_ranges(b + i * block_limbs, b + (i + 1) * block_limbs, b + (m - 1 - i) * block_limbs);
+            }
+            const std::size_t tail_bits = count * bits;
+            digit_buffer result(kernels::radix_limbs(count, base) + blocks.size() + 1);
+            digit* r = result.mutable_data();
+            r[tail_bits / digit_bits + blocks.size()] = kernels::shift_left_bits(r + tail_bits / digit_bits, b, blocks.size(), static_cast<int>(tail_bits % digit_bits));
+            blocks = digit_buffer();
+            // The value of the last digits is below 2^tail_bits, under the blocks.
+            const kernels::scratch_buffer<> low(kernels::radix_limbs(count, base));
+            decode_stream_digits(low.get(), s.data(), count, base);
+            for(std::size_t i = 0; i < kernels::radix_limbs(count, base); i++)
+            {
+                r[i] |= low.get()[i];
+            }
+            result.resize(kernels::normalized_size(r, result.size()));
+            return create_from_buffer(std::move(result), false);
+        }
+        // The value of the count digit characters at s.
+        static integer integer_from_stream_digits(char* s, const std::size_t count, const int base)
+        {
+            digit_buffer result(kernels::radix_limbs(count, base));
+            decode_stream_digits(result.mutable_data(), s, count, base);
+            result.resize(kernels::normalized_size(result.data(), result.size()));
+            return create_from_buffer(std::move(result), false);
+        }
+        // The digits of any other base from a stream, in blocks of chunk.length * 2^j of them, about stream_characters
+        // digits. As in a binary counter, two values of 2^k blocks in a row become one of 2^(k + 1), the first times
+        // chunk.value^(2^(j + k)) (from the power_table) plus the second, so the multiplications are as balanced as in
+        // create(). At the end the values left and the digits after them are joined from the most significant.
+        static integer integer_from_stream(std::streambuf& buffer, const int base)
+        {
+            const kernels::radix_chunk chunk(base);
+            std::size_t j = 0;
+            while((static_cast<std::size_t>(chunk.length) << (j + 1)) <= stream_characters)
+            {
+                j++;
+            }
+            const std::size_t block = static_cast<std::size_t>(chunk.length) << j;
+            const auto power = [&](const std::size_t k)
+            {
+                const power_table::power p = power_table::get(chunk.value, j + k);
+                return create_from_buffer(digit_buffer(p.limbs, p.limbs + p.size), false);
+            };
+            // The values of 2^level blocks each, the levels decreasing.
+            struct part
+            {
+                integer value;
+                std::size_t level;
+            };
+            std::vector<part> parts;
+            std::string s(block, '\0');
+            std::size_t count;
+            while((count = read_stream_digits(buffer, s.data(), block, base)) == block)
+            {
+                part p{integer_from_stream_digits(s.data(), count, base), 0};
+                for(; !parts.empty() and parts.back().level == p.level; p.level++)
+                {
+                    p.value += parts.back().value * power(p.level);
+                    parts.pop_back();
+                }
+                parts.push_back(std::move(p));
+            }
+            integer x;
+            for(part& p : parts)
+            {
+                x = x * power(p.level);
+                x += p.value;
+                p.value = integer();
+            }
+            if(count != 0)
+            {
+                x = x * pow(from_digit(static_cast<digit>(base)), count);
+                x += integer_from_stream_digits(s.data(), count, base);
+            }
+            return x;
+        }
+        // The characters of the n limbs x (n > 0) in the base, without the leading zeroes.
+        static void magnitude_to_stream(std::ostream& out, const digit* x, const std::size_t n, const int base, const bool uppercase)
+        {
+            if(base == 16)
+            {
+                hex_to_stream(out, x, n, uppercase);
+                return;
+            }
+            std::string piece(stream_characters, '\0');
+            bool started = false;
+            // Digits into characters, without the leading zeroes.
+            auto write = [&](const unsigned char* s, std::size_t k)
+            {
+                for(; !started and k != 0 and *s == 0; s++, k--)
+                {
+                }
+                started = started or k != 0;
+                char* characters = piece.data();
+                for(std::size_t i = 0; i < k; i++)
+                {
+                    characters[i] = get_digit_character(s[i], uppercase);
+                }
+                out.write(characters, static_cast<std::streamsize>(k));
+            };
+            std::string digits(stream_characters, '\0');
+            unsigned char* values = reinterpret_cast<unsigned char*>(digits.data());
+            const int bits = kernels::radix_bits(base);
+            if(bits != 0)
+            {
+                // Pieces of whole limbs, from the top.
+                const std::size_t count = kernels::radix_digits(n, base);
+                for(std::size_t end = count; end != 0;)
+                {
+                    const std::size_t start = (end - 1) / stream_characters * stream_characters;
+                    const std::size_t limb = start * bits / digit_bits;
+                    kernels::to_radix_power_of_two(values, x + limb, n - limb, end - start, bits);
+                    write(values, end - start);
+                    end = start;
+                }
+                return;
+            }
+            const kernels::radix_chunk chunk(base);
+            const kernels::radix_powers powers(chunk, n / 2);
+            kernels::to_radix_pieces(x, n, kernels::radix_digits(n, base), base, powers, stream_characters, values, write);
+        }
+        // Hex characters of the n limbs x, the top limbs first, without the leading zeroes.
+        static void hex_to_stream(std::ostream& out, const digit* x, const std::size_t n, const bool uppercase)
+        {
+            constexpr std::size_t limbs = stream_characters / kernels::hex_limb_characters;
+            std::string s(stream_characters, '\0');
+            for(std::size_t end = n; end != 0;)
+            {
+                const std::size_t start = (end - 1) / limbs * limbs;
+                kernels::to_hex(s.data(), x + start, end - start, uppercase);
+                const std::size_t skipped = end == n ? s.find_first_not_of('0') : 0;
+                out.write(s.data() + skipped, static_cast<std::streamsize>(kernels::hex_limb_characters * (end - start) - skipped));
+                end = start;
+            }
+        }
+    };
+    // Arithmetic modulo a fixed odd m in the Montgomery form, for many multiplications by the same modulus (e.g.
+    // exponentiation). The values are arrays of size() limbs below m, converted with to_mont() and back with from_mont(),
+    // and mul() and sqr() give their product in the same form, add() and sub() their sum and difference. Only the setup
+    // divides. A context may be shared between threads.
+    class montgomery_context
+    {
+    public:
+        using digit = int_titan::digit;
+        // Modulus m, which must be odd and positive.
+        explicit montgomery_context(const integer& modulus) : m(modulus)
+        {
+            const auto& mv = modulus.digits.view();
+            n = mv.size();
+            if(n == 0 or modulus.is_negative or mv[0] % 2 == 0)
+            {
+                throw std::logic_error("Montgomery modulus must be odd and positive.");
+            }
+            limbs = limb_buffer<digit>(mv.data(), mv.data() + n);
+            m_inverse = kernels::montgomery_inverse(limbs[0]);
+            // R^2 mod m turns a value into the form by one multiplication, mul(x, R^2) = x * R mod m. And R mod m is one.
+            r_squared = integer::residue(integer::shift_left(integer::one, static_cast<int>(2 * n)), m, n);
+            r_one = integer::residue(integer::shift_left(integer::one, static_cast<int>(n)), m, n);
+        }
+        // Number of limbs of the values (those of m).
+        std::size_t size() const
+        {
+            return n;
+        }
+        const integer& modulus() const
+        {
+            return m;
+        }
+        // The form of 1 (R mod m).
+        const digit* one() const
+        {
+            return r_one.data();
+        }
+        // r = x * R mod m, for x below m.
+        void to_mont(digit* r, const digit* x) const
+        {
+            mul(r, x, r_squared.data());
+        }
+        // r = x * R mod m, for any x (the non-negative residue).
+        void to_mont(digit* r, const integer& x) const
+        {
+            const integer::digit_buffer value = integer::residue(x, m, n);
+            to_mont(r, value.data());
+        }
+        // r = x / R mod m: the value x is the form of. r may alias x.
+        void from_mont(digit* r, const digit* x) const
+        {
+            with_scratch([&](digit* t)
+            {
+                std::copy(x, x + n, t);
+                std::fill(t + n, t + 2 * n, digit(0));
+                kernels::montgomery_reduce(r, t, limbs.data(), n, m_inverse);
+            });
+        }
+        // The value x is the form of.
+        integer from_mont(const digit* x) const
+        {
+            integer::digit_buffer value(n);
+            digit* v = value.mutable_data();
+            from_mont(v, x);
+            value.resize(kernels::normalized_size(v, n));
+            return integer::create_from_buffer(std::move(value), false);
+        }
+        // r = x * y / R mod m, the form of the product. r may alias x or y.
+        void mul(digit* r, const digit* x, const digit* y) const
+        {
+            with_scratch([&](digit* t)
+            {
+                kernels::montgomery_multiply(r, x, y, limbs.data(), n, m_inverse, t);
+            });
+        }
+        // r = x^2 / R mod m, the form of the square. r may alias x.
+        void sqr(digit* r, const digit* x) const
+        {
+            with_scratch([&](digit* t)
+            {
+                kernels::montgomery_square(r, x, limbs.data(), n, m_inverse, t);
+            });
+        }
+        // r = x + y mod m, the form of the sum. r may alias x or y.
+        void add(digit* r, const digit* x, const digit* y) const
+        {
+            const digit carry = kernels::add_n(r, x, y, n);
+            if(carry != 0 or kernels::compare(r, limbs.data(), n) >= 0)
+            {
+                kernels::sub_n(r, r, limbs.data(), n);
+            }
+        }
+        // r = x - y mod m, the form of the difference. r may alias x or y.
+        void sub(digit* r, const digit* x, const digit* y) const
+        {
+            if(kernels::sub_n(r, x, y, n) != 0)
+            {
+                kernels::add_n(r, r, limbs.data(), n);
+            }
+        }
+    private:
+        // Moduli up to this many limbs get their temporary limbs on the stack.
+        static constexpr std::size_t stack_limbs = 32;
+        integer m;
+        limb_buffer<digit> limbs;
+        std::size_t n = 0;
+        digit m_inverse = 0;
+        integer::digit_buffer r_squared;
+        integer::digit_buffer r_one;
+        // Call f with the temporary limbs for the kernels.
+        template<typename F>
+        void with_scratch(F f) const
+        {
+            if(n <= stack_limbs)
+            {
+                digit t[kernels::montgomery_scratch_size(stack_limbs)];
+                f(t);
+                return;
+            }
+            const std::size_t size = kernels::montgomery_scratch_size(n);
+            const kernels::scratch_buffer<> memory(size);
+            f(memory.get());
+        }
+    };
+#if INTTITAN_IFMA
+    // Montgomery arithmetic modulo a fixed odd m in radix 2^52, for the AVX-512 IFMA kernel of ifma.h, which pow_mod()
+    // and multi_pow_mod() take where the processor has it and m is of a size it covers (is_available()). The values are
+    // arrays of size() digits of 52 bits below 2m, in the form x * R mod m with R = 2^(52k) for the k digits of m,
+    // converted with to_mont() and back to limbs with from_mont(), and mul() and sqr() give their product in the same
+    // form, as the exponentiation kernels need. A context may be shared between threads.
+    class ifma_montgomery_context
+    {
+    public:
+        using digit = int_titan::digit;
+        // Is there a kernel for a modulus of n limbs on this processor? Below min_limbs, the limbs are faster.
+        static bool is_available(const std::size_t n)
+        {
+            return n >= min_limbs and kernels::select_radix_52_multiply(cpu(), kernels::radix_52_digits(n)) != nullptr;
+        }
+        // Modulus m, which must be odd and positive, of a size is_available() for.
+        explicit ifma_montgomery_context(const integer& modulus) : m(modulus)
+        {
+            const auto& mv = modulus.digits.view();
+            n = mv.size();
+            if(n == 0 or modulus.is_negative or mv[0] % 2 == 0)
+            {
+                throw std::logic_error("Montgomery modulus must be odd and positive.");
+            }
+            k = kernels::radix_52_digits(n);
+            multiply = kernels::select_radix_52_multiply(cpu(), k);
+            if(multiply == nullptr)
+            {
+                throw std::logic_error("No IFMA kernel for the modulus.");
+            }
+            limbs = limb_buffer<digit>(mv.data(), mv.data() + n);
+            m_inverse = kernels::montgomery_inverse(mv[0]) & kernels::radix_52_mask;
+            // m, R^2 mod m and R mod m, each in size() digits.
+            const std::size_t padded = size();
+            constants = integer::digit_buffer(3 * padded);
+            digit* c = constants.mutable_data();
+            kernels::to_radix_52(c, k, mv.data(), n);
+            const integer r = integer::shift_left_bits(integer::one, kernels::radix_52_bits * k);
+            const integer::digit_buffer r_squared = integer::residue(r * r, m, n);
+            kernels::to_radix_52(c + padded, k, r_squared.data(), n);
+            const integer::digit_buffer r_one = integer::residue(r, m, n);
+            kernels::to_radix_52(c + 2 * padded, k, r_one.data(), n);
+        }
+        // Number of digits of the values (those of m, and zeroes up to a whole number of vectors).
+        std::size_t size() const
+        {
+            return kernels::radix_52_padded(k);
+        }
+        const integer& modulus() const
+        {
+            return m;
+        }
+        // The form of 1 (R mod m).
+        const digit* one() const
+        {
+            return constants.data() + 2 * size();
+        }
+        // r = x * R mod m, for any x (the non-negative residue).
+        void to_mont(digit* r, const integer& x) const
+        {
+            const integer::digit_buffer value = integer::residue(x, m, n);
+            kernels::to_radix_52(r, k, value.data(), n);
+            std::fill(r + k, r + size(), digit(0));
+            mul(r, r, constants.data() + size());
+        }
+        // r = x / R mod m in n limbs, below m: the value x is the form of.
+        void from_mont(digit* r, const digit* x) const
+        {
+            // x / R is at most m, as x * 1 + q * m < (2 + R) * m, and is m only for a form of 0.
+            digit unit[kernels::ifma_max_digits] = {1};
+            digit t[kernels::ifma_max_digits];
+            mul(t, x, unit);
+            kernels::from_radix_52(r, n, t, k);
+            kernels::montgomery_finish(r, r, 0, limbs.data(), n);
+        }
+        // r = x * y / R mod m, the form of the product. r may alias x or y.
+        void mul(digit* r, const digit* x, const digit* y) const
+        {
+            multiply(r, x, y, constants.data(), k, m_inverse);
+        }
+        // r = x^2 / R mod m, the form of the square. r may alias x.
+        void sqr(digit* r, const digit* x) const
+        {
+            multiply(r, x, x, constants.data(), k, m_inverse);
+        }
+    private:
+        // Smallest modulus in limbs for which the IFMA kernel beats montgomery_context.
+        static constexpr std::size_t min_limbs = 4;
+        integer m;
+        limb_buffer<digit> limbs;
+        std::size_t n = 0;
+        std::size_t k = 0;
+        digit m_inverse = 0;
+        integer::digit_buffer constants;
+        kernels::radix_52_multiply multiply = nullptr;
+    };
+#endif
+    // Reduction modulo a fixed positive m of k digits without division, for moduli that are even or change too often for
+    // a Montgomery context. The setup computes mu = floor(B^2k / m), then reduce() (or x % reducer) takes any integer
+    // below m^2 with two multiplications. mul() and sqr() multiply values of size() limbs below m, as for the
+    // exponentiation kernels. A reducer may be shared between threads.
+    class barrett_reducer
+    {
+    public:
+        using digit = int_titan::digit;
+        // Modulus m, which must be positive.
+        explicit barrett_reducer(const integer& modulus) : m(modulus)
+        {
+            const auto& mv = modulus.digits.view();
+            k = mv.size();
+            if(k == 0 or modulus.is_negative)
+            {
+                throw std::logic_error("Barrett modulus must be positive.");
+            }
+            limbs = limb_buffer<digit>(mv.data(), mv.data() + k);
+            const integer reciprocal = integer::divide(integer::shift_left(integer::one, static_cast<int>(2 * k)), m).first;
+            const auto& rv = reciprocal.digits.view();
+            mu = limb_buffer<digit>(rv.data(), rv.data() + rv.size());
+            unit = integer::residue(integer::one, m, k);
+        }
+        // Number of limbs of the values (those of m).
+        std::size_t size() const
+        {
+            return k;
+        }
+        const integer& modulus() const
+        {
+            return m;
+        }
+        // x mod m, truncated like x % m (the sign of x). Values from m^2 on are divided.
+        integer reduce(const integer& x) const
+        {
+            const auto& xv = x.digits.view();
+            const std::size_t xn = xv.size();
+            if(xn > 2 * k)
+            {
+                return x % m;
+            }
+            integer::digit_buffer result(k);
+            digit* r = result.mutable_data();
+            with_scratch([&](digit* t)
+            {
+                kernels::barrett_reduce(r, xv.data(), xn, limbs.data(), k, mu.data(), mu.size(), t);
+            });
+            result.resize(kernels::normalized_size(r, k));
+            return integer::create_from_buffer(std::move(result), x.is_negative and !result.empty());
+        }
+        // The value 1 (0 when m is 1).
+        const digit* one() const
+        {
+            return unit.data();
+        }
+        // r = x * y mod m. r may alias x or y.
+        void mul(digit* r, const digit* x, const digit* y) const
+        {
+            with_scratch([&](digit* t)
+            {
+                kernels::multiply(t, x, k, y, k);
+                kernels::barrett_reduce(r, t, 2 * k, limbs.data(), k, mu.data(), mu.size(), t + 2 * k);
+            });
+        }
+        // r = x^2 mod m. r may alias x.
+        void sqr(digit* r, const digit* x) const
+        {
+            with_scratch([&](digit* t)
+            {
+                kernels::square(t, x, k);
+                kernels::barrett_reduce(r, t, 2 * k, limbs.data(), k, mu.data(), mu.size(), t + 2 * k);
+            });
+        }
+    private:
+        // Moduli up to this many limbs get their temporary limbs on the stack.
+        static constexpr std::size_t stack_limbs = 32;
+        integer m;
+        limb_buffer<digit> limbs;
+        std::size_t k = 0;
+        limb_buffer<digit> mu;
+        integer::digit_buffer unit;
+        // Limbs of temporary memory: a product and those of the reduction.
+        static constexpr std::size_t scratch_size(const std::size_t k)
+        {
+            return 2 * k + kernels::barrett_scratch_size(k);
+        }
+        // Call f with the temporary limbs.
+        template<typename F>
+        void with_scratch(F f) const
+        {
+            if(k <= stack_limbs)
+            {
+                digit t[scratch_size(stack_limbs)];
+                f(t);
+                return;
+            }
+            const kernels::scratch_buffer<> memory(scratch_size(k));
+            f(memory.get());
+        }
+    };
+    // x mod m by the reducer for m, the same as x % m.
+    inline integer operator%(const integer& x, const barrett_reducer& reducer)
+    {
+        return reducer.reduce(x);
+    }
+    inline integer& operator%=(integer& x, const barrett_reducer& reducer)
+    {
+        x = reducer.reduce(x);
+        return x;
+    }
+    // Powers of a fixed base g modulo the odd modulus of a Montgomery context, for exponents of any number of bits: the
+    // table holds g^(d * 2^(k i)) for every window i of k bits of the exponents up to exponent_bits and every digit d of
+    // a window, so g^e takes a lookup and a multiplication per non-zero window of e, and no squarings. The table takes
+    // (2^k - 1) * ceil(exponent_bits / k) values of the size of the modulus, e.g. 2 MiB for 2048 bits and k = 4. Any
+    // bits of e above exponent_bits go through a sliding window over the power after the last window. A table may be
+    // shared between threads.
+    class fixed_base_table
+    {
+    public:
+        using digit = int_titan::digit;
+        fixed_base_table(const montgomery_context& context, const integer& g, const std::size_t exponent_bits, const int window_bits = 4)
+            : montgomery(context), k(window_bits), windows((exponent_bits + static_cast<std::size_t>(window_bits) - 1) / static_cast<std::size_t>(window_bits))
+        {
+            if(k < 1 or k > 8)
+            {
+                throw std::invalid_argument("Window of 1 to 8 bits expected.");
+            }
+            const std::size_t n = montgomery.size();
+            const std::size_t digits = (std::size_t(1) << k) - 1;
+            table = limb_buffer<digit>(windows * digits * n);
+            top = limb_buffer<digit>(n);
+            digit* b = top.mutable_data();
+            montgomery.to_mont(b, g);
+            // Row i holds b^1, ..., b^(2^k - 1) for b = g^(2^(k i)), and b^(2^k) is the b of the next row.
+            for(std::size_t i = 0; i < windows; i++)
+            {
+                digit* row = table.mutable_data() + i * digits * n;
+                std::copy(b, b + n, row);
+                for(std::size_t d = 1; d < digits; d++)
+                {
+                    montgomery.mul(row + d * n, row + (d - 1) * n, b);
+                }
+                montgomery.mul(b, row + (digits - 1) * n, b);
+            }
+        }
+        const montgomery_context& context() const
+        {
+            return montgomery;
+        }
+        // g^e mod m, for a non-negative e.
+        integer pow(const integer& e) const
+        {
+            const auto& ev = e.digits.view();
+            const std::size_t en = ev.size();
+            if(e.is_negative and en != 0)
+            {
+                throw std::logic_error("Negative exponent impermissible.");
+            }
+            const std::size_t n = montgomery.size();
+            const std::size_t digits = (std::size_t(1) << k) - 1;
+            integer::digit_buffer result(n);
+            digit* r = result.mutable_data();
+            std::copy(montgomery.one(), montgomery.one() + n, r);
+            for(std::size_t i = 0; i < windows; i++)
+            {
+                const digit w = kernels::exponent_window(ev.data(), en, i * k, k);
+                if(w != 0)
+                {
+                    montgomery.mul(r, r, table.data() + (i * digits + w - 1) * n);
+                }
+            }
+            const std::size_t covered = windows * k;
+            if(covered < en * digit_bits)
+            {
+                // The high bits, as an exponent of their own for the power after the last window.
+                integer::digit_buffer high(en - covered / digit_bits);
+                digit* h = high.mutable_data();
+                kernels::shift_right_bits(h, ev.data() + covered / digit_bits, high.size(), static_cast<int>(covered % digit_bits));
+                const std::size_t hn = kernels::normalized_size(h, high.size());
+                if(hn != 0)
+                {
+                    integer::digit_buffer power(n);
+                    kernels::power_sliding_window(power.mutable_data(), top.data(), h, hn, montgomery);
+                    montgomery.mul(r, r, power.data());
+                }
+            }
+            montgomery.from_mont(r, r);
+            result.resize(kernels::normalized_size(r, n));
+            return integer::create_from_buffer(std::move(result), false);
+        }
+    private:
+        montgomery_context montgomery;
+        int k;
+        std::size_t windows;
+        limb_buffer<digit> table;
+        // g^(2^(k windows)), in the form.
+        limb_buffer<digit> top;
+    };
+    inline integer integer::pow_mod(const integer& base, const integer& exponent, const integer& modulus, const bool constant_time)
+    {
+        const auto& mv = modulus.digits.view();
+        const std::size_t mn = mv.size();
+        if(mn == 0)
+        {
+            throw std::logic_error("Division by 0 impermissible.");
+        }
+        const auto& ev = exponent.digits.view();
+        const std::size_t en = ev.size();
+        if(exponent.is_negative and en != 0)
+        {
+            throw std::logic_error("Negative exponent impermissible.");
+        }
+        const integer m = absolute_value(modulus);
+        digit_buffer result(mn);
+        digit* r = result.mutable_data();
+        const auto power = [&](digit* y, const digit* x, const auto& reduction)
+        {
+            if(constant_time)
+            {
+                kernels::power_fixed_window(y, x, ev.data(), en, reduction);
+            }
+            else
+            {
+                kernels::power_sliding_window(y, x, ev.data(), en, reduction);
+            }
+        };
+#if INTTITAN_IFMA
+        // In radix 2^52 from the base to the power, back to limbs only at the end.
+        if(mv[0] % 2 != 0 and ifma_montgomery_context::is_available(mn))
+        {
+            const ifma_montgomery_context context(m);
+            digit_buffer values(2 * context.size());
+            digit* x = values.mutable_data();
+            digit* y = x + context.size();
+            context.to_mont(x, base);
+            power(y, x, context);
+            context.from_mont(r, y);
+        }
+        else
+#endif
+        if(mv[0] % 2 != 0)
+        {
+            const montgomery_context context(m);
+            digit_buffer x(mn);
+            context.to_mont(x.mutable_data(), base);
+            power(r, x.data(), context);
+            context.from_mont(r, r);
+        }
+        else
+        {
+            const barrett_reducer reducer(m);
+            const digit_buffer x = residue(base, m, mn);
+            power(r, x.data(), reducer);
+        }
+        result.resize(kernels::normalized_size(r, mn));
+        return create_from_buffer(std::move(result), false);
+    }
+    inline integer integer::multi_pow_mod(const integer* bases, const integer* exponents, const std::size_t count, const integer& modulus)
+    {
+        const auto& mv = modulus.digits.view();
+        const std::size_t mn = mv.size();
+        if(mn == 0)
+        {
+            throw std::logic_error("Division by 0 impermissible.");
+        }
+        // The digits of the exponents, kept for the kernel (flattened copies with INTTITAN_FLEX_VECTOR_STORAGE).
+        std::vector<std::decay_t<decltype(exponents[0].digits.view())>> exponent_digits;
+        exponent_digits.reserve(count);
+        std::vector<const digit*> e(count);
+        std::vector<std::size_t> en(count);
+        for(std::size_t j = 0; j < count; j++)
+        {
+            const auto& ev = exponent_digits.emplace_back(exponents[j].digits.view());
+            en[j] = ev.size();
+            e[j] = ev.data();
+            if(exponents[j].is_negative and en[j] != 0)
+            {
+                throw std::logic_error("Negative exponent impermissible.");
+            }
+        }
+        const integer m = absolute_value(modulus);
+        digit_buffer result(mn);
+        digit* r = result.mutable_data();
+        std::vector<const digit*> x(count);
+#if INTTITAN_IFMA
+        if(mv[0] % 2 != 0 and ifma_montgomery_context::is_available(mn))
+        {
+            const ifma_montgomery_context context(m);
+            const std::size_t size = context.size();
+            // The bases in radix 2^52 side by side, then the power.
+            const kernels::scratch_buffer<> memory((count + 1) * size);
+            for(std::size_t j = 0; j < count; j++)
+            {
+                context.to_mont(memory.get() + j * size, bases[j]);
+                x[j] = memory.get() + j * size;
+            }
+            digit* y = memory.get() + count * size;
+            kernels::power_interleaved(y, x.data(), e.data(), en.data(), count, context);
+            context.from_mont(r, y);
+            result.resize(kernels::normalized_size(r, mn));
+            return create_from_buffer(std::move(result), false);
+        }
+#endif
+        // The bases in the form of the reduction, side by side.
+        const kernels::scratch_buffer<> memory(count * mn);
+        for(std::size_t j = 0; j < count; j++)
+        {
+            x[j] = memory.get() + j * mn;
+        }
+        if(mv[0] % 2 != 0)
+        {
+            const montgomery_context context(m);
+            for(std::size_t j = 0; j < count; j++)
+            {
+                context.to_mont(memory.get() + j * mn, bases[j]);
+            }
+            kernels::power_interleaved(r, x.data(), e.data(), en.data(), count, context);
+            context.from_mont(r, r);
+        }
+        else
+        {
+            const barrett_reducer reducer(m);
+            for(std::size_t j = 0; j < count; j++)
+            {
+                const digit_buffer value = residue(bases[j], m, mn);
+                std::copy(value.data(), value.data() + mn, memory.get() + j * mn);
+            }
+            kernels::power_interleaved(r, x.data(), e.data(), en.data(), count, reducer);
+        }
+        result.resize(kernels::normalized_size(r, mn));
+        return create_from_buffer(std::move(result), false);
+    }
+    // Row i holds the cofactors of the i-th value of a pair in terms of the pair its steps started from. Its determinant
+    // is 1 or -1, so the pair keeps its gcd, whatever the steps.
+    struct integer::gcd_matrix
+    {
+        integer m[2][2] = {{integer::one, integer::zero}, {integer::zero, integer::one}};
+        bool is_identity() const
+        {
+            return bit_length(m[0][1]) == 0 and bit_length(m[1][0]) == 0;
+        }
+        void swap_rows()
+        {
+            std::swap(m[0], m[1]);
+        }
+        void negate_row(const int i)
+        {
+            for(integer& x : m[i])
+            {
+                x.is_negative = !x.is_negative and !is_zero(x);
+            }
+        }
+    };
+    // m = t m, for the steps of t after those of m.
+    inline void integer::gcd_multiply(const gcd_matrix& t, gcd_matrix& m)
+    {
+        for(int j = 0; j < 2; j++)
+        {
+            integer x = t.m[0][0] * m.m[0][j];
+            addmul(x, t.m[0][1], m.m[1][j]);
+            integer y = t.m[1][0] * m.m[0][j];
+            addmul(y, t.m[1][1], m.m[1][j]);
+            m.m[0][j] = std::move(x);
+            m.m[1][j] = std::move(y);
+        }
+    }
+    inline void integer::gcd_division_step(integer& a, integer& b, gcd_matrix* m)
+    {
+        auto [q, r] = divide(a, b);
+        a = std::move(b);
+        b = std::move(r);
+        if(m != nullptr)
+        {
+            for(int j = 0; j < 2; j++)
+            {
+                submul(m->m[0][j], q, m->m[1][j]);
+            }
+            m->swap_rows();
+        }
+    }
+    inline void integer::gcd_reduce(integer& a, integer& b, const std::size_t bits, gcd_matrix* m)
+    {
+        const auto& av = a.digits.view();
+        const auto& bv = b.digits.view();
+        const std::size_t an = av.size();
+        const std::size_t bn = bv.size();
+        const kernels::scratch_buffer<> memory(kernels::euclid_pair::memory_size(an) + 6 * (an + 2));
+        kernels::euclid_pair p(memory.get(), av.data(), an, bv.data(), bn);
+        kernels::euclid_matrix steps;
+        steps.reset(memory.get() + kernels::euclid_pair::memory_size(an), an + 2);
+        kernels::euclid_reduce(p, bits, m != nullptr ? &steps : nullptr);
+        a = create_from_buffer(digit_buffer(p.x, p.x + p.xn), false);
+        b = create_from_buffer(digit_buffer(p.y, p.y + p.yn), false);
+        if(m != nullptr)
+        {
+            // The signs of the entries are those of the number of steps, see euclid_matrix.
+            gcd_matrix t;
+            for(int i = 0; i < 4; i++)
+            {
+                const digit* e = steps.m[i];
+                digit_buffer entry(e, e + kernels::normalized_size(e, steps.n));
+                const bool is_negative = (i == 1 or i == 2) != steps.odd;
+                t.m[i / 2][i % 2] = create_from_buffer(std::move(entry), is_negative and !entry.empty());
+            }
+            gcd_multiply(t, *m);
+        }
+    }
+    inline void integer::gcd_apply(integer& a, integer& b, const gcd_matrix& t, gcd_matrix* m)
+    {
+        const auto row = [&](const int i, const integer& x, const integer& y)
+        {
+            integer r = t.m[i][0] * x;
+            addmul(r, t.m[i][1], y);
+            return r;
+        };
+        integer next_a = row(0, a, b);
+        b = row(1, a, b);
+        a = std::move(next_a);
+        if(m != nullptr)
+        {
+            gcd_multiply(t, *m);
+        }
+        // The low bits may have changed the last quotients, which leaves a value negative or the pair out of order.
+        // Negating a row or swapping the rows puts it right.
+        gcd_matrix fix;
+        gcd_matrix& rows = m != nullptr ? *m : fix;
+        if(a.is_negative)
+        {
+            a.is_negative = false;
+            rows.negate_row(0);
+        }
+        if(b.is_negative)
+        {
+            b.is_negative = false;
+            rows.negate_row(1);
+        }
+        if(compare(a, b) < 0)
+        {
+            std::swap(a, b);
+            rows.swap_rows();
+        }
+    }
+    // Above the threshold, the top bits of the pair (half of those of a to start with) are reduced by a recursive
+    // half-GCD, which takes off about half of them, and its matrix is applied to the whole pair: two such passes take a
+    // from n to about n / 2 bits. The cost is that of the products of the matrices, O(M(n) log n). Steps of Lehmer and
+    // of division finish the reduction, and do all of it below the threshold.
+    inline void integer::half_gcd(integer& a, integer& b, gcd_matrix* m)
+    {
+        const std::size_t n = bit_length(a);
+        const std::size_t s = n / 2 + 1;
+        if(n >= tuning.half_gcd * digit_bits)
+        {
+            while(bit_length(b) > s)
+            {
+                const std::size_t an = bit_length(a);
+                // Top bits of twice as many as are left to take off, but at most n / 2 of them.
+                const std::size_t p = std::max(2 * s > an ? 2 * s - an : 0, an - n / 2);
+                if(an - p < 4 * digit_bits)
+                {
+                    break;
+                }
+                gcd_matrix t;
+                if(bit_length(b) > p + digit_bits)
+                {
+                    integer top_a = shift_right_bits(a, p);
+                    integer top_b = shift_right_bits(b, p);
+                    half_gcd(top_a, top_b, &t);
+                }
+                // A b much shorter than a (or neither reduced) is a large quotient, for a division.
+                if(t.is_identity())
+                {
+                    gcd_division_step(a, b, m);
+                }
+                else
+                {
+                    gcd_apply(a, b, t, m);
+                }
+            }
+        }
+        if(bit_length(b) > s)
+        {
+            gcd_reduce(a, b, s, m);
+        }
+    }
+    // With |base| = o 2^z for odd o: o^exponent in limbs for all of its bits, exponent (bits of o), then the shift by
+    // z exponent. Every power on the way, before and after its squaring or its product by o, fits in the same limbs.
+    inline integer integer::pow(const integer& base, const std::size_t exponent)
+    {
+        if(exponent == 0)
+        {
+            return one;
+        }
+        const auto& bv = base.digits.view();
+        const std::size_t bn = bv.size();
+        if(bn == 0)
+        {
+            return zero;
+        }
+        const std::size_t zeros = count_trailing_zeros(base);
+        const std::size_t odd_bits = bit_length(base) - zeros;
+        const std::size_t n = (exponent * odd_bits + digit_bits - 1) / digit_bits + 2;
+        const std::size_t skipped = zeros / digit_bits;
+        const std::size_t work = kernels::multiply_scratch_size(n);
+        const kernels::scratch_buffer<> memory((bn - skipped) + 2 * n + work);
+        digit* o = memory.get();
+        digit* p = o + (bn - skipped);
+        digit* q = p + n;
+        const kernels::scratch_space scratch{q + n, q + n + work};
+        kernels::shift_right_bits(o, bv.data() + skipped, bn - skipped, static_cast<int>(zeros % digit_bits));
+        const std::size_t on = kernels::normalized_size(o, bn - skipped);
+        std::copy(o, o + on, p);
+        std::size_t pn = on;
+        if(odd_bits > 1)
+        {
+            int i = std::numeric_limits<std::size_t>::digits - 1;
+            while(((exponent >> i) & 1) == 0)
+            {
+                i--;
+            }
+            while(i-- != 0)
+            {
+                kernels::square(q, p, pn, scratch);
+                pn = kernels::normalized_size(q, 2 * pn);
+                std::swap(p, q);
+                if(((exponent >> i) & 1) == 0)
+                {
+                    continue;
+                }
+                if(on == 1)
+                {
+                    p[pn] = kernels::multiply_by_digit(p, p, pn, o[0]);
+                    pn += p[pn] != 0;
+                }
+                else
+                {
+                    kernels::multiply(q, p, pn, o, on, scratch);
+                    pn = kernels::normalized_size(q, pn + on);
+                    std::swap(p, q);
+                }
+            }
+        }
+        const std::size_t shift = zeros * exponent;
+        const std::size_t shift_digits = shift / digit_bits;
+        digit_buffer result(shift_digits + pn + 1);
+        digit* r = result.mutable_data();
+        r[shift_digits + pn] = kernels::shift_left_bits(r + shift_digits, p, pn, static_cast<int>(shift % digit_bits));
+        result.resize(kernels::normalized_size(r, result.size()));
+        return create_from_buffer(std::move(result), base.is_negative and exponent % 2 != 0);
+    }
+    inline integer integer::gcd(const integer& x, const integer& y)
+    {
+        integer a = absolute_value(x);
+        integer b = absolute_value(y);
+        if(compare(a, b) < 0)
+        {
+            std::swap(a, b);
+        }
+        // Every half-GCD halves the pair, a large quotient is a division.
+        while(bit_length(a) >= tuning.half_gcd * digit_bits and !is_zero(b))
+        {
+            if(bit_length(a) - bit_length(b) >= digit_bits)
+            {
+                gcd_division_step(a, b, nullptr);
+            }
+            else
+            {
+                half_gcd(a, b, nullptr);
+            }
+        }
+        const auto& av = a.digits.view();
+        const auto& bv = b.digits.view();
+        const std::size_t an = av.size();
+        const std::size_t bn = bv.size();
+        digit_buffer g(std::max<std::size_t>({an, bn, 2}));
+        g.resize(kernels::gcd(g.mutable_data(), av.data(), an, bv.data(), bn));
+        return create_from_buffer(std::move(g), false);
+    }
+    inline integer integer::extended_gcd(const integer& x, const integer& y, integer& s, integer& t)
+    {
+        integer a = absolute_value(x);
+        integer b = absolute_value(y);
+        // The rows are the cofactors of the pair in terms of (|x|, |y|).
+        gcd_matrix m;
+        if(compare(a, b) < 0)
+        {
+            std::swap(a, b);
+            m.swap_rows();
+        }
+        while(!is_zero(b))
+        {
+            if(bit_length(a) < tuning.half_gcd * digit_bits)
+            {
+                gcd_reduce(a, b, 0, &m);
+            }
+            else if(bit_length(a) - bit_length(b) < digit_bits)
+            {
+                half_gcd(a, b, &m);
+            }
+            else
+            {
+                gcd_division_step(a, b, &m);
+            }
+        }
+        integer u = std::move(m.m[0][0]);
+        integer v = std::move(m.m[0][1]);
+        // The smallest cofactors: u |x| + v |y| = g stays true with u - k |y| / g and v + k |x| / g, and the k that
+        // brings u to at most half of |y| / g brings v to about half of |x| / g.
+        if(!is_zero(x) and !is_zero(y))
+        {
+            const integer y_g = divide(absolute_value(y), a).first;
+            const integer x_g = divide(absolute_value(x), a).first;
+            integer k = divide(u, y_g).first;
+            submul(u, k, y_g);
+            addmul(v, k, x_g);
+            if(compare(shift_left_bits(absolute_value(u), 1), y_g) > 0)
+            {
+                k = u.is_negative ? -one : one;
+                submul(u, k, y_g);
+                addmul(v, k, x_g);
+            }
+        }
+        u.is_negative = (u.is_negative xor x.is_negative) and !is_zero(u);
+        v.is_negative = (v.is_negative xor y.is_negative) and !is_zero(v);
+        s = std::move(u);
+        t = std::move(v);
+        return a;
+    }
+    inline integer integer::mod_inverse(const integer& x, const integer& m)
+    {
+        if(bit_length(m) == 0)
+        {
+            throw std::logic_error("Division by 0 impermissible.");
+        }
+        integer s;
+        integer t;
+        if(!is_equal_to(extended_gcd(x, m, s, t), one))
+        {
+            throw std::logic_error("No inverse: the operands have a common factor.");
+        }
+        if(s.is_negative)
+        {
+            s += absolute_value(m);
+        }
+        return s;
+    }
+    // The root r of the top bits x / 2^(k h) gives r 2^h, below the root of x by less than 2^h, and a Newton step
+    // from there overshoots by about (k - 1) 2^(2h) / (2 root), under one for the h taken. The step never ends below
+    // the root, so a few decrements at most make it exact.
+    inline integer integer::root(const integer& x, const unsigned k)
+    {
+        const std::size_t bits = bit_length(x);
+        if(bits <= 2 * digit_bits)
+        {
+            return from_digit(kernels::root(to_superdigit(x), k));
+        }
+        if(k >= bits)
+        {
+            return one;
+        }
+        // The root has more than root_bits bits.
+        const std::size_t root_bits = (bits - 1) / k;
+        std::size_t k_bits = 0;
+        while((k >> k_bits) != 0)
+        {
+            k_bits++;
+        }
+        const integer k_minus_one = from_digit(k - 1);
+        const integer divisor = from_digit(k);
+        const auto newton = [&](const integer& r)
+        {
+            integer next = r * k_minus_one;
+            next += x / pow(r, k - 1);
+            return next / divisor;
+        };
+        if(root_bits < k_bits + 2)
+        {
+            // Too few bits for the halving (k near the bits of x): Newton from above, which only decreases to the root.
+            integer r = shift_left_bits(one, root_bits + 1);
+            while(true)
+            {
+                integer next = newton(r);
+                if(compare(next, r) >= 0)
+                {
+                    return r;
+                }
+                r = std::move(next);
+            }
+        }
+        const std::size_t h = (root_bits - k_bits) / 2;
+        integer r = newton(shift_left_bits(root(shift_right_bits(x, k * h), k), h));
+        while(compare(pow(r, k), x) > 0)
+        {
+            r -= one;
+        }
+        return r;
+    }
+    // The square root of Zimmermann ("Karatsuba Square Root", 1999), which is the Newton step for squares, arranged so
+    // that its division is of a quarter of the size: for x = a3 b^3 + a2 b^2 + a1 b + a0 with b = 2^h and a3 >= b / 4,
+    // the root s' and remainder r' of a3 b + a2 give the quotient q and remainder u of (r' b + a1) / (2 s'), and then
+    // s = s' b + q and r = u b + a0 - q^2, too large by one if r is negative. Other x are shifted by an even number of
+    // bits to the form, and the shift is taken off s and r at the end.
+    inline void integer::square_root(const integer& x, integer& s, integer& r)
+    {
+        const std::size_t bits = bit_length(x);
+        if(bits <= 2 * digit_bits)
+        {
+            const superdigit n = to_superdigit(x);
+            const digit root = kernels::root(n, 2);
+            s = from_digit(root);
+            r = from_superdigit(n - static_cast<superdigit>(root) * root);
+            return;
+        }
+        const std::size_t h = (bits + 3) / 4;
+        const std::size_t c = (4 * h - bits) / 2;
+        const integer a = shift_left_bits(absolute_value(x), 2 * c);
+        integer top_root;
+        integer top_remainder;
+        square_root(shift_right_bits(a, 2 * h), top_root, top_remainder);
+        integer numerator = shift_left_bits(top_remainder, h);
+        numerator += low_bits(shift_right_bits(a, h), h);
+        auto [q, u] = divide(numerator, shift_left_bits(top_root, 1));
+        s = shift_left_bits(top_root, h);
+        s += q;
+        r = shift_left_bits(u, h);
+        r += low_bits(a, h);
+        r -= square(q);
+        if(r.is_negative)
+        {
+            r += s;
+            r += s;
+            r -= one;
+            s -= one;
+        }
+        if(c != 0)
+        {
+            // s = S 2^c + s0 with S the root of x, whose remainder is (r + 2 s0 s - s0^2) / 4^c.
+            const integer s0 = low_bits(s, c);
+            addmul(r, shift_left_bits(s0, 1), s);
+            r -= square(s0);
+            r = shift_right_bits(r, 2 * c);
+            s = shift_right_bits(s, c);
+        }
+    }
+    inline integer integer::isqrt(const integer& x)
+    {
+        if(x.is_negative)
+        {
+            throw std::logic_error("Square root of a negative number impermissible.");
+        }
+        integer s;
+        integer r;
+        square_root(x, s, r);
+        return s;
+    }
+    inline integer integer::iroot(const integer& x, const unsigned k)
+    {
+        if(k == 0)
+        {
+            throw std::logic_error("Zeroth root impermissible.");
+        }
+        const bool is_negative = x.is_negative;
+        if(is_negative and k % 2 == 0)
+        {
+            throw std::logic_error("Even root of a negative number impermissible.");
+        }
+        if(k == 1)
+        {
+            return x;
+        }
+        if(k == 2)
+        {
+            return isqrt(x);
+        }
+        integer r = root(absolute_value(x), k);
+        r.is_negative = is_negative and !is_zero(r);
+        return r;
+    }
+    inline bool integer::is_perfect_square(const integer& x)
+    {
+        const auto& xv = x.digits.view();
+        const std::size_t n = xv.size();
+        if(n == 0)
+        {
+            return true;
+        }
+        if(x.is_negative or !kernels::may_be_square(xv.data(), n))
+        {
+            return false;
+        }
+        integer s;
+        integer r;
+        square_root(x, s, r);
+        return bit_length(r) == 0;
+    }
+    // The Miller-Rabin and strong Lucas tests of an odd x > 2^32, on values in the Montgomery form of its context.
+    struct integer::prime_test
+    {
+        const montgomery_context context;
+        const std::size_t n;
+        // The forms of 1 and of x - 1.
+        const digit* one;
+        kernels::scratch_buffer<> minus_one;
+        // x - 1 = d 2^s for odd d.
+        integer d;
+        std::size_t s;
+        explicit prime_test(const integer& x) : context(x), n(context.size()), one(context.one()), minus_one(n)
+        {
+            std::fill(minus_one.get(), minus_one.get() + n, digit(0));
+            context.sub(minus_one.get(), minus_one.get(), one);
+            d = x;
+            d -= integer::one;
+            s = count_trailing_zeros(d);
+            d = shift_right_bits(d, s);
+        }
+        bool equal(const digit* a, const digit* b) const
+        {
+            return std::equal(a, a + n, b);
+        }
+        bool is_zero(const digit* a) const
+        {
+            return kernels::normalized_size(a, n) == 0;
+        }
+        // Is x a strong probable prime to the base? base^d is 1 or -1, or one of its s - 1 repeated squares is -1.
+        bool miller_rabin(const digit base) const
+        {
+            const auto& dv = d.digits.view();
+            const kernels::scratch_buffer<> memory(2 * n);
+            digit* y = memory.get();
+            digit* b = y + n;
+            context.to_mont(b, from_digit(base));
+            kernels::power_sliding_window(y, b, dv.data(), dv.size(), context);
+            if(equal(y, one) or equal(y, minus_one.get()))
+            {
+                return true;
+            }
+            for(std::size_t i = 1; i < s; i++)
+            {
+                context.sqr(y, y);
+                if(equal(y, minus_one.get()))
+                {
+                    return true;
+                }
+                if(equal(y, one))
+                {
+                    return false;
+                }
+            }
+            return false;
+        }
+        // Is x a strong Lucas probable prime? For the first D of 5, -7, 9, -11, ... with (D / x) = -1, P = 1 and
+        // Q = (1 - D) / 4, and x + 1 = e 2^t for odd e: U_e = 0, or V_(e 2^r) = 0 for some r < t. The ladder carries V_k,
+        // V_(k+1) and Q^k from the top bit of e, with V_2k = V_k^2 - 2 Q^k and V_(2k+1) = V_k V_(k+1) - P Q^k, and
+        // D U_e = 2 V_(e+1) - P V_e. Squares have no such D, so they are rejected first.
+        bool strong_lucas() const
+        {
+            const integer& x = context.modulus();
+            const auto& xv = x.digits.view();
+            if(is_perfect_square(x))
+            {
+                return false;
+            }
+            std::int64_t D = 5;
+            while(true)
+            {
+                const int j = kernels::jacobi(D, xv.data(), n);
+                if(j == -1)
+                {
+                    break;
+                }
+                if(j == 0)
+                {
+                    // A common factor with |D|, which is below x.
+                    return false;
+                }
+                D = D > 0 ? -(D + 2) : -D + 2;
+            }
+            const std::int64_t Q = (1 - D) / 4;
+            integer x_plus_one = x;
+            x_plus_one += integer::one;
+            const std::size_t t_bits = count_trailing_zeros(x_plus_one);
+            const integer e = shift_right_bits(x_plus_one, t_bits);
+            const auto& ev = e.digits.view();
+            const std::size_t en = ev.size();
+            const kernels::scratch_buffer<> memory(6 * n);
+            digit* v = memory.get();
+            digit* v_next = v + n;
+            digit* q_power = v_next + n;
+            digit* q = q_power + n;
+            digit* t = q + n;
+            digit* u = t + n;
+            const integer q_magnitude = from_superdigit(static_cast<superdigit>(Q < 0 ? -Q : Q));
+            context.to_mont(q, Q < 0 ? negate(q_magnitude) : q_magnitude);
+            context.add(v, one, one);
+            std::copy(one, one + n, v_next);
+            std::copy(one, one + n, q_power);
+            for(std::size_t i = en * digit_bits - kernels::leading_zeros(ev[en - 1]); i-- != 0;)
+            {
+                // V_(2k+1), either way.
+                context.mul(t, v, v_next);
+                context.sub(t, t, q_power);
+                if(kernels::exponent_bit(ev.data(), i) == 0)
+                {
+                    // V_2k = V_k^2 - 2 Q^k, and Q^2k.
+                    context.sqr(v, v);
+                    context.sub(v, v, q_power);
+                    context.sub(v, v, q_power);
+                    std::copy(t, t + n, v_next);
+                    context.sqr(q_power, q_power);
+                }
+                else
+                {
+                    // V_(2k+2) = V_(k+1)^2 - 2 Q^(k+1), and Q^(2k+1).
+                    context.mul(u, q_power, q);
+                    context.sqr(v_next, v_next);
+                    context.sub(v_next, v_next, u);
+                    context.sub(v_next, v_next, u);
+                    std::copy(t, t + n, v);
+                    context.mul(q_power, q_power, u);
+                }
+            }
+            // U_e = 0 if 2 V_(e+1) = V_e, as D and x have no common factor.
+            context.add(t, v_next, v_next);
+            if(equal(t, v))
+            {
+                return true;
+            }
+            for(std::size_t r = 0; r < t_bits; r++)
+            {
+                if(is_zero(v))
+                {
+                    return true;
+                }
+                context.sqr(v, v);
+                context.sub(v, v, q_power);
+                context.sub(v, v, q_power);
+                context.sqr(q_power, q_power);
+            }
+            return false;
+        }
+    };
+    inline bool integer::probable_prime_tests(const integer& x, const unsigned rounds)
+    {
+        const prime_test test(x);
+        if(!test.miller_rabin(2) or !test.strong_lucas())
+        {
+            return false;
+        }
+        const std::vector<std::uint32_t>& primes = kernels::odd_primes();
+        for(unsigned i = 0; i < rounds and i < primes.size(); i++)
+        {
+            if(!test.miller_rabin(primes[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    inline bool integer::is_probable_prime(const integer& x, const unsigned rounds)
+    {
+        if(x.is_negative)
+        {
+            return false;
+        }
+        if(bit_length(x) <= 32)
+        {
+            return kernels::is_small_prime(static_cast<std::uint64_t>(to_superdigit(x)));
+        }
+        const auto& xv = x.digits.view();
+        const std::size_t xn = xv.size();
+        if(xv[0] % 2 == 0 or kernels::has_small_factor(xv.data(), xn, kernels::trial_division_primes))
+        {
+            return false;
+        }
+        return probable_prime_tests(x, rounds);
+    }
+    // Up to 2^32 the candidates are tested by trial division, above it they are sieved in windows of about as many
+    // odd candidates as x has bits, some three times the average gap between primes. Sieving by more primes pays as
+    // the tests get dearer: 8 per bit of x, all of the table from 818 bits.
+    inline integer integer::next_prime(const integer& x, const unsigned rounds)
+    {
+        if(x.is_negative or bit_length(x) <= 32)
+        {
+            const std::uint64_t limit = std::uint64_t(1) << 32;
+            for(std::uint64_t c = x.is_negative ? 0 : static_cast<std::uint64_t>(to_superdigit(x)) + 1; c < limit; c++)
+            {
+                if(kernels::is_small_prime(c))
+                {
+                    return from_superdigit(static_cast<superdigit>(c));
+                }
+            }
+            return next_prime(from_superdigit(static_cast<superdigit>(limit)), rounds);
+        }
+        integer start = x;
+        start += one;
+        if(start.digits.view()[0] % 2 == 0)
+        {
+            start += one;
+        }
+        const auto& sv = start.digits.view();
+        const std::size_t bits = bit_length(x);
+        kernels::prime_sieve sieve(sv.data(), sv.size(), std::max<std::size_t>(256, bits), 8 * bits);
+        while(true)
+        {
+            for(std::size_t i = 0; i < sieve.size(); i++)
+            {
+                if(!sieve.candidate(i))
+                {
+                    continue;
+                }
+                integer candidate = start;
+                candidate += from_superdigit(2 * static_cast<superdigit>(i));
+                if(probable_prime_tests(candidate, rounds))
+                {
+                    return candidate;
+                }
+            }
+            start += from_superdigit(2 * static_cast<superdigit>(sieve.size()));
+            sieve.next();
+        }
+    }
+    // Hash and equality for the unordered containers keyed on integer, e.g. std::unordered_map<integer, V, integer_hash,
+    // integer_equal>. Both are transparent and take machine integers too, so find(42) needs no integer for the key (with
+    // the heterogeneous lookup of C++20).
+    struct integer_hash
+    {
+        using is_transparent = void;
+        std::size_t operator()(const integer& x) const
+        {
+            return integer::hash(x);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        std::size_t operator()(const T value) const
+        {
+            return integer::hash(value);
+        }
+    };
+    struct integer_equal
+    {
+        using is_transparent = void;
+        bool operator()(const integer& x, const integer& y) const
+        {
+            return integer::is_equal_to(x, y);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        bool operator()(const integer& x, const T y) const
+        {
+            return integer::is_equal_to(x, y);
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        bool operator()(const T x, const integer& y) const
+        {
+            return integer::is_equal_to(y, x);
+        }
+    };
+    // A std::format specification of an integer, [[fill]align][sign][#][0][width][type] with the type one of d (the
+    // default), x, X, o, b and B: parsed from the characters after the colon and applied by write(). It is kept apart
+    // from std::formatter so that it works (and is tested) without <format>. Left out, and rejected: a width given by
+    // an argument ("{:{}}"), the locale (L), and the c type.
+    struct integer_format
+    {
+        char fill = ' ';
+        // '<', '>' or '^', or 0 for none: right, or padded with zeros after the sign and prefix with the 0 flag.
+        char align = 0;
+        // '-' (only for negative values), '+' or ' '.
+        char sign = '-';
+        bool prefix = false;
+        bool zeros = false;
+        std::size_t width = 0;
+        int base = 10;
+        bool uppercase = false;
+        // Parse [first, last) up to the closing '}' or the end, which is returned, or nullptr if the specification is
+        // invalid.
+        constexpr const char* parse(const char* first, const char* const last)
+        {
+            const auto is_align = [](const char c)
+            {
+                return c == '<' or c == '>' or c == '^';
+            };
+            if(last - first >= 2 and is_align(first[1]) and first[0] != '{' and first[0] != '}')
+            {
+                fill = first[0];
+                align = first[1];
+                first += 2;
+            }
+            else if(first != last and is_align(*first))
+            {
+                align = *first++;
+            }
+            if(first != last and (*first == '+' or *first == '-' or *first == ' '))
+            {
+                sign = *first++;
+            }
+            if(first != last and *first == '#')
+            {
+                prefix = true;
+                ++first;
+            }
+            if(first != last and *first == '0')
+            {
+                zeros = true;
+                ++first;
+            }
+            for(; first != last and *first >= '0' and *first <= '9'; ++first)
+            {
+                if(width > (std::numeric_limits<std::size_t>::max() - 9) / 10)
+                {
+                    return nullptr;
+                }
+                width = width * 10 + static_cast<std::size_t>(*first - '0');
+            }
+            if(first != last and *first != '}')
+            {
+                switch(*first++)
+                {
+                case 'd':
+                    base = 10;
+                    break;
+                case 'x':
+                    base = 16;
+                    break;
+                case 'X':
+                    base = 16;
+                    uppercase = true;
+                    break;
+                case 'o':
+                    base = 8;
+                    break;
+                case 'b':
+                    base = 2;
+                    break;
+                case 'B':
+                    base = 2;
+                    uppercase = true;
+                    break;
+                default:
+                    return nullptr;
+                }
+            }
+            return first == last or *first == '}' ? first : nullptr;
+        }
+        // Write x to out as specified: the sign, the prefix (0x, 0X, 0b, 0B, or 0 for octal values other than 0) and
+        // the digits, padded to the width. Small values are written on the stack, through to_chars().
+        template<typename Out>
+        Out write(Out out, const integer& x) const
+        {
+            char local[256];
+            std::string heap;
+            const std::size_t length = integer::to_chars_length(x, base);
+            char* first = local;
+            if(length > sizeof(local))
+            {
+                heap.resize(length);
+                first = heap.data();
+            }
+            char* const last = to_chars(first, first + length, x, base).ptr;
+            char head[3];
+            std::size_t h = 0;
+            if(*first == '-')
+            {
+                head[h++] = *first++;
+            }
+            else if(sign != '-')
+            {
+                head[h++] = sign;
+            }
+            if(prefix and base != 10 and !(base == 8 and *first == '0'))
+            {
+                head[h++] = '0';
+                if(base != 8)
+                {
+                    head[h++] = base == 16 ? uppercase ? 'X' : 'x' : uppercase ? 'B' : 'b';
+                }
+            }
+            const std::size_t size = h + static_cast<std::size_t>(last - first);
+            const std::size_t padding = width > size ? width - size : 0;
+            const std::size_t before = align == '<' ? 0 : align == '^' ? padding / 2 : align == 0 and zeros ? 0 : padding;
+            const std::size_t after = align == '<' ? padding : align == '^' ? padding - padding / 2 : 0;
+            out = std::fill_n(out, before, fill);
+            out = std::copy(head, head + h, out);
+            out = std::fill_n(out, padding - before - after, '0');
+            return std::fill_n(std::transform(first, last, out, [this](const char c)
+            {
+                return uppercase and c >= 'a' ? static_cast<char>(c - 'a' + 'A') : c;
+            }), after, fill);
+        }
+    };
+}
+
+namespace std
+{
+    template<>
+    struct hash<int_titan::integer>
+    {
+        std::size_t operator()(const int_titan::integer& x) const
+        {
+            return int_titan::integer::hash(x);
+        }
+    };
+#ifdef __cpp_lib_format
+    // Formatting of integers with std::format, by the specification of int_titan::integer_format.
+    template<>
+    struct formatter<int_titan::integer, char>
+    {
+        int_titan::integer_format specification;
+        constexpr auto parse(std::format_parse_context& context)
+        {
+            const char* const first = std::to_address(context.begin());
+            const char* const end = specification.parse(first, first + (context.end() - context.begin()));
+            if(end == nullptr)
+            {
+                throw std::format_error("Invalid format for an integer.");
+            }
+            return context.begin() + (end - first);
+        }
+        template<typename FormatContext>
+        auto format(const int_titan::integer& x, FormatContext& context) const
+        {
+            return specification.write(context.out(), x);
+        }
+    };
+#endif
+}
+
+// Defined inline where the class is complete, so that any number of translation units may include the header. With the
+// contiguous digits both are constant-initialized (in the inline limbs), so no code runs for them at startup.
+inline const int_titan::integer int_titan::integer::zero{};
+#if INTTITAN_CONSTANT_DIGITS
+inline const int_titan::integer int_titan::integer::one{std::in_place, 1};
+#else
+inline const int_titan::integer int_titan::integer::one = int_titan::integer::create(integer_digits({1}), false);
+#endif
 
-const int_titan::integer int_titan::integer::zero = int_titan::integer::create(integer_digits(), false);
-const int_titan::integer int_titan::integer::one = int_titan::integer::create(integer_digits({1}), false);
+// The storage of the digits, instantiated once in the int_titan library (int_titan.cpp) instead of in every translation
+// unit, see INTTITAN_EXTERN_TEMPLATES.
+#if INTTITAN_EXTERN_TEMPLATES
+extern template class int_titan::limb_buffer<int_titan::digit, INTTITAN_INLINE_LIMBS, int_titan::integer::memory_policy>;
+#if INTTITAN_FLEX_VECTOR_STORAGE
+extern template class int_titan::flex_limbs<int_titan::digit, int_titan::integer::memory_policy>;
+extern template class immer::flex_vector<int_titan::digit, int_titan::integer::memory_policy>;
+extern template class immer::flex_vector_transient<int_titan::digit, int_titan::integer::memory_policy>;
+#endif
+#endif
 
 #endif //INTTITAN_INTEGER_H
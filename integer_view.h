@@ -0,0 +1,90 @@
+#ifndef INTTITAN_INTEGER_VIEW_H
+#define INTTITAN_INTEGER_VIEW_H
+#include "bytes.h"
+#include "config.h"
+#include "kernels.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+// Integers in memory the library does not own, e.g. received or mapped as bytes: a view is the address of little-endian
+// limbs, their number and a sign, and wrapping them copies nothing. The memory must outlive the view and must not change
+// while it is read through it. Views of the low or high limbs or of a range of them are views too, so an algorithm that
+// splits its operands (as Karatsuba does) takes the parts without allocating, and integer's operations on views (add,
+// subtract, multiply, square, compare) read them in place, as the kernels read limbs.
+namespace int_titan
+{
+    class integer_view
+    {
+    public:
+        integer_view() = default;
+        // The n limbs at limbs, leading zeroes not counted.
+        integer_view(const digit* limbs, const std::size_t n, const bool is_negative = false) : first(limbs), count(kernels::normalized_size(limbs, n)), negative(is_negative and count != 0)
+        {
+        }
+        // Little-endian unsigned bytes in place, as integer::to_bytes() writes them without a prefix: on a little-endian
+        // host, for data aligned for digits and a whole number of limbs. Throws otherwise; integer::from_bytes() copies
+        // them in any case.
+        integer_view(const std::byte* data, const std::size_t size)
+        {
+            if(!INTTITAN_LITTLE_ENDIAN or reinterpret_cast<std::uintptr_t>(data) % alignof(digit) != 0 or size % sizeof(digit) != 0)
+            {
+                throw std::logic_error("Bytes not in the layout of the limbs.");
+            }
+            first = reinterpret_cast<const digit*>(data);
+            count = kernels::normalized_size(first, size / sizeof(digit));
+        }
+        const digit* limbs() const
+        {
+            return first;
+        }
+        // Number of limbs, without leading zeroes.
+        std::size_t size() const
+        {
+            return count;
+        }
+        bool is_negative() const
+        {
+            return negative;
+        }
+        bool is_zero() const
+        {
+            return count == 0;
+        }
+        // Limb i of the magnitude, 0 above size().
+        digit operator[](const std::size_t i) const
+        {
+            return i < count ? first[i] : 0;
+        }
+        // Views of parts of the magnitude, in place: they are non-negative and, like every view, without leading zeroes,
+        // so a part may have fewer limbs than asked for. B is 2^digit_bits.
+        // |x|, the view without its sign.
+        integer_view magnitude() const
+        {
+            return integer_view(first, count);
+        }
+        // The low k limbs, |x| mod B^k.
+        integer_view low(const std::size_t k) const
+        {
+            return integer_view(first, std::min(k, count));
+        }
+        // The limbs from k up, floor(|x| / B^k).
+        integer_view high(const std::size_t k) const
+        {
+            const std::size_t skipped = std::min(k, count);
+            return integer_view(first + skipped, count - skipped);
+        }
+        // The limbs [a, b), floor(|x| / B^a) mod B^(b - a).
+        integer_view slice(const std::size_t a, const std::size_t b) const
+        {
+            return high(a).low(b > a ? b - a : 0);
+        }
+    private:
+        const digit* first = nullptr;
+        std::size_t count = 0;
+        bool negative = false;
+    };
+}
+
+#endif //INTTITAN_INTEGER_VIEW_H
@@ -0,0 +1,657 @@
+#ifndef INTTITAN_KERNELS_H
+#define INTTITAN_KERNELS_H
+#include "config.h"
+#include "cpu.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#if INTTITAN_SIMD and defined(__ARM_NEON) and defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Arithmetic on raw little-endian spans of limbs. These know nothing about signs or storage, and the caller provides
+// the output memory.
+namespace int_titan
+{
+    namespace kernels
+    {
+        // Number of limbs in x without the leading zeroes.
+        inline std::size_t normalized_size(const digit* x, std::size_t n)
+        {
+            while(n != 0 and x[n - 1] == 0)
+            {
+                n--;
+            }
+            return n;
+        }
+        // Compare x and y of the same length (returns -1, 0 or 1). The equal limbs at the top are skipped 32 bytes (16 with
+        // NEON) at a time, then the first different one decides.
+        inline int compare(const digit* x, const digit* y, std::size_t n)
+        {
+#if INTTITAN_SIMD and defined(__SSE2__)
+            constexpr std::size_t step = 32 / sizeof(digit);
+            while(n >= step)
+            {
+                const __m128i* a = reinterpret_cast<const __m128i*>(x + n - step);
+                const __m128i* b = reinterpret_cast<const __m128i*>(y + n - step);
+                const __m128i low = _mm_cmpeq_epi8(_mm_loadu_si128(a), _mm_loadu_si128(b));
+                const __m128i high = _mm_cmpeq_epi8(_mm_loadu_si128(a + 1), _mm_loadu_si128(b + 1));
+                if(_mm_movemask_epi8(_mm_and_si128(low, high)) != 0xFFFF)
+                {
+                    break;
+                }
+                n -= step;
+            }
+#elif INTTITAN_SIMD and defined(__ARM_NEON) and defined(__aarch64__)
+            constexpr std::size_t step = 16 / sizeof(digit);
+            while(n >= step)
+            {
+                const uint32x4_t a = vld1q_u32(reinterpret_cast<const std::uint32_t*>(x + n - step));
+                const uint32x4_t b = vld1q_u32(reinterpret_cast<const std::uint32_t*>(y + n - step));
+                if(vminvq_u32(vceqq_u32(a, b)) != 0xFFFFFFFFu)
+                {
+                    break;
+                }
+                n -= step;
+            }
+#endif
+            for(std::size_t i = n; i-- != 0;)
+            {
+                if(x[i] != y[i])
+                {
+                    return x[i] < y[i] ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+        // Compare x and y of any lengths, which may have leading zeroes (returns -1, 0 or 1).
+        inline int compare(const digit* x, std::size_t xn, const digit* y, std::size_t yn)
+        {
+            for(; xn > yn; xn--)
+            {
+                if(x[xn - 1] != 0)
+                {
+                    return 1;
+                }
+            }
+            for(; yn > xn; yn--)
+            {
+                if(y[yn - 1] != 0)
+                {
+                    return -1;
+                }
+            }
+            return compare(x, y, xn);
+        }
+        // r = x + y, all n limbs, through the double-width sum. Returns the carry out of the top one. r may alias x or y.
+        inline digit add_n_portable(digit* r, const digit* x, const digit* y, const std::size_t n)
+        {
+            digit carry = 0;
+            for(std::size_t i = 0; i < n; i++)
+            {
+                const superdigit sum = static_cast<superdigit>(x[i]) + y[i] + carry;
+                r[i] = static_cast<digit>(sum);
+                carry = static_cast<digit>(sum >> digit_bits);
+            }
+            return carry;
+        }
+        // r = x - y, all n limbs, through the double-width difference. Returns the borrow out of the top one. r may alias
+        // x or y.
+        inline digit sub_n_portable(digit* r, const digit* x, const digit* y, const std::size_t n)
+        {
+            digit borrow = 0;
+            for(std::size_t i = 0; i < n; i++)
+            {
+                const superdigit difference = static_cast<superdigit>(x[i]) - y[i] - borrow;
+                r[i] = static_cast<digit>(difference);
+                borrow = static_cast<digit>(difference >> digit_bits) & 1;
+            }
+            return borrow;
+        }
+        // r = x * d. Writes n limbs and returns the carry limb. r may alias x.
+        inline digit multiply_by_digit(digit* r, const digit* x, const std::size_t n, const digit d)
+        {
+            digit carry = 0;
+            for(std::size_t i = 0; i < n; i++)
+            {
+                const superdigit product = static_cast<superdigit>(x[i]) * d + carry;
+                r[i] = static_cast<digit>(product);
+                carry = static_cast<digit>(product >> digit_bits);
+            }
+            return carry;
+        }
+        // r = r + x * d, both of n limbs. Returns the carry limb. The inner loop of schoolbook multiplication.
+        inline digit addmul_1_portable(digit* r, const digit* x, const std::size_t n, const digit d)
+        {
+            digit carry = 0;
+            for(std::size_t i = 0; i < n; i++)
+            {
+                const superdigit t = static_cast<superdigit>(x[i]) * d + r[i] + carry;
+                r[i] = static_cast<digit>(t);
+                carry = static_cast<digit>(t >> digit_bits);
+            }
+            return carry;
+        }
+        // r = r - x * d, both of n limbs. Returns the borrow limb. The inner loop of schoolbook division.
+        inline digit submul_1(digit* r, const digit* x, const std::size_t n, const digit d)
+        {
+            digit borrow = 0;
+            for(std::size_t i = 0; i < n; i++)
+            {
+                // The high half of the product is at most B - 2, so adding the borrow out of the low half never wraps.
+                const superdigit product = static_cast<superdigit>(x[i]) * d + borrow;
+                const digit low = static_cast<digit>(product);
+                borrow = static_cast<digit>(product >> digit_bits) + (r[i] < low ? 1 : 0);
+                r[i] -= low;
+            }
+            return borrow;
+        }
+#if defined(__x86_64__)
+        // sum = x + y + carry, returns the carry out (0 or 1), through the carry flag (ADC).
+        inline unsigned char add_with_carry(const unsigned char carry, const digit x, const digit y, digit& sum)
+        {
+            if constexpr(digit_bits == 64)
+            {
+                unsigned long long s;
+                const unsigned char out = _addcarry_u64(carry, x, y, &s);
+                sum = s;
+                return out;
+            }
+            else
+            {
+                unsigned int s;
+                const unsigned char out = _addcarry_u32(carry, x, y, &s);
+                sum = s;
+                return out;
+            }
+        }
+        // difference = x - y - borrow, returns the borrow out (0 or 1), through the carry flag (SBB).
+        inline unsigned char subtract_with_borrow(const unsigned char borrow, const digit x, const digit y, digit& difference)
+        {
+            if constexpr(digit_bits == 64)
+            {
+                unsigned long long d;
+                const unsigned char out = _subborrow_u64(borrow, x, y, &d);
+                difference = d;
+                return out;
+            }
+            else
+            {
+                unsigned int d;
+                const unsigned char out = _subborrow_u32(borrow, x, y, &d);
+                difference = d;
+                return out;
+            }
+        }
+        // add_n() through the carry flag, unrolled so that the carry stays in the flag across the limbs of a step.
+        inline digit add_n_carry_flag(digit* r, const digit* x, const digit* y, const std::size_t n)
+        {
+            unsigned char carry = 0;
+            std::size_t i = 0;
+            for(; i + 4 <= n; i += 4)
+            {
+                carry = add_with_carry(carry, x[i], y[i], r[i]);
+                carry = add_with_carry(carry, x[i + 1], y[i + 1], r[i + 1]);
+                carry = add_with_carry(carry, x[i + 2], y[i + 2], r[i + 2]);
+                carry = add_with_carry(carry, x[i + 3], y[i + 3], r[i + 3]);
+            }
+            for(; i < n; i++)
+            {
+                carry = add_with_carry(carry, x[i], y[i], r[i]);
+            }
+            return carry;
+        }
+        // sub_n() through the carry flag.
+        inline digit sub_n_carry_flag(digit* r, const digit* x, const digit* y, const std::size_t n)
+        {
+            unsigned char borrow = 0;
+            std::size_t i = 0;
+            for(; i + 4 <= n; i += 4)
+            {
+                borrow = subtract_with_borrow(borrow, x[i], y[i], r[i]);
+                borrow = subtract_with_borrow(borrow, x[i + 1], y[i + 1], r[i + 1]);
+                borrow = subtract_with_borrow(borrow, x[i + 2], y[i + 2], r[i + 2]);
+                borrow = subtract_with_borrow(borrow, x[i + 3], y[i + 3], r[i + 3]);
+            }
+            for(; i < n; i++)
+            {
+                borrow = subtract_with_borrow(borrow, x[i], y[i], r[i]);
+            }
+            return borrow;
+        }
+#endif
+#if defined(__x86_64__) and INTTITAN_DIGIT_BITS == 64
+        // addmul_1() with MULX (BMI2), whose flags-free products leave the carry flag and the overflow flag to two
+        // separate carry chains (ADCX for the high halves of the products, ADOX for r), four limbs per step. The compilers
+        // do not keep the chains apart when given the intrinsics, hence the assembly.
+        inline digit addmul_1_mulx(digit* r, const digit* x, const std::size_t n, const digit d)
+        {
+            // The limbs beyond a multiple of four go first, so that the carry goes on into the steps.
+            const std::size_t head = n % 4;
+            digit carry = addmul_1_portable(r, x, head, d);
+            std::size_t steps = n / 4;
+            if(steps == 0)
+            {
+                return carry;
+            }
+            r += head;
+            x += head;
+            digit low;
+            digit high;
+            // MULX takes d in rdx; LEA and JRCXZ leave the flags alone. The XOR clears both of them.
+            __asm__ volatile(
+                "xor %k[low], %k[low]\n\t"
+                "1:\n\t"
+                "mulx (%[x]), %[low], %[high]\n\t"
+                "adcx %[carry], %[low]\n\t"
+                "adox (%[r]), %[low]\n\t"
+                "mov %[low], (%[r])\n\t"
+                "mulx 8(%[x]), %[low], %[carry]\n\t"
+                "adcx %[high], %[low]\n\t"
+                "adox 8(%[r]), %[low]\n\t"
+                "mov %[low], 8(%[r])\n\t"
+                "mulx 16(%[x]), %[low], %[high]\n\t"
+                "adcx %[carry], %[low]\n\t"
+                "adox 16(%[r]), %[low]\n\t"
+                "mov %[low], 16(%[r])\n\t"
+                "mulx 24(%[x]), %[low], %[carry]\n\t"
+                "adcx %[high], %[low]\n\t"
+                "adox 24(%[r]), %[low]\n\t"
+                "mov %[low], 24(%[r])\n\t"
+                "lea 32(%[x]), %[x]\n\t"
+                "lea 32(%[r]), %[r]\n\t"
+                "lea -1(%[steps]), %[steps]\n\t"
+                "jrcxz 2f\n\t"
+                "jmp 1b\n\t"
+                "2:\n\t"
+                "mov $0, %k[low]\n\t"
+                "adcx %[low], %[carry]\n\t"
+                "adox %[low], %[carry]\n\t"
+                : [r] "+&r"(r), [x] "+&r"(x), [steps] "+&c"(steps), [carry] "+&r"(carry), [low] "=&r"(low), [high] "=&r"(high)
+                : "d"(d)
+                : "cc", "memory");
+            return carry;
+        }
+#endif
+        // r = x * y (schoolbook) with the given addmul_1(), without any allocation. Writes xn + yn limbs, r must not
+        // overlap x or y.
+        template<digit (*AddMul)(digit*, const digit*, std::size_t, digit)>
+        void multiply_basecase_with(digit* r, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn)
+        {
+            if(yn == 0)
+            {
+                std::fill(r, r + xn, digit(0));
+                return;
+            }
+            r[xn] = multiply_by_digit(r, x, xn, y[0]);
+            for(std::size_t j = 1; j < yn; j++)
+            {
+                r[xn + j] = AddMul(r + j, x, xn, y[j]);
+            }
+        }
+        // The kernels that have versions for instruction set extensions, bound to the best ones for the processor (see
+        // cpu()) the first time they are needed.
+        struct arithmetic_kernels
+        {
+            digit (*add_n)(digit*, const digit*, const digit*, std::size_t);
+            digit (*sub_n)(digit*, const digit*, const digit*, std::size_t);
+            digit (*addmul_1)(digit*, const digit*, std::size_t, digit);
+            void (*multiply_basecase)(digit*, const digit*, std::size_t, const digit*, std::size_t);
+        };
+        inline arithmetic_kernels select_arithmetic_kernels(const cpu_features& features)
+        {
+            arithmetic_kernels selected{add_n_portable, sub_n_portable, addmul_1_portable, multiply_basecase_with<addmul_1_portable>};
+#if defined(__x86_64__)
+            if(features.carry_flag)
+            {
+                selected.add_n = add_n_carry_flag;
+                selected.sub_n = sub_n_carry_flag;
+            }
+#endif
+#if defined(__x86_64__) and INTTITAN_DIGIT_BITS == 64
+            if(features.bmi2 and features.adx)
+            {
+                selected.addmul_1 = addmul_1_mulx;
+                selected.multiply_basecase = multiply_basecase_with<addmul_1_mulx>;
+            }
+#endif
+            (void)features;
+            return selected;
+        }
+        inline const arithmetic_kernels& arithmetic()
+        {
+            static const arithmetic_kernels selected = select_arithmetic_kernels(cpu());
+            return selected;
+        }
+        // r = x + y, all n limbs. Returns the carry out of the top one. r may alias x or y.
+        inline digit add_n(digit* r, const digit* x, const digit* y, const std::size_t n)
+        {
+            // A few limbs are not worth a call through a pointer.
+            if(n < 4)
+            {
+                return add_n_portable(r, x, y, n);
+            }
+            return arithmetic().add_n(r, x, y, n);
+        }
+        // r = x - y, all n limbs. Returns the borrow out of the top one. r may alias x or y.
+        inline digit sub_n(digit* r, const digit* x, const digit* y, const std::size_t n)
+        {
+            if(n < 4)
+            {
+                return sub_n_portable(r, x, y, n);
+            }
+            return arithmetic().sub_n(r, x, y, n);
+        }
+        // r = r + x * d, both of n limbs. Returns the carry limb.
+        inline digit addmul_1(digit* r, const digit* x, const std::size_t n, const digit d)
+        {
+            return arithmetic().addmul_1(r, x, n, d);
+        }
+        // r = x * y (schoolbook), without any allocation. Writes xn + yn limbs, r must not overlap x or y.
+        inline void multiply_basecase(digit* r, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn)
+        {
+            arithmetic().multiply_basecase(r, x, xn, y, yn);
+        }
+        // r = x + y, where xn >= yn. Writes xn limbs and returns the carry out of the top one. r may alias x or y.
+        inline digit add(digit* r, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn)
+        {
+            digit carry = add_n(r, x, y, yn);
+            std::size_t i = yn;
+            // The carry runs into the rest of x, which only needs copying once it stops (in place, not even that).
+            for(; i < xn and carry != 0; i++)
+            {
+                r[i] = x[i] + 1;
+                carry = r[i] == 0 ? 1 : 0;
+            }
+            if(r != x)
+            {
+                std::copy(x + i, x + xn, r + i);
+            }
+            return carry;
+        }
+        // r = x - y, where xn >= yn. Writes xn limbs and returns the borrow out of the top one. r may alias x or y.
+        inline digit subtract(digit* r, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn)
+        {
+            digit borrow = sub_n(r, x, y, yn);
+            std::size_t i = yn;
+            for(; i < xn and borrow != 0; i++)
+            {
+                borrow = x[i] == 0 ? 1 : 0;
+                r[i] = x[i] - 1;
+            }
+            if(r != x)
+            {
+                std::copy(x + i, x + xn, r + i);
+            }
+            return borrow;
+        }
+        // Number of leading zero bits of a non-zero digit.
+        inline int leading_zeros(const digit d)
+        {
+            assert(d != 0);
+            if constexpr(digit_bits == 64)
+            {
+                return __builtin_clzll(d);
+            }
+            else
+            {
+                return __builtin_clz(d);
+            }
+        }
+        // Number of trailing zero bits of a non-zero digit.
+        inline int trailing_zeros(const digit d)
+        {
+            assert(d != 0);
+            if constexpr(digit_bits == 64)
+            {
+                return __builtin_ctzll(d);
+            }
+            else
+            {
+                return __builtin_ctz(d);
+            }
+        }
+        // Number of one bits of a digit (POPCNT where the compiler targets it).
+        inline int population_count(const digit d)
+        {
+            if constexpr(digit_bits == 64)
+            {
+                return __builtin_popcountll(d);
+            }
+            else
+            {
+                return __builtin_popcount(d);
+            }
+        }
+        // r = x << s (0 <= s < digit_bits). Writes n limbs and returns the bits shifted out of the top. r may alias x.
+        inline digit shift_left_bits(digit* r, const digit* x, const std::size_t n, const int s)
+        {
+            if(s == 0)
+            {
+                std::copy_backward(x, x + n, r + n);
+                return 0;
+            }
+            if(n == 0)
+            {
+                return 0;
+            }
+            const digit out = x[n - 1] >> (digit_bits - s);
+            for(std::size_t i = n - 1; i != 0; i--)
+            {
+                r[i] = (x[i] << s) | (x[i - 1] >> (digit_bits - s));
+            }
+            r[0] = x[0] << s;
+            return out;
+        }
+        // r = x >> s (0 <= s < digit_bits). Writes n limbs and returns the bits shifted out of the bottom (at the top of
+        // the returned digit). r may alias x.
+        inline digit shift_right_bits(digit* r, const digit* x, const std::size_t n, const int s)
+        {
+            if(s == 0)
+            {
+                std::copy(x, x + n, r);
+                return 0;
+            }
+            const digit out = n != 0 ? x[0] << (digit_bits - s) : 0;
+            for(std::size_t i = 0; i < n; i++)
+            {
+                const digit high = i + 1 < n ? x[i + 1] << (digit_bits - s) : 0;
+                r[i] = (x[i] >> s) | high;
+            }
+            return out;
+        }
+        // A divisor of one digit, prepared for the 2-by-1 division of Moller and Granlund ("Improved division by invariant
+        // integers", 2011): d shifted up to its top bit, and its reciprocal v = floor((B^2 - 1) / d) - B, the only division
+        // it takes. Every digit of a quotient then costs two multiplications instead of a division of a superdigit.
+        struct digit_divisor
+        {
+            int shift;
+            digit d;
+            digit v;
+            explicit digit_divisor(const digit divisor) : shift(leading_zeros(divisor)), d(divisor << shift),
+                v(static_cast<digit>(((static_cast<superdigit>(~d) << digit_bits) | std::numeric_limits<digit>::max()) / d))
+            {
+            }
+            // q = (u1 B + u0) / d and u1 = the remainder, for u1 < d.
+            digit divide(digit& u1, const digit u0) const
+            {
+                const superdigit product = static_cast<superdigit>(v) * u1 + ((static_cast<superdigit>(u1) << digit_bits) | u0);
+                digit q = static_cast<digit>(product >> digit_bits) + 1;
+                digit r = u0 - q * d;
+                if(r > static_cast<digit>(product))
+                {
+                    q--;
+                    r += d;
+                }
+                if(r >= d)
+                {
+                    q++;
+                    r -= d;
+                }
+                u1 = r;
+                return q;
+            }
+        };
+        // r = x / d, returns the remainder. Writes n limbs, r may alias x. The digits of x are shifted as d was, on the
+        // way, and the remainder back.
+        inline digit divide_by_digit(digit* r, const digit* x, const std::size_t n, const digit_divisor& d)
+        {
+            if(n == 0)
+            {
+                return 0;
+            }
+            if(d.shift == 0)
+            {
+                digit remainder = 0;
+                for(std::size_t i = n; i-- != 0;)
+                {
+                    r[i] = d.divide(remainder, x[i]);
+                }
+                return remainder;
+            }
+            digit remainder = x[n - 1] >> (digit_bits - d.shift);
+            for(std::size_t i = n; i-- != 0;)
+            {
+                const digit low = i != 0 ? x[i - 1] >> (digit_bits - d.shift) : 0;
+                r[i] = d.divide(remainder, (x[i] << d.shift) | low);
+            }
+            return remainder >> d.shift;
+        }
+        inline digit divide_by_digit(digit* r, const digit* x, const std::size_t n, const digit d)
+        {
+            return divide_by_digit(r, x, n, digit_divisor(d));
+        }
+        // x mod d for x of n limbs, without the quotient.
+        inline digit modulo_digit(const digit* x, const std::size_t n, const digit_divisor& d)
+        {
+            if(n == 0)
+            {
+                return 0;
+            }
+            digit remainder = d.shift == 0 ? 0 : x[n - 1] >> (digit_bits - d.shift);
+            for(std::size_t i = n; i-- != 0;)
+            {
+                const digit low = d.shift != 0 and i != 0 ? x[i - 1] >> (digit_bits - d.shift) : 0;
+                d.divide(remainder, (x[i] << d.shift) | low);
+            }
+            return remainder >> d.shift;
+        }
+        inline digit modulo_digit(const digit* x, const std::size_t n, const digit d)
+        {
+            return modulo_digit(x, n, digit_divisor(d));
+        }
+        // r = x / d for an x known to be a multiple of d, without a remainder to carry: from the bottom, each digit of
+        // the quotient is the difference times the inverse of the odd part of d modulo B (Jebelean's exact division),
+        // after the trailing zero bits of d are shifted out of x. Writes n limbs, r may alias x.
+        inline void divide_exact_by_digit(digit* r, const digit* x, const std::size_t n, digit d)
+        {
+            const int zeros = trailing_zeros(d);
+            d >>= zeros;
+            // The inverse of d modulo B by Newton's iteration, as d is its own inverse modulo 8.
+            digit inverse = d;
+            for(int bits = 3; bits < digit_bits; bits *= 2)
+            {
+                inverse *= 2 - d * inverse;
+            }
+            digit borrow = 0;
+            for(std::size_t i = 0; i < n; i++)
+            {
+                digit current = x[i];
+                if(zeros != 0)
+                {
+                    current = (current >> zeros) | (i + 1 < n ? x[i + 1] << (digit_bits - zeros) : 0);
+                }
+                const digit difference = current - borrow;
+                const digit q = difference * inverse;
+                r[i] = q;
+                borrow = static_cast<digit>((static_cast<superdigit>(q) * d) >> digit_bits) + (current < borrow);
+            }
+        }
+        // The 128-bit product of a and b folded to 64 bits (low half xor high half), the mixing step of the hash.
+        inline std::uint64_t hash_mix(const std::uint64_t a, const std::uint64_t b)
+        {
+#if defined(__SIZEOF_INT128__)
+            const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+            return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+#else
+            const std::uint64_t a0 = a & 0xFFFFFFFFu, a1 = a >> 32, b0 = b & 0xFFFFFFFFu, b1 = b >> 32;
+            const std::uint64_t middle = (a0 * b0 >> 32) + (a1 * b0 & 0xFFFFFFFFu) + a0 * b1;
+            const std::uint64_t low = a * b;
+            const std::uint64_t high = a1 * b1 + (a1 * b0 >> 32) + (middle >> 32);
+            return low ^ high;
+#endif
+        }
+        // Hash of the n limbs of x (without leading zeroes) and a seed, by multiply-mixing 16 bytes at a time as wyhash
+        // does. The limbs are read as 64-bit words, so the hash is the same for both digit sizes.
+        inline std::uint64_t hash(const digit* x, const std::size_t n, const std::uint64_t seed)
+        {
+            constexpr std::uint64_t k0 = 0xA0761D6478BD642Full;
+            constexpr std::uint64_t k1 = 0xE7037ED1A0B428DBull;
+            constexpr std::uint64_t k2 = 0x8EBC6AF09C88C6E3ull;
+            constexpr std::size_t per_word = 64 / digit_bits;
+            const std::size_t words = (n + per_word - 1) / per_word;
+            const auto word = [x, n](const std::size_t i)
+            {
+                std::uint64_t w = 0;
+                for(std::size_t j = 0; j < per_word and i * per_word + j < n; j++)
+                {
+                    w |= static_cast<std::uint64_t>(x[i * per_word + j]) << (j * digit_bits % 64);
+                }
+                return w;
+            };
+            std::uint64_t h = seed ^ k0;
+            std::size_t i = 0;
+            for(; i + 2 <= words; i += 2)
+            {
+                h = hash_mix(word(i) ^ k1, word(i + 1) ^ h);
+            }
+            if(i < words)
+            {
+                h = hash_mix(word(i) ^ k1, h ^ k2);
+            }
+            return hash_mix(h ^ k2, words ^ k1);
+        }
+        // Temporary limbs taken from memory provided by the caller. It is passed by value, so whatever a callee takes is
+        // given back when it returns.
+        struct scratch_space
+        {
+            digit* next;
+            digit* end;
+            digit* take(const std::size_t n)
+            {
+                assert(n <= static_cast<std::size_t>(end - next));
+                return std::exchange(next, next + n);
+            }
+        };
+        // r = x^2 (schoolbook), computing every cross product x[i] * x[j] (i < j) once and doubling their sum, so it
+        // takes about half the digit products of multiply_basecase. Writes 2n limbs, r must not overlap x.
+        inline void square_basecase(digit* r, const digit* x, const std::size_t n)
+        {
+            std::fill(r, r + 2 * n, digit(0));
+            for(std::size_t i = 0; i + 1 < n; i++)
+            {
+                r[i + n] = addmul_1(r + 2 * i + 1, x + i + 1, n - i - 1, x[i]);
+            }
+            // The cross products count twice, then the squares on the diagonal are added.
+            shift_left_bits(r, r, 2 * n, 1);
+            digit carry = 0;
+            for(std::size_t i = 0; i < n; i++)
+            {
+                const superdigit square = static_cast<superdigit>(x[i]) * x[i];
+                const superdigit low = static_cast<superdigit>(r[2 * i]) + static_cast<digit>(square) + carry;
+                r[2 * i] = static_cast<digit>(low);
+                const superdigit high = static_cast<superdigit>(r[2 * i + 1]) + (square >> digit_bits) + (low >> digit_bits);
+                r[2 * i + 1] = static_cast<digit>(high);
+                carry = static_cast<digit>(high >> digit_bits);
+            }
+        }
+    }
+}
+
+#endif //INTTITAN_KERNELS_H
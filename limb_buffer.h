@@ -0,0 +1,241 @@
+#ifndef INTTITAN_LIMB_BUFFER_H
+#define INTTITAN_LIMB_BUFFER_H
+#include "memory.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+namespace int_titan
+{
+    // A contiguous buffer of limbs (little-endian). Up to InlineLimbs limbs are kept inside the object itself, larger
+    // buffers live in a heap memory block that is shared between copies and copied on the first write (copy-on-write).
+    // The block comes from the heap of MemoryPolicy and has its reference count, see memory.h.
+    template<typename Digit, std::size_t InlineLimbs = 0, typename MemoryPolicy = default_memory_policy>
+    class limb_buffer
+    {
+    public:
+        using value_type = Digit;
+        using size_type = std::size_t;
+        using const_iterator = const Digit*;
+        using memory_policy = MemoryPolicy;
+        static constexpr size_type inline_capacity = InlineLimbs;
+        limb_buffer() = default;
+        // Buffer of 'count' zero limbs.
+        explicit limb_buffer(const size_type count)
+        {
+            resize(count);
+        }
+        // Copy of the limbs in [first, last).
+        limb_buffer(const Digit* first, const Digit* last)
+        {
+            const size_type n = last - first;
+            if(n > InlineLimbs)
+            {
+                block = allocate(n);
+            }
+            std::copy(first, last, storage());
+            count = n;
+        }
+        limb_buffer(std::initializer_list<Digit> digits) : limb_buffer(digits.begin(), digits.end())
+        {
+        }
+        // The single limb d, inline (there must be room for one), in a constant expression: a buffer of static storage
+        // is then initialized at compile time, with no code run at startup.
+        constexpr limb_buffer(std::in_place_t, const Digit d) : count(1), local{d}
+        {
+            static_assert(InlineLimbs >= 1, "No inline limb for the digit.");
+        }
+        limb_buffer(const limb_buffer& other) noexcept : block(other.block), count(other.count)
+        {
+            if(block != nullptr)
+            {
+                block->inc();
+            }
+            else
+            {
+                local = other.local;
+            }
+        }
+        limb_buffer(limb_buffer&& other) noexcept : block(std::exchange(other.block, nullptr)), count(std::exchange(other.count, 0))
+        {
+            if(block == nullptr)
+            {
+                local = other.local;
+            }
+        }
+        limb_buffer& operator=(const limb_buffer& other) noexcept
+        {
+            if(this != &other)
+            {
+                limb_buffer copy(other);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+        limb_buffer& operator=(limb_buffer&& other) noexcept
+        {
+            if(this != &other)
+            {
+                release(std::exchange(block, std::exchange(other.block, nullptr)));
+                count = std::exchange(other.count, 0);
+                if(block == nullptr)
+                {
+                    local = other.local;
+                }
+            }
+            return *this;
+        }
+        ~limb_buffer()
+        {
+            release(block);
+        }
+        size_type size() const
+        {
+            return count;
+        }
+        bool empty() const
+        {
+            return count == 0;
+        }
+        size_type capacity() const
+        {
+            return block != nullptr ? block->capacity : InlineLimbs;
+        }
+        const Digit* data() const
+        {
+            return block != nullptr ? limbs(block) : local.data();
+        }
+        const_iterator begin() const
+        {
+            return data();
+        }
+        const_iterator end() const
+        {
+            return data() + count;
+        }
+        Digit operator[](const size_type index) const
+        {
+            assert(index < count);
+            return data()[index];
+        }
+        // Are the limbs kept inside the object (no heap memory)?
+        bool is_inline() const
+        {
+            return block == nullptr;
+        }
+        // Is this the only copy referring to the memory block?
+        bool unique() const
+        {
+            return block == nullptr or block->unique();
+        }
+        // Mutable access to the limbs, detaching from the other copies first.
+        Digit* mutable_data()
+        {
+            if(!unique())
+            {
+                detach(count);
+            }
+            return storage();
+        }
+        // Make room for at least 'new_capacity' limbs without changing the size.
+        void reserve(const size_type new_capacity)
+        {
+            if(new_capacity > capacity() or !unique())
+            {
+                detach(std::max(new_capacity, count));
+            }
+        }
+        // Change the number of limbs, the new limbs are zero.
+        void resize(const size_type new_count)
+        {
+            if(new_count <= count)
+            {
+                // Shrinking never writes, so the memory block can stay shared.
+                count = new_count;
+                return;
+            }
+            if(new_count > capacity())
+            {
+                detach(std::max(new_count, 2 * capacity()));
+            }
+            else if(!unique())
+            {
+                detach(new_count);
+            }
+            std::fill(storage() + count, storage() + new_count, Digit(0));
+            count = new_count;
+        }
+        void push_back(const Digit d)
+        {
+            resize(count + 1);
+            storage()[count - 1] = d;
+        }
+        // Do both refer to the same limbs (the same object or a shared memory block)?
+        bool shares_storage(const limb_buffer& other) const
+        {
+            return this == &other or (block != nullptr and block == other.block);
+        }
+        // The buffer is contiguous already, so it is its own view.
+        const limb_buffer& view() const
+        {
+            return *this;
+        }
+        friend bool operator==(const limb_buffer& x, const limb_buffer& y)
+        {
+            return x.count == y.count and ((x.block != nullptr and x.block == y.block) or std::equal(x.begin(), x.end(), y.begin()));
+        }
+        friend bool operator!=(const limb_buffer& x, const limb_buffer& y)
+        {
+            return !(x == y);
+        }
+    private:
+        // The memory block: the reference count and capacity, followed by the limbs.
+        struct header : MemoryPolicy::refcount
+        {
+            size_type capacity;
+        };
+        // The blocks vary in size, so the heap is used without the free lists for fixed sizes.
+        using heap = typename MemoryPolicy::heap::type;
+        // The heap memory block, or nullptr while the limbs are inline.
+        header* block = nullptr;
+        size_type count = 0;
+        std::array<Digit, InlineLimbs> local{};
+        Digit* storage()
+        {
+            return block != nullptr ? limbs(block) : local.data();
+        }
+        static Digit* limbs(header* h)
+        {
+            return reinterpret_cast<Digit*>(h + 1);
+        }
+        static header* allocate(const size_type capacity)
+        {
+            header* h = new(heap::allocate(sizeof(header) + capacity * sizeof(Digit))) header();
+            h->capacity = capacity;
+            return h;
+        }
+        static void release(header* h)
+        {
+            if(h != nullptr and h->dec())
+            {
+                const size_type capacity = h->capacity;
+                h->~header();
+                heap::deallocate(sizeof(header) + capacity * sizeof(Digit), h);
+            }
+        }
+        // Move the limbs into new, uniquely owned memory (inline if they fit).
+        void detach(const size_type new_capacity)
+        {
+            assert(block != nullptr or new_capacity > InlineLimbs);
+            header* h = new_capacity > InlineLimbs ? allocate(new_capacity) : nullptr;
+            Digit* destination = h != nullptr ? limbs(h) : local.data();
+            std::copy(data(), data() + count, destination);
+            release(std::exchange(block, h));
+        }
+    };
+}
+
+#endif //INTTITAN_LIMB_BUFFER_H
@@ -1,74 +1,317 @@
-#include "integer.h"
+#include "calculator.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
-#include <regex>
+#include <vector>
+// Files are mapped and the terminal detected through the POSIX interface where there is one.
+#if __has_include(<sys/mman.h>) and __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define INTTITAN_POSIX_INPUT 1
+#else
+#define INTTITAN_POSIX_INPUT 0
+#endif
 
-using int_titan::integer;
+using int_titan::calculator;
 
-void free_calculator()
+namespace
 {
-    while(true)
+    const char* const usage =
+        "IntTitan [options] [file | -]...\n"
+        "Evaluates the expression on every line of the files (- for the standard input) and writes its value, or\n"
+        "\"error: \" and the reason, on a line of its own. Without files, reads the standard input, or runs the\n"
+        "interactive calculator when it is a terminal.\n"
+        "  -b, --base N          base of the numbers in the expressions, 2 to 36 (default 16)\n"
+        "  -o, --output-base N   base of the values written (default that of the expressions)\n"
+        "  -l, --lowercase       lowercase letters in the values\n"
+        "  -j, --threads N       evaluate on N threads (0 for one per processor), the output in the order of the input\n"
+        "  -h, --help            this text\n";
+    struct options
     {
-        std::cout << "Radix = 16" << std::endl;
-        int radix = 16; // Currently, only hex is supported.
-        std::cout << "Enter the expression (end with '='):" << std::endl;
-        std::string expression;
-        std::cin.ignore();
-        std::getline(std::cin, expression, '=');
-        auto split = [](const std::string& str, const std::string& regex) -> std::vector<std::string>
+        int base = 16;
+        int output_base = 0;
+        bool uppercase = true;
+        std::size_t threads = 1;
+        std::vector<std::string> files;
+    };
+    // Lines evaluated in one go: a window of the input, split into parts for the threads.
+    constexpr std::size_t window_size = 16 << 20;
+    // Evaluates windows of complete lines and writes their results to the output, on the calling thread or across a
+    // pool. Every part has a calculator of its own, and the outputs are written in the order of the parts.
+    class batch
+    {
+    public:
+        explicit batch(const options& o) : pool(o.threads > 1 ? std::make_unique<int_titan::thread_pool>(o.threads) : nullptr)
         {
-            std::regex r(regex);
-            return {std::sregex_token_iterator(str.begin(), str.end(), r, -1), std::sregex_token_iterator()};
-        };
-        std::vector<std::string> terms = split(expression, R"([+\-\n])");
-        std::vector<char> operations;
-        if(expression[0] != '+' and expression[0] != '-')
+            const std::size_t parts = pool == nullptr ? 1 : 4 * o.threads;
+            calculators.assign(parts, calculator(o.base, o.output_base, o.uppercase));
+            outputs.resize(parts);
+        }
+        void evaluate(const std::string_view text)
         {
-            operations.emplace_back('+');
+            if(pool == nullptr)
+            {
+                calculators[0].evaluate_text(text, outputs[0]);
+                flush(1);
+                return;
+            }
+            // Equal parts of the characters, each moved to the end of the line it falls in.
+            const std::size_t parts = calculators.size();
+            std::vector<std::size_t> bounds(parts + 1, text.size());
+            bounds[0] = 0;
+            for(std::size_t p = 1; p < parts; p++)
+            {
+                const std::size_t newline = text.find('\n', std::max(bounds[p - 1], text.size() * p / parts));
+                bounds[p] = newline == std::string_view::npos ? text.size() : newline + 1;
+            }
+            pool->run(parts, [&](const std::size_t p)
+            {
+                calculators[p].evaluate_text(text.substr(bounds[p], bounds[p + 1] - bounds[p]), outputs[p]);
+            });
+            flush(parts);
         }
-        for(char c : expression)
+        // Evaluate all of the stream, a window at a time.
+        void evaluate(std::istream& in)
         {
-            if(c == '+' or c == '-')
+            std::string input;
+            while(true)
             {
-                operations.emplace_back(c);
+                const std::size_t kept = input.size();
+                input.resize(kept + window_size);
+                in.read(input.data() + kept, static_cast<std::streamsize>(window_size));
+                input.resize(kept + static_cast<std::size_t>(in.gcount()));
+                const bool last = input.size() == kept;
+                const std::size_t end = last ? input.size() : input.rfind('\n') + 1;
+                evaluate(std::string_view(input).substr(0, end));
+                input.erase(0, end);
+                if(last)
+                {
+                    return;
+                }
             }
         }
-        auto compute = [](const std::vector<std::string>& terms, const std::vector<char>& operations, const int radix) -> integer
+        // Evaluate all of the text, a window at a time.
+        void evaluate_all(const std::string_view text)
         {
-            assert(terms.size() == operations.size());
-            integer sum = integer::create("0", radix);
-            for(int i = 0; i < terms.size(); i++)
+            for(std::size_t start = 0; start < text.size();)
             {
-                integer num = integer::create(terms[i], radix == 16);
-                if(operations[i] == '-')
+                std::size_t end = text.size();
+                if(text.size() - start > window_size)
                 {
-                    num = integer::negate(num);
+                    const std::size_t newline = text.find('\n', start + window_size);
+                    end = newline == std::string_view::npos ? text.size() : newline + 1;
                 }
-                sum = integer::add(sum, num);
+                evaluate(text.substr(start, end - start));
+                start = end;
+            }
+        }
+    private:
+        std::unique_ptr<int_titan::thread_pool> pool;
+        std::vector<calculator> calculators;
+        std::vector<std::string> outputs;
+        void flush(const std::size_t parts)
+        {
+            for(std::size_t p = 0; p < parts; p++)
+            {
+                std::cout.write(outputs[p].data(), static_cast<std::streamsize>(outputs[p].size()));
+                outputs[p].clear();
+            }
+        }
+    };
+    // Evaluate the file at path, mapped into memory if it can be, else read as a stream. False if it cannot be read.
+    bool evaluate_file(batch& b, const std::string& path)
+    {
+#if INTTITAN_POSIX_INPUT
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+        {
+            return false;
+        }
+        struct stat status;
+        if(::fstat(fd, &status) == 0 and S_ISREG(status.st_mode) and status.st_size > 0)
+        {
+            const std::size_t length = static_cast<std::size_t>(status.st_size);
+            void* const data = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data != MAP_FAILED)
+            {
+                ::close(fd);
+                ::madvise(data, length, MADV_SEQUENTIAL);
+                b.evaluate_all(std::string_view(static_cast<const char*>(data), length));
+                ::munmap(data, length);
+                return true;
             }
-            return sum;
-        };
-        integer result = compute(terms, operations, radix);
-        std::cout << integer::to_string(result, radix, true) << std::endl;
+        }
+        ::close(fd);
+#endif
+        std::ifstream in(path, std::ios::binary);
+        if(!in)
+        {
+            return false;
+        }
+        b.evaluate(in);
+        return true;
+    }
+    bool interactive_input()
+    {
+#if INTTITAN_POSIX_INPUT
+        return ::isatty(STDIN_FILENO) != 0;
+#else
+        return true;
+#endif
+    }
+    // The number in text, or -1 if it is not one.
+    long number(const char* text)
+    {
+        char* end = nullptr;
+        const long n = std::strtol(text, &end, 10);
+        return end == text or *end != '\0' or n < 0 ? -1 : n;
+    }
+    // Parse the arguments into o, false (after a message) for a malformed command line.
+    bool parse_arguments(const int argc, char** argv, options& o)
+    {
+        for(int i = 1; i < argc; i++)
+        {
+            const std::string_view argument = argv[i];
+            const auto value = [&](long& n)
+            {
+                if(i + 1 >= argc or (n = number(argv[i + 1])) < 0)
+                {
+                    std::cerr << "IntTitan: " << argument << " takes a number\n";
+                    return false;
+                }
+                i++;
+                return true;
+            };
+            long n = 0;
+            if(argument == "-h" or argument == "--help")
+            {
+                std::cout << usage;
+                std::exit(0);
+            }
+            else if(argument == "-b" or argument == "--base")
+            {
+                if(!value(n))
+                {
+                    return false;
+                }
+                o.base = static_cast<int>(n);
+            }
+            else if(argument == "-o" or argument == "--output-base")
+            {
+                if(!value(n))
+                {
+                    return false;
+                }
+                o.output_base = static_cast<int>(n);
+            }
+            else if(argument == "-l" or argument == "--lowercase")
+            {
+                o.uppercase = false;
+            }
+            else if(argument == "-j" or argument == "--threads")
+            {
+                if(!value(n))
+                {
+                    return false;
+                }
+                o.threads = n == 0 ? std::max(1u, std::thread::hardware_concurrency()) : static_cast<std::size_t>(n);
+            }
+            else if(argument.size() > 1 and argument[0] == '-')
+            {
+                std::cerr << "IntTitan: unknown option " << argument << "\n" << usage;
+                return false;
+            }
+            else
+            {
+                o.files.emplace_back(argument);
+            }
+        }
+        const auto valid = [](const int base) { return base >= 2 and base <= 36; };
+        if(!valid(o.base) or (o.output_base != 0 and !valid(o.output_base)))
+        {
+            std::cerr << "IntTitan: bases from 2 to 36 expected\n";
+            return false;
+        }
+        return true;
     }
 }
 
-int main()
+void free_calculator(const options& o)
 {
-    std::cout << "Pick the desired option:" << std::endl;
-    std::cout << "1. Free calculator." << std::endl;
+    calculator evaluator(o.base, o.output_base, o.uppercase);
+    std::cout << "Radix = " << evaluator.base() << '\n';
+    std::string result;
     while(true)
     {
-        int selected;
-        std::cin >> selected;
-        std::unordered_map<int, decltype(&free_calculator)> options = {{ 1, &free_calculator }};
-        if (options.find(selected) != options.end())
+        std::cout << "Enter the expression (end with '='):" << std::endl;
+        std::string expression;
+        if(!std::getline(std::cin >> std::ws, expression, '='))
         {
-            options[selected]();
+            return;
         }
-        else
+        result.clear();
+        evaluator.evaluate_line(expression, result);
+        std::cout << result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    options o;
+    if(!parse_arguments(argc, argv, o))
+    {
+        return 2;
+    }
+    if(o.files.empty() and interactive_input())
+    {
+        std::cout << "Pick the desired option:\n";
+        std::cout << "1. Free calculator." << std::endl;
+        while(true)
+        {
+            int selected;
+            if(!(std::cin >> selected))
+            {
+                return 0;
+            }
+            std::unordered_map<int, void(*)(const options&)> choices = {{ 1, &free_calculator }};
+            if (choices.find(selected) != choices.end())
+            {
+                choices[selected](o);
+            }
+            else
+            {
+                std::cout << "No such option. Try again:" << std::endl;
+            }
+        }
+    }
+    std::ios::sync_with_stdio(false);
+    batch b(o);
+    if(o.files.empty())
+    {
+        o.files.emplace_back("-");
+    }
+    int status = 0;
+    for(const std::string& file : o.files)
+    {
+        if(file == "-")
         {
-            std::cout << "No such option. Try again:" << std::endl;
+            b.evaluate(std::cin);
+        }
+        else if(!evaluate_file(b, file))
+        {
+            std::cerr << "IntTitan: cannot read " << file << '\n';
+            status = 1;
         }
     }
-}
\ No newline at end of file
+    std::cout.flush();
+    return status;
+}
@@ -0,0 +1,278 @@
+#ifndef INTTITAN_MAPPED_H
+#define INTTITAN_MAPPED_H
+#include "config.h"
+#include "integer_view.h"
+#include "kernels.h"
+#include "memory.h"
+#include <immer/heap/heap_policy.hpp>
+#include <immer/lock/spinlock_policy.hpp>
+#include <immer/memory_policy.hpp>
+#include <immer/refcount/refcount_policy.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+// Memory-mapped files take the POSIX interface.
+#if __has_include(<sys/mman.h>) and __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define INTTITAN_MAPPED_FILES 1
+#else
+#define INTTITAN_MAPPED_FILES 0
+#endif
+
+// Integers that live in memory-mapped files, for values too large to keep resident: mapped_integer is a file in a compact
+// format (a header with the sign and the number of limbs, then the raw limbs) that is used in place by mmap, without
+// parsing, and mapped_memory_policy puts the large limb blocks of every integer into unlinked temporary files. Both
+// hand the kernels plain limb spans, the page cache moves them between memory and disk.
+namespace int_titan
+{
+#if INTTITAN_MAPPED_FILES
+    // The first bytes of a mapped integer file. The limbs follow, in the byte order of the host that wrote them, at a
+    // cache line from the start. Files are only read by builds with the same digit size and byte order.
+    struct mapped_header
+    {
+        char magic[8];
+        std::uint32_t version;
+        // 0x01020304 as written by the host.
+        std::uint32_t byte_order;
+        std::uint32_t digit_bits;
+        std::uint32_t is_negative;
+        std::uint64_t limbs;
+        unsigned char reserved[32];
+    };
+    static_assert(sizeof(mapped_header) == 64);
+    // An integer in a file mapped into memory: view() and limbs() read it in place, and the limbs of a writable
+    // mapping (open(path, true) or create()) are the output of the kernels as well, written back to the file by the
+    // page cache.
+    class mapped_integer
+    {
+    public:
+        mapped_integer() = default;
+        mapped_integer(const mapped_integer&) = delete;
+        mapped_integer& operator=(const mapped_integer&) = delete;
+        mapped_integer(mapped_integer&& other) noexcept : address(std::exchange(other.address, nullptr)), length(std::exchange(other.length, 0)), writable(other.writable)
+        {
+        }
+        mapped_integer& operator=(mapped_integer&& other) noexcept
+        {
+            if(this != &other)
+            {
+                unmap();
+                address = std::exchange(other.address, nullptr);
+                length = std::exchange(other.length, 0);
+                writable = other.writable;
+            }
+            return *this;
+        }
+        ~mapped_integer()
+        {
+            unmap();
+        }
+        // The integer of the file at path, also writable if asked.
+        static mapped_integer open(const std::string& path, const bool writable = false)
+        {
+            const int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+            if(fd < 0)
+            {
+                throw std::system_error(errno, std::generic_category(), "Cannot open " + path);
+            }
+            struct stat status;
+            if(::fstat(fd, &status) != 0)
+            {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "Cannot open " + path);
+            }
+            const std::size_t length = static_cast<std::size_t>(status.st_size);
+            if(length < sizeof(mapped_header))
+            {
+                ::close(fd);
+                throw std::invalid_argument("Not a mapped integer file: " + path);
+            }
+            mapped_integer x = map(fd, length, writable, path);
+            const mapped_header& h = x.header();
+            if(std::memcmp(h.magic, magic, sizeof(h.magic)) != 0 or h.version != version)
+            {
+                throw std::invalid_argument("Not a mapped integer file: " + path);
+            }
+            if(h.byte_order != byte_order_mark or h.digit_bits != digit_bits)
+            {
+                throw std::invalid_argument("Mapped integer file of another digit size or byte order: " + path);
+            }
+            if(h.limbs > (length - sizeof(mapped_header)) / sizeof(digit))
+            {
+                throw std::invalid_argument("Mapped integer file shorter than its limbs: " + path);
+            }
+            return x;
+        }
+        // A new file at path (replacing any) of n zero limbs and a non-negative sign, mapped writable.
+        static mapped_integer create(const std::string& path, const std::size_t n)
+        {
+            const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if(fd < 0)
+            {
+                throw std::system_error(errno, std::generic_category(), "Cannot create " + path);
+            }
+            const std::size_t length = sizeof(mapped_header) + n * sizeof(digit);
+            if(::ftruncate(fd, static_cast<off_t>(length)) != 0)
+            {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "Cannot create " + path);
+            }
+            mapped_integer x = map(fd, length, true, path);
+            mapped_header& h = x.header();
+            std::memcpy(h.magic, magic, sizeof(h.magic));
+            h.version = version;
+            h.byte_order = byte_order_mark;
+            h.digit_bits = digit_bits;
+            h.limbs = n;
+            return x;
+        }
+        // Write x to a new file at path.
+        static void save(const std::string& path, const integer_view& x)
+        {
+            mapped_integer file = create(path, x.size());
+            std::copy(x.limbs(), x.limbs() + x.size(), file.mutable_limbs());
+            file.set_negative(x.is_negative());
+        }
+        // The integer, read in place.
+        integer_view view() const
+        {
+            return integer_view(limbs(), size(), is_negative());
+        }
+        const digit* limbs() const
+        {
+            return reinterpret_cast<const digit*>(static_cast<const char*>(address) + sizeof(mapped_header));
+        }
+        // Throws unless the mapping is writable.
+        digit* mutable_limbs()
+        {
+            check_writable();
+            return reinterpret_cast<digit*>(static_cast<char*>(address) + sizeof(mapped_header));
+        }
+        // Number of limbs of the file, leading zeroes included.
+        std::size_t size() const
+        {
+            return address != nullptr ? static_cast<std::size_t>(header().limbs) : 0;
+        }
+        bool is_negative() const
+        {
+            return address != nullptr and header().is_negative != 0;
+        }
+        // Throws unless the mapping is writable.
+        void set_negative(const bool negative)
+        {
+            check_writable();
+            header().is_negative = negative ? 1 : 0;
+        }
+    private:
+        static constexpr char magic[8] = {'I', 'N', 'T', 'T', 'I', 'T', 'A', 'N'};
+        static constexpr std::uint32_t version = 1;
+        static constexpr std::uint32_t byte_order_mark = 0x01020304;
+        void* address = nullptr;
+        std::size_t length = 0;
+        bool writable = false;
+        // Map the length bytes of the open file fd, which is closed either way.
+        static mapped_integer map(const int fd, const std::size_t length, const bool writable, const std::string& path)
+        {
+            void* address = ::mmap(nullptr, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+            const int error = errno;
+            ::close(fd);
+            if(address == MAP_FAILED)
+            {
+                throw std::system_error(error, std::generic_category(), "Cannot map " + path);
+            }
+            mapped_integer x;
+            x.address = address;
+            x.length = length;
+            x.writable = writable;
+            return x;
+        }
+        mapped_header& header() const
+        {
+            return *static_cast<mapped_header*>(address);
+        }
+        void check_writable() const
+        {
+            if(address == nullptr or !writable)
+            {
+                throw std::logic_error("Writing to a read-only mapped integer impermissible.");
+            }
+        }
+        void unmap()
+        {
+            if(address != nullptr)
+            {
+                ::munmap(address, length);
+                address = nullptr;
+            }
+        }
+    };
+    // An immer heap whose blocks of INTTITAN_MAPPED_HEAP_THRESHOLD bytes or more are mapped from temporary files in
+    // directory(), unlinked as soon as they are created, so that the limbs of large integers are paged out to those files
+    // instead of to swap, and the disk space is given back when they are freed. Smaller blocks come from operator new.
+    struct mapped_heap
+    {
+        // Where the files go: $TMPDIR, else /tmp. Set it before the first large allocation.
+        static std::string& directory()
+        {
+            static std::string path = []
+            {
+                const char* tmp = std::getenv("TMPDIR");
+                return std::string(tmp != nullptr and *tmp != '\0' ? tmp : "/tmp");
+            }();
+            return path;
+        }
+        template<typename... Tags>
+        static void* allocate(const std::size_t size, Tags...)
+        {
+            if(size < INTTITAN_MAPPED_HEAP_THRESHOLD)
+            {
+                return ::operator new(size);
+            }
+            std::string name = directory() + "/inttitan-XXXXXX";
+            const int fd = ::mkstemp(name.data());
+            if(fd < 0)
+            {
+                throw std::bad_alloc();
+            }
+            ::unlink(name.c_str());
+            void* p = ::ftruncate(fd, static_cast<off_t>(size)) == 0 ? ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+            ::close(fd);
+            if(p == MAP_FAILED)
+            {
+                throw std::bad_alloc();
+            }
+            return p;
+        }
+        template<typename... Tags>
+        static void deallocate(const std::size_t size, void* data, Tags...)
+        {
+            if(size < INTTITAN_MAPPED_HEAP_THRESHOLD)
+            {
+                ::operator delete(data);
+            }
+            else
+            {
+                ::munmap(data, size);
+            }
+        }
+    };
+    // Atomic reference counts and the mapped_heap. The scratch memory of the kernels stays on the ordinary heap, see
+    // INTTITAN_SCRATCH_POOL_LIMIT.
+    using mapped_memory_policy = immer::memory_policy<immer::heap_policy<mapped_heap>, immer::refcount_policy, immer::spinlock_policy>;
+#endif
+}
+
+#endif //INTTITAN_MAPPED_H
@@ -0,0 +1,160 @@
+#ifndef INTTITAN_MEMORY_H
+#define INTTITAN_MEMORY_H
+#include <immer/heap/cpp_heap.hpp>
+#include <immer/heap/heap_policy.hpp>
+#include <immer/lock/no_lock_policy.hpp>
+#include <immer/memory_policy.hpp>
+#include <immer/refcount/unsafe_refcount_policy.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Memory policies for the limbs of an integer (see INTTITAN_MEMORY_POLICY). They are immer::memory_policy instances, so
+// the same policy serves the contiguous limb_buffer (which uses its heap and reference count) and the immer::flex_vector
+// of flex_limbs.
+namespace int_titan
+{
+    // Bump allocator for request-scoped computations: memory is cut out of large chunks by moving a pointer, freeing it
+    // does nothing (except for the most recent allocation, which is given back), and all of it is released at once by
+    // reset() or the destructor. An arena belongs to one thread, see arena_scope.
+    class arena
+    {
+    public:
+        // Chunks hold at least chunk_size bytes, larger allocations get a chunk of their own.
+        explicit arena(const std::size_t chunk_size = 64 * 1024) : chunk_size(chunk_size)
+        {
+        }
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+        ~arena()
+        {
+            while(chunks != nullptr)
+            {
+                ::operator delete(std::exchange(chunks, chunks->previous));
+            }
+        }
+        void* allocate(std::size_t size)
+        {
+            size = (size + alignment - 1) / alignment * alignment;
+            if(static_cast<std::size_t>(end - top) < size)
+            {
+                add_chunk(size);
+            }
+            void* p = top;
+            top += size;
+            used += size;
+            return p;
+        }
+        void deallocate(void* p, std::size_t size)
+        {
+            size = (size + alignment - 1) / alignment * alignment;
+            if(static_cast<char*>(p) + size == top)
+            {
+                top -= size;
+                used -= size;
+            }
+        }
+        // Release everything allocated so far; the newest chunk is kept for the next allocations.
+        void reset()
+        {
+            if(chunks == nullptr)
+            {
+                return;
+            }
+            while(chunks->previous != nullptr)
+            {
+                ::operator delete(std::exchange(chunks->previous, chunks->previous->previous));
+            }
+            top = reinterpret_cast<char*>(chunks) + sizeof(chunk);
+            used = 0;
+        }
+        // Bytes handed out and not given back since the last reset().
+        std::size_t bytes_used() const
+        {
+            return used;
+        }
+        // The arena the arena_heap of this thread allocates from, nullptr for none.
+        static arena*& current()
+        {
+            thread_local arena* active = nullptr;
+            return active;
+        }
+    private:
+        static constexpr std::size_t alignment = alignof(std::max_align_t);
+        // A chunk starts with this header, padded to the alignment.
+        struct alignas(alignof(std::max_align_t)) chunk
+        {
+            chunk* previous;
+            std::size_t size;
+        };
+        const std::size_t chunk_size;
+        chunk* chunks = nullptr;
+        char* top = nullptr;
+        char* end = nullptr;
+        std::size_t used = 0;
+        void add_chunk(const std::size_t size)
+        {
+            const std::size_t bytes = std::max(size, chunk_size);
+            chunk* c = static_cast<chunk*>(::operator new(sizeof(chunk) + bytes));
+            c->previous = chunks;
+            c->size = bytes;
+            chunks = c;
+            top = reinterpret_cast<char*>(c) + sizeof(chunk);
+            end = top + bytes;
+        }
+    };
+    // Makes an arena the current one of the thread for its lifetime, restoring the previous one after.
+    class arena_scope
+    {
+    public:
+        explicit arena_scope(arena& a) : previous(std::exchange(arena::current(), &a))
+        {
+        }
+        arena_scope(const arena_scope&) = delete;
+        arena_scope& operator=(const arena_scope&) = delete;
+        ~arena_scope()
+        {
+            arena::current() = previous;
+        }
+    private:
+        arena* previous;
+    };
+    // An immer heap that allocates from the current arena of the thread, or from operator new without one. Every block
+    // remembers where it came from, so it can be freed outside the scope too, but memory from an arena must be freed
+    // before the arena is reset or destroyed, i.e. the integers computed in a scope must not outlive the arena.
+    struct arena_heap
+    {
+        static constexpr std::size_t prefix = alignof(std::max_align_t);
+        template<typename... Tags>
+        static void* allocate(const std::size_t size, Tags...)
+        {
+            arena* a = arena::current();
+            char* p = static_cast<char*>(a != nullptr ? a->allocate(size + prefix) : ::operator new(size + prefix));
+            new(p) arena*(a);
+            return p + prefix;
+        }
+        template<typename... Tags>
+        static void deallocate(const std::size_t size, void* data, Tags...)
+        {
+            char* p = static_cast<char*>(data) - prefix;
+            arena* a = *std::launder(reinterpret_cast<arena**>(p));
+            if(a != nullptr)
+            {
+                a->deallocate(p, size + prefix);
+            }
+            else
+            {
+                ::operator delete(p);
+            }
+        }
+    };
+    // Atomic reference counts and the standard heap (with free lists for the tree nodes of flex_limbs).
+    using default_memory_policy = immer::default_memory_policy;
+    // Plain reference counts and unsynchronized free lists, for integers that never cross threads.
+    using single_thread_memory_policy = immer::memory_policy<immer::unsafe_free_list_heap_policy<immer::cpp_heap>, immer::unsafe_refcount_policy, immer::no_lock_policy>;
+    // Plain reference counts and the arena_heap. No free lists, which would keep arena memory past its release.
+    using arena_memory_policy = immer::memory_policy<immer::heap_policy<arena_heap>, immer::unsafe_refcount_policy, immer::no_lock_policy>;
+}
+
+#endif //INTTITAN_MEMORY_H
@@ -0,0 +1,142 @@
+#ifndef INTTITAN_MONTGOMERY_H
+#define INTTITAN_MONTGOMERY_H
+#include "config.h"
+#include "kernels.h"
+#include "multiplication.h"
+#include <algorithm>
+#include <cstddef>
+
+// Montgomery multiplication (P. L. Montgomery, Modular multiplication without trial division, 1985) modulo an odd m of n
+// limbs. A value x is kept as x * R mod m, where R = B^n, and the product of two such values is reduced by adding the
+// multiple of m that clears the low n limbs, one limb at a time, then dropping them. No division is needed after the
+// setup, see "Analyzing and comparing Montgomery multiplication algorithms" (Koc, Acar, Kaliski, 1996) for the CIOS and
+// FIOS orderings of the loops.
+namespace int_titan
+{
+    namespace kernels
+    {
+        // -m^-1 mod B for an odd m0, by Newton's iteration: m0 is its own inverse modulo 8, and each step doubles the
+        // number of correct bits.
+        inline digit montgomery_inverse(const digit m0)
+        {
+            digit inverse = m0;
+            for(int bits = 3; bits < digit_bits; bits *= 2)
+            {
+                inverse *= 2 - m0 * inverse;
+            }
+            return static_cast<digit>(0) - inverse;
+        }
+        // The result of a reduction is t (n limbs) plus top * B^n, below 2m: subtract m once if it is not below m. The
+        // subtraction is always done and undone by a mask, so that the time does not depend on the values (see the
+        // constant-time exponentiation). r may alias t.
+        inline void montgomery_finish(digit* r, const digit* t, const digit top, const digit* m, const std::size_t n)
+        {
+            const digit borrow = sub_n(r, t, m, n);
+            // t was below m if the subtraction borrowed and there is no top limb (which the borrow then cancels).
+            const digit mask = static_cast<digit>(0) - (borrow & (top ^ 1));
+            digit carry = 0;
+            for(std::size_t i = 0; i < n; i++)
+            {
+                const superdigit sum = static_cast<superdigit>(r[i]) + (m[i] & mask) + carry;
+                r[i] = static_cast<digit>(sum);
+                carry = static_cast<digit>(sum >> digit_bits);
+            }
+        }
+        // r = x * y / R mod m (x, y below m), finely integrated (FIOS): a single pass over the limbs of y and m for each
+        // limb of x, with the product and the reduction sharing it. t holds n + 1 limbs. Best for a few limbs, where the
+        // second pass of montgomery_multiply_cios() costs more than it saves.
+        inline void montgomery_multiply_fios(digit* r, const digit* x, const digit* y, const digit* m, const std::size_t n, const digit m_inverse, digit* t)
+        {
+            std::fill(t, t + n + 1, digit(0));
+            for(std::size_t i = 0; i < n; i++)
+            {
+                superdigit product = static_cast<superdigit>(x[i]) * y[0] + t[0];
+                digit product_carry = static_cast<digit>(product >> digit_bits);
+                const digit q = static_cast<digit>(product) * m_inverse;
+                superdigit reduced = static_cast<superdigit>(q) * m[0] + static_cast<digit>(product);
+                digit reduced_carry = static_cast<digit>(reduced >> digit_bits);
+                for(std::size_t j = 1; j < n; j++)
+                {
+                    product = static_cast<superdigit>(x[i]) * y[j] + t[j] + product_carry;
+                    product_carry = static_cast<digit>(product >> digit_bits);
+                    reduced = static_cast<superdigit>(q) * m[j] + static_cast<digit>(product) + reduced_carry;
+                    reduced_carry = static_cast<digit>(reduced >> digit_bits);
+                    // The low limb is cleared, so everything moves down by one.
+                    t[j - 1] = static_cast<digit>(reduced);
+                }
+                const superdigit top = static_cast<superdigit>(t[n]) + product_carry + reduced_carry;
+                t[n - 1] = static_cast<digit>(top);
+                t[n] = static_cast<digit>(top >> digit_bits);
+            }
+            montgomery_finish(r, t, t[n], m, n);
+        }
+        // r = x * y / R mod m (x, y below m), coarsely integrated (CIOS): for each limb of x, one addmul_1() pass adds
+        // x[i] * y and another the multiple of m that clears limb i, so both run on the fastest kernel for the processor.
+        // t holds 2n limbs.
+        inline void montgomery_multiply_cios(digit* r, const digit* x, const digit* y, const digit* m, const std::size_t n, const digit m_inverse, digit* t)
+        {
+            std::fill(t, t + n, digit(0));
+            digit carry = 0;
+            for(std::size_t i = 0; i < n; i++)
+            {
+                const digit product_carry = addmul_1(t + i, y, n, x[i]);
+                const digit reduced_carry = addmul_1(t + i, m, n, t[i] * m_inverse);
+                const superdigit top = static_cast<superdigit>(product_carry) + reduced_carry + carry;
+                t[i + n] = static_cast<digit>(top);
+                carry = static_cast<digit>(top >> digit_bits);
+            }
+            montgomery_finish(r, t + n, carry, m, n);
+        }
+        // r = t / R mod m for t of 2n limbs below m * R (REDC), destroying t. r may alias t.
+        inline void montgomery_reduce(digit* r, digit* t, const digit* m, const std::size_t n, const digit m_inverse)
+        {
+            digit carry = 0;
+            for(std::size_t i = 0; i < n; i++)
+            {
+                const digit reduced_carry = addmul_1(t + i, m, n, t[i] * m_inverse);
+                const superdigit top = static_cast<superdigit>(t[i + n]) + reduced_carry + carry;
+                t[i + n] = static_cast<digit>(top);
+                carry = static_cast<digit>(top >> digit_bits);
+            }
+            montgomery_finish(r, t + n, carry, m, n);
+        }
+        // r = x * y / R mod m (x, y below m), by the faster ordering for n. From the Karatsuba threshold on, the product
+        // is computed first and then reduced, since it takes fewer than n^2 digit products there. t holds 2n limbs. r may
+        // alias x or y.
+        inline void montgomery_multiply(digit* r, const digit* x, const digit* y, const digit* m, const std::size_t n, const digit m_inverse, digit* t)
+        {
+            if(n < 4)
+            {
+                montgomery_multiply_fios(r, x, y, m, n, m_inverse, t);
+            }
+            else if(n < tuning.karatsuba_multiply)
+            {
+                montgomery_multiply_cios(r, x, y, m, n, m_inverse, t);
+            }
+            else
+            {
+                multiply(t, x, n, y, n);
+                montgomery_reduce(r, t, m, n, m_inverse);
+            }
+        }
+        // Limbs of temporary memory the Montgomery kernels need for a modulus of n limbs.
+        constexpr std::size_t montgomery_scratch_size(const std::size_t n)
+        {
+            return 2 * n + 1;
+        }
+        // r = x^2 / R mod m (x below m): the square, which takes about half the digit products of a multiplication, then
+        // montgomery_reduce(). t holds 2n limbs. r may alias x.
+        inline void montgomery_square(digit* r, const digit* x, const digit* m, const std::size_t n, const digit m_inverse, digit* t)
+        {
+            if(n < 4)
+            {
+                montgomery_multiply_fios(r, x, x, m, n, m_inverse, t);
+                return;
+            }
+            square(t, x, n);
+            montgomery_reduce(r, t, m, n, m_inverse);
+        }
+    }
+}
+
+#endif //INTTITAN_MONTGOMERY_H
@@ -0,0 +1,633 @@
+#ifndef INTTITAN_MULTIPLICATION_H
+#define INTTITAN_MULTIPLICATION_H
+#include "config.h"
+#include "kernels.h"
+#include "ntt.h"
+#include "parallel.h"
+#include "scratch.h"
+
+// Multiplication of raw limb spans: the schoolbook basecase for small operands, then Karatsuba, Toom-3, Toom-4 and the
+// number-theoretic transforms (ntt.h) as the smaller operand reaches the tuning thresholds. Squares have their own
+// thresholds, as every tier saves work on them. The short products give only the low or the high limbs of a product.
+namespace int_titan
+{
+    namespace kernels
+    {
+        // Scratch limbs needed to multiply operands of (at most) n digits.
+        inline std::size_t multiply_scratch_size(const std::size_t n)
+        {
+            // Every level of the recursion takes at most about 5n limbs and divides n by two or more. The constant covers the
+            // rounding of the part sizes on the way down.
+            return 10 * n + 512;
+        }
+        inline void multiply(digit* r, const digit* x, std::size_t xn, const digit* y, std::size_t yn, scratch_space scratch);
+        inline void square(digit* r, const digit* x, std::size_t n, scratch_space scratch);
+        // f(i, scratch) for i < count on the executor, each with scratch space of its own of the given size.
+        template<typename F>
+        void parallel_products(const std::size_t count, const std::size_t size, const F& f)
+        {
+            parallel_for(count, [&](const std::size_t i)
+            {
+                const scratch_buffer<> memory(size);
+                f(i, scratch_space{memory.get(), memory.get() + size});
+            });
+        }
+        // Karatsuba multiplication of x and y, where (xn + 1) / 2 < yn <= xn. Writes xn + yn limbs into r.
+        // With x = x1 * B^m + x0 and y = y1 * B^m + y0, the middle product x0 * y1 + x1 * y0 is computed as
+        // x0 * y0 + x1 * y1 - (x0 - x1) * (y0 - y1), so only three half-size products are needed.
+        inline void karatsuba_multiply(digit* r, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn, scratch_space scratch)
+        {
+            const std::size_t m = (xn + 1) / 2; // Size of the low parts.
+            const std::size_t a = xn - m; // Size of x1.
+            const std::size_t b = yn - m; // Size of y1.
+            const digit* x0 = x;
+            const digit* x1 = x + m;
+            const digit* y0 = y;
+            const digit* y1 = y + m;
+            // |x0 - x1| and |y0 - y1|, remembering whether they were negative.
+            digit* dx = scratch.take(m);
+            digit* dy = scratch.take(m);
+            const bool x_negative = compare(x0, m, x1, a) < 0;
+            const bool y_negative = compare(y0, m, y1, b) < 0;
+            if(x_negative)
+            {
+                // x1 > x0, so the digits of x0 above x1's length are zero.
+                subtract(dx, x1, a, x0, a);
+                std::fill(dx + a, dx + m, digit(0));
+            }
+            else
+            {
+                subtract(dx, x0, m, x1, a);
+            }
+            if(y_negative)
+            {
+                subtract(dy, y1, b, y0, b);
+                std::fill(dy + b, dy + m, digit(0));
+            }
+            else
+            {
+                subtract(dy, y0, m, y1, b);
+            }
+            // The outer products go straight to their places in r.
+            digit* middle;
+            if(parallel_multiply(yn))
+            {
+                middle = scratch.take(2 * m);
+                parallel_products(3, multiply_scratch_size(m), [&](const std::size_t i, const scratch_space local)
+                {
+                    if(i == 0)
+                    {
+                        multiply(r, x0, m, y0, m, local);
+                    }
+                    else if(i == 1)
+                    {
+                        multiply(r + 2 * m, x1, a, y1, b, local);
+                    }
+                    else
+                    {
+                        multiply(middle, dx, m, dy, m, local);
+                    }
+                });
+            }
+            else
+            {
+                multiply(r, x0, m, y0, m, scratch);
+                multiply(r + 2 * m, x1, a, y1, b, scratch);
+                middle = scratch.take(2 * m);
+                multiply(middle, dx, m, dy, m, scratch);
+            }
+            // t = x0 * y0 + x1 * y1 - (x0 - x1) * (y0 - y1).
+            digit* t = scratch.take(2 * m + 1);
+            t[2 * m] = add(t, r, 2 * m, r + 2 * m, a + b);
+            if(x_negative == y_negative)
+            {
+                subtract(t, t, 2 * m + 1, middle, 2 * m);
+            }
+            else
+            {
+                add(t, t, 2 * m + 1, middle, 2 * m);
+            }
+            // The middle product fits below the top of r, so there is no carry out of it.
+            const std::size_t tn = normalized_size(t, 2 * m + 1);
+            assert(tn <= m + a + b);
+            add(r + m, r + m, m + a + b, t, tn);
+        }
+        // Karatsuba squaring of x, where n >= 2. Writes 2n limbs into r. The middle term 2 * x0 * x1 is found as
+        // x0^2 + x1^2 - (x0 - x1)^2, so all three half-size products are squares.
+        inline void karatsuba_square(digit* r, const digit* x, const std::size_t n, scratch_space scratch)
+        {
+            const std::size_t m = (n + 1) / 2; // Size of the low part.
+            const std::size_t a = n - m; // Size of x1.
+            const digit* x0 = x;
+            const digit* x1 = x + m;
+            digit* dx = scratch.take(m);
+            if(compare(x0, m, x1, a) < 0)
+            {
+                subtract(dx, x1, a, x0, a);
+                std::fill(dx + a, dx + m, digit(0));
+            }
+            else
+            {
+                subtract(dx, x0, m, x1, a);
+            }
+            digit* middle;
+            if(parallel_multiply(n))
+            {
+                middle = scratch.take(2 * m);
+                parallel_products(3, multiply_scratch_size(m), [&](const std::size_t i, const scratch_space local)
+                {
+                    if(i == 0)
+                    {
+                        square(r, x0, m, local);
+                    }
+                    else if(i == 1)
+                    {
+                        square(r + 2 * m, x1, a, local);
+                    }
+                    else
+                    {
+                        square(middle, dx, m, local);
+                    }
+                });
+            }
+            else
+            {
+                square(r, x0, m, scratch);
+                square(r + 2 * m, x1, a, scratch);
+                middle = scratch.take(2 * m);
+                square(middle, dx, m, scratch);
+            }
+            // t = x0^2 + x1^2 - (x0 - x1)^2, never negative.
+            digit* t = scratch.take(2 * m + 1);
+            t[2 * m] = add(t, r, 2 * m, r + 2 * m, 2 * a);
+            subtract(t, t, 2 * m + 1, middle, 2 * m);
+            const std::size_t tn = normalized_size(t, 2 * m + 1);
+            assert(tn <= m + 2 * a);
+            add(r + m, r + m, m + 2 * a, t, tn);
+        }
+        // A signed number of fixed width (magnitude and sign), used by the Toom-Cook evaluation and interpolation.
+        struct toom_value
+        {
+            digit* limbs;
+            bool negative;
+        };
+        // v = a + b (or a - b), all n limbs wide. v may alias a or b.
+        inline void toom_add(toom_value& v, const toom_value& a, toom_value b, const std::size_t n, const bool subtract_b = false)
+        {
+            b.negative = b.negative != subtract_b;
+            const bool a_negative = a.negative;
+            if(a_negative == b.negative)
+            {
+                add(v.limbs, a.limbs, n, b.limbs, n);
+                v.negative = a_negative;
+            }
+            else if(compare(a.limbs, b.limbs, n) >= 0)
+            {
+                subtract(v.limbs, a.limbs, n, b.limbs, n);
+                v.negative = a_negative;
+            }
+            else
+            {
+                subtract(v.limbs, b.limbs, n, a.limbs, n);
+                v.negative = b.negative;
+            }
+        }
+        // v = v - d * a, with t (n limbs) as temporary space.
+        inline void toom_submul(toom_value& v, const toom_value& a, const digit d, toom_value t, const std::size_t n)
+        {
+            std::copy(a.limbs, a.limbs + n, t.limbs);
+            t.negative = a.negative;
+            multiply_by_digit(t.limbs, t.limbs, n, d);
+            toom_add(v, v, t, n, true);
+        }
+        // v = v / d, where the division is known to be exact.
+        inline void toom_divide_exact(toom_value& v, const digit d, const std::size_t n)
+        {
+            divide_exact_by_digit(v.limbs, v.limbs, n, d);
+        }
+        // v = |v| + part (when v is positive) or part - |v| (when negative), where v is w limbs wide and pn <= w.
+        inline void toom_add_part(toom_value& v, const digit* part, const std::size_t pn, const std::size_t w)
+        {
+            if(!v.negative)
+            {
+                add(v.limbs, v.limbs, w, part, pn);
+            }
+            else if(compare(v.limbs, w, part, pn) > 0)
+            {
+                subtract(v.limbs, v.limbs, w, part, pn);
+            }
+            else
+            {
+                // |v| <= part, so |v| fits in pn limbs.
+                subtract(v.limbs, part, pn, v.limbs, pn);
+                std::fill(v.limbs + pn, v.limbs + w, digit(0));
+                v.negative = false;
+            }
+        }
+        // Evaluate the polynomial with k coefficients of m digits (the last one shorter) stored in x at point t. The
+        // result is w limbs wide.
+        inline toom_value toom_evaluate(digit* v, const digit* x, const std::size_t xn, const std::size_t m, const std::size_t k, const int t, const std::size_t w)
+        {
+            // Horner's rule, starting from the top coefficient.
+            toom_value result{v, false};
+            const std::size_t top = (k - 1) * m;
+            std::fill(std::copy(x + top, x + xn, v), v + w, digit(0));
+            for(std::size_t i = k - 1; i-- != 0;)
+            {
+                const digit factor = static_cast<digit>(t < 0 ? -t : t);
+                if(factor != 1)
+                {
+                    multiply_by_digit(v, v, w, factor);
+                }
+                result.negative = result.negative != (t < 0);
+                toom_add_part(result, x + i * m, m, w);
+            }
+            return result;
+        }
+        // r = p * q for w-limb values, stored l limbs wide.
+        inline toom_value toom_pointwise(digit* r, const toom_value& p, const toom_value& q, const std::size_t w, const std::size_t l, scratch_space scratch)
+        {
+            std::size_t pn = normalized_size(p.limbs, w);
+            std::size_t qn = normalized_size(q.limbs, w);
+            const digit* a = p.limbs;
+            const digit* b = q.limbs;
+            if(pn < qn)
+            {
+                std::swap(a, b);
+                std::swap(pn, qn);
+            }
+            if(qn == 0)
+            {
+                pn = 0;
+            }
+            else
+            {
+                multiply(r, a, pn, b, qn, scratch);
+            }
+            std::fill(r + pn + qn, r + l, digit(0));
+            return {r, p.negative != q.negative};
+        }
+        // Split x and y into k parts of m digits, multiply the polynomials at the given points and store the products
+        // (l limbs wide) into the values. Also stores the products at 0 and infinity into their places in r, and copies
+        // them l limbs wide into c0 and c_last. When y is x, the polynomial is evaluated once and every product is a
+        // square.
+        template<std::size_t points>
+        inline void toom_products(digit* r, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn, const std::size_t m, const std::size_t k, const int (&at)[points],
+            toom_value (&values)[points], toom_value& c0, toom_value& c_last, const std::size_t l, scratch_space& scratch)
+        {
+            const std::size_t w = m + 1;
+            const bool squaring = x == y and xn == yn;
+            for(std::size_t i = 0; i < points; i++)
+            {
+                values[i].limbs = scratch.take(l);
+            }
+            const auto point = [&](const std::size_t i, scratch_space local)
+            {
+                const toom_value p = toom_evaluate(local.take(w), x, xn, m, k, at[i], w);
+                const toom_value q = squaring ? p : toom_evaluate(local.take(w), y, yn, m, k, at[i], w);
+                values[i] = toom_pointwise(values[i].limbs, p, q, w, l, local);
+            };
+            // The coefficients at 0 and infinity are plain products of the lowest and the highest parts.
+            const std::size_t top = (k - 1) * m;
+            const std::size_t last = xn + yn - 2 * top;
+            if(parallel_multiply(yn))
+            {
+                // The products are independent, an evaluated point takes 2w limbs besides.
+                parallel_products(points + 2, 2 * w + multiply_scratch_size(w), [&](const std::size_t i, const scratch_space local)
+                {
+                    if(i < points)
+                    {
+                        point(i, local);
+                    }
+                    else if(i == points)
+                    {
+                        multiply(r, x, m, y, m, local);
+                    }
+                    else
+                    {
+                        multiply(r + 2 * top, x + top, xn - top, y + top, yn - top, local);
+                    }
+                });
+            }
+            else
+            {
+                for(std::size_t i = 0; i < points; i++)
+                {
+                    point(i, scratch);
+                }
+                multiply(r, x, m, y, m, scratch);
+                multiply(r + 2 * top, x + top, xn - top, y + top, yn - top, scratch);
+            }
+            c0 = {scratch.take(l), false};
+            std::fill(std::copy(r, r + 2 * m, c0.limbs), c0.limbs + l, digit(0));
+            c_last = {scratch.take(l), false};
+            std::fill(std::copy(r + 2 * top, r + 2 * top + last, c_last.limbs), c_last.limbs + l, digit(0));
+            // The inner coefficients are added on top of the zeroes in between.
+            std::fill(r + 2 * m, r + 2 * top, digit(0));
+        }
+        // r += c * B^(i * m) for the (non-negative) inner coefficients c_i.
+        inline void toom_recompose(digit* r, const std::size_t n, const std::size_t m, const toom_value* c, const std::size_t count, const std::size_t l)
+        {
+            for(std::size_t i = 0; i < count; i++)
+            {
+                const std::size_t offset = (i + 1) * m;
+                const std::size_t cn = normalized_size(c[i].limbs, l);
+                assert(!c[i].negative or cn == 0);
+                assert(cn <= n - offset);
+                add(r + offset, r + offset, n - offset, c[i].limbs, cn);
+            }
+        }
+        // Toom-3 multiplication of x and y, where yn > 2 * ceil(xn / 3) and yn <= xn. Writes xn + yn limbs into r.
+        // The product of two degree-2 polynomials is evaluated at 0, 1, -1, 2 and infinity and interpolated from there.
+        // With y = x it squares (see toom_products).
+        inline void toom3_multiply(digit* r, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn, scratch_space scratch)
+        {
+            const std::size_t m = (xn + 2) / 3;
+            const std::size_t l = 2 * m + 3;
+            const int at[] = {1, -1, 2};
+            toom_value v[3], c0, c4;
+            toom_products(r, x, xn, y, yn, m, 3, at, v, c0, c4, l, scratch);
+            toom_value& r1 = v[0];
+            toom_value& rm1 = v[1];
+            toom_value& r2 = v[2];
+            toom_value t{scratch.take(l), false};
+            toom_value c2{scratch.take(l), false};
+            // c2 = (r(1) + r(-1)) / 2 - c0 - c4.
+            toom_add(c2, r1, rm1, l);
+            toom_divide_exact(c2, 2, l);
+            toom_add(c2, c2, c0, l, true);
+            toom_add(c2, c2, c4, l, true);
+            // c1 + c3 = (r(1) - r(-1)) / 2, kept in r1.
+            toom_add(r1, r1, rm1, l, true);
+            toom_divide_exact(r1, 2, l);
+            // c1 + 4 * c3 = (r(2) - c0 - 4 * c2 - 16 * c4) / 2, kept in r2.
+            toom_add(r2, r2, c0, l, true);
+            toom_submul(r2, c2, 4, t, l);
+            toom_submul(r2, c4, 16, t, l);
+            toom_divide_exact(r2, 2, l);
+            // c3 = ((c1 + 4 * c3) - (c1 + c3)) / 3 and c1 = (c1 + c3) - c3.
+            toom_add(r2, r2, r1, l, true);
+            toom_divide_exact(r2, 3, l);
+            toom_add(r1, r1, r2, l, true);
+            const toom_value inner[] = {r1, c2, r2};
+            toom_recompose(r, xn + yn, m, inner, 3, l);
+        }
+        // Toom-4 multiplication of x and y, where yn > 3 * ceil(xn / 4) and yn <= xn. Writes xn + yn limbs into r.
+        // The product of two degree-3 polynomials is evaluated at 0, 1, -1, 2, -2, 3 and infinity. The even and the odd
+        // coefficients are then separated with the symmetric points and solved for independently. With y = x it squares.
+        inline void toom4_multiply(digit* r, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn, scratch_space scratch)
+        {
+            const std::size_t m = (xn + 3) / 4;
+            const std::size_t l = 2 * m + 3;
+            const int at[] = {1, -1, 2, -2, 3};
+            toom_value v[5], c0, c6;
+            toom_products(r, x, xn, y, yn, m, 4, at, v, c0, c6, l, scratch);
+            toom_value& r1 = v[0];
+            toom_value& rm1 = v[1];
+            toom_value& r2 = v[2];
+            toom_value& rm2 = v[3];
+            toom_value& r3 = v[4];
+            toom_value t{scratch.take(l), false};
+            toom_value c2{scratch.take(l), false};
+            toom_value c4{scratch.take(l), false};
+            // c2 + c4 = (r(1) + r(-1)) / 2 - c0 - c6, kept in c2.
+            toom_add(c2, r1, rm1, l);
+            toom_divide_exact(c2, 2, l);
+            toom_add(c2, c2, c0, l, true);
+            toom_add(c2, c2, c6, l, true);
+            // c2 + 4 * c4 = ((r(2) + r(-2)) / 2 - c0 - 64 * c6) / 4, kept in c4.
+            toom_add(c4, r2, rm2, l);
+            toom_divide_exact(c4, 2, l);
+            toom_add(c4, c4, c0, l, true);
+            toom_submul(c4, c6, 64, t, l);
+            toom_divide_exact(c4, 4, l);
+            // c4 = ((c2 + 4 * c4) - (c2 + c4)) / 3 and c2 = (c2 + c4) - c4.
+            toom_add(c4, c4, c2, l, true);
+            toom_divide_exact(c4, 3, l);
+            toom_add(c2, c2, c4, l, true);
+            // The odd coefficients: c1 + c3 + c5 = (r(1) - r(-1)) / 2 in r1, c1 + 4 * c3 + 16 * c5 = (r(2) - r(-2)) / 4
+            // in r2 and c1 + 9 * c3 + 81 * c5 = (r(3) - c0 - 9 * c2 - 81 * c4 - 729 * c6) / 3 in r3.
+            toom_add(r1, r1, rm1, l, true);
+            toom_divide_exact(r1, 2, l);
+            toom_add(r2, r2, rm2, l, true);
+            toom_divide_exact(r2, 4, l);
+            toom_add(r3, r3, c0, l, true);
+            toom_submul(r3, c2, 9, t, l);
+            toom_submul(r3, c4, 81, t, l);
+            toom_submul(r3, c6, 729, t, l);
+            toom_divide_exact(r3, 3, l);
+            // c3 + 13 * c5 = (r3 - r2) / 5 in r3 and c3 + 5 * c5 = (r2 - r1) / 3 in r2.
+            toom_add(r3, r3, r2, l, true);
+            toom_divide_exact(r3, 5, l);
+            toom_add(r2, r2, r1, l, true);
+            toom_divide_exact(r2, 3, l);
+            // c5 = (r3 - r2) / 8, c3 = r2 - 5 * c5 and c1 = r1 - c3 - c5.
+            toom_add(r3, r3, r2, l, true);
+            toom_divide_exact(r3, 8, l);
+            toom_submul(r2, r3, 5, t, l);
+            toom_add(r1, r1, r2, l, true);
+            toom_add(r1, r1, r3, l, true);
+            const toom_value inner[] = {r1, c2, r2, c4, r3};
+            toom_recompose(r, xn + yn, m, inner, 5, l);
+        }
+        // r = x^2. Writes 2n limbs, r must not overlap x.
+        inline void square(digit* r, const digit* x, const std::size_t n, scratch_space scratch)
+        {
+            if(n < std::max<std::size_t>(tuning.karatsuba_square, 2))
+            {
+                square_basecase(r, x, n);
+            }
+            else if(n >= tuning.ntt_multiply and ntt_supported(n, n))
+            {
+                // A square needs only one forward transform.
+                ntt_multiply(r, x, n, nullptr, n);
+            }
+            else if(n >= std::max<std::size_t>(tuning.toom4_square, 16))
+            {
+                toom4_multiply(r, x, n, x, n, scratch);
+            }
+            else if(n >= std::max<std::size_t>(tuning.toom3_square, 8))
+            {
+                toom3_multiply(r, x, n, x, n, scratch);
+            }
+            else
+            {
+                karatsuba_square(r, x, n, scratch);
+            }
+        }
+        // r = x * y, where xn >= yn. Writes xn + yn limbs, r must not overlap x or y. Goes to square() if y is x.
+        inline void multiply(digit* r, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn, scratch_space scratch)
+        {
+            assert(xn >= yn);
+            // Pick the fastest algorithm for the size of the smaller operand, as long as the operands are balanced enough
+            // for its split.
+            if(x == y and xn == yn)
+            {
+                square(r, x, xn, scratch);
+            }
+            else if(yn < std::max<std::size_t>(tuning.karatsuba_multiply, 2))
+            {
+                multiply_basecase(r, x, xn, y, yn);
+            }
+            else if(yn >= tuning.ntt_multiply and ntt_supported(xn, yn))
+            {
+                ntt_multiply(r, x, xn, y, yn);
+            }
+            else if(yn >= std::max<std::size_t>(tuning.toom4_multiply, 16) and yn > 3 * ((xn + 3) / 4))
+            {
+                toom4_multiply(r, x, xn, y, yn, scratch);
+            }
+            else if(yn >= std::max<std::size_t>(tuning.toom3_multiply, 8) and yn > 2 * ((xn + 2) / 3))
+            {
+                toom3_multiply(r, x, xn, y, yn, scratch);
+            }
+            else if(2 * yn > xn + 1)
+            {
+                karatsuba_multiply(r, x, xn, y, yn, scratch);
+            }
+            else
+            {
+                // Unbalanced operands: multiply y by yn-digit pieces of x, so that each product is balanced.
+                multiply(r, x, yn, y, yn, scratch);
+                digit* piece = scratch.take(2 * yn);
+                for(std::size_t i = yn; i < xn; i += yn)
+                {
+                    const std::size_t n = std::min(yn, xn - i);
+                    multiply(piece, y, yn, x + i, n, scratch);
+                    // r already holds yn digits at position i, the rest of the piece extends it.
+                    add(r + i, piece, n + yn, r + i, yn);
+                }
+            }
+        }
+        // r = x^2. Writes 2n limbs, r must not overlap x. Allocates the scratch space if needed.
+        inline void square(digit* r, const digit* x, const std::size_t n)
+        {
+            if(n < tuning.karatsuba_square)
+            {
+                square_basecase(r, x, n);
+                return;
+            }
+            const std::size_t size = multiply_scratch_size(n);
+            const scratch_buffer<> memory(size);
+            square(r, x, n, scratch_space{memory.get(), memory.get() + size});
+        }
+        // r = x * y, where xn >= yn. Writes xn + yn limbs, r must not overlap x or y. Allocates the scratch space if needed.
+        inline void multiply(digit* r, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn)
+        {
+            if(x == y and xn == yn)
+            {
+                square(r, x, xn);
+                return;
+            }
+            if(yn < tuning.karatsuba_multiply)
+            {
+                multiply_basecase(r, x, xn, y, yn);
+                return;
+            }
+            const std::size_t size = multiply_scratch_size(xn);
+            const scratch_buffer<> memory(size);
+            multiply(r, x, xn, y, yn, scratch_space{memory.get(), memory.get() + size});
+        }
+        // Operand size from which the short products split into a full product and two short ones (Mulders, "On short
+        // multiplications and divisions", 2000), below it they are schoolbook. The full product of the top (or bottom)
+        // k = 0.7n limbs leaves two short products of 0.3n limbs, which costs less than a full product of n limbs once
+        // that is Karatsuba's.
+        inline std::size_t short_product_threshold()
+        {
+            return std::max<std::size_t>(2 * tuning.karatsuba_multiply, 16);
+        }
+        // r = x * y mod B^n, the low n limbs of the product. Writes n limbs, r must not overlap x or y.
+        inline void multiply_low(digit* r, const digit* x, std::size_t xn, const digit* y, std::size_t yn, const std::size_t n)
+        {
+            xn = std::min(xn, n);
+            yn = std::min(yn, n);
+            if(xn < yn)
+            {
+                std::swap(x, y);
+                std::swap(xn, yn);
+            }
+            if(yn == 0)
+            {
+                std::fill(r, r + n, digit(0));
+                return;
+            }
+            if(xn + yn <= n)
+            {
+                multiply(r, x, xn, y, yn);
+                std::fill(r + xn + yn, r + n, digit(0));
+                return;
+            }
+            if(n < short_product_threshold())
+            {
+                // Schoolbook, with every row cut at B^n. The limb past a row is still zero, so its carry goes there.
+                std::fill(r, r + n, digit(0));
+                for(std::size_t i = 0; i < xn; i++)
+                {
+                    const std::size_t m = std::min(yn, n - i);
+                    const digit carry = addmul_1(r + i, y, m, x[i]);
+                    if(i + m < n)
+                    {
+                        r[i + m] = carry;
+                    }
+                }
+                return;
+            }
+            // With x = x1 * B^k + x0 and y = y1 * B^k + y0, x * y mod B^n is x0 * y0 + (x1 * y0 + x0 * y1) * B^k, where
+            // the products of x1 and y1 only count mod B^(n - k).
+            const std::size_t k = n - n * 3 / 10;
+            const std::size_t l = n - k;
+            const std::size_t x0n = std::min(xn, k);
+            const std::size_t y0n = std::min(yn, k);
+            const scratch_buffer<> memory(x0n + y0n + l);
+            digit* full = memory.get();
+            digit* part = full + x0n + y0n;
+            multiply(full, x, x0n, y, y0n);
+            std::copy(full, full + std::min(n, x0n + y0n), r);
+            std::fill(r + std::min(n, x0n + y0n), r + n, digit(0));
+            if(xn > k)
+            {
+                multiply_low(part, x + k, xn - k, y, std::min(yn, l), l);
+                add(r + k, r + k, l, part, l);
+            }
+            if(yn > k)
+            {
+                multiply_low(part, y + k, yn - k, x, std::min(xn, l), l);
+                add(r + k, r + k, l, part, l);
+            }
+        }
+        // r = floor(x * y / B^n) for x and y of n limbs, give or take: the result is at most n too small (the high n limbs
+        // of the product without the carries of most of the low ones). Writes n limbs, r must not overlap x or y.
+        inline void multiply_high(digit* r, const digit* x, const digit* y, const std::size_t n)
+        {
+            if(n < short_product_threshold())
+            {
+                // The columns of the digit products from n - 1 up, into t[0] on. The columns below carry less than n
+                // into column n.
+                const scratch_buffer<> t(n + 1);
+                std::fill(t.get(), t.get() + n + 1, digit(0));
+                for(std::size_t i = 0; i < n; i++)
+                {
+                    t[i + 1] = addmul_1(t.get(), y + n - 1 - i, i + 1, x[i]);
+                }
+                std::copy(t.get() + 1, t.get() + n + 1, r);
+                return;
+            }
+            // With x = x1 * B^l + x0 (x1 of k = n - l limbs) and y likewise, the top of x * y is x1 * y1 * B^2l plus the
+            // tops of the short products of the top l limbs of x1 and y0, and of x0 and the top l limbs of y1. The rest
+            // adds less than a unit at each level.
+            const std::size_t k = n - n * 3 / 10;
+            const std::size_t l = n - k;
+            const scratch_buffer<> memory(2 * k + l);
+            digit* full = memory.get();
+            digit* part = full + 2 * k;
+            multiply(full, x + l, k, y + l, k);
+            std::copy(full + k - l, full + 2 * k, r);
+            multiply_high(part, x + k, y, l);
+            add(r, r, n, part, l);
+            multiply_high(part, x, y + k, l);
+            add(r, r, n, part, l);
+        }
+    }
+}
+
+#endif //INTTITAN_MULTIPLICATION_H
@@ -0,0 +1,333 @@
+#ifndef INTTITAN_NTT_H
+#define INTTITAN_NTT_H
+#include "config.h"
+#include "kernels.h"
+#include "parallel.h"
+#include "scratch.h"
+#include <algorithm>
+
+// Multiplication of huge limb spans by number-theoretic transforms. The 32-bit halves of the digits (the digits
+// themselves if they are 32-bit) are used as coefficients and the convolution is computed modulo three primes below
+// 2^31, which together bound a coefficient by about 2^92.6. That is enough for operands of less than 2^28 coefficients
+// and the primes allow transforms of up to 2^25 points.
+namespace int_titan
+{
+    namespace kernels
+    {
+        // Arithmetic modulo a prime p = c * 2^k + 1 < 2^31, in Montgomery form with R = 2^32.
+        struct ntt_prime
+        {
+            std::uint32_t p;
+            std::uint32_t generator; // A primitive root modulo p.
+            int two_adicity; // k, so transforms of up to 2^k points exist.
+            std::uint32_t p_inverse; // -p^-1 mod 2^32.
+            std::uint32_t r2; // R^2 mod p.
+            constexpr ntt_prime(const std::uint32_t p, const std::uint32_t generator, const int two_adicity)
+                : p(p), generator(generator), two_adicity(two_adicity), p_inverse(negated_inverse(p)), r2(static_cast<std::uint32_t>((static_cast<unsigned __int128>(1) << 64) % p))
+            {
+            }
+            // REDC: t * R^-1 mod p, for t < p * R.
+            constexpr std::uint32_t reduce(const std::uint64_t t) const
+            {
+                const std::uint32_t m = static_cast<std::uint32_t>(t) * p_inverse;
+                const std::uint32_t u = static_cast<std::uint32_t>((t + static_cast<std::uint64_t>(m) * p) >> 32);
+                return u >= p ? u - p : u;
+            }
+            // a * b * R^-1 mod p. With b in Montgomery form this is the plain product a * b mod p.
+            constexpr std::uint32_t multiply(const std::uint32_t a, const std::uint32_t b) const
+            {
+                return reduce(static_cast<std::uint64_t>(a) * b);
+            }
+            constexpr std::uint32_t to_montgomery(const std::uint32_t a) const
+            {
+                return reduce(static_cast<std::uint64_t>(a) * r2);
+            }
+            constexpr std::uint32_t add(const std::uint32_t a, const std::uint32_t b) const
+            {
+                const std::uint32_t s = a + b;
+                return s >= p ? s - p : s;
+            }
+            constexpr std::uint32_t subtract(const std::uint32_t a, const std::uint32_t b) const
+            {
+                return a >= b ? a - b : a + p - b;
+            }
+            // a^e mod p, in plain form.
+            constexpr std::uint32_t power(std::uint32_t a, std::uint64_t e) const
+            {
+                std::uint64_t result = 1;
+                std::uint64_t base = a % p;
+                for(; e != 0; e >>= 1)
+                {
+                    if(e & 1)
+                    {
+                        result = result * base % p;
+                    }
+                    base = base * base % p;
+                }
+                return static_cast<std::uint32_t>(result);
+            }
+            constexpr std::uint32_t inverse(const std::uint32_t a) const
+            {
+                return power(a, p - 2);
+            }
+        private:
+            static constexpr std::uint32_t negated_inverse(const std::uint32_t p)
+            {
+                // Newton's iteration doubles the number of correct low bits each time.
+                std::uint32_t inverse = p;
+                for(int i = 0; i < 4; i++)
+                {
+                    inverse *= 2 - p * inverse;
+                }
+                return -inverse;
+            }
+        };
+        constexpr ntt_prime ntt_primes[3] = {
+            {2013265921, 31, 27}, // 15 * 2^27 + 1
+            {1811939329, 13, 26}, // 27 * 2^26 + 1
+            {2113929217, 5, 25}, // 63 * 2^25 + 1
+        };
+        // Largest supported transform.
+        constexpr std::size_t ntt_max_length = std::size_t(1) << 25;
+        // Coefficients per digit.
+        constexpr std::size_t ntt_digit_coefficients = digit_bits / 32;
+        // Can x * y (xn and yn limbs) be computed by ntt_multiply()?
+        inline bool ntt_supported(const std::size_t xn, const std::size_t yn)
+        {
+            return (xn + yn) * ntt_digit_coefficients - 1 <= ntt_max_length;
+        }
+        // Coefficient i of the limbs x.
+        inline std::uint32_t ntt_coefficient(const digit* x, const std::size_t i)
+        {
+            return static_cast<std::uint32_t>(x[i / ntt_digit_coefficients] >> (32 * (i % ntt_digit_coefficients)));
+        }
+        // Twiddle factors (in Montgomery form) for every level of a transform of n points: w_2len^j is at index len + j,
+        // where w_2len is a root of unity of order 2len (or its inverse for the inverse transform).
+        inline scratch_buffer<std::uint32_t> ntt_twiddles(const ntt_prime& prime, const std::size_t n, const bool inverse)
+        {
+            scratch_buffer<std::uint32_t> twiddles(n);
+            std::uint32_t root = prime.power(prime.generator, (prime.p - 1) / n);
+            if(inverse)
+            {
+                root = prime.inverse(root);
+            }
+            const std::size_t half = n / 2;
+            const std::uint32_t root_montgomery = prime.to_montgomery(root);
+            std::uint32_t w = prime.to_montgomery(1);
+            for(std::size_t j = 0; j < half; j++)
+            {
+                twiddles[half + j] = w;
+                w = prime.reduce(static_cast<std::uint64_t>(w) * root_montgomery);
+            }
+            // The root of order 2len is the square of the one of order 4len.
+            for(std::size_t len = half / 2; len >= 1; len /= 2)
+            {
+                for(std::size_t j = 0; j < len; j++)
+                {
+                    twiddles[len + j] = twiddles[2 * len + 2 * j];
+                }
+            }
+            return twiddles;
+        }
+        // The butterflies (j, j + len) of the forward transform for j in [first, last), in the block at a.
+        inline void ntt_forward_butterflies(std::uint32_t* a, const std::size_t len, const std::size_t first, const std::size_t last, const ntt_prime& prime, const std::uint32_t* w)
+        {
+            for(std::size_t j = first; j < last; j++)
+            {
+                const std::uint32_t u = a[j];
+                const std::uint32_t v = a[j + len];
+                a[j] = prime.add(u, v);
+                a[j + len] = prime.multiply(prime.subtract(u, v), w[j]);
+            }
+        }
+        // The butterflies (j, j + len) of the inverse transform for j in [first, last), in the block at a.
+        inline void ntt_inverse_butterflies(std::uint32_t* a, const std::size_t len, const std::size_t first, const std::size_t last, const ntt_prime& prime, const std::uint32_t* w)
+        {
+            for(std::size_t j = first; j < last; j++)
+            {
+                const std::uint32_t u = a[j];
+                const std::uint32_t v = prime.multiply(a[j + len], w[j]);
+                a[j] = prime.add(u, v);
+                a[j + len] = prime.subtract(u, v);
+            }
+        }
+        // Number of parts the n points are split into for the executor (a power of two), 1 to run on this thread.
+        inline std::size_t ntt_parts(const std::size_t n, const bool parallel)
+        {
+            // Every part is a few thousand points at least, so that a task outweighs its scheduling.
+            std::size_t parts = 1;
+            while(parallel and parts < 4 * parallel_executor->concurrency() and n / parts >= 8192)
+            {
+                parts *= 2;
+            }
+            return parts;
+        }
+        // A level len of butterflies in which every block spans more than one part: each part takes an equal run of
+        // butterflies, which stays inside one block.
+        template<typename Butterflies>
+        void ntt_split_level(std::uint32_t* a, const std::size_t n, const std::size_t parts, const std::size_t len, const Butterflies& butterflies)
+        {
+            const std::size_t per_part = n / parts / 2;
+            parallel_for(parts, [&](const std::size_t t)
+            {
+                const std::size_t k = t * per_part;
+                const std::size_t first = k % len;
+                butterflies(a + k / len * 2 * len, len, first, first + per_part);
+            });
+        }
+        // Forward transform (decimation in frequency), natural order in and bit-reversed order out. Once the blocks are
+        // no larger than a part, the parts are independent and each finishes its levels alone.
+        inline void ntt_forward(std::uint32_t* a, const std::size_t n, const ntt_prime& prime, const std::uint32_t* twiddles, const std::size_t parts = 1)
+        {
+            const std::size_t size = n / parts;
+            const auto butterflies = [&](std::uint32_t* block, const std::size_t len, const std::size_t first, const std::size_t last)
+            {
+                ntt_forward_butterflies(block, len, first, last, prime, twiddles + len);
+            };
+            std::size_t len = n / 2;
+            for(; len >= size; len /= 2)
+            {
+                ntt_split_level(a, n, parts, len, butterflies);
+            }
+            parallel_for(parts, [&](const std::size_t t)
+            {
+                for(std::size_t l = len; l >= 1; l /= 2)
+                {
+                    for(std::size_t i = t * size; i < (t + 1) * size; i += 2 * l)
+                    {
+                        butterflies(a + i, l, 0, l);
+                    }
+                }
+            });
+        }
+        // Inverse transform (decimation in time) with the inverse twiddles, bit-reversed order in and natural order out.
+        // The result is scaled by n. The parts do the levels within them alone first.
+        inline void ntt_inverse(std::uint32_t* a, const std::size_t n, const ntt_prime& prime, const std::uint32_t* twiddles, const std::size_t parts = 1)
+        {
+            const std::size_t size = n / parts;
+            const auto butterflies = [&](std::uint32_t* block, const std::size_t len, const std::size_t first, const std::size_t last)
+            {
+                ntt_inverse_butterflies(block, len, first, last, prime, twiddles + len);
+            };
+            parallel_for(parts, [&](const std::size_t t)
+            {
+                for(std::size_t l = 1; l < size; l *= 2)
+                {
+                    for(std::size_t i = t * size; i < (t + 1) * size; i += 2 * l)
+                    {
+                        butterflies(a + i, l, 0, l);
+                    }
+                }
+            });
+            for(std::size_t len = size; len < n; len *= 2)
+            {
+                ntt_split_level(a, n, parts, len, butterflies);
+            }
+        }
+        // Cyclic convolution of x and y (xn and yn coefficients) modulo one prime, written into a (n points). If y is
+        // null, x is squared and only one forward transform is needed. The points are split into the given number of
+        // parts for the executor.
+        inline void ntt_convolution(std::uint32_t* a, std::uint32_t* b, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn, const std::size_t n, const ntt_prime& prime, const std::size_t parts = 1)
+        {
+            const std::size_t size = n / parts;
+            const auto load = [&](std::uint32_t* destination, const digit* source, const std::size_t count)
+            {
+                parallel_for(parts, [&](const std::size_t t)
+                {
+                    const std::size_t first = t * size;
+                    const std::size_t last = std::max(first, std::min(count, first + size));
+                    for(std::size_t i = first; i < last; i++)
+                    {
+                        destination[i] = ntt_coefficient(source, i) % prime.p;
+                    }
+                    std::fill(destination + last, destination + first + size, std::uint32_t(0));
+                });
+            };
+            const auto forward = ntt_twiddles(prime, n, false);
+            load(a, x, xn);
+            ntt_forward(a, n, prime, forward.get(), parts);
+            if(y != nullptr)
+            {
+                load(b, y, yn);
+                ntt_forward(b, n, prime, forward.get(), parts);
+            }
+            else
+            {
+                b = a;
+            }
+            // The pointwise products come out with an extra factor of R^-1, which the scaling by (R / n) cancels.
+            const std::uint32_t scale = prime.to_montgomery(prime.to_montgomery(prime.inverse(static_cast<std::uint32_t>(n % prime.p))));
+            parallel_for(parts, [&](const std::size_t t)
+            {
+                for(std::size_t i = t * size; i < (t + 1) * size; i++)
+                {
+                    a[i] = prime.multiply(prime.multiply(a[i], b[i]), scale);
+                }
+            });
+            ntt_inverse(a, n, prime, ntt_twiddles(prime, n, true).get(), parts);
+        }
+        // r = x * y through the transforms, or r = x^2 when y is null, if ntt_supported(xn, yn). Writes xn + yn limbs, r
+        // must not overlap x or y.
+        inline void ntt_multiply(digit* r, const digit* x, const std::size_t xn, const digit* y, const std::size_t yn)
+        {
+            const std::size_t xc = xn * ntt_digit_coefficients;
+            const std::size_t yc = yn * ntt_digit_coefficients;
+            const std::size_t count = xc + yc - 1; // Number of coefficients in the product.
+            std::size_t n = 1;
+            while(n < count)
+            {
+                n *= 2;
+            }
+            assert(n <= ntt_max_length);
+            const bool squaring = y == nullptr;
+            // In parallel, the primes are worked on at the same time, each with a temporary transform of its own.
+            const bool parallel = parallel_multiply(std::min(xn, yn));
+            const std::size_t temporaries = squaring ? 0 : parallel ? 3 : 1;
+            const scratch_buffer<std::uint32_t> memory((3 + temporaries) * n);
+            std::uint32_t* residues[3] = {memory.get(), memory.get() + n, memory.get() + 2 * n};
+            const std::size_t parts = ntt_parts(n, parallel);
+            const auto convolution = [&](const std::size_t k)
+            {
+                std::uint32_t* temporary = squaring ? nullptr : memory.get() + (3 + (parallel ? k : 0)) * n;
+                ntt_convolution(residues[k], temporary, x, xc, y, yc, n, ntt_primes[k], parts);
+            };
+            if(parallel)
+            {
+                parallel_for(3, convolution);
+            }
+            else
+            {
+                for(std::size_t k = 0; k < 3; k++)
+                {
+                    convolution(k);
+                }
+            }
+            // Garner's algorithm: v = v1 + p1 * (v2 + p2 * v3) from the three residues, then carry the coefficients
+            // into 32-bit pieces of the digits.
+            const ntt_prime& p1 = ntt_primes[0];
+            const ntt_prime& p2 = ntt_primes[1];
+            const ntt_prime& p3 = ntt_primes[2];
+            const std::uint64_t p1_inverse = p2.inverse(p1.p % p2.p);
+            const std::uint64_t p1p2 = static_cast<std::uint64_t>(p1.p) * p2.p;
+            const std::uint64_t p1p2_inverse = p3.inverse(static_cast<std::uint32_t>(p1p2 % p3.p));
+            unsigned __int128 carry = 0;
+            std::fill(r, r + xn + yn, digit(0));
+            for(std::size_t i = 0; i < xc + yc; i++)
+            {
+                if(i < count)
+                {
+                    const std::uint64_t v1 = residues[0][i];
+                    const std::uint64_t v2 = (residues[1][i] + p2.p - v1 % p2.p) % p2.p * p1_inverse % p2.p;
+                    const std::uint64_t low = v1 + v2 * p1.p; // Below p1 * p2.
+                    const std::uint64_t v3 = (residues[2][i] + p3.p - low % p3.p) % p3.p * p1p2_inverse % p3.p;
+                    carry += low + static_cast<unsigned __int128>(v3) * p1p2;
+                }
+                r[i / ntt_digit_coefficients] |= static_cast<digit>(static_cast<std::uint32_t>(carry)) << (32 * (i % ntt_digit_coefficients));
+                carry >>= 32;
+            }
+            assert(carry == 0);
+        }
+    }
+}
+
+#endif //INTTITAN_NTT_H
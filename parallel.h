@@ -0,0 +1,168 @@
+#ifndef INTTITAN_PARALLEL_H
+#define INTTITAN_PARALLEL_H
+#include "config.h"
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Parallel multiplication: an executor runs the independent parts of a huge product (the subproducts of the top levels
+// of Karatsuba and Toom-Cook, the primes, butterflies and pointwise products of the transforms) on several threads.
+// It is off until an executor is set, see parallel_executor.
+namespace int_titan
+{
+    // Runs batches of tasks, possibly concurrently. Implement it to hand the work to an existing task system.
+    class executor
+    {
+    public:
+        virtual ~executor() = default;
+        // Run task(0), ..., task(count - 1) and return when all of them are done. Tasks may call run() themselves.
+        virtual void run(std::size_t count, const std::function<void(std::size_t)>& task) = 0;
+        // Number of tasks that can run at the same time.
+        virtual std::size_t concurrency() const = 0;
+    };
+    // An executor of its own worker threads. The thread that calls run() works on its batch too, and a thread waiting
+    // for its batch takes tasks of the others meanwhile (the nested batches of its own tasks among them), so nesting
+    // never leaves a thread idle while there is work.
+    class thread_pool : public executor
+    {
+    public:
+        // A pool for the given number of threads in all, the calling one included.
+        explicit thread_pool(const std::size_t threads = std::thread::hardware_concurrency())
+        {
+            for(std::size_t i = 1; i < threads; i++)
+            {
+                workers.emplace_back([this]
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    while(!stopping)
+                    {
+                        if(!run_one(lock))
+                        {
+                            changed.wait(lock);
+                        }
+                    }
+                });
+            }
+        }
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+        ~thread_pool() override
+        {
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            changed.notify_all();
+            for(std::thread& worker : workers)
+            {
+                worker.join();
+            }
+        }
+        void run(const std::size_t count, const std::function<void(std::size_t)>& task) override
+        {
+            if(count == 0)
+            {
+                return;
+            }
+            batch b{&task, count, 0, 0, nullptr};
+            std::unique_lock<std::mutex> lock(mutex);
+            open.push_back(&b);
+            changed.notify_all();
+            while(b.finished < b.count)
+            {
+                if(!run_one(lock))
+                {
+                    changed.wait(lock);
+                }
+            }
+            if(b.error)
+            {
+                std::rethrow_exception(b.error);
+            }
+        }
+        std::size_t concurrency() const override
+        {
+            return workers.size() + 1;
+        }
+    private:
+        struct batch
+        {
+            const std::function<void(std::size_t)>* task;
+            std::size_t count;
+            std::size_t next = 0;
+            std::size_t finished = 0;
+            std::exception_ptr error;
+        };
+        std::mutex mutex;
+        std::condition_variable changed;
+        // The batches with tasks left to start, the newest last.
+        std::vector<batch*> open;
+        std::vector<std::thread> workers;
+        bool stopping = false;
+        // With the lock held: start a task of the newest batch and run it without the lock, false if there are none.
+        bool run_one(std::unique_lock<std::mutex>& lock)
+        {
+            if(open.empty())
+            {
+                return false;
+            }
+            batch* b = open.back();
+            const std::size_t i = b->next++;
+            if(b->next == b->count)
+            {
+                open.pop_back();
+            }
+            lock.unlock();
+            std::exception_ptr error;
+            try
+            {
+                (*b->task)(i);
+            }
+            catch(...)
+            {
+                error = std::current_exception();
+            }
+            lock.lock();
+            if(error and !b->error)
+            {
+                b->error = error;
+            }
+            if(++b->finished == b->count)
+            {
+                changed.notify_all();
+            }
+            return true;
+        }
+    };
+    // The executor of parallel multiplication, nullptr (the default) to multiply on the calling thread only. It may be
+    // changed as long as no thread is computing meanwhile, like tuning.
+    inline executor* parallel_executor = nullptr;
+    namespace kernels
+    {
+        // Is a product whose smaller operand has n limbs split across the executor?
+        inline bool parallel_multiply(const std::size_t n)
+        {
+            return parallel_executor != nullptr and n >= tuning.parallel_multiply;
+        }
+        // f(0), ..., f(count - 1) on the executor, or in order on this thread without one.
+        template<typename F>
+        void parallel_for(const std::size_t count, const F& f)
+        {
+            if(parallel_executor == nullptr or count < 2)
+            {
+                for(std::size_t i = 0; i < count; i++)
+                {
+                    f(i);
+                }
+                return;
+            }
+            parallel_executor->run(count, std::cref(f));
+        }
+    }
+}
+
+#endif //INTTITAN_PARALLEL_H
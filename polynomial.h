@@ -0,0 +1,487 @@
+#ifndef INTTITAN_POLYNOMIAL_H
+#define INTTITAN_POLYNOMIAL_H
+#include "config.h"
+#include "integer.h"
+#include "kernels.h"
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Polynomials in one variable with integer coefficients. A product goes through Kronecker substitution: both operands
+// are evaluated at x = 2^b, for slots of b bits that hold every coefficient of the product with its sign, by placing
+// the coefficients side by side in the limbs of one integer each; a single integer multiplication (with all its fast
+// algorithms) gives the product at 2^b, whose coefficients are read back from the slots. Evaluation is Horner's rule,
+// each step a product added straight into the next coefficient, and division is long division with products
+// subtracted in place.
+namespace int_titan
+{
+    class polynomial
+    {
+    public:
+        // Zero.
+        polynomial() = default;
+        // The constant c.
+        polynomial(integer c)
+        {
+            if(!integer::is_zero(c))
+            {
+                coefficients_value.push_back(std::move(c));
+            }
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        polynomial(const T value) : polynomial(integer(value))
+        {
+        }
+        // c[0] + c[1] x + ... + c[n - 1] x^(n - 1), lowest degree first.
+        explicit polynomial(std::vector<integer> c) : coefficients_value(std::move(c))
+        {
+            normalize();
+        }
+        // The monomial c x^k.
+        static polynomial monomial(integer c, const std::size_t k)
+        {
+            if(integer::is_zero(c))
+            {
+                return polynomial();
+            }
+            std::vector<integer> r(k + 1);
+            r[k] = std::move(c);
+            return polynomial(std::move(r));
+        }
+        // The coefficients, lowest degree first, without zeroes above the leading one (none for zero).
+        static const std::vector<integer>& coefficients(const polynomial& p)
+        {
+            return p.coefficients_value;
+        }
+        // The coefficient of x^i, zero above the degree.
+        static const integer& coefficient(const polynomial& p, const std::size_t i)
+        {
+            return i < p.coefficients_value.size() ? p.coefficients_value[i] : integer::zero;
+        }
+        // Number of coefficients up to the leading one, 0 for zero.
+        static std::size_t size(const polynomial& p)
+        {
+            return p.coefficients_value.size();
+        }
+        // The degree, -1 for zero.
+        static long long degree(const polynomial& p)
+        {
+            return static_cast<long long>(p.coefficients_value.size()) - 1;
+        }
+        static bool is_zero(const polynomial& p)
+        {
+            return p.coefficients_value.empty();
+        }
+        // The coefficient of the highest power, zero for zero.
+        static const integer& leading_coefficient(const polynomial& p)
+        {
+            return p.coefficients_value.empty() ? integer::zero : p.coefficients_value.back();
+        }
+        // Terms from the highest power down, as "3*x^2 - x + 5" ("0" for zero), the coefficients in the base.
+        static std::string to_string(const polynomial& p, const int base = 10, const bool uppercase = true)
+        {
+            if(p.coefficients_value.empty())
+            {
+                return "0";
+            }
+            std::string s;
+            for(std::size_t i = p.coefficients_value.size(); i-- > 0;)
+            {
+                const integer& c = p.coefficients_value[i];
+                if(integer::is_zero(c))
+                {
+                    continue;
+                }
+                if(!s.empty())
+                {
+                    s += integer::sign(c) < 0 ? " - " : " + ";
+                }
+                else if(integer::sign(c) < 0)
+                {
+                    s += '-';
+                }
+                const integer magnitude = integer::absolute_value(c);
+                if(i == 0 or magnitude != 1)
+                {
+                    s += integer::to_string(magnitude, base, uppercase);
+                    if(i != 0)
+                    {
+                        s += '*';
+                    }
+                }
+                if(i != 0)
+                {
+                    s += 'x';
+                    if(i != 1)
+                    {
+                        s += '^';
+                        s += std::to_string(i);
+                    }
+                }
+            }
+            return s;
+        }
+        static polynomial negate(polynomial p)
+        {
+            for(integer& c : p.coefficients_value)
+            {
+                c = integer::negate(std::move(c));
+            }
+            return p;
+        }
+        static polynomial add(const polynomial& x, const polynomial& y)
+        {
+            return sum(x, y, false);
+        }
+        static polynomial subtract(const polynomial& x, const polynomial& y)
+        {
+            return sum(x, y, true);
+        }
+        // x * y by Kronecker substitution, or coefficient by coefficient when either is a constant.
+        static polynomial multiply(const polynomial& x, const polynomial& y)
+        {
+            if(x.coefficients_value.empty() or y.coefficients_value.empty())
+            {
+                return polynomial();
+            }
+            if(x.coefficients_value.size() == 1)
+            {
+                return multiply(y, x.coefficients_value[0]);
+            }
+            if(y.coefficients_value.size() == 1)
+            {
+                return multiply(x, y.coefficients_value[0]);
+            }
+            if(&x == &y)
+            {
+                return square(x);
+            }
+            const std::size_t b = slot_bits(x, y);
+            return unpack(pack(x, b) * pack(y, b), b, x.coefficients_value.size() + y.coefficients_value.size() - 1);
+        }
+        // x^2, with the one integer product a square.
+        static polynomial square(const polynomial& x)
+        {
+            if(x.coefficients_value.size() <= 1)
+            {
+                return multiply(x, coefficient(x, 0));
+            }
+            const std::size_t b = slot_bits(x, x);
+            return unpack(integer::square(pack(x, b)), b, 2 * x.coefficients_value.size() - 1);
+        }
+        // x * c, every coefficient times c.
+        static polynomial multiply(polynomial x, const integer& c)
+        {
+            if(integer::is_zero(c))
+            {
+                return polynomial();
+            }
+            for(integer& a : x.coefficients_value)
+            {
+                a *= c;
+            }
+            return x;
+        }
+        // p(x) by Horner's rule: r = r * x + c from the leading coefficient down, the product added into a copy of c in
+        // place (integer::addmul), so that no integer is formed for it.
+        static integer evaluate(const polynomial& p, const integer& x)
+        {
+            const std::vector<integer>& c = p.coefficients_value;
+            if(c.empty())
+            {
+                return integer();
+            }
+            integer r = c.back();
+            for(std::size_t i = c.size() - 1; i-- > 0;)
+            {
+                integer t = c[i];
+                integer::addmul(t, r, x);
+                r = std::move(t);
+            }
+            return r;
+        }
+        // At a machine integer, each step a multiplication by its digits in place and an addition.
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        static integer evaluate(const polynomial& p, const T x)
+        {
+            const std::vector<integer>& c = p.coefficients_value;
+            if(c.empty())
+            {
+                return integer();
+            }
+            integer r = c.back();
+            for(std::size_t i = c.size() - 1; i-- > 0;)
+            {
+                r *= x;
+                r += c[i];
+            }
+            return r;
+        }
+        // The quotient and the remainder, x = q y + r with r of lower degree than y, by long division: each coefficient
+        // of q is that of the remainder so far divided by the leading coefficient of y, and q_i y is subtracted in place
+        // (integer::submul). Over the integers they exist if every such division is exact, as for y of leading
+        // coefficient 1 or -1; throws otherwise, and for y zero.
+        static std::pair<polynomial, polynomial> divide(const polynomial& x, const polynomial& y)
+        {
+            const std::vector<integer>& d = y.coefficients_value;
+            if(d.empty())
+            {
+                throw std::logic_error("Division by 0 impermissible.");
+            }
+            std::vector<integer> r = x.coefficients_value;
+            if(r.size() < d.size())
+            {
+                return {polynomial(), x};
+            }
+            const integer& lead = d.back();
+            const int unit = lead == 1 ? 1 : lead == -1 ? -1 : 0;
+            const std::size_t dn = d.size() - 1;
+            std::vector<integer> q(r.size() - dn);
+            for(std::size_t i = q.size(); i-- > 0;)
+            {
+                integer& top = r[i + dn];
+                if(integer::is_zero(top))
+                {
+                    continue;
+                }
+                if(unit != 0)
+                {
+                    q[i] = unit > 0 ? std::move(top) : integer::negate(std::move(top));
+                }
+                else
+                {
+                    auto [quotient, remainder] = integer::divide(top, lead);
+                    if(!integer::is_zero(remainder))
+                    {
+                        throw std::logic_error("Inexact polynomial division over the integers impermissible.");
+                    }
+                    q[i] = std::move(quotient);
+                }
+                top = integer();
+                for(std::size_t j = 0; j < dn; j++)
+                {
+                    integer::submul(r[i + j], q[i], d[j]);
+                }
+            }
+            r.resize(dn);
+            return {polynomial(std::move(q)), polynomial(std::move(r))};
+        }
+        static bool is_equal_to(const polynomial& x, const polynomial& y)
+        {
+            return x.coefficients_value == y.coefficients_value;
+        }
+
+        // Operator functions.
+        // Comparison.
+        friend bool operator==(const polynomial& x, const polynomial& y)
+        {
+            return is_equal_to(x, y);
+        }
+        friend bool operator!=(const polynomial& x, const polynomial& y)
+        {
+            return !is_equal_to(x, y);
+        }
+        // Arithmetic.
+        friend polynomial operator+(const polynomial& x, const polynomial& y)
+        {
+            return add(x, y);
+        }
+        friend polynomial& operator+=(polynomial& x, const polynomial& y)
+        {
+            x = add(x, y);
+            return x;
+        }
+        friend polynomial operator-(const polynomial& x, const polynomial& y)
+        {
+            return subtract(x, y);
+        }
+        friend polynomial& operator-=(polynomial& x, const polynomial& y)
+        {
+            x = subtract(x, y);
+            return x;
+        }
+        friend polynomial operator-(const polynomial& x)
+        {
+            return negate(x);
+        }
+        friend polynomial operator*(const polynomial& x, const polynomial& y)
+        {
+            return multiply(x, y);
+        }
+        friend polynomial& operator*=(polynomial& x, const polynomial& y)
+        {
+            x = multiply(x, y);
+            return x;
+        }
+        friend polynomial operator/(const polynomial& x, const polynomial& y)
+        {
+            return divide(x, y).first;
+        }
+        friend polynomial& operator/=(polynomial& x, const polynomial& y)
+        {
+            x = divide(x, y).first;
+            return x;
+        }
+        friend polynomial operator%(const polynomial& x, const polynomial& y)
+        {
+            return divide(x, y).second;
+        }
+        friend polynomial& operator%=(polynomial& x, const polynomial& y)
+        {
+            x = divide(x, y).second;
+            return x;
+        }
+        // Stream output, as to_string in decimal.
+        friend std::ostream& operator<<(std::ostream& out, const polynomial& p)
+        {
+            return out << to_string(p);
+        }
+    private:
+        // Lowest degree first, the last one non-zero.
+        std::vector<integer> coefficients_value;
+        void normalize()
+        {
+            while(!coefficients_value.empty() and integer::is_zero(coefficients_value.back()))
+            {
+                coefficients_value.pop_back();
+            }
+        }
+        // x + y, or x - y.
+        static polynomial sum(const polynomial& x, const polynomial& y, const bool subtract_y)
+        {
+            const std::vector<integer>& a = x.coefficients_value;
+            const std::vector<integer>& b = y.coefficients_value;
+            std::vector<integer> r(std::max(a.size(), b.size()));
+            for(std::size_t i = 0; i < r.size(); i++)
+            {
+                if(i >= b.size())
+                {
+                    r[i] = a[i];
+                }
+                else if(i >= a.size())
+                {
+                    r[i] = subtract_y ? -b[i] : b[i];
+                }
+                else
+                {
+                    r[i] = subtract_y ? a[i] - b[i] : a[i] + b[i];
+                }
+            }
+            return polynomial(std::move(r));
+        }
+        static std::size_t max_bits(const polynomial& p)
+        {
+            std::size_t bits = 0;
+            for(const integer& c : p.coefficients_value)
+            {
+                bits = std::max(bits, integer::bit_length(c));
+            }
+            return bits;
+        }
+        // Bits of a slot for the coefficients of x * y: each is a sum of at most min(m, n) products of coefficients below
+        // 2^bx and 2^by in magnitude, so it is below 2^(bx + by + bit_length(min(m, n))), and a bit more holds its sign.
+        static std::size_t slot_bits(const polynomial& x, const polynomial& y)
+        {
+            std::size_t terms = std::min(x.coefficients_value.size(), y.coefficients_value.size());
+            std::size_t term_bits = 0;
+            for(; terms != 0; terms >>= 1)
+            {
+                term_bits++;
+            }
+            return max_bits(x) + max_bits(y) + term_bits + 1;
+        }
+        // p(2^b), for |coefficients| below 2^b: the positive coefficients side by side in the limbs of one integer, the
+        // negative ones in those of another, and the difference of the two.
+        static integer pack(const polynomial& p, const std::size_t b)
+        {
+            const std::vector<integer>& c = p.coefficients_value;
+            const std::size_t n = (c.size() * b + digit_bits - 1) / digit_bits + 1;
+            integer::digit_buffer parts[2];
+            bool used[2] = {false, false};
+            for(std::size_t i = 0; i < c.size(); i++)
+            {
+                if(integer::is_zero(c[i]))
+                {
+                    continue;
+                }
+                const int part = c[i].is_negative ? 1 : 0;
+                if(!used[part])
+                {
+                    parts[part] = integer::digit_buffer(n);
+                    std::fill(parts[part].mutable_data(), parts[part].mutable_data() + n, digit(0));
+                    used[part] = true;
+                }
+                digit* r = parts[part].mutable_data() + i * b / digit_bits;
+                const int s = static_cast<int>(i * b % digit_bits);
+                const auto& cv = c[i].digits.view();
+                for(std::size_t j = 0; j < cv.size(); j++)
+                {
+                    r[j] |= cv[j] << s;
+                    if(s != 0)
+                    {
+                        r[j + 1] |= cv[j] >> (digit_bits - s);
+                    }
+                }
+            }
+            integer value[2];
+            for(int part = 0; part < 2; part++)
+            {
+                if(used[part])
+                {
+                    parts[part].resize(kernels::normalized_size(parts[part].data(), n));
+                    value[part] = integer::create_from_buffer(std::move(parts[part]), false);
+                }
+            }
+            return std::move(value[0]) - value[1];
+        }
+        // The n coefficients of the polynomial whose value at 2^b is v, each below 2^(b - 1) in magnitude: slot i, read
+        // as b bits plus the borrow of the slot below, stands for a negative coefficient (and borrows from slot i + 1)
+        // when it is at least 2^(b - 1). A negative v is read as -v, its coefficients negated.
+        static polynomial unpack(const integer& v, const std::size_t b, const std::size_t n)
+        {
+            const auto& vv = v.digits.view();
+            const std::size_t vn = vv.size();
+            const integer slot = integer::shift_left_bits(integer::one, b);
+            // Limbs of a slot at any offset in the limbs, one more than b takes for the bits below the offset.
+            const std::size_t w = (b + digit_bits - 1) / digit_bits + 1;
+            const digit top_mask = b % digit_bits == 0 ? ~digit(0) : (digit(1) << (b % digit_bits)) - 1;
+            std::vector<integer> r(n);
+            bool borrow = false;
+            for(std::size_t i = 0; i < n; i++)
+            {
+                const std::size_t offset = i * b / digit_bits;
+                integer field;
+                if(offset < vn)
+                {
+                    const std::size_t count = std::min(w, vn - offset);
+                    integer::digit_buffer f(w);
+                    digit* fd = f.mutable_data();
+                    std::fill(fd, fd + w, digit(0));
+                    kernels::shift_right_bits(fd, vv.data() + offset, count, static_cast<int>(i * b % digit_bits));
+                    const std::size_t fn = (b + digit_bits - 1) / digit_bits;
+                    fd[fn - 1] &= top_mask;
+                    f.resize(kernels::normalized_size(fd, fn));
+                    field = integer::create_from_buffer(std::move(f), false);
+                }
+                if(borrow)
+                {
+                    ++field;
+                }
+                borrow = integer::bit_length(field) >= b;
+                if(borrow)
+                {
+                    field -= slot;
+                }
+                r[i] = v.is_negative ? integer::negate(std::move(field)) : std::move(field);
+            }
+            return polynomial(std::move(r));
+        }
+    };
+}
+
+#endif //INTTITAN_POLYNOMIAL_H
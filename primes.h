@@ -0,0 +1,220 @@
+#ifndef INTTITAN_PRIMES_H
+#define INTTITAN_PRIMES_H
+#include "config.h"
+#include "kernels.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// The pieces of primality testing that work on limbs and machine words: the table of small primes, grouped into
+// products of one digit so that trial division takes one pass over the limbs per group, the sieve of a window of
+// candidates for integer::next_prime, and the Jacobi symbol that picks the parameters of the Lucas test.
+namespace int_titan
+{
+    namespace kernels
+    {
+        // The sieve primes are those below this, enough to test any number below its square by trial division.
+        constexpr std::uint32_t sieve_prime_limit = 1 << 16;
+        // Odd primes that integer::is_probable_prime tries as factors before any exponentiation (those up to 1621).
+        constexpr std::size_t trial_division_primes = 256;
+        // The odd primes below sieve_prime_limit, by the sieve of Eratosthenes on first use.
+        inline const std::vector<std::uint32_t>& odd_primes()
+        {
+            static const std::vector<std::uint32_t> primes = []
+            {
+                std::vector<bool> composite(sieve_prime_limit, false);
+                std::vector<std::uint32_t> p;
+                for(std::uint32_t i = 3; i < sieve_prime_limit; i += 2)
+                {
+                    if(composite[i])
+                    {
+                        continue;
+                    }
+                    p.push_back(i);
+                    for(std::uint32_t j = i * i; j < sieve_prime_limit; j += 2 * i)
+                    {
+                        composite[j] = true;
+                    }
+                }
+                return p;
+            }();
+            return primes;
+        }
+        // Consecutive odd primes [first, last) of the table, with their product, which fits in a digit.
+        struct prime_group
+        {
+            digit_divisor product;
+            std::uint32_t first;
+            std::uint32_t last;
+        };
+        inline const std::vector<prime_group>& prime_groups()
+        {
+            static const std::vector<prime_group> groups = []
+            {
+                const std::vector<std::uint32_t>& primes = odd_primes();
+                std::vector<prime_group> g;
+                for(std::uint32_t i = 0; i < primes.size();)
+                {
+                    digit product = 1;
+                    std::uint32_t last = i;
+                    while(last < primes.size() and product <= std::numeric_limits<digit>::max() / primes[last])
+                    {
+                        product *= primes[last++];
+                    }
+                    g.push_back({digit_divisor(product), i, last});
+                    i = last;
+                }
+                return g;
+            }();
+            return groups;
+        }
+        // r[i] = x mod odd_primes()[i] for i < count, x of n limbs: one remainder of x by each product of primes, and
+        // those by its primes from it.
+        inline void prime_residues(std::uint32_t* r, const digit* x, const std::size_t n, const std::size_t count)
+        {
+            const std::vector<std::uint32_t>& primes = odd_primes();
+            for(const prime_group& group : prime_groups())
+            {
+                if(group.first >= count)
+                {
+                    break;
+                }
+                const digit remainder = modulo_digit(x, n, group.product);
+                for(std::uint32_t i = group.first; i < group.last and i < count; i++)
+                {
+                    r[i] = static_cast<std::uint32_t>(remainder % primes[i]);
+                }
+            }
+        }
+        // Is one of the first count odd primes a factor of x (n limbs)? Stops at the first group with one.
+        inline bool has_small_factor(const digit* x, const std::size_t n, const std::size_t count)
+        {
+            const std::vector<std::uint32_t>& primes = odd_primes();
+            for(const prime_group& group : prime_groups())
+            {
+                if(group.first >= count)
+                {
+                    break;
+                }
+                const digit remainder = modulo_digit(x, n, group.product);
+                for(std::uint32_t i = group.first; i < group.last and i < count; i++)
+                {
+                    if(remainder % primes[i] == 0)
+                    {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+        // Is x prime? Trial division by the table, exact for x below sieve_prime_limit^2.
+        inline bool is_small_prime(const std::uint64_t x)
+        {
+            if(x < 2 or x % 2 == 0)
+            {
+                return x == 2;
+            }
+            for(const std::uint32_t p : odd_primes())
+            {
+                if(static_cast<std::uint64_t>(p) * p > x)
+                {
+                    break;
+                }
+                if(x % p == 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        // The Jacobi symbol (a / m) for odd m, by quadratic reciprocity.
+        inline int jacobi(std::uint64_t a, std::uint64_t m)
+        {
+            int t = 1;
+            a %= m;
+            while(a != 0)
+            {
+                while(a % 2 == 0)
+                {
+                    a /= 2;
+                    if(m % 8 == 3 or m % 8 == 5)
+                    {
+                        t = -t;
+                    }
+                }
+                std::swap(a, m);
+                if(a % 4 == 3 and m % 4 == 3)
+                {
+                    t = -t;
+                }
+                a %= m;
+            }
+            return m == 1 ? t : 0;
+        }
+        // The Jacobi symbol (a / x) for odd a and an odd x of n limbs: (-1 / x) by x mod 4, and (|a| / x) by reciprocity
+        // from (x mod |a| / |a|).
+        inline int jacobi(const std::int64_t a, const digit* x, const std::size_t n)
+        {
+            const std::uint64_t magnitude = a < 0 ? 0 - static_cast<std::uint64_t>(a) : static_cast<std::uint64_t>(a);
+            int t = a < 0 and x[0] % 4 == 3 ? -1 : 1;
+            if(magnitude % 4 == 3 and x[0] % 4 == 3)
+            {
+                t = -t;
+            }
+            return t * jacobi(modulo_digit(x, n, static_cast<digit>(magnitude)), magnitude);
+        }
+        // The odd candidates start + 2i of a window (i < size), less those with a factor among the first count odd
+        // primes, for a start above them. The residues of start are computed once, and those of the next window follow
+        // from them by an addition, so no candidate is divided by the primes.
+        class prime_sieve
+        {
+        public:
+            prime_sieve(const digit* start, const std::size_t n, const std::size_t size, const std::size_t count) : composite(size), residues(std::min(count, odd_primes().size()))
+            {
+                prime_residues(residues.data(), start, n, residues.size());
+                sieve();
+            }
+            std::size_t size() const
+            {
+                return composite.size();
+            }
+            // Is start + 2i still a candidate?
+            bool candidate(const std::size_t i) const
+            {
+                return composite[i] == 0;
+            }
+            // On to the window after this one, starting at start + 2 size().
+            void next()
+            {
+                const std::vector<std::uint32_t>& primes = odd_primes();
+                const std::uint64_t step = 2 * static_cast<std::uint64_t>(size());
+                for(std::size_t j = 0; j < residues.size(); j++)
+                {
+                    residues[j] = static_cast<std::uint32_t>((residues[j] + step % primes[j]) % primes[j]);
+                }
+                sieve();
+            }
+        private:
+            std::vector<unsigned char> composite;
+            std::vector<std::uint32_t> residues;
+            // Cross out the i with start + 2i = 0 mod p, i = -r / 2 mod p for the residue r of start.
+            void sieve()
+            {
+                std::fill(composite.begin(), composite.end(), 0);
+                const std::vector<std::uint32_t>& primes = odd_primes();
+                for(std::size_t j = 0; j < residues.size(); j++)
+                {
+                    const std::uint64_t p = primes[j];
+                    for(std::uint64_t i = (p - residues[j]) % p * ((p + 1) / 2) % p; i < composite.size(); i += p)
+                    {
+                        composite[i] = 1;
+                    }
+                }
+            }
+        };
+    }
+}
+
+#endif //INTTITAN_PRIMES_H
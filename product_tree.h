@@ -0,0 +1,172 @@
+#ifndef INTTITAN_PRODUCT_TREE_H
+#define INTTITAN_PRODUCT_TREE_H
+#include "integer.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+// Products of many factors and remainders by many moduli. Folding *= over n factors multiplies a growing product by a
+// small one every time, which is quadratic; a balanced tree multiplies operands of about the same size at every level,
+// so the fast tiers (Karatsuba up to the transforms) do the work. With a parallel_executor the subtrees of the larger
+// levels are multiplied at the same time.
+namespace int_titan
+{
+    namespace tree
+    {
+        // Are operands of about this many bits worth splitting across the executor?
+        inline bool parallel(const std::size_t bits)
+        {
+            return kernels::parallel_multiply(bits / (2 * digit_bits));
+        }
+        // The product of first[i] for i in [begin, end), where bits[i] is the cumulative bit length of the factors before
+        // i. The range is split where the bits reach half, so both halves are about the same size however the factors
+        // vary.
+        template<typename Iterator>
+        integer product(const Iterator first, const std::vector<std::size_t>& bits, const std::size_t begin, const std::size_t end)
+        {
+            if(end - begin <= 2)
+            {
+                return end - begin == 1 ? integer(first[begin]) : first[begin] * first[begin + 1];
+            }
+            const std::size_t half = bits[begin] + (bits[end] - bits[begin]) / 2;
+            std::size_t middle = std::upper_bound(bits.begin() + begin + 1, bits.begin() + end, half) - bits.begin() - 1;
+            middle = std::min(std::max(middle, begin + 1), end - 1);
+            integer halves[2];
+            const auto multiply_half = [&](const std::size_t i)
+            {
+                halves[i] = i == 0 ? product(first, bits, begin, middle) : product(first, bits, middle, end);
+            };
+            if(parallel(bits[end] - bits[begin]))
+            {
+                kernels::parallel_for(2, multiply_half);
+            }
+            else
+            {
+                multiply_half(0);
+                multiply_half(1);
+            }
+            return std::move(halves[0]) * halves[1];
+        }
+    }
+    // The product of the integers in [first, last) (1 for none), by a balanced tree. Random access iterators.
+    template<typename Iterator>
+    integer product(const Iterator first, const Iterator last)
+    {
+        const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+        if(n == 0)
+        {
+            return integer::one;
+        }
+        std::vector<std::size_t> bits(n + 1, 0);
+        for(std::size_t i = 0; i < n; i++)
+        {
+            bits[i + 1] = bits[i] + integer::bit_length(first[i]) + 1;
+        }
+        return tree::product(first, bits, 0, n);
+    }
+    template<typename Range>
+    integer product(const Range& factors)
+    {
+        return product(std::begin(factors), std::end(factors));
+    }
+    // The products of the moduli, level by level: level 0 holds the moduli, every level above the products of adjacent
+    // pairs of the one below (an odd one out is carried up as it is), up to a single root. It is kept to reduce any
+    // number of values by the same moduli.
+    class product_tree
+    {
+    public:
+        explicit product_tree(std::vector<integer> moduli)
+        {
+            levels.push_back(std::move(moduli));
+            while(levels.back().size() > 1)
+            {
+                const std::vector<integer>& below = levels.back();
+                std::vector<integer> level((below.size() + 1) / 2);
+                for_each_node(level.size(), bit_length(below), [&](const std::size_t i)
+                {
+                    level[i] = 2 * i + 1 < below.size() ? below[2 * i] * below[2 * i + 1] : below[2 * i];
+                });
+                levels.push_back(std::move(level));
+            }
+        }
+        // The product of all the moduli (1 for none).
+        integer root() const
+        {
+            return levels.back().empty() ? integer::one : levels.back()[0];
+        }
+        const std::vector<integer>& moduli() const
+        {
+            return levels[0];
+        }
+        // Number of levels, from the moduli to the root.
+        std::size_t height() const
+        {
+            return levels.size();
+        }
+        // The nodes of level l: the moduli for 0, the products of pairs of the level below for the others.
+        const std::vector<integer>& level(const std::size_t l) const
+        {
+            return levels[l];
+        }
+        // x % m for every modulus m (truncated like the operator), going down the tree: the remainder by a node is
+        // reduced by its two children, so every division is of a value about twice the size of its divisor rather than of
+        // x itself.
+        std::vector<integer> remainders(const integer& x) const
+        {
+            if(levels[0].empty())
+            {
+                return {};
+            }
+            // The remainder by a product keeps the sign of x, and those by its factors follow from it.
+            std::vector<integer> above{x % levels.back()[0]};
+            for(std::size_t l = levels.size() - 1; l-- != 0;)
+            {
+                const std::vector<integer>& moduli = levels[l];
+                std::vector<integer> here(moduli.size());
+                for_each_node(here.size(), bit_length(moduli), [&](const std::size_t i)
+                {
+                    here[i] = above[i / 2] % moduli[i];
+                });
+                above = std::move(here);
+            }
+            return above;
+        }
+    private:
+        std::vector<std::vector<integer>> levels;
+        static std::size_t bit_length(const std::vector<integer>& level)
+        {
+            return level.empty() ? 0 : integer::bit_length(level[0]);
+        }
+        // f(i) for the count nodes of a level, whose nodes have about the given number of bits. Across the executor when
+        // the level is big enough in all.
+        template<typename F>
+        static void for_each_node(const std::size_t count, const std::size_t bits, const F& f)
+        {
+            if(parallel_executor == nullptr or !tree::parallel(count * bits))
+            {
+                for(std::size_t i = 0; i < count; i++)
+                {
+                    f(i);
+                }
+                return;
+            }
+            const std::size_t parts = std::min(count, 4 * parallel_executor->concurrency());
+            kernels::parallel_for(parts, [&](const std::size_t p)
+            {
+                for(std::size_t i = p * count / parts; i < (p + 1) * count / parts; i++)
+                {
+                    f(i);
+                }
+            });
+        }
+    };
+    // x % m for every m of the moduli, via a product tree of them.
+    inline std::vector<integer> remainder_tree(const integer& x, std::vector<integer> moduli)
+    {
+        return product_tree(std::move(moduli)).remainders(x);
+    }
+}
+
+#endif //INTTITAN_PRODUCT_TREE_H
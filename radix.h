@@ -0,0 +1,408 @@
+#ifndef INTTITAN_RADIX_H
+#define INTTITAN_RADIX_H
+#include "config.h"
+#include "division.h"
+#include "kernels.h"
+#include "multiplication.h"
+#include "scratch.h"
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <vector>
+
+// Conversion of raw limb spans from and to the digits of a base between 2 and 36, given as their values (not characters)
+// with the most significant first. Powers of two are a matter of moving bits around. Other bases go through chunks of as
+// many digits as fit in a limb (9 for decimal), and through divide and conquer with the powers base^(k * 2^i) of the
+// chunk base for large sizes.
+namespace int_titan
+{
+    // The powers b^(2^k) of one-digit numbers b, each computed once (the square of the one before) and kept for the
+    // calling thread, so repeated conversions in a base, and any other user of these powers, share them. The conversions
+    // take those of the chunk base (see radix_chunk, 10^19 for decimal with 64-bit digits).
+    class power_table
+    {
+    public:
+        // The limbs of a power, without leading zeroes. They stay valid until clear().
+        struct power
+        {
+            const digit* limbs;
+            std::size_t size;
+        };
+        // b^(2^k) for b >= 2.
+        static power get(const digit b, const std::size_t k)
+        {
+            std::deque<std::vector<digit>>& powers = local_powers(b);
+            if(powers.empty())
+            {
+                powers.push_back({b});
+            }
+            while(powers.size() <= k)
+            {
+                const std::vector<digit>& last = powers.back();
+                std::vector<digit> square(2 * last.size());
+                kernels::square(square.data(), last.data(), last.size());
+                square.resize(kernels::normalized_size(square.data(), square.size()));
+                powers.push_back(std::move(square));
+            }
+            return {powers[k].data(), powers[k].size()};
+        }
+        // Limbs kept for the calling thread.
+        static std::size_t cached_limbs()
+        {
+            std::size_t n = 0;
+            for(const table& t : local())
+            {
+                for(const std::vector<digit>& p : t.powers)
+                {
+                    n += p.size();
+                }
+            }
+            return n;
+        }
+        // Give the powers of the calling thread back to the heap.
+        static void clear()
+        {
+            local().clear();
+        }
+    private:
+        struct table
+        {
+            digit base;
+            std::deque<std::vector<digit>> powers;
+        };
+        static std::deque<table>& local()
+        {
+            thread_local std::deque<table> tables;
+            return tables;
+        }
+        static std::deque<std::vector<digit>>& local_powers(const digit b)
+        {
+            std::deque<table>& tables = local();
+            for(table& t : tables)
+            {
+                if(t.base == b)
+                {
+                    return t.powers;
+                }
+            }
+            tables.push_back({b, {}});
+            return tables.back().powers;
+        }
+    };
+    namespace kernels
+    {
+        // Number of bits per digit of a base that is a power of two, or 0 for any other base.
+        inline int radix_bits(const int base)
+        {
+            return (base & (base - 1)) == 0 ? __builtin_ctz(base) : 0;
+        }
+        // Value of every character as a digit of a base up to 36 (the letters in either case), or -1.
+        struct radix_value_table
+        {
+            std::int8_t values[256];
+            constexpr radix_value_table() : values()
+            {
+                for(int c = 0; c < 256; c++)
+                {
+                    const int lower = c | 0x20;
+                    values[c] = static_cast<std::int8_t>(c >= '0' and c <= '9' ? c - '0' : lower >= 'a' and lower <= 'z' ? lower - 'a' + 10 : -1);
+                }
+            }
+        };
+        inline constexpr radix_value_table radix_values{};
+        // The largest number k of digits of the base that always fit in a limb, and base^k.
+        struct radix_chunk
+        {
+            int length = 0;
+            digit value = 1;
+            explicit radix_chunk(const int base)
+            {
+                for(superdigit v = base; v <= std::numeric_limits<digit>::max(); v *= base)
+                {
+                    value = static_cast<digit>(v);
+                    length++;
+                }
+            }
+        };
+        // Limbs needed for the value of count digits of the base.
+        inline std::size_t radix_limbs(const std::size_t count, const int base)
+        {
+            const int bits = radix_bits(base);
+            if(bits != 0)
+            {
+                return (count * bits + digit_bits - 1) / digit_bits;
+            }
+            // Every chunk is below B.
+            const std::size_t length = radix_chunk(base).length;
+            return (count + length - 1) / length;
+        }
+        // Number of digits of the base enough for any value of n limbs.
+        inline std::size_t radix_digits(const std::size_t n, const int base)
+        {
+            const int bits = radix_bits(base);
+            if(bits != 0)
+            {
+                return (n * digit_bits + bits - 1) / bits;
+            }
+            return static_cast<std::size_t>(static_cast<double>(n) * digit_bits / std::log2(base)) + 2;
+        }
+        // The powers base^(k * 2^i) of the chunk base, each the square of the one before, from the power_table.
+        class radix_powers
+        {
+        public:
+            // Powers up to a size of about n limbs.
+            radix_powers(const radix_chunk& chunk, const std::size_t n) : chunk_length(chunk.length)
+            {
+                powers.push_back(power_table::get(chunk.value, 0));
+                while(2 * powers.back().size <= n)
+                {
+                    powers.push_back(power_table::get(chunk.value, powers.size()));
+                }
+            }
+            std::size_t count() const
+            {
+                return powers.size();
+            }
+            const digit* limbs(const std::size_t i) const
+            {
+                return powers[i].limbs;
+            }
+            std::size_t size(const std::size_t i) const
+            {
+                return powers[i].size;
+            }
+            // The number of digits of the base the power stands for.
+            std::size_t digits(const std::size_t i) const
+            {
+                return static_cast<std::size_t>(chunk_length) << i;
+            }
+        private:
+            std::vector<power_table::power> powers;
+            int chunk_length;
+        };
+        // r = the value of the count digits at s, for a base of 2^bits. Writes radix_limbs(count) limbs and returns the
+        // size without leading zeroes.
+        inline std::size_t from_radix_power_of_two(digit* r, const unsigned char* s, const std::size_t count, const int bits)
+        {
+            const std::size_t n = (count * bits + digit_bits - 1) / digit_bits;
+            std::fill(r, r + n, digit(0));
+            for(std::size_t i = 0; i < count; i++)
+            {
+                const std::size_t position = i * bits; // Of the digit s[count - 1 - i].
+                const digit value = s[count - 1 - i];
+                const int offset = static_cast<int>(position % digit_bits);
+                r[position / digit_bits] |= value << offset;
+                if(offset + bits > digit_bits)
+                {
+                    r[position / digit_bits + 1] |= value >> (digit_bits - offset);
+                }
+            }
+            return normalized_size(r, n);
+        }
+        // r = the value of the count digits at s, one chunk at a time. Writes radix_limbs(count) limbs and returns the
+        // size without leading zeroes.
+        inline std::size_t from_radix_basecase(digit* r, const unsigned char* s, const std::size_t count, const int base, const radix_chunk& chunk)
+        {
+            std::size_t n = 0;
+            // The first chunk takes the digits left over by the others.
+            std::size_t i = count % chunk.length != 0 ? count % chunk.length : chunk.length;
+            for(std::size_t start = 0; start < count; start = i, i += chunk.length)
+            {
+                digit d = 0;
+                for(std::size_t j = start; j < i; j++)
+                {
+                    d = d * base + s[j];
+                }
+                r[n] = multiply_by_digit(r, r, n, chunk.value);
+                add(r, r, n + 1, &d, 1);
+                n = normalized_size(r, n + 1);
+            }
+            return n;
+        }
+        // r = the value of the count digits at s: the high digits times the largest power of the chunk base that leaves
+        // some of them, plus the value of the low digits. Writes radix_limbs(count) limbs and returns the size without
+        // leading zeroes.
+        inline std::size_t from_radix_recursive(digit* r, const unsigned char* s, const std::size_t count, const int base, const radix_chunk& chunk, const radix_powers& powers)
+        {
+            if(radix_limbs(count, base) < std::max<std::size_t>(tuning.radix_parse, 2))
+            {
+                return from_radix_basecase(r, s, count, base, chunk);
+            }
+            std::size_t i = 0;
+            while(i + 1 < powers.count() and powers.digits(i + 1) < count)
+            {
+                i++;
+            }
+            const std::size_t low_count = powers.digits(i);
+            const std::size_t high_count = count - low_count;
+            const std::size_t high_limbs = radix_limbs(high_count, base);
+            const scratch_buffer<> memory(high_limbs + radix_limbs(low_count, base));
+            digit* high = memory.get();
+            digit* low = high + high_limbs;
+            const std::size_t hn = from_radix_recursive(high, s, high_count, base, chunk, powers);
+            const std::size_t ln = from_radix_recursive(low, s + high_count, low_count, base, chunk, powers);
+            if(hn == 0)
+            {
+                std::copy(low, low + ln, r);
+                return ln;
+            }
+            // Both sizes add up to at most one limb per chunk, which is the room r has.
+            const std::size_t pn = powers.size(i);
+            if(hn >= pn)
+            {
+                multiply(r, high, hn, powers.limbs(i), pn);
+            }
+            else
+            {
+                multiply(r, powers.limbs(i), pn, high, hn);
+            }
+            add(r, r, hn + pn, low, ln);
+            return normalized_size(r, hn + pn);
+        }
+        // r = the value of the count digits (below the base, most significant first) at s. Writes radix_limbs(count)
+        // limbs and returns the size without leading zeroes.
+        inline std::size_t from_radix(digit* r, const unsigned char* s, const std::size_t count, const int base)
+        {
+            const int bits = radix_bits(base);
+            if(bits != 0)
+            {
+                return from_radix_power_of_two(r, s, count, bits);
+            }
+            const radix_chunk chunk(base);
+            if(radix_limbs(count, base) < std::max<std::size_t>(tuning.radix_parse, 2))
+            {
+                return from_radix_basecase(r, s, count, base, chunk);
+            }
+            const radix_powers powers(chunk, radix_limbs(count, base) / 2);
+            return from_radix_recursive(r, s, count, base, chunk, powers);
+        }
+        // Writes the count lowest digits of x (n limbs) into s, for a base of 2^bits, leading zeroes included.
+        inline void to_radix_power_of_two(unsigned char* s, const digit* x, const std::size_t n, const std::size_t count, const int bits)
+        {
+            const digit mask = (digit(1) << bits) - 1;
+            for(std::size_t i = 0; i < count; i++)
+            {
+                const std::size_t position = i * bits; // Of the digit s[count - 1 - i].
+                const std::size_t index = position / digit_bits;
+                const int offset = static_cast<int>(position % digit_bits);
+                digit value = index < n ? x[index] >> offset : 0;
+                if(offset + bits > digit_bits and index + 1 < n)
+                {
+                    value |= x[index + 1] << (digit_bits - offset);
+                }
+                s[count - 1 - i] = static_cast<unsigned char>(value & mask);
+            }
+        }
+        // Writes count digits of x (n limbs, below base^count) into s, leading zeroes included, one chunk at a time by
+        // dividing by the chunk base. x is overwritten.
+        inline void to_radix_basecase(unsigned char* s, digit* x, std::size_t n, std::size_t count, const int base, const radix_chunk& chunk)
+        {
+            n = normalized_size(x, n);
+            const digit_divisor divisor(chunk.value);
+            while(n != 0)
+            {
+                digit d = divide_by_digit(x, x, n, divisor);
+                n = normalized_size(x, n);
+                for(int j = 0; j < chunk.length and count != 0; j++)
+                {
+                    s[--count] = static_cast<unsigned char>(d % base);
+                    d /= base;
+                }
+            }
+            std::fill(s, s + count, static_cast<unsigned char>(0));
+        }
+        // Writes count digits of x (n limbs, below base^count) into s, leading zeroes included: the quotient and the
+        // remainder by a power of the chunk base of about half the size of x are written one after the other.
+        inline void to_radix_recursive(unsigned char* s, const digit* x, std::size_t n, const std::size_t count, const int base, const radix_chunk& chunk, const radix_powers& powers)
+        {
+            n = normalized_size(x, n);
+            if(n < std::max<std::size_t>(tuning.radix_print, 2))
+            {
+                const scratch_buffer<> copy(n);
+                std::copy(x, x + n, copy.get());
+                to_radix_basecase(s, copy.get(), n, count, base, chunk);
+                return;
+            }
+            // x is at least B^(n - 1), so it is above the power and count covers more digits than the power has.
+            std::size_t i = 0;
+            while(i + 1 < powers.count() and 2 * powers.size(i + 1) <= n)
+            {
+                i++;
+            }
+            const std::size_t pn = powers.size(i);
+            const std::size_t low_count = powers.digits(i);
+            const scratch_buffer<> memory((n - pn + 1) + pn);
+            digit* q = memory.get();
+            digit* r = q + n - pn + 1;
+            divide(q, r, x, n, powers.limbs(i), pn);
+            to_radix_recursive(s, q, n - pn + 1, count - low_count, base, chunk, powers);
+            to_radix_recursive(s + count - low_count, r, pn, low_count, base, chunk, powers);
+        }
+        // Writes count digits of x (n limbs, below base^count) into s, leading zeroes included.
+        inline void to_radix(unsigned char* s, const digit* x, std::size_t n, const std::size_t count, const int base)
+        {
+            const int bits = radix_bits(base);
+            if(bits != 0)
+            {
+                to_radix_power_of_two(s, x, n, count, bits);
+                return;
+            }
+            const radix_chunk chunk(base);
+            n = normalized_size(x, n);
+            if(n < std::max<std::size_t>(tuning.radix_print, 2))
+            {
+                const scratch_buffer<> copy(n);
+                std::copy(x, x + n, copy.get());
+                to_radix_basecase(s, copy.get(), n, count, base, chunk);
+                return;
+            }
+            const radix_powers powers(chunk, n / 2);
+            to_radix_recursive(s, x, n, count, base, chunk, powers);
+        }
+        // Passes the count digits of x (n limbs, below base^count) to write(piece, k), leading zeroes included, in pieces
+        // of k <= leaf digits (leaf at least a chunk) with the most significant first. As in to_radix_recursive, but
+        // only the pieces are ever written out, into the leaf digits at piece: the leading zeroes of a part take no
+        // division, and the digits of a part of at most leaf digits come from to_radix().
+        template<typename Write>
+        inline void to_radix_pieces(const digit* x, std::size_t n, std::size_t count, const int base, const radix_powers& powers, const std::size_t leaf, unsigned char* piece, Write& write)
+        {
+            n = normalized_size(x, n);
+            const std::size_t used = std::min(count, radix_digits(n, base));
+            for(std::size_t zeroes = count - used; zeroes != 0;)
+            {
+                const std::size_t k = std::min(zeroes, leaf);
+                std::fill(piece, piece + k, static_cast<unsigned char>(0));
+                write(piece, k);
+                zeroes -= k;
+            }
+            count = used;
+            if(count <= leaf)
+            {
+                to_radix(piece, x, n, count, base);
+                write(piece, count);
+                return;
+            }
+            // The power has fewer digits than the part, so both the quotient and the remainder have some.
+            std::size_t i = 0;
+            while(i + 1 < powers.count() and 2 * powers.size(i + 1) <= n)
+            {
+                i++;
+            }
+            while(i != 0 and powers.digits(i) >= count)
+            {
+                i--;
+            }
+            const std::size_t pn = powers.size(i);
+            const std::size_t low_count = powers.digits(i);
+            const scratch_buffer<> memory((n - pn + 1) + pn);
+            digit* q = memory.get();
+            digit* r = q + n - pn + 1;
+            divide(q, r, x, n, powers.limbs(i), pn);
+            to_radix_pieces(q, n - pn + 1, count - low_count, base, powers, leaf, piece, write);
+            to_radix_pieces(r, pn, low_count, base, powers, leaf, piece, write);
+        }
+    }
+}
+
+#endif //INTTITAN_RADIX_H
@@ -0,0 +1,423 @@
+#ifndef INTTITAN_RATIONAL_H
+#define INTTITAN_RATIONAL_H
+#include "config.h"
+#include "integer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// Exact rationals of two integers. The operations leave their results unreduced, since a gcd costs more than the
+// products and sums of small operands, and reduce only those that grow past INTTITAN_RATIONAL_REDUCE_THRESHOLD digits.
+// Everything else works on the unreduced fractions: comparisons by the bit lengths and cross products, and sums of equal
+// denominators or of integers without any product of denominators. Output and hashing reduce a copy, reduce() the value
+// itself; a reduced value is kept marked as such, so it is never reduced twice.
+namespace int_titan
+{
+    class rational
+    {
+    public:
+        // Zero.
+        rational() : numerator_value(), denominator_value(integer::one), is_reduced(true)
+        {
+        }
+        // The integer x (n / 1).
+        rational(integer x) : numerator_value(std::move(x)), denominator_value(integer::one), is_reduced(true)
+        {
+        }
+        template<typename T, typename = std::enable_if_t<is_machine_integer<T>>>
+        rational(const T value) : rational(integer(value))
+        {
+        }
+        // n / d, of a non-zero d (any signs).
+        rational(integer n, integer d) : numerator_value(std::move(n)), denominator_value(std::move(d)), is_reduced(false)
+        {
+            if(integer::bit_length(denominator_value) == 0)
+            {
+                throw std::logic_error("Division by 0 impermissible.");
+            }
+            normalize_sign();
+        }
+        // Create a rational from "n/d" or "n" in the base, such as "-22/7".
+        static rational create(const std::string_view str, const int base = 10)
+        {
+            const std::size_t slash = str.find('/');
+            if(slash == std::string_view::npos)
+            {
+                return rational(integer::create(str, base));
+            }
+            return rational(integer::create(str.substr(0, slash), base), integer::create(str.substr(slash + 1), base));
+        }
+        // "n/d" in lowest terms, or "n" for an integer.
+        static std::string to_string(const rational& x, const int base = 10, const bool uppercase = true)
+        {
+            const rational r = reduced(x);
+            std::string s = integer::to_string(r.numerator_value, base, uppercase);
+            if(r.denominator_value != integer::one)
+            {
+                s += '/';
+                s += integer::to_string(r.denominator_value, base, uppercase);
+            }
+            return s;
+        }
+        // x in lowest terms, with a positive denominator.
+        static rational reduced(rational x)
+        {
+            reduce(x);
+            return x;
+        }
+        static void reduce(rational& x)
+        {
+            if(x.is_reduced)
+            {
+                return;
+            }
+            const integer g = integer::gcd(x.numerator_value, x.denominator_value);
+            if(g != integer::one)
+            {
+                x.numerator_value = integer::divide(x.numerator_value, g).first;
+                x.denominator_value = integer::divide(x.denominator_value, g).first;
+            }
+            x.is_reduced = true;
+        }
+        // The numerator and the (positive) denominator in lowest terms.
+        static integer numerator(const rational& x)
+        {
+            return reduced(x).numerator_value;
+        }
+        static integer denominator(const rational& x)
+        {
+            return reduced(x).denominator_value;
+        }
+        // Is x an integer? An unreduced one may have any denominator, so this takes a remainder.
+        static bool is_integer(const rational& x)
+        {
+            return x.denominator_value == integer::one or integer::is_zero(integer::divide(x.numerator_value, x.denominator_value).second);
+        }
+        // -1, 0 or 1 as x is negative, zero or positive.
+        static int sign(const rational& x)
+        {
+            return integer::sign(x.numerator_value);
+        }
+        static rational negate(rational x)
+        {
+            x.numerator_value = integer::negate(std::move(x.numerator_value));
+            return x;
+        }
+        static rational absolute_value(rational x)
+        {
+            x.numerator_value = integer::absolute_value(std::move(x.numerator_value));
+            return x;
+        }
+        // 1 / x, of a non-zero x.
+        static rational inverse(const rational& x)
+        {
+            rational r(x.denominator_value, x.numerator_value);
+            r.is_reduced = x.is_reduced;
+            return r;
+        }
+        // The integer part of x, truncated toward zero, and the floor of x.
+        static integer truncate(const rational& x)
+        {
+            return integer::divide(x.numerator_value, x.denominator_value).first;
+        }
+        static integer floor(const rational& x)
+        {
+            auto [quotient, remainder] = integer::divide(x.numerator_value, x.denominator_value);
+            if(integer::sign(remainder) < 0)
+            {
+                --quotient;
+            }
+            return std::move(quotient);
+        }
+        // x rounded to the nearest floating-point value (ties to even): the quotient of the numerator and the denominator
+        // to three bits more than F holds, with a sticky bit for the remainder, rounded once to the bits F keeps (fewer
+        // for a subnormal).
+        static double to_double(const rational& x)
+        {
+            return to_floating<double>(x);
+        }
+        static long double to_long_double(const rational& x)
+        {
+            return to_floating<long double>(x);
+        }
+        static rational add(const rational& x, const rational& y)
+        {
+            return sum(x, y, false);
+        }
+        static rational subtract(const rational& x, const rational& y)
+        {
+            return sum(x, y, true);
+        }
+        static rational multiply(const rational& x, const rational& y)
+        {
+            rational r;
+            r.numerator_value = x.numerator_value * y.numerator_value;
+            r.denominator_value = x.denominator_value * y.denominator_value;
+            // Only a product of integers is known to be in lowest terms.
+            r.is_reduced = r.denominator_value == integer::one;
+            return bounded(std::move(r));
+        }
+        // x / y, of a non-zero y.
+        static rational divide(const rational& x, const rational& y)
+        {
+            if(integer::bit_length(y.numerator_value) == 0)
+            {
+                throw std::logic_error("Division by 0 impermissible.");
+            }
+            rational r;
+            r.numerator_value = x.numerator_value * y.denominator_value;
+            r.denominator_value = x.denominator_value * y.numerator_value;
+            r.is_reduced = false;
+            r.normalize_sign();
+            return bounded(std::move(r));
+        }
+        // Three-way comparison: -1, 0 or 1 as x is less than, equal to or greater than y. The signs and the bit lengths
+        // decide most pairs; only values within a factor of 4 of each other take the cross products.
+        static int compare(const rational& x, const rational& y)
+        {
+            const int x_sign = sign(x);
+            const int y_sign = sign(y);
+            if(x_sign != y_sign or x_sign == 0)
+            {
+                return x_sign < y_sign ? -1 : x_sign > y_sign ? 1 : 0;
+            }
+            if(x.denominator_value == y.denominator_value)
+            {
+                return integer::compare(x.numerator_value, y.numerator_value);
+            }
+            // 2^(e - 1) < |n / d| < 2^(e + 1) for e the bit length of n less that of d.
+            const auto exponent = [](const rational& r)
+            {
+                return static_cast<long long>(integer::bit_length(r.numerator_value)) - static_cast<long long>(integer::bit_length(r.denominator_value));
+            };
+            const long long x_exponent = exponent(x);
+            const long long y_exponent = exponent(y);
+            if(x_exponent > y_exponent + 1 or y_exponent > x_exponent + 1)
+            {
+                return (x_exponent > y_exponent) == (x_sign > 0) ? 1 : -1;
+            }
+            return integer::compare(x.numerator_value * y.denominator_value, y.numerator_value * x.denominator_value);
+        }
+        static bool is_equal_to(const rational& x, const rational& y)
+        {
+            // Fractions in lowest terms are equal only as pairs.
+            if(x.is_reduced and y.is_reduced)
+            {
+                return x.numerator_value == y.numerator_value and x.denominator_value == y.denominator_value;
+            }
+            return compare(x, y) == 0;
+        }
+        // Hash of the value, the same for equal rationals (of the reduced fraction).
+        static std::size_t hash(const rational& x)
+        {
+            const rational r = reduced(x);
+            const std::size_t h = integer::hash(r.numerator_value);
+            return h ^ (integer::hash(r.denominator_value) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2));
+        }
+
+        // Operator functions.
+        // Comparison.
+        friend bool operator==(const rational& x, const rational& y)
+        {
+            return is_equal_to(x, y);
+        }
+        friend bool operator!=(const rational& x, const rational& y)
+        {
+            return !is_equal_to(x, y);
+        }
+        friend bool operator<(const rational& x, const rational& y)
+        {
+            return compare(x, y) < 0;
+        }
+        friend bool operator<=(const rational& x, const rational& y)
+        {
+            return compare(x, y) <= 0;
+        }
+        friend bool operator>(const rational& x, const rational& y)
+        {
+            return compare(x, y) > 0;
+        }
+        friend bool operator>=(const rational& x, const rational& y)
+        {
+            return compare(x, y) >= 0;
+        }
+        // Arithmetic.
+        friend rational operator+(const rational& x, const rational& y)
+        {
+            return add(x, y);
+        }
+        friend rational& operator+=(rational& x, const rational& y)
+        {
+            x = add(x, y);
+            return x;
+        }
+        friend rational operator-(const rational& x, const rational& y)
+        {
+            return subtract(x, y);
+        }
+        friend rational& operator-=(rational& x, const rational& y)
+        {
+            x = subtract(x, y);
+            return x;
+        }
+        friend rational operator-(const rational& x)
+        {
+            return negate(x);
+        }
+        friend rational operator*(const rational& x, const rational& y)
+        {
+            return multiply(x, y);
+        }
+        friend rational& operator*=(rational& x, const rational& y)
+        {
+            x = multiply(x, y);
+            return x;
+        }
+        friend rational operator/(const rational& x, const rational& y)
+        {
+            return divide(x, y);
+        }
+        friend rational& operator/=(rational& x, const rational& y)
+        {
+            x = divide(x, y);
+            return x;
+        }
+        // Stream output, as to_string in decimal.
+        friend std::ostream& operator<<(std::ostream& out, const rational& x)
+        {
+            return out << to_string(x);
+        }
+    private:
+        integer numerator_value;
+        // Always positive.
+        integer denominator_value;
+        // Is the fraction known to be in lowest terms?
+        bool is_reduced;
+        void normalize_sign()
+        {
+            if(integer::sign(denominator_value) < 0)
+            {
+                numerator_value = integer::negate(std::move(numerator_value));
+                denominator_value = integer::negate(std::move(denominator_value));
+            }
+            if(integer::bit_length(numerator_value) == 0)
+            {
+                denominator_value = integer::one;
+            }
+            is_reduced = is_reduced or denominator_value == integer::one;
+        }
+        // r, reduced if it grew past the threshold.
+        static rational bounded(rational r)
+        {
+            const std::size_t bits = integer::bit_length(r.numerator_value) + integer::bit_length(r.denominator_value);
+            if(bits > static_cast<std::size_t>(INTTITAN_RATIONAL_REDUCE_THRESHOLD) * digit_bits)
+            {
+                reduce(r);
+            }
+            return r;
+        }
+        // x + y, or x - y.
+        static rational sum(const rational& x, const rational& y, const bool subtract_y)
+        {
+            const auto combine = [subtract_y](const integer& a, const integer& b)
+            {
+                return subtract_y ? a - b : a + b;
+            };
+            rational r;
+            if(x.denominator_value == y.denominator_value)
+            {
+                // a/d + c/d: a common factor of a + c and d may well turn up.
+                r.numerator_value = combine(x.numerator_value, y.numerator_value);
+                r.denominator_value = x.denominator_value;
+                r.is_reduced = r.denominator_value == integer::one;
+            }
+            else if(y.denominator_value == integer::one)
+            {
+                // a/b + c is in lowest terms if a/b is: gcd(a + c b, b) = gcd(a, b).
+                r.numerator_value = combine(x.numerator_value, y.numerator_value * x.denominator_value);
+                r.denominator_value = x.denominator_value;
+                r.is_reduced = x.is_reduced;
+            }
+            else if(x.denominator_value == integer::one)
+            {
+                r.numerator_value = combine(x.numerator_value * y.denominator_value, y.numerator_value);
+                r.denominator_value = y.denominator_value;
+                r.is_reduced = y.is_reduced;
+            }
+            else
+            {
+                r.numerator_value = combine(x.numerator_value * y.denominator_value, y.numerator_value * x.denominator_value);
+                r.denominator_value = x.denominator_value * y.denominator_value;
+                r.is_reduced = false;
+            }
+            if(integer::bit_length(r.numerator_value) == 0)
+            {
+                return rational();
+            }
+            return bounded(std::move(r));
+        }
+        template<typename F>
+        static F to_floating(const rational& x)
+        {
+            if(sign(x) == 0)
+            {
+                return F(0);
+            }
+            // At least digits_of_F + 3 bits of quotient, the lowest of them sticky, but none below two under the lowest
+            // bit F keeps (2^-1074 for double): a subnormal result keeps fewer bits than digits_of_F, and rounding to
+            // those and then again in ldexp() can be off by one, so the quotient is rounded here to the bits F keeps.
+            constexpr long long lowest_bit = std::numeric_limits<F>::min_exponent - std::numeric_limits<F>::digits;
+            const long long shift = std::min(static_cast<long long>(integer::bit_length(x.denominator_value)) - static_cast<long long>(integer::bit_length(x.numerator_value)) + std::numeric_limits<F>::digits + 3, 2 - lowest_bit);
+            const integer n = integer::absolute_value(x.numerator_value);
+            auto [quotient, remainder] = shift >= 0 ? integer::divide(n << static_cast<std::size_t>(shift), x.denominator_value)
+                : integer::divide(n, x.denominator_value << static_cast<std::size_t>(-shift));
+            if(integer::bit_length(remainder) != 0)
+            {
+                quotient |= integer::one;
+            }
+            // The lowest bit kept, of digits_of_F below the top one or lowest_bit, and the bits under it (at least two).
+            const long long bits = static_cast<long long>(integer::bit_length(quotient));
+            const long long lowest = std::max(bits - shift - std::numeric_limits<F>::digits, lowest_bit);
+            const std::size_t cut = static_cast<std::size_t>(lowest + shift);
+            const bool half = integer::test_bit(quotient, cut - 1);
+            const bool sticky = integer::count_trailing_zeros(quotient) < cut - 1;
+            quotient >>= cut;
+            if(half and (sticky or integer::test_bit(quotient, 0)))
+            {
+                ++quotient;
+            }
+            F r;
+            if constexpr(std::is_same_v<F, double>)
+            {
+                r = integer::to_double(quotient);
+            }
+            else
+            {
+                r = integer::to_long_double(quotient);
+            }
+            return std::ldexp(sign(x) < 0 ? -r : r, static_cast<int>(std::min<long long>(lowest, 1 << 20)));
+        }
+    };
+}
+
+namespace std
+{
+    template<>
+    struct hash<int_titan::rational>
+    {
+        std::size_t operator()(const int_titan::rational& x) const
+        {
+            return int_titan::rational::hash(x);
+        }
+    };
+}
+
+#endif //INTTITAN_RATIONAL_H
@@ -0,0 +1,449 @@
+#ifndef INTTITAN_RNS_H
+#define INTTITAN_RNS_H
+#include "config.h"
+#include "cpu.h"
+#include "integer.h"
+#include "primes.h"
+#include "product_tree.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+// The x86 vector code is compiled if it can be picked at runtime, or if the compiler targets its extension anyway.
+#if INTTITAN_SIMD and defined(__x86_64__) and (INTTITAN_DISPATCH or defined(__AVX2__))
+#define INTTITAN_RNS_AVX2 1
+#include <immintrin.h>
+#else
+#define INTTITAN_RNS_AVX2 0
+#endif
+
+// Residue number system: an integer as its residues modulo a fixed basis of primes below 2^31, one 32-bit word each.
+// Sums, differences and products of values below the product M of the primes are computed prime by prime, with no
+// carries between them, so they take time linear in the number of primes and run 8 primes at a time with AVX2; only the
+// conversions are costly. to_rns() reduces by a remainder tree, from_rns() reconstructs by Garner's algorithm for a few
+// primes and by the CRT over the product tree for many. The residues are kept in Montgomery form (times 2^32), as
+// kernels::ntt_prime keeps them, so a product is one reduction.
+namespace int_titan
+{
+    namespace kernels
+    {
+        // REDC: t * 2^-32 mod p, for t < p * 2^32 and p_inverse = -p^-1 mod 2^32.
+        inline std::uint32_t rns_reduce(const std::uint64_t t, const std::uint32_t p, const std::uint32_t p_inverse)
+        {
+            const std::uint32_t m = static_cast<std::uint32_t>(t) * p_inverse;
+            const std::uint32_t u = static_cast<std::uint32_t>((t + static_cast<std::uint64_t>(m) * p) >> 32);
+            return u >= p ? u - p : u;
+        }
+        // r[i] = x[i] + y[i] mod p[i] for i < n. r may alias x or y, as in the others.
+        inline void rns_add_portable(std::uint32_t* r, const std::uint32_t* x, const std::uint32_t* y, const std::uint32_t* p, const std::size_t n)
+        {
+            for(std::size_t i = 0; i < n; i++)
+            {
+                const std::uint32_t s = x[i] + y[i];
+                r[i] = s >= p[i] ? s - p[i] : s;
+            }
+        }
+        // r[i] = x[i] - y[i] mod p[i].
+        inline void rns_subtract_portable(std::uint32_t* r, const std::uint32_t* x, const std::uint32_t* y, const std::uint32_t* p, const std::size_t n)
+        {
+            for(std::size_t i = 0; i < n; i++)
+            {
+                r[i] = x[i] >= y[i] ? x[i] - y[i] : x[i] + p[i] - y[i];
+            }
+        }
+        // r[i] = x[i] * y[i] * 2^-32 mod p[i], the form of the product.
+        inline void rns_multiply_portable(std::uint32_t* r, const std::uint32_t* x, const std::uint32_t* y, const std::uint32_t* p, const std::uint32_t* p_inverse, const std::size_t n)
+        {
+            for(std::size_t i = 0; i < n; i++)
+            {
+                r[i] = rns_reduce(static_cast<std::uint64_t>(x[i]) * y[i], p[i], p_inverse[i]);
+            }
+        }
+#if INTTITAN_RNS_AVX2
+        // The values of s below 2p, less p where they are at least p: s - p wraps around above s otherwise.
+        INTTITAN_TARGET("avx2") inline __m256i rns_correct_avx2(const __m256i s, const __m256i p)
+        {
+            return _mm256_min_epu32(s, _mm256_sub_epi32(s, p));
+        }
+        // REDC of the products of the even lanes of x and y (as 64-bit lanes), the results in the low halves.
+        INTTITAN_TARGET("avx2") inline __m256i rns_reduce_avx2(const __m256i x, const __m256i y, const __m256i p, const __m256i p_inverse)
+        {
+            const __m256i t = _mm256_mul_epu32(x, y);
+            const __m256i m = _mm256_mul_epu32(t, p_inverse);
+            return _mm256_srli_epi64(_mm256_add_epi64(t, _mm256_mul_epu32(m, p)), 32);
+        }
+        INTTITAN_TARGET("avx2") inline void rns_add_avx2(std::uint32_t* r, const std::uint32_t* x, const std::uint32_t* y, const std::uint32_t* p, const std::size_t n)
+        {
+            std::size_t i = 0;
+            for(; i + 8 <= n; i += 8)
+            {
+                const __m256i s = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), rns_correct_avx2(s, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i))));
+            }
+            rns_add_portable(r + i, x + i, y + i, p + i, n - i);
+        }
+        INTTITAN_TARGET("avx2") inline void rns_subtract_avx2(std::uint32_t* r, const std::uint32_t* x, const std::uint32_t* y, const std::uint32_t* p, const std::size_t n)
+        {
+            std::size_t i = 0;
+            for(; i + 8 <= n; i += 8)
+            {
+                const __m256i d = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)));
+                // d + p is below p exactly where x - y did not wrap around.
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_min_epu32(d, _mm256_add_epi32(d, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)))));
+            }
+            rns_subtract_portable(r + i, x + i, y + i, p + i, n - i);
+        }
+        INTTITAN_TARGET("avx2") inline void rns_multiply_avx2(std::uint32_t* r, const std::uint32_t* x, const std::uint32_t* y, const std::uint32_t* p, const std::uint32_t* p_inverse, const std::size_t n)
+        {
+            std::size_t i = 0;
+            for(; i + 8 <= n; i += 8)
+            {
+                const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+                const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i));
+                const __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_inverse + i));
+                // The even lanes, then the odd ones moved down, and the results interleaved again.
+                const __m256i even = rns_reduce_avx2(a, b, q, v);
+                const __m256i odd = rns_reduce_avx2(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32), _mm256_srli_epi64(q, 32), _mm256_srli_epi64(v, 32));
+                const __m256i u = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), rns_correct_avx2(u, q));
+            }
+            rns_multiply_portable(r + i, x + i, y + i, p + i, p_inverse + i, n - i);
+        }
+#endif
+        inline void rns_add(std::uint32_t* r, const std::uint32_t* x, const std::uint32_t* y, const std::uint32_t* p, const std::size_t n)
+        {
+#if INTTITAN_RNS_AVX2
+            if(cpu().avx2)
+            {
+                rns_add_avx2(r, x, y, p, n);
+                return;
+            }
+#endif
+            rns_add_portable(r, x, y, p, n);
+        }
+        inline void rns_subtract(std::uint32_t* r, const std::uint32_t* x, const std::uint32_t* y, const std::uint32_t* p, const std::size_t n)
+        {
+#if INTTITAN_RNS_AVX2
+            if(cpu().avx2)
+            {
+                rns_subtract_avx2(r, x, y, p, n);
+                return;
+            }
+#endif
+            rns_subtract_portable(r, x, y, p, n);
+        }
+        inline void rns_multiply(std::uint32_t* r, const std::uint32_t* x, const std::uint32_t* y, const std::uint32_t* p, const std::uint32_t* p_inverse, const std::size_t n)
+        {
+#if INTTITAN_RNS_AVX2
+            if(cpu().avx2)
+            {
+                rns_multiply_avx2(r, x, y, p, p_inverse, n);
+                return;
+            }
+#endif
+            rns_multiply_portable(r, x, y, p, p_inverse, n);
+        }
+        // The count largest primes below 2^31, from the largest down. Trial division by the sieve primes suffices for
+        // numbers below 2^32.
+        inline std::vector<std::uint32_t> rns_primes(const std::size_t count)
+        {
+            std::vector<std::uint32_t> primes;
+            primes.reserve(count);
+            for(std::uint32_t candidate = (std::uint32_t(1) << 31) - 1; primes.size() < count; candidate -= 2)
+            {
+                bool prime = true;
+                for(const std::uint32_t q : odd_primes())
+                {
+                    if(q * q > candidate)
+                    {
+                        break;
+                    }
+                    if(candidate % q == 0)
+                    {
+                        prime = false;
+                        break;
+                    }
+                }
+                if(prime)
+                {
+                    primes.push_back(candidate);
+                }
+            }
+            return primes;
+        }
+    }
+    // The residues of an integer modulo the primes of an rns_basis, in its Montgomery form. The values only mean
+    // something to the basis that made them.
+    class rns_integer
+    {
+    public:
+        rns_integer() = default;
+        // Number of residues, that of the primes of the basis.
+        std::size_t size() const
+        {
+            return residues.size();
+        }
+        const std::uint32_t* data() const
+        {
+            return residues.data();
+        }
+        std::uint32_t* data()
+        {
+            return residues.data();
+        }
+    private:
+        friend class rns_basis;
+        std::vector<std::uint32_t> residues;
+        explicit rns_integer(const std::size_t n) : residues(n, 0)
+        {
+        }
+    };
+    // A basis of the residue number system: the primes, their product M and what the conversions need. Values represent
+    // integers modulo M: those in [0, M), or with from_rns(x, true) those in (-M / 2, M / 2], so the basis must be
+    // chosen (see for_bits()) for the largest result a computation may have, not for its operands. A basis may be
+    // shared between threads.
+    class rns_basis
+    {
+    public:
+        // Primes from which from_rns() reconstructs over the product tree rather than by Garner's algorithm, which is
+        // quadratic in them, and from which to_rns() reduces down the tree rather than by every prime on its own.
+        static constexpr std::size_t crt_tree_primes = 8;
+        static constexpr std::size_t remainder_tree_primes = 32;
+        // The count largest primes below 2^31.
+        explicit rns_basis(const std::size_t count) : primes(kernels::rns_primes(count)), p_inverse(count), r_squared(count), tree(std::vector<integer>(primes.begin(), primes.end()))
+        {
+            if(count == 0)
+            {
+                throw std::invalid_argument("At least one prime expected.");
+            }
+            for(std::size_t i = 0; i < count; i++)
+            {
+                p_inverse[i] = static_cast<std::uint32_t>(kernels::montgomery_inverse(primes[i]));
+                const std::uint64_t r = (std::uint64_t(1) << 32) % primes[i];
+                r_squared[i] = static_cast<std::uint32_t>(r * r % primes[i]);
+            }
+            m = tree.root();
+            if(count < crt_tree_primes)
+            {
+                // The inverse of p[0] * ... * p[i - 1] modulo p[i], for Garner's algorithm.
+                garner_inverse.resize(count);
+                for(std::size_t i = 0; i < count; i++)
+                {
+                    std::uint64_t product = 1;
+                    for(std::size_t j = 0; j < i; j++)
+                    {
+                        product = product * primes[j] % primes[i];
+                    }
+                    garner_inverse[i] = inverse(static_cast<std::uint32_t>(product), i);
+                }
+            }
+            else
+            {
+                // (M / p) mod p for each prime p, as the remainder of M by p^2 divided by p, then its inverse.
+                std::vector<integer> squares(count);
+                for(std::size_t i = 0; i < count; i++)
+                {
+                    squares[i] = integer(static_cast<std::uint64_t>(primes[i]) * primes[i]);
+                }
+                const std::vector<integer> remainders = remainder_tree(m, std::move(squares));
+                crt_inverse.resize(count);
+                for(std::size_t i = 0; i < count; i++)
+                {
+                    crt_inverse[i] = inverse(static_cast<std::uint32_t>(integer::to<std::uint64_t>(remainders[i]) / primes[i]), i);
+                }
+            }
+        }
+        // A basis whose M exceeds 2^(bits + 1), enough for from_rns(x, true) of the values of magnitude below 2^bits.
+        static rns_basis for_bits(const std::size_t bits)
+        {
+            // Every prime is above 2^30.
+            return rns_basis((bits + 1) / 30 + 1);
+        }
+        // Number of primes.
+        std::size_t size() const
+        {
+            return primes.size();
+        }
+        // The primes, from the largest down.
+        const std::vector<std::uint32_t>& moduli() const
+        {
+            return primes;
+        }
+        // Their product M.
+        const integer& modulus() const
+        {
+            return m;
+        }
+        // The residues of x modulo the primes (those of x mod M).
+        rns_integer to_rns(const integer& x) const
+        {
+            const std::size_t n = size();
+            rns_integer r(n);
+            const integer magnitude = integer::absolute_value(x);
+            // A value of a few digits is reduced by every prime on its own, a larger one down the tree.
+            if(n < remainder_tree_primes or integer::bit_length(magnitude) <= 4 * digit_bits)
+            {
+                for(std::size_t i = 0; i < n; i++)
+                {
+                    r.residues[i] = static_cast<std::uint32_t>(integer::mod_digit(magnitude, primes[i]));
+                }
+            }
+            else
+            {
+                const std::vector<integer> remainders = tree.remainders(magnitude);
+                for(std::size_t i = 0; i < n; i++)
+                {
+                    r.residues[i] = integer::to<std::uint32_t>(remainders[i]);
+                }
+            }
+            for(std::size_t i = 0; i < n; i++)
+            {
+                std::uint32_t& v = r.residues[i];
+                v = x < integer::zero and v != 0 ? primes[i] - v : v;
+                v = kernels::rns_reduce(static_cast<std::uint64_t>(v) * r_squared[i], primes[i], p_inverse[i]);
+            }
+            return r;
+        }
+        // The integer in [0, M) of the residues x, or in (-M / 2, M / 2] if balanced (the one of the least magnitude).
+        integer from_rns(const rns_integer& x, const bool balanced = false) const
+        {
+            check(x);
+            const std::size_t n = size();
+            std::vector<std::uint32_t> v(n);
+            for(std::size_t i = 0; i < n; i++)
+            {
+                v[i] = kernels::rns_reduce(x.residues[i], primes[i], p_inverse[i]);
+            }
+            integer r = n < crt_tree_primes ? garner(v) : crt(v);
+            if(balanced and integer::shift_left_bits(r, 1) > m)
+            {
+                r -= m;
+            }
+            return r;
+        }
+        // r = x + y, x - y, x * y, -x (mod M). r may be x or y.
+        void add(rns_integer& r, const rns_integer& x, const rns_integer& y) const
+        {
+            prepare(r, x, y);
+            kernels::rns_add(r.data(), x.data(), y.data(), primes.data(), size());
+        }
+        void subtract(rns_integer& r, const rns_integer& x, const rns_integer& y) const
+        {
+            prepare(r, x, y);
+            kernels::rns_subtract(r.data(), x.data(), y.data(), primes.data(), size());
+        }
+        void multiply(rns_integer& r, const rns_integer& x, const rns_integer& y) const
+        {
+            prepare(r, x, y);
+            kernels::rns_multiply(r.data(), x.data(), y.data(), primes.data(), p_inverse.data(), size());
+        }
+        void negate(rns_integer& r, const rns_integer& x) const
+        {
+            const rns_integer zero(size());
+            subtract(r, zero, x);
+        }
+        rns_integer add(const rns_integer& x, const rns_integer& y) const
+        {
+            rns_integer r;
+            add(r, x, y);
+            return r;
+        }
+        rns_integer subtract(const rns_integer& x, const rns_integer& y) const
+        {
+            rns_integer r;
+            subtract(r, x, y);
+            return r;
+        }
+        rns_integer multiply(const rns_integer& x, const rns_integer& y) const
+        {
+            rns_integer r;
+            multiply(r, x, y);
+            return r;
+        }
+    private:
+        std::vector<std::uint32_t> primes;
+        std::vector<std::uint32_t> p_inverse; // -p^-1 mod 2^32.
+        std::vector<std::uint32_t> r_squared; // 2^64 mod p.
+        std::vector<std::uint32_t> garner_inverse;
+        std::vector<std::uint32_t> crt_inverse;
+        product_tree tree;
+        integer m;
+        // a^-1 mod primes[i], for a not divisible by it.
+        std::uint32_t inverse(const std::uint32_t a, const std::size_t i) const
+        {
+            const std::uint64_t p = primes[i];
+            std::uint64_t result = 1;
+            std::uint64_t base = a % p;
+            for(std::uint64_t e = p - 2; e != 0; e >>= 1)
+            {
+                if(e & 1)
+                {
+                    result = result * base % p;
+                }
+                base = base * base % p;
+            }
+            return static_cast<std::uint32_t>(result);
+        }
+        void check(const rns_integer& x) const
+        {
+            if(x.size() != size())
+            {
+                throw std::invalid_argument("Residues of another basis.");
+            }
+        }
+        void prepare(rns_integer& r, const rns_integer& x, const rns_integer& y) const
+        {
+            check(x);
+            check(y);
+            r.residues.resize(size());
+        }
+        // Garner's algorithm: the digits c of the value in the mixed radix of the primes, c[i] = (v[i] - (the value of
+        // c[0..i) mod p[i])) / (p[0] * ... * p[i - 1]) mod p[i], in words, then the value by Horner's rule.
+        integer garner(const std::vector<std::uint32_t>& v) const
+        {
+            const std::size_t n = size();
+            std::vector<std::uint32_t> c(n);
+            for(std::size_t i = 0; i < n; i++)
+            {
+                const std::uint64_t p = primes[i];
+                std::uint64_t below = 0;
+                for(std::size_t j = i; j-- != 0;)
+                {
+                    below = (below * primes[j] + c[j]) % p;
+                }
+                c[i] = static_cast<std::uint32_t>((v[i] + p - below) % p * garner_inverse[i] % p);
+            }
+            integer r(c[n - 1]);
+            for(std::size_t i = n - 1; i-- != 0;)
+            {
+                r = r * integer(primes[i]) + integer(c[i]);
+            }
+            return r;
+        }
+        // The CRT over the product tree: the sum of v[i] (M / p[i])^-1 mod p[i] times M / p[i], summed up the tree where
+        // a node is left * (product of right) + right * (product of left), then reduced by M.
+        integer crt(const std::vector<std::uint32_t>& v) const
+        {
+            const std::size_t n = size();
+            std::vector<integer> values(n);
+            for(std::size_t i = 0; i < n; i++)
+            {
+                values[i] = integer(static_cast<std::uint64_t>(v[i]) * crt_inverse[i] % primes[i]);
+            }
+            for(std::size_t l = 0; l + 1 < tree.height(); l++)
+            {
+                const std::vector<integer>& products = tree.level(l);
+                std::vector<integer> above((values.size() + 1) / 2);
+                for(std::size_t i = 0; i < above.size(); i++)
+                {
+                    above[i] = 2 * i + 1 < values.size() ? values[2 * i] * products[2 * i + 1] + values[2 * i + 1] * products[2 * i] : std::move(values[2 * i]);
+                }
+                values = std::move(above);
+            }
+            return values[0] % m;
+        }
+    };
+}
+
+#endif //INTTITAN_RNS_H
@@ -0,0 +1,95 @@
+#ifndef INTTITAN_ROOTS_H
+#define INTTITAN_ROOTS_H
+#include "config.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// The pieces of integer roots that work on limbs: the roots of values up to two digits, from a floating-point estimate
+// corrected exactly, which seed the Newton iterations of integer::isqrt and integer::iroot, and the filter of residues
+// that rejects most non-squares before any root is taken.
+namespace int_titan
+{
+    namespace kernels
+    {
+        // Is r^k greater than n? Without overflow: the powers stop as soon as they pass n.
+        inline bool power_exceeds(const superdigit r, const unsigned k, const superdigit n)
+        {
+            superdigit power = 1;
+            for(unsigned i = 0; i < k; i++)
+            {
+                if(r != 0 and power > n / r)
+                {
+                    return true;
+                }
+                power *= r;
+            }
+            return power > n;
+        }
+        // floor(n^(1/k)) for k >= 2. The long double estimate is off by at most a few units, which the exact
+        // comparisons put right.
+        inline digit root(const superdigit n, const unsigned k)
+        {
+            superdigit r = static_cast<superdigit>(k == 2 ? std::sqrt(static_cast<long double>(n)) : std::pow(static_cast<long double>(n), 1.0L / k));
+            while(r != 0 and power_exceeds(r, k, n))
+            {
+                r--;
+            }
+            while(!power_exceeds(r + 1, k, n))
+            {
+                r++;
+            }
+            return static_cast<digit>(r);
+        }
+        // The squares modulo m as a mask of bits, m at most 256.
+        struct square_residues
+        {
+            std::uint64_t mask[4] = {};
+            constexpr explicit square_residues(const unsigned m)
+            {
+                for(unsigned i = 0; i < m; i++)
+                {
+                    const unsigned r = i * i % m;
+                    mask[r / 64] |= std::uint64_t(1) << (r % 64);
+                }
+            }
+            constexpr bool contains(const unsigned r) const
+            {
+                return ((mask[r / 64] >> (r % 64)) & 1) != 0;
+            }
+        };
+        // The product of the odd moduli of the filter, below 2^32 so that the residue takes 64-bit divisions by a
+        // constant.
+        constexpr std::uint32_t square_filter_modulus = 9 * 5 * 7 * 11 * 13 * 17 * 19 * 23;
+        // Can the n limbs x (n > 0) be a square? It must be one modulo 256 (the low byte) and modulo each of 9, 5, 7, ...,
+        // 23 (the residue modulo their product): together a non-square passes about once in 900 times.
+        inline bool may_be_square(const digit* x, const std::size_t n)
+        {
+            constexpr square_residues low(256);
+            if(!low.contains(static_cast<unsigned>(x[0] & 0xFF)))
+            {
+                return false;
+            }
+            constexpr unsigned moduli[] = {9, 5, 7, 11, 13, 17, 19, 23};
+            constexpr square_residues residues[] = {square_residues(9), square_residues(5), square_residues(7), square_residues(11), square_residues(13), square_residues(17), square_residues(19), square_residues(23)};
+            std::uint64_t r = 0;
+            for(std::size_t i = n; i-- != 0;)
+            {
+                for(int shift = digit_bits - 32; shift >= 0; shift -= 32)
+                {
+                    r = ((r << 32) | static_cast<std::uint32_t>(x[i] >> shift)) % square_filter_modulus;
+                }
+            }
+            for(int i = 0; i < 8; i++)
+            {
+                if(!residues[i].contains(static_cast<unsigned>(r % moduli[i])))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+}
+
+#endif //INTTITAN_ROOTS_H
@@ -0,0 +1,158 @@
+#ifndef INTTITAN_SCRATCH_H
+#define INTTITAN_SCRATCH_H
+#include "config.h"
+#include "stats.h"
+#include <climits>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Temporary memory of the kernels (multiplication, division, radix conversion, exponentiation), taken from a pool of
+// each thread instead of the heap. Freed blocks are kept in lists by size class (powers of two), as in the free lists of
+// immer's thread_local_free_list_heap, so a computation that repeats reaches a state without heap allocations.
+namespace int_titan
+{
+    // The scratch pool of the calling thread. The memory it keeps is bounded by limit(), blocks that do not fit are given
+    // back to the heap.
+    class scratch_pool
+    {
+    public:
+        // Bytes kept for reuse.
+        static std::size_t cached_bytes()
+        {
+            return local().cached;
+        }
+        // Most bytes kept for reuse, INTTITAN_SCRATCH_POOL_LIMIT to start with. Lowering it trims the pool.
+        static std::size_t limit()
+        {
+            return local().limit;
+        }
+        static void set_limit(const std::size_t bytes)
+        {
+            pool& p = local();
+            p.limit = bytes;
+            p.trim(bytes);
+        }
+        // Give the kept memory back to the heap, down to the given number of bytes (all of it by default).
+        static void trim(const std::size_t keep = 0)
+        {
+            local().trim(keep);
+        }
+        // A block of at least the given number of bytes, aligned for any type.
+        static void* allocate(const std::size_t bytes)
+        {
+            pool& p = local();
+            const int c = size_class(bytes);
+            if(c >= classes)
+            {
+                statistics::count_scratch_allocation(bytes);
+                return ::operator new(bytes);
+            }
+            if(p.blocks[c] != nullptr)
+            {
+                p.cached -= block_size(c);
+                return std::exchange(p.blocks[c], p.blocks[c]->next);
+            }
+            statistics::count_scratch_allocation(block_size(c));
+            return ::operator new(block_size(c));
+        }
+        // Return a block of allocate(bytes).
+        static void deallocate(void* block, const std::size_t bytes)
+        {
+            pool& p = local();
+            const int c = size_class(bytes);
+            if(c >= classes or p.cached + block_size(c) > p.limit)
+            {
+                ::operator delete(block);
+                return;
+            }
+            p.blocks[c] = new(block) node{p.blocks[c]};
+            p.cached += block_size(c);
+        }
+    private:
+        // Class c holds blocks of 64 * 2^c bytes.
+        static constexpr int classes = 32;
+        static constexpr std::size_t smallest_block = 64;
+        struct node
+        {
+            node* next;
+        };
+        struct pool
+        {
+            node* blocks[classes] = {};
+            std::size_t cached = 0;
+            std::size_t limit = INTTITAN_SCRATCH_POOL_LIMIT;
+            ~pool()
+            {
+                trim(0);
+            }
+            // Free the largest blocks first, they hold most of the memory.
+            void trim(const std::size_t keep)
+            {
+                for(int c = classes; c-- != 0 and cached > keep;)
+                {
+                    while(blocks[c] != nullptr and cached > keep)
+                    {
+                        ::operator delete(std::exchange(blocks[c], blocks[c]->next));
+                        cached -= block_size(c);
+                    }
+                }
+            }
+        };
+        static pool& local()
+        {
+            thread_local pool p;
+            return p;
+        }
+        static std::size_t block_size(const int c)
+        {
+            return smallest_block << c;
+        }
+        static int size_class(const std::size_t bytes)
+        {
+            if(bytes <= smallest_block)
+            {
+                return 0;
+            }
+            // The number of bits of (bytes - 1) / 64, so that the block is the next power of two.
+            return static_cast<int>(sizeof(unsigned long long) * CHAR_BIT) - __builtin_clzll((bytes - 1) / smallest_block);
+        }
+    };
+    namespace kernels
+    {
+        // An array of n uninitialized elements from the scratch pool, returned to it by the destructor.
+        template<typename T = digit>
+        class scratch_buffer
+        {
+        public:
+            explicit scratch_buffer(const std::size_t n) : elements(static_cast<T*>(scratch_pool::allocate(n * sizeof(T)))), n(n)
+            {
+            }
+            scratch_buffer(scratch_buffer&& other) noexcept : elements(std::exchange(other.elements, nullptr)), n(other.n)
+            {
+            }
+            scratch_buffer(const scratch_buffer&) = delete;
+            scratch_buffer& operator=(const scratch_buffer&) = delete;
+            ~scratch_buffer()
+            {
+                if(elements != nullptr)
+                {
+                    scratch_pool::deallocate(elements, n * sizeof(T));
+                }
+            }
+            T* get() const
+            {
+                return elements;
+            }
+            T& operator[](const std::size_t i) const
+            {
+                return elements[i];
+            }
+        private:
+            T* elements;
+            std::size_t n;
+        };
+    }
+}
+
+#endif //INTTITAN_SCRATCH_H
@@ -0,0 +1,255 @@
+#ifndef INTTITAN_STATS_H
+#define INTTITAN_STATS_H
+#include "config.h"
+#include <immer/memory_policy.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+// Counters for finding out where a workload spends its time: with INTTITAN_STATS, every addition, subtraction,
+// multiplication, squaring and division of integers is counted with the sizes of its operands, and the heap of the
+// memory policy with its allocations, the way immer wraps a heap in debug_size_heap and counts its nodes under
+// IMMER_DEBUG_STATS. statistics::snapshot() reads them all at once, for a metrics system or write_stats(). Without
+// INTTITAN_STATS the counting compiles to nothing, the memory policy is left as it is and the snapshots are zeroes.
+namespace int_titan
+{
+    constexpr bool stats_enabled = INTTITAN_STATS != 0;
+    // The operations counted. An operation is counted once, for the magnitudes its kernel is run on: x + y of opposite
+    // signs is a subtraction, and small_divide is a division (or remainder) by a single digit.
+    enum class operation
+    {
+        add,
+        subtract,
+        multiply,
+        square,
+        divide,
+        small_divide
+    };
+    constexpr std::size_t operation_count = 6;
+    inline constexpr const char* operation_names[operation_count] = {"add", "subtract", "multiply", "square", "divide", "small_divide"};
+    // Operand sizes in powers of two: bucket 0 holds empty operands, bucket b those of 2^(b-1) to 2^b - 1 limbs.
+    constexpr std::size_t size_buckets = std::numeric_limits<std::size_t>::digits + 1;
+    constexpr std::size_t size_bucket(std::size_t limbs)
+    {
+        std::size_t b = 0;
+        for(; limbs != 0; limbs >>= 1)
+        {
+            b++;
+        }
+        return b;
+    }
+    struct operation_counts
+    {
+        std::uint64_t calls = 0;
+        // Limbs of all the operands.
+        std::uint64_t limbs = 0;
+        // Calls by the size bucket of the larger operand (the dividend) and of the smaller one (the divisor). A square
+        // has no smaller operand.
+        std::uint64_t larger_sizes[size_buckets] = {};
+        std::uint64_t smaller_sizes[size_buckets] = {};
+    };
+    // The counters at one point in time. Each is read on its own, so one taken while other threads compute is only
+    // consistent counter by counter.
+    struct stats_snapshot
+    {
+        operation_counts operations[operation_count] = {};
+        // Blocks of the heap of the memory policy: the limbs of integers (and the nodes of flex_limbs).
+        std::uint64_t allocations = 0;
+        std::uint64_t allocated_bytes = 0;
+        std::uint64_t deallocations = 0;
+        std::uint64_t deallocated_bytes = 0;
+        // Blocks the scratch pool of the kernels had to take from the heap.
+        std::uint64_t scratch_allocations = 0;
+        std::uint64_t scratch_bytes = 0;
+        const operation_counts& operator[](const operation op) const
+        {
+            return operations[static_cast<std::size_t>(op)];
+        }
+        // Bytes of the heap in use.
+        std::uint64_t live_bytes() const
+        {
+            return allocated_bytes - deallocated_bytes;
+        }
+    };
+    // The atomic counterparts of operation_counts and stats_snapshot, behind statistics.
+    struct operation_counters
+    {
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> limbs{0};
+        std::atomic<std::uint64_t> larger_sizes[size_buckets] = {};
+        std::atomic<std::uint64_t> smaller_sizes[size_buckets] = {};
+    };
+    struct stats_counters
+    {
+        operation_counters operations[operation_count];
+        std::atomic<std::uint64_t> allocations{0};
+        std::atomic<std::uint64_t> allocated_bytes{0};
+        std::atomic<std::uint64_t> deallocations{0};
+        std::atomic<std::uint64_t> deallocated_bytes{0};
+        std::atomic<std::uint64_t> scratch_allocations{0};
+        std::atomic<std::uint64_t> scratch_bytes{0};
+    };
+    // The counters of the program, shared by all threads and updated with relaxed atomics.
+    class statistics
+    {
+    public:
+        // An operation on operands of the given numbers of limbs.
+        static void count(const operation op, const std::size_t larger, const std::size_t smaller = 0)
+        {
+            if constexpr(stats_enabled)
+            {
+                operation_counters& c = totals.operations[static_cast<std::size_t>(op)];
+                c.calls.fetch_add(1, std::memory_order_relaxed);
+                c.limbs.fetch_add(larger + smaller, std::memory_order_relaxed);
+                c.larger_sizes[size_bucket(larger)].fetch_add(1, std::memory_order_relaxed);
+                if(op != operation::square)
+                {
+                    c.smaller_sizes[size_bucket(smaller)].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+        static void count_allocation(const std::size_t bytes)
+        {
+            if constexpr(stats_enabled)
+            {
+                totals.allocations.fetch_add(1, std::memory_order_relaxed);
+                totals.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            }
+        }
+        static void count_deallocation(const std::size_t bytes)
+        {
+            if constexpr(stats_enabled)
+            {
+                totals.deallocations.fetch_add(1, std::memory_order_relaxed);
+                totals.deallocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            }
+        }
+        static void count_scratch_allocation(const std::size_t bytes)
+        {
+            if constexpr(stats_enabled)
+            {
+                totals.scratch_allocations.fetch_add(1, std::memory_order_relaxed);
+                totals.scratch_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            }
+        }
+        static stats_snapshot snapshot()
+        {
+            stats_snapshot s;
+            if constexpr(stats_enabled)
+            {
+                for(std::size_t i = 0; i < operation_count; i++)
+                {
+                    const operation_counters& c = totals.operations[i];
+                    operation_counts& o = s.operations[i];
+                    o.calls = c.calls.load(std::memory_order_relaxed);
+                    o.limbs = c.limbs.load(std::memory_order_relaxed);
+                    for(std::size_t b = 0; b < size_buckets; b++)
+                    {
+                        o.larger_sizes[b] = c.larger_sizes[b].load(std::memory_order_relaxed);
+                        o.smaller_sizes[b] = c.smaller_sizes[b].load(std::memory_order_relaxed);
+                    }
+                }
+                s.allocations = totals.allocations.load(std::memory_order_relaxed);
+                s.allocated_bytes = totals.allocated_bytes.load(std::memory_order_relaxed);
+                s.deallocations = totals.deallocations.load(std::memory_order_relaxed);
+                s.deallocated_bytes = totals.deallocated_bytes.load(std::memory_order_relaxed);
+                s.scratch_allocations = totals.scratch_allocations.load(std::memory_order_relaxed);
+                s.scratch_bytes = totals.scratch_bytes.load(std::memory_order_relaxed);
+            }
+            return s;
+        }
+        // Set all the counters to zero. The heap counters start over too, so live_bytes() no longer covers the blocks
+        // allocated before.
+        static void reset()
+        {
+            if constexpr(stats_enabled)
+            {
+                for(operation_counters& c : totals.operations)
+                {
+                    c.calls.store(0, std::memory_order_relaxed);
+                    c.limbs.store(0, std::memory_order_relaxed);
+                    for(std::size_t b = 0; b < size_buckets; b++)
+                    {
+                        c.larger_sizes[b].store(0, std::memory_order_relaxed);
+                        c.smaller_sizes[b].store(0, std::memory_order_relaxed);
+                    }
+                }
+                for(std::atomic<std::uint64_t>* c : {&totals.allocations, &totals.allocated_bytes, &totals.deallocations, &totals.deallocated_bytes, &totals.scratch_allocations, &totals.scratch_bytes})
+                {
+                    c->store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+    private:
+        static inline stats_counters totals;
+    };
+    // A snapshot as lines of "name = value", e.g. "multiply.calls = 12" and "multiply.larger.64 = 3" for 3 calls with a
+    // larger operand of 64 to 127 limbs (empty buckets are left out), then the "heap." and "scratch." counters.
+    inline void write_stats(std::ostream& out, const stats_snapshot& s)
+    {
+        const auto sizes = [&out](const char* name, const char* operand, const std::uint64_t (&buckets)[size_buckets])
+        {
+            for(std::size_t b = 0; b < size_buckets; b++)
+            {
+                if(buckets[b] != 0)
+                {
+                    out << name << '.' << operand << '.' << (b == 0 ? 0 : std::uint64_t(1) << (b - 1)) << " = " << buckets[b] << '\n';
+                }
+            }
+        };
+        for(std::size_t i = 0; i < operation_count; i++)
+        {
+            const operation_counts& o = s.operations[i];
+            out << operation_names[i] << ".calls = " << o.calls << '\n';
+            out << operation_names[i] << ".limbs = " << o.limbs << '\n';
+            sizes(operation_names[i], "larger", o.larger_sizes);
+            sizes(operation_names[i], "smaller", o.smaller_sizes);
+        }
+        out << "heap.allocations = " << s.allocations << '\n';
+        out << "heap.allocated_bytes = " << s.allocated_bytes << '\n';
+        out << "heap.deallocations = " << s.deallocations << '\n';
+        out << "heap.deallocated_bytes = " << s.deallocated_bytes << '\n';
+        out << "scratch.allocations = " << s.scratch_allocations << '\n';
+        out << "scratch.bytes = " << s.scratch_bytes << '\n';
+    }
+    // An immer heap that counts the blocks of the heap Base, as debug_size_heap wraps one to check their sizes.
+    template<typename Base>
+    struct stats_heap : Base
+    {
+        template<typename... Tags>
+        static void* allocate(const std::size_t size, Tags... tags)
+        {
+            void* p = Base::allocate(size, tags...);
+            statistics::count_allocation(size);
+            return p;
+        }
+        template<typename... Tags>
+        static void deallocate(const std::size_t size, void* data, Tags... tags)
+        {
+            statistics::count_deallocation(size);
+            Base::deallocate(size, data, tags...);
+        }
+    };
+    // The heap policy HeapPolicy with its heaps (those for fixed sizes too) wrapped in stats_heap.
+    template<typename HeapPolicy>
+    struct stats_heap_policy
+    {
+        using type = stats_heap<typename HeapPolicy::type>;
+        template<std::size_t Size>
+        struct optimized
+        {
+            using type = stats_heap<typename HeapPolicy::template optimized<Size>::type>;
+        };
+    };
+    // The memory policy MemoryPolicy with a counted heap under INTTITAN_STATS, else MemoryPolicy itself.
+    template<typename MemoryPolicy>
+    using stats_memory_policy = std::conditional_t<stats_enabled,
+        immer::memory_policy<stats_heap_policy<typename MemoryPolicy::heap>, typename MemoryPolicy::refcount, typename MemoryPolicy::lock, typename MemoryPolicy::transience,
+            MemoryPolicy::prefer_fewer_bigger_objects, MemoryPolicy::use_transient_rvalues>,
+        MemoryPolicy>;
+}
+
+#endif //INTTITAN_STATS_H
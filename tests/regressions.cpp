@@ -0,0 +1,306 @@
+// Cases that once went wrong, each checked by the value it must give. Runs as the regressions test (ctest); the exit
+// status is 1 if any case fails, each of which is printed by its name.
+#include "atomic_integer.h"
+#include "bigfloat.h"
+#include "calculator.h"
+#include "integer.h"
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace int_titan
+{
+    // Runs the steps of atomic_integer's operations one at a time, so that a single thread replays an interleaving.
+    struct atomic_integer_replay
+    {
+        using node = atomic_integer::node;
+        static node* acquire(const atomic_integer& a)
+        {
+            return a.acquire();
+        }
+        static void unpin(const atomic_integer& a, node* const n)
+        {
+            a.unpin(n);
+        }
+        // The first half of store() and exchange(): the new node goes into the word, which returns the previous one.
+        static std::uint64_t swap(atomic_integer& a, integer x)
+        {
+            return a.word.exchange(atomic_integer::pack(new node(std::move(x))), std::memory_order_acq_rel);
+        }
+        static const integer& value(const std::uint64_t previous)
+        {
+            return atomic_integer::unpack(previous)->value;
+        }
+        // The second half: the readers of the previous node move to it.
+        static void replace(const std::uint64_t previous)
+        {
+            atomic_integer::replace(previous, 0);
+        }
+    };
+}
+
+namespace
+{
+    using int_titan::integer;
+    int failures = 0;
+    // Five limbs of 64 bits, beyond the inline ones: the limbs are on the heap, in blocks copies can share.
+    const char* const wide = "123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0";
+    void check(const char* name, const bool ok)
+    {
+        if(!ok)
+        {
+            std::cout << "FAILED: " << name << '\n';
+            failures++;
+        }
+    }
+    // A reader pins the node, a writer swaps the word, the reader unpins (from the node, as the word has moved on) and
+    // only then does the writer move the readers: the node must live until the last of them, and be freed once.
+    void atomic_integer_unpin_before_replace()
+    {
+        using replay = int_titan::atomic_integer_replay;
+        const integer big = integer::create(wide);
+        {
+            int_titan::atomic_integer a(big);
+            replay::node* const n = replay::acquire(a);
+            const std::uint64_t previous = replay::swap(a, integer(1));
+            check("atomic_integer: pinned value", n->value == big);
+            replay::unpin(a, n);
+            replay::replace(previous);
+            check("atomic_integer: value after store", a.load() == 1);
+        }
+        {
+            // exchange() reads the previous value between the swap and the replace.
+            int_titan::atomic_integer a(big);
+            replay::node* const n = replay::acquire(a);
+            const std::uint64_t previous = replay::swap(a, integer(2));
+            replay::unpin(a, n);
+            check("atomic_integer: exchanged value", replay::value(previous) == big);
+            replay::replace(previous);
+            check("atomic_integer: value after exchange", a.load() == 2);
+        }
+    }
+    // As many readers as the count in the word holds with 64-bit pointers (65535) pin the node at once, and a store
+    // moves them all.
+    void atomic_integer_most_readers()
+    {
+        using replay = int_titan::atomic_integer_replay;
+        const integer big = integer::create(wide);
+        int_titan::atomic_integer a(big);
+        std::vector<replay::node*> pinned;
+        for(int i = 0; i < 0xFFFF; i++)
+        {
+            pinned.push_back(replay::acquire(a));
+        }
+        check("atomic_integer: most readers", pinned.back() == pinned.front() and pinned.back()->value == big);
+        const std::uint64_t previous = replay::swap(a, integer(3));
+        replay::replace(previous);
+        for(replay::node* const n : pinned)
+        {
+            replay::unpin(a, n);
+        }
+        check("atomic_integer: after most readers", a.load() == 3);
+    }
+    // x and -x share their limbs, which multiply() squares, but the product is negative.
+    void multiply_by_negation()
+    {
+        const integer x = integer::create(wide);
+        const integer unshared = integer::create(wide);
+        check("x * -x", x * -x == -(x * unshared));
+        check("-x * x", -x * x < 0);
+        check("0 * -0", integer() * -integer() == 0);
+    }
+    // Is the expression rejected as malformed?
+    bool rejects(int_titan::calculator& calculator, const std::string& expression)
+    {
+        try
+        {
+            calculator.evaluate(expression);
+            return false;
+        }
+        catch(const std::invalid_argument&)
+        {
+            return true;
+        }
+    }
+    // Parentheses and unary operators recurse as deeply as binary ones, and are bounded by the same depth.
+    void calculator_nesting()
+    {
+        int_titan::calculator calculator;
+        // The operand inside is one more call.
+        const std::size_t depth = int_titan::calculator::max_depth - 1;
+        const std::string nested = std::string(depth, '(') + "1" + std::string(depth, ')');
+        check("calculator: parentheses to the depth", calculator.evaluate(nested) == 1);
+        check("calculator: parentheses beyond the depth", rejects(calculator, "(" + nested + ")"));
+        const std::string deeper = std::string(2000, '(') + "1" + std::string(2000, ')');
+        check("calculator: 2000 parentheses", rejects(calculator, deeper));
+        check("calculator: unclosed parentheses", rejects(calculator, std::string(10'000'000, '(')));
+        check("calculator: unary operators", rejects(calculator, std::string(10'000'000, '-') + "1"));
+        check("calculator: after a rejection", calculator.evaluate("-(1 + 2) * 3") == -9);
+        // Right shifts past std::size_t saturate, left ones are still out of range.
+        check("calculator: huge right shift", calculator.evaluate("1 >> 10000000000000000000000") == 0);
+        check("calculator: huge right shift of a negative", calculator.evaluate("-5 >> 10000000000000000000000") == -1);
+        try
+        {
+            calculator.evaluate("1 << 10000000000000000000000");
+            check("calculator: huge left shift", false);
+        }
+        catch(const std::out_of_range&)
+        {
+        }
+    }
+    // m * 2^e, exactly.
+    int_titan::bigfloat scaled(const integer& m, const int e)
+    {
+        const integer power = integer::one << static_cast<std::size_t>(e < 0 ? -e : e);
+        const int_titan::rational r = e < 0 ? int_titan::rational(m, power) : int_titan::rational(m * power);
+        return int_titan::bigfloat::from_rational(r, integer::bit_length(m) + 1);
+    }
+    // Subnormal doubles keep fewer than 53 bits, to which the value is rounded once: rounded to 53 bits first, the
+    // ones below the lowest kept one become a tie that rounds up. Of bigfloat and of rational.
+    void subnormal_to_double()
+    {
+        using int_titan::bigfloat;
+        const integer m = (integer::one << 60) + (1 << 9) + (1 << 8) - 1;
+        check("bigfloat: subnormal", bigfloat::to_double(scaled(m, -1083)) == std::ldexp(double((1ull << 51) + 1), -1074));
+        check("bigfloat: negative subnormal", bigfloat::to_double(scaled(-m, -1083)) == -std::ldexp(double((1ull << 51) + 1), -1074));
+        check("bigfloat: half of the least", bigfloat::to_double(scaled(integer::one, -1075)) == 0);
+        check("bigfloat: above half of the least", bigfloat::to_double(scaled(integer(3), -1076)) == std::ldexp(1.0, -1074));
+        check("bigfloat: far below the least", std::signbit(bigfloat::to_double(scaled(integer(-3), -1100))));
+        check("bigfloat: least normal", bigfloat::to_double(scaled(integer::one, -1022)) == std::ldexp(1.0, -1022));
+        using int_titan::rational;
+        const integer scale = integer::one << 1083;
+        check("rational: subnormal", rational::to_double(rational(m, scale)) == std::ldexp(double((1ull << 51) + 1), -1074));
+        check("rational: half of the least", rational::to_double(rational(integer::one, integer::one << 1075)) == 0);
+        check("rational: above half of the least", rational::to_double(rational(integer(3), integer::one << 1076)) == std::ldexp(1.0, -1074));
+        check("rational: a third of the least", rational::to_double(rational(integer::one, 3 * (integer::one << 1074))) == 0);
+        check("rational: two thirds of the least", rational::to_double(rational(integer(2), 3 * (integer::one << 1074))) == std::ldexp(1.0, -1074));
+    }
+    // Is the tuning file rejected?
+    bool rejects_tuning(const std::string& file)
+    {
+        std::istringstream in(file);
+        try
+        {
+            int_titan::read_tuning(in);
+            return false;
+        }
+        catch(const std::invalid_argument&)
+        {
+            return true;
+        }
+    }
+    // Every threshold is checked against the least its algorithm takes, not only those of Karatsuba and Toom-Cook.
+    void tuning_below_least()
+    {
+        check("tuning: half_gcd 0", rejects_tuning("half_gcd = 0\n"));
+        check("tuning: ntt_multiply 39", rejects_tuning("ntt_multiply = 39\n"));
+        check("tuning: newton_divide 5", rejects_tuning("newton_divide = 5\n"));
+        check("tuning: radix_print 1", rejects_tuning("radix_print = 1\n"));
+        check("tuning: half_gcd 4", !rejects_tuning("half_gcd = 4\n"));
+        std::stringstream file;
+        int_titan::write_tuning(file);
+        check("tuning: built-in thresholds", !rejects_tuning(file.str()));
+    }
+    // operator>> and operator<< as for int: the prefixes the base of the stream allows, and std::internal padding.
+    void stream_prefixes()
+    {
+        const auto read = [](const char* text, const std::ios_base::fmtflags base, const integer& value, const std::string& rest)
+        {
+            std::istringstream in(text);
+            in.setf(base, std::ios_base::basefield);
+            integer x(-7);
+            in >> x;
+            in.clear();
+            std::string left;
+            std::getline(in, left);
+            return x == value and left == rest;
+        };
+        // As for int, a 0x without digits after it is no integer.
+        const auto fails = [](const char* text, const std::ios_base::fmtflags base)
+        {
+            std::istringstream in(text);
+            in.setf(base, std::ios_base::basefield);
+            integer x;
+            in >> x;
+            return in.fail();
+        };
+        const std::ios_base::fmtflags none{};
+        check("operator>>: hex 0x1f", read("0x1f", std::ios_base::hex, 31, ""));
+        check("operator>>: hex -0X1F", read("-0X1F", std::ios_base::hex, -31, ""));
+        for(const char* text : {"0x", "0xz", "-0x", "0x-1"})
+        {
+            check(("operator>>: hex " + std::string(text)).c_str(), fails(text, std::ios_base::hex));
+            check(("operator>>: no base " + std::string(text)).c_str(), fails(text, none));
+        }
+        check("operator>>: hex 0", read("0", std::ios_base::hex, 0, ""));
+        check("operator>>: dec 0x1f", read("0x1f", std::ios_base::dec, 0, "x1f"));
+        check("operator>>: oct 017", read("017", std::ios_base::oct, 15, ""));
+        check("operator>>: no base 0x1f", read("0x1f", none, 31, ""));
+        check("operator>>: no base 017", read("-017", none, -15, ""));
+        check("operator>>: no base 08", read("08", none, 0, "8"));
+        check("operator>>: no base 19", read("19", none, 19, ""));
+        std::ostringstream out;
+        out << std::setfill('*') << std::internal << std::setw(8) << integer(-5) << '|' << std::showbase << std::hex << std::setw(8) << integer(255);
+        check("operator<<: internal", out.str() == "-******5|0x****ff");
+        // The 0 of octal is no prefix the fill goes after, unlike 0x.
+        std::ostringstream octal;
+        octal << std::oct << std::showbase << std::internal << std::setw(25) << std::setfill('*') << integer(255);
+        check("operator<<: internal octal", octal.str() == std::string(21, '*') + "0377");
+    }
+    // The std::format specification, or "invalid".
+    std::string formatted(const std::string& specification, const integer& x)
+    {
+        int_titan::integer_format format;
+        if(format.parse(specification.data(), specification.data() + specification.size()) == nullptr)
+        {
+            return "invalid";
+        }
+        std::string s;
+        format.write(std::back_inserter(s), x);
+        return s;
+    }
+    // The results std::format gives for int.
+    void format_specifications()
+    {
+        check("format: default", formatted("", integer(-42)) == "-42");
+        check("format: right", formatted("*>8", integer(-5)) == "******-5");
+        check("format: left", formatted("*<8", integer(-5)) == "-5******");
+        check("format: center", formatted("*^8", integer(-5)) == "***-5***");
+        check("format: zeros", formatted("08", integer(-5)) == "-0000005");
+        check("format: zeros and prefix", formatted("#010x", integer(255)) == "0x000000ff");
+        check("format: zeros with an alignment", formatted("<06", integer(7)) == "7     ");
+        check("format: plus and uppercase", formatted("+#X", integer(255)) == "+0XFF");
+        check("format: space", formatted(" d", integer(5)) == " 5");
+        check("format: octal 0", formatted("#o", integer(0)) == "0");
+        check("format: octal 8", formatted("#o", integer(8)) == "010");
+        check("format: binary", formatted("#B", integer(-5)) == "-0B101");
+        check("format: wide", formatted(">300", integer(1)) == std::string(299, ' ') + "1");
+        check("format: precision", formatted(".2", integer(1)) == "invalid");
+        check("format: locale", formatted("L", integer(1)) == "invalid");
+        check("format: argument width", formatted("{}", integer(1)) == "invalid");
+        check("format: character", formatted("c", integer(65)) == "invalid");
+    }
+}
+
+int main()
+{
+    atomic_integer_unpin_before_replace();
+    atomic_integer_most_readers();
+    multiply_by_negation();
+    calculator_nesting();
+    subnormal_to_double();
+    tuning_below_least();
+    stream_prefixes();
+    format_specifications();
+    if(failures == 0)
+    {
+        std::cout << "All regressions pass.\n";
+    }
+    return failures == 0 ? 0 : 1;
+}
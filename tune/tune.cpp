@@ -0,0 +1,226 @@
+// Measures the crossovers of int_titan::tuning on this host and writes them as a tuning file (see tuning.h), to be
+// named by $INTTITAN_TUNING or INTTITAN_TUNING_FILE, or with --header as INTTITAN_*_THRESHOLD definitions to include
+// before the library:
+//     tune [--header] [-o <file>]
+// Each threshold t is found by timing its operation at a size n twice, with t = n (the faster algorithm at the top,
+// the ones below it under) and with t = n + 1, and taking the first of two sizes in a row where the former wins. The
+// higher tiers are kept out of the way until their turn, so that each one is measured above the tuned ones below it.
+// parallel_multiply depends on the executor of the program and keeps its value.
+#include "integer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using int_titan::digit;
+using int_titan::integer;
+using int_titan::tuning;
+namespace kernels = int_titan::kernels;
+
+namespace
+{
+    // Out of reach of any operand measured.
+    constexpr std::size_t never = std::numeric_limits<std::size_t>::max() / 4;
+    std::vector<digit> random_limbs(const std::size_t n, const std::uint64_t seed)
+    {
+        std::mt19937_64 rng(seed * 1000003 + n);
+        std::vector<digit> limbs(n);
+        for(digit& d : limbs)
+        {
+            d = static_cast<digit>(rng());
+        }
+        limbs.back() |= digit(1) << (int_titan::digit_bits - 1);
+        return limbs;
+    }
+    // Seconds a call of f takes: the least of five runs of enough calls for two milliseconds.
+    double seconds(const std::function<void()>& f)
+    {
+        using clock = std::chrono::steady_clock;
+        std::size_t calls = 1;
+        double best = std::numeric_limits<double>::max();
+        for(int run = 0; run < 5;)
+        {
+            const clock::time_point start = clock::now();
+            for(std::size_t i = 0; i < calls; i++)
+            {
+                f();
+            }
+            const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+            if(elapsed < 0.002)
+            {
+                calls *= 2;
+                continue;
+            }
+            best = std::min(best, elapsed / static_cast<double>(calls));
+            run++;
+        }
+        return best;
+    }
+    // Set threshold to the crossover of run(n) between low and high (high if the faster algorithm never wins there).
+    void crossover(const char* name, std::size_t& threshold, const std::size_t low, const std::size_t high, const std::function<std::function<void()>(std::size_t)>& setup)
+    {
+        std::size_t found = high;
+        std::size_t first = 0;
+        for(std::size_t n = low; n <= high; n = std::max(n + 1, n + n / 8))
+        {
+            const std::function<void()> run = setup(n);
+            threshold = n;
+            const double faster = seconds(run);
+            threshold = n + 1;
+            const double slower = seconds(run);
+            std::cerr << name << ' ' << n << ": " << faster / slower << '\n';
+            if(faster >= slower)
+            {
+                first = 0;
+                continue;
+            }
+            if(first != 0)
+            {
+                found = first;
+                break;
+            }
+            first = n;
+        }
+        threshold = found;
+        std::cerr << name << " = " << found << '\n';
+    }
+    // n by n limbs.
+    std::function<void()> multiplication(const std::size_t n)
+    {
+        auto x = std::make_shared<std::vector<digit>>(random_limbs(n, 1));
+        auto y = std::make_shared<std::vector<digit>>(random_limbs(n, 2));
+        auto r = std::make_shared<std::vector<digit>>(2 * n);
+        return [=]
+        {
+            kernels::multiply(r->data(), x->data(), n, y->data(), n);
+        };
+    }
+    std::function<void()> squaring(const std::size_t n)
+    {
+        auto x = std::make_shared<std::vector<digit>>(random_limbs(n, 1));
+        auto r = std::make_shared<std::vector<digit>>(2 * n);
+        return [=]
+        {
+            kernels::square(r->data(), x->data(), n);
+        };
+    }
+    // ratio * n limbs by n limbs.
+    std::function<void()> division(const std::size_t n, const std::size_t ratio)
+    {
+        auto x = std::make_shared<std::vector<digit>>(random_limbs(ratio * n, 1));
+        auto y = std::make_shared<std::vector<digit>>(random_limbs(n, 2));
+        auto q = std::make_shared<std::vector<digit>>(ratio * n - n + 1);
+        auto r = std::make_shared<std::vector<digit>>(n);
+        return [=]
+        {
+            kernels::divide(q->data(), r->data(), x->data(), ratio * n, y->data(), n);
+        };
+    }
+    std::function<void()> gcd(const std::size_t n)
+    {
+        auto x = std::make_shared<integer>(integer::create(int_titan::integer_view(random_limbs(n, 1).data(), n)));
+        auto y = std::make_shared<integer>(integer::create(int_titan::integer_view(random_limbs(n, 2).data(), n)));
+        return [=]
+        {
+            integer::gcd(*x, *y);
+        };
+    }
+    // The decimal digits of an n-limb value.
+    std::function<void()> parsing(const std::size_t n)
+    {
+        const std::size_t count = kernels::radix_digits(n, 10) - 2;
+        auto s = std::make_shared<std::vector<unsigned char>>(count);
+        std::mt19937_64 rng(n);
+        for(unsigned char& c : *s)
+        {
+            c = static_cast<unsigned char>(rng() % 10);
+        }
+        auto r = std::make_shared<std::vector<digit>>(kernels::radix_limbs(count, 10));
+        return [=]
+        {
+            kernels::from_radix(r->data(), s->data(), count, 10);
+        };
+    }
+    std::function<void()> printing(const std::size_t n)
+    {
+        auto x = std::make_shared<std::vector<digit>>(random_limbs(n, 1));
+        auto s = std::make_shared<std::vector<unsigned char>>(kernels::radix_digits(n, 10));
+        return [=]
+        {
+            kernels::to_radix(s->data(), x->data(), n, s->size(), 10);
+        };
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool header = false;
+    std::string path;
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--header") == 0)
+        {
+            header = true;
+        }
+        else if(std::strcmp(argv[i], "-o") == 0 and i + 1 < argc)
+        {
+            path = argv[++i];
+        }
+        else
+        {
+            std::cerr << "usage: tune [--header] [-o <file>]\n";
+            return 2;
+        }
+    }
+    int_titan::parallel_executor = nullptr;
+    tuning.toom3_multiply = tuning.toom4_multiply = tuning.ntt_multiply = never;
+    tuning.toom3_square = tuning.toom4_square = never;
+    crossover("karatsuba_multiply", tuning.karatsuba_multiply, 4, 128, multiplication);
+    crossover("toom3_multiply", tuning.toom3_multiply, std::max<std::size_t>(tuning.karatsuba_multiply, 8), 640, multiplication);
+    crossover("toom4_multiply", tuning.toom4_multiply, std::max<std::size_t>(tuning.toom3_multiply, 16), 1280, multiplication);
+    crossover("karatsuba_square", tuning.karatsuba_square, 4, 192, squaring);
+    crossover("toom3_square", tuning.toom3_square, std::max<std::size_t>(tuning.karatsuba_square, 8), 640, squaring);
+    crossover("toom4_square", tuning.toom4_square, std::max<std::size_t>(tuning.toom3_square, 16), 1280, squaring);
+    crossover("ntt_multiply", tuning.ntt_multiply, std::max<std::size_t>(tuning.toom4_multiply, 1024), 65536, multiplication);
+    tuning.newton_divide = never;
+    crossover("burnikel_ziegler_divide", tuning.burnikel_ziegler_divide, 8, 256, [](const std::size_t n) { return division(n, 2); });
+    crossover("newton_divide", tuning.newton_divide, std::max<std::size_t>(tuning.burnikel_ziegler_divide, 512), 32768, [](const std::size_t n) { return division(n, 5); });
+    crossover("half_gcd", tuning.half_gcd, 32, 2048, gcd);
+    crossover("radix_parse", tuning.radix_parse, 2, 256, parsing);
+    crossover("radix_print", tuning.radix_print, 2, 256, printing);
+    std::ofstream file;
+    if(!path.empty())
+    {
+        file.open(path);
+        if(!file)
+        {
+            std::cerr << "cannot write " << path << '\n';
+            return 1;
+        }
+    }
+    std::ostream& out = path.empty() ? std::cout : file;
+    if(header)
+    {
+        out << "// int_titan thresholds measured by tune, for " << int_titan::digit_bits << "-bit digits.\n";
+        out << "#ifndef INTTITAN_DIGIT_BITS\n#define INTTITAN_DIGIT_BITS " << int_titan::digit_bits << "\n#endif\n";
+        out << "#if INTTITAN_DIGIT_BITS != " << int_titan::digit_bits << "\n#error \"Thresholds for another digit size.\"\n#endif\n";
+        for(const int_titan::threshold_name& threshold : int_titan::threshold_names)
+        {
+            out << "#define " << threshold.macro << ' ' << tuning.*threshold.member << '\n';
+        }
+    }
+    else
+    {
+        out << "# int_titan thresholds measured by tune.\n";
+        int_titan::write_tuning(out);
+    }
+    return 0;
+}
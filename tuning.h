@@ -0,0 +1,136 @@
+#ifndef INTTITAN_TUNING_H
+#define INTTITAN_TUNING_H
+#include "config.h"
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+// The thresholds of int_titan::tuning as a text file, so that each host can run the tune executable once and have its
+// own crossovers from then on: lines of "name = value" with the names of the thresholds members, "#" comments, and the
+// digit size the values were measured for. The file named by $INTTITAN_TUNING, else by INTTITAN_TUNING_FILE, is read
+// when the program starts; tune also writes the same values as INTTITAN_*_THRESHOLD definitions for a build instead.
+namespace int_titan
+{
+    // A member of thresholds, its names in tuning files and as a build option, and the least value its algorithm takes
+    // (with a half_gcd of 0, say, the GCD would never end).
+    struct threshold_name
+    {
+        const char* name;
+        const char* macro;
+        std::size_t thresholds::*member;
+        std::size_t least;
+    };
+    inline constexpr threshold_name threshold_names[] = {
+        {"karatsuba_multiply", "INTTITAN_KARATSUBA_THRESHOLD", &thresholds::karatsuba_multiply, 2},
+        {"toom3_multiply", "INTTITAN_TOOM3_THRESHOLD", &thresholds::toom3_multiply, 8},
+        {"toom4_multiply", "INTTITAN_TOOM4_THRESHOLD", &thresholds::toom4_multiply, 16},
+        {"karatsuba_square", "INTTITAN_KARATSUBA_SQUARE_THRESHOLD", &thresholds::karatsuba_square, 2},
+        {"toom3_square", "INTTITAN_TOOM3_SQUARE_THRESHOLD", &thresholds::toom3_square, 8},
+        {"toom4_square", "INTTITAN_TOOM4_SQUARE_THRESHOLD", &thresholds::toom4_square, 16},
+        {"ntt_multiply", "INTTITAN_NTT_THRESHOLD", &thresholds::ntt_multiply, 40},
+        {"parallel_multiply", "INTTITAN_PARALLEL_MULTIPLY_THRESHOLD", &thresholds::parallel_multiply, 32},
+        {"burnikel_ziegler_divide", "INTTITAN_BURNIKEL_ZIEGLER_THRESHOLD", &thresholds::burnikel_ziegler_divide, 4},
+        {"newton_divide", "INTTITAN_NEWTON_DIVISION_THRESHOLD", &thresholds::newton_divide, 6},
+        {"half_gcd", "INTTITAN_HALF_GCD_THRESHOLD", &thresholds::half_gcd, 4},
+        {"radix_parse", "INTTITAN_RADIX_PARSE_THRESHOLD", &thresholds::radix_parse, 2},
+        {"radix_print", "INTTITAN_RADIX_PRINT_THRESHOLD", &thresholds::radix_print, 2},
+    };
+    // Thresholds from a tuning file: those it names are changed, the others kept. Throws for an unknown name, a value
+    // that is not a number of limbs or below the least the algorithm takes, and for another digit size, in which case t
+    // is left as it was.
+    inline thresholds read_tuning(std::istream& in, thresholds t = tuning)
+    {
+        std::string line;
+        while(std::getline(in, line))
+        {
+            line = line.substr(0, line.find('#'));
+            const std::size_t equals = line.find('=');
+            const auto trim = [](const std::string& s)
+            {
+                const std::size_t first = s.find_first_not_of(" \t\r");
+                return first == std::string::npos ? std::string() : s.substr(first, s.find_last_not_of(" \t\r") - first + 1);
+            };
+            const std::string name = trim(line.substr(0, equals));
+            if(name.empty() and equals == std::string::npos)
+            {
+                continue;
+            }
+            const std::string text = equals != std::string::npos ? trim(line.substr(equals + 1)) : std::string();
+            if(text.empty() or text.find_first_not_of("0123456789") != std::string::npos or text.size() > 18)
+            {
+                throw std::invalid_argument("Invalid tuning value for " + name + ".");
+            }
+            const std::size_t value = std::stoull(text);
+            if(name == "digit_bits")
+            {
+                if(value != static_cast<std::size_t>(digit_bits))
+                {
+                    throw std::invalid_argument("Tuning for another digit size.");
+                }
+                continue;
+            }
+            bool found = false;
+            for(const threshold_name& threshold : threshold_names)
+            {
+                if(name == threshold.name)
+                {
+                    t.*threshold.member = value;
+                    found = true;
+                }
+            }
+            if(!found)
+            {
+                throw std::invalid_argument("Unknown tuning threshold " + name + ".");
+            }
+        }
+        for(const threshold_name& threshold : threshold_names)
+        {
+            if(t.*threshold.member < threshold.least)
+            {
+                throw std::invalid_argument("Tuning threshold " + std::string(threshold.name) + " below the least its algorithm takes.");
+            }
+        }
+        return t;
+    }
+    // Write all the thresholds of t as a tuning file.
+    inline void write_tuning(std::ostream& out, const thresholds& t = tuning)
+    {
+        out << "digit_bits = " << digit_bits << '\n';
+        for(const threshold_name& threshold : threshold_names)
+        {
+            out << threshold.name << " = " << t.*threshold.member << '\n';
+        }
+    }
+    // Set tuning from the tuning file at path. Returns false if it cannot be opened, throws as read_tuning() does.
+    inline bool load_tuning(const std::string& path)
+    {
+        std::ifstream in(path);
+        if(!in)
+        {
+            return false;
+        }
+        tuning = read_tuning(in);
+        return true;
+    }
+    // The tuning file of the program, read before main(): $INTTITAN_TUNING, else INTTITAN_TUNING_FILE. A missing or
+    // invalid file leaves the built-in thresholds; the returned path is empty then.
+    inline const std::string startup_tuning = []
+    {
+        const char* variable = std::getenv("INTTITAN_TUNING");
+        const std::string path = variable != nullptr ? variable : INTTITAN_TUNING_FILE;
+        try
+        {
+            return !path.empty() and load_tuning(path) ? path : std::string();
+        }
+        catch(const std::invalid_argument&)
+        {
+            return std::string();
+        }
+    }();
+}
+
+#endif //INTTITAN_TUNING_H